@@ -7,9 +7,11 @@
 #include <algorithm>
 #include <cinttypes>
 #include <cmath>
+#include <condition_variable>
 #include <cstdint>
 #include <cstring>
 #include <optional>
+#include <thread>
 #include <sys/types.h>
 
 #include <speex/speex_resampler.h>
@@ -18,6 +20,7 @@
 #include "tal-chorus/ChorusEngine.h"
 
 #include "private/compressor.h"
+#include "private/stereo_highpass.h"
 
 #include "capture/capture.h"
 #include "channel_names.h"
@@ -68,11 +71,13 @@ constexpr auto DefaultBlocksize = 1024;
 constexpr auto MinBlocksize     = 16;
 constexpr auto MaxBlocksize     = 8192;
 
+// The channels' buffers of frames waiting to be mixed hold at least a few
+// default-sized blocks; they grow beyond that if the mixer falls behind
+constexpr size_t MinFrameBufferCapacity = 4 * DefaultBlocksize;
+
 template <class T, size_t ROWS, size_t COLS>
 using matrix = std::array<std::array<T, COLS>, ROWS>;
 
-using HighpassFilter = std::array<Iir::Butterworth::HighPass<2>, 2>;
-
 using EmVerb = MVerb<float>;
 
 struct CrossfeedSettings {
@@ -87,7 +92,7 @@ struct ReverbSettings {
 	// the low-end response like other reverbs. So we're adding one
 	// here. This helps take control over low-frequency build-up,
 	// resulting in a more pleasant sound.
-	HighpassFilter highpass_filter = {};
+	StereoHighpassFilter highpass_filter = {};
 
 	ReverbPreset preset            = ReverbPreset::None;
 	float synthesizer_send_level   = 0.0f;
@@ -123,9 +128,7 @@ struct ReverbSettings {
 
 		mverb.setSampleRate(static_cast<float>(sample_rate_hz));
 
-		for (auto& f : highpass_filter) {
-			f.setup(sample_rate_hz, highpass_freq_hz);
-		}
+		highpass_filter.Setup(sample_rate_hz, highpass_freq_hz);
 	}
 };
 
@@ -158,6 +161,10 @@ struct ChorusSettings {
 // This shows up nicely as 50% and -6.00 dB in the MIXER command's output
 constexpr auto Minus6db = 0.501f;
 
+// The mixer thread renders channels together with up to this many threads
+// minus one helper threads by default
+constexpr unsigned MaxRenderThreads = 8;
+
 struct MixerSettings {
 	RWQueue<AudioFrame> final_output{1};
 	RWQueue<int16_t> capture_queue{1};
@@ -174,11 +181,39 @@ struct MixerSettings {
 	// Temporary mixing buffers
 	std::vector<AudioFrame> reverb_aux_buffer   = {};
 	std::vector<AudioFrame> chorus_aux_buffer   = {};
+
+	// Planar buffers for processing the reverb and chorus in whole blocks
+	std::array<std::vector<float>, 2> effect_in_buffers  = {};
+	std::array<std::vector<float>, 2> effect_out_buffers = {};
 	std::vector<int16_t> capture_buffer         = {};
 	std::vector<AudioFrame> fast_forward_buffer = {};
 
 	std::map<std::string, MixerChannelPtr> channels = {};
 
+	// The channels with the ParallelRender feature are rendered in parallel
+	// by the mixer thread and these helper threads, then all channels are
+	// accumulated one by one in channel order, so the mixed output doesn't
+	// depend on which thread rendered what
+	struct {
+		std::vector<std::thread> threads = {};
+
+		// Including the mixer thread; 0 means one per core
+		unsigned num_threads = 0;
+
+		std::mutex mutex                = {};
+		std::condition_variable start   = {};
+		std::condition_variable done    = {};
+
+		uint32_t generation = 0;
+		size_t num_busy     = 0;
+		bool should_exit    = false;
+
+		std::vector<MixerChannel*> channels        = {};
+		std::vector<MixerChannel*> serial_channels = {};
+		int frames_requested                       = 0;
+		std::atomic<size_t> next_channel           = 0;
+	} render = {};
+
 	std::map<std::string, MixerChannelSettings> channel_settings_cache = {};
 
 	std::atomic<bool> thread_should_quit = false;
@@ -215,7 +250,7 @@ struct MixerSettings {
 	// well-defined.
 	std::atomic<float> playback_gain = 1.0f;
 
-	HighpassFilter highpass_filter = {};
+	StereoHighpassFilter highpass_filter = {};
 	Compressor compressor          = {};
 	bool do_compressor             = false;
 
@@ -340,6 +375,9 @@ MixerChannel::MixerChannel(MIXER_Handler _handler, const std::string& _name,
           features(_features)
 {
 	do_sleep = HasFeature(ChannelFeature::Sleep);
+
+	// Make room for the frames added before the first mix
+	audio_frames.Reserve(MinFrameBufferCapacity);
 }
 
 bool MixerChannel::HasFeature(const ChannelFeature feature)
@@ -915,7 +953,7 @@ void MixerChannel::Enable(const bool should_enable)
 		// we don't perform this zero'ing in the enable phase.
 
 		frames_needed = 0;
-		audio_frames.clear();
+		audio_frames.Clear();
 
 		prev_frame = {0.0f, 0.0f};
 		next_frame = {0.0f, 0.0f};
@@ -1219,16 +1257,23 @@ void MixerChannel::Mix(const int frames_requested)
 		return;
 	}
 
+	const auto start_us = GetTicksUs();
+
 	frames_needed = frames_requested;
 
-	while (frames_needed > audio_frames.size()) {
-		std::unique_lock lock(mutex);
+	std::unique_lock lock(mutex);
 
+	// Leave room for the frames the handler adds beyond the requested ones
+	// (e.g., due to resampling). This only grows the buffer when a larger
+	// block is requested, such as in fast-forward mode.
+	audio_frames.Reserve(std::max(MinFrameBufferCapacity, frames_needed * 4));
+
+	while (frames_needed > audio_frames.Size()) {
 		auto stretch_factor = static_cast<float>(sample_rate_hz) /
 		                      static_cast<float>(mixer.sample_rate_hz);
 
 		auto frames_remaining = iceil(
-		        static_cast<float>(frames_needed - audio_frames.size()) *
+		        static_cast<float>(frames_needed - audio_frames.Size()) *
 		        stretch_factor);
 
 		// Avoid underflow
@@ -1238,18 +1283,39 @@ void MixerChannel::Mix(const int frames_requested)
 
 		lock.unlock();
 		handler(frames_remaining);
+		lock.lock();
+	}
+	lock.unlock();
+
+	const auto elapsed_us = GetTicksUsSince(start_us);
+
+	render_total_us.fetch_add(elapsed_us, std::memory_order_relaxed);
+	render_frames.fetch_add(frames_requested, std::memory_order_relaxed);
+	render_num_mixes.fetch_add(1, std::memory_order_relaxed);
+
+	if (elapsed_us > render_peak_us.load(std::memory_order_relaxed)) {
+		render_peak_us.store(elapsed_us, std::memory_order_relaxed);
 	}
 }
 
+MixerChannel::RenderTimes MixerChannel::GetRenderTimes() const
+{
+	return {render_total_us.load(std::memory_order_relaxed),
+	        render_peak_us.load(std::memory_order_relaxed),
+	        render_frames.load(std::memory_order_relaxed),
+	        render_num_mixes.load(std::memory_order_relaxed)};
+}
+
 void MixerChannel::AddSilence()
 {
 	std::lock_guard lock(mutex);
 
-	if (audio_frames.size() < frames_needed) {
+	const auto num_frames = audio_frames.Size();
+	if (num_frames < frames_needed) {
+		output_buffer.clear();
+
 		if (prev_frame.left == 0.0f && prev_frame.right == 0.0f) {
-			while (audio_frames.size() < frames_needed) {
-				audio_frames.emplace_back(0.0f, 0.0f);
-			}
+			output_buffer.resize(frames_needed - num_frames);
 
 			// Make sure the next samples are zero when they get
 			// switched to prev
@@ -1261,7 +1327,7 @@ void MixerChannel::AddSilence()
 			const auto mapped_output_left  = output_map.left;
 			const auto mapped_output_right = output_map.right;
 
-			while (audio_frames.size() < frames_needed) {
+			while (num_frames + output_buffer.size() < frames_needed) {
 				// Fade gradually to silence to avoid clicks.
 				// Maybe the fade factor f depends on the sample
 				// rate.
@@ -1286,15 +1352,39 @@ void MixerChannel::AddSilence()
 				out_frame[mapped_output_left] = frame_with_gain.left;
 				out_frame[mapped_output_right] = frame_with_gain.right;
 
-				audio_frames.push_back(out_frame);
+				output_buffer.push_back(out_frame);
 				prev_frame = next_frame;
 			}
 		}
+		PushFrames(output_buffer);
 	}
 
 	last_samples_were_silence = true;
 }
 
+// The caller needs to hold the mutex
+void MixerChannel::PushFrames(const std::vector<AudioFrame>& frames)
+{
+	// Count the frames that don't fit when the mixer falls behind; the
+	// buffer grows to keep them
+	const auto free_space = audio_frames.Capacity() - audio_frames.Size();
+	if (frames.size() > free_space) {
+		overrun_frames += check_cast<int64_t>(frames.size() - free_space);
+	}
+	audio_frames.Push(frames.data(), frames.size());
+
+	peak_occupancy = std::max(peak_occupancy, audio_frames.Size());
+}
+
+MixerChannel::FrameBufferStats MixerChannel::GetFrameBufferStats()
+{
+	std::lock_guard lock(mutex);
+	return {audio_frames.Size(),
+	        peak_occupancy,
+	        audio_frames.Capacity(),
+	        overrun_frames};
+}
+
 static void log_filter_settings(const std::string& channel_name,
                                 const std::string& filter_name, const int order,
                                 const int cutoff_freq_hz)
@@ -2186,9 +2276,7 @@ void MixerChannel::AddSamples(const int num_frames, const Type* data)
 	ConvertSamplesAndMaybeZohUpsample<Type, stereo, signeddata, nativeorder>(
 	        data, num_frames);
 
-	// Starting index this function will start writing to
-	// The audio_frames vector can contain previously converted/resampled audio
-	const size_t audio_frames_starting_size = audio_frames.size();
+	output_buffer.clear();
 
 	if (do_lerp_upsample) {
 		assert(!do_resample);
@@ -2208,7 +2296,7 @@ void MixerChannel::AddSamples(const int num_frames, const Type* data)
 			                               curr_frame.right,
 			                               s.pos);
 
-			audio_frames.push_back(lerped_frame);
+			output_buffer.push_back(lerped_frame);
 
 			s.pos += s.step;
 #if 0
@@ -2244,14 +2332,13 @@ void MixerChannel::AddSamples(const int num_frames, const Type* data)
 		// frames it wrote
 		const auto estimated_frames = out_frames;
 
-		audio_frames.resize(audio_frames_starting_size + estimated_frames);
+		output_buffer.resize(estimated_frames);
 
 		// These are vectors of AudioFrame which is just 2 packed floats
 		const auto input_ptr = reinterpret_cast<const float*>(
 		        convert_buffer.data());
 
-		auto output_ptr = reinterpret_cast<float*>(
-		        audio_frames.data() + audio_frames_starting_size);
+		auto output_ptr = reinterpret_cast<float*>(output_buffer.data());
 
 		speex_resampler_process_interleaved_float(speex_resampler.state,
 		                                          input_ptr,
@@ -2263,38 +2350,35 @@ void MixerChannel::AddSamples(const int num_frames, const Type* data)
 		// resampled frames, so ensure the number of output frames
 		// is within the logical size.
 		assert(out_frames <= estimated_frames);
-		audio_frames.resize(audio_frames_starting_size + out_frames); // only shrinks
+		output_buffer.resize(out_frames); // only shrinks
 	} else {
-		audio_frames.insert(audio_frames.end(),
-		                    convert_buffer.begin(),
-		                    convert_buffer.end());
+		output_buffer.assign(convert_buffer.begin(), convert_buffer.end());
 	}
 
 	// Optionally gate, filter, and apply crossfeed.
-	// Runs in-place over newly added frames.
-	for (size_t i = audio_frames_starting_size; i < audio_frames.size(); ++i) {
+	// Runs in-place over the new frames.
+	for (auto& frame : output_buffer) {
 		if (do_noise_gate) {
-			audio_frames[i] = noise_gate.processor.Process(
-			        audio_frames[i]);
+			frame = noise_gate.processor.Process(frame);
 		}
 
 		if (filters.highpass.state == FilterState::On) {
 			auto& hpf = filters.highpass.hpf;
 
-			audio_frames[i] = {hpf[0].filter(audio_frames[i].left),
-			                   hpf[1].filter(audio_frames[i].right)};
+			frame = {hpf[0].filter(frame.left), hpf[1].filter(frame.right)};
 		}
 		if (filters.lowpass.state == FilterState::On) {
 			auto& lpf = filters.lowpass.lpf;
 
-			audio_frames[i] = {lpf[0].filter(audio_frames[i].left),
-			                   lpf[1].filter(audio_frames[i].right)};
+			frame = {lpf[0].filter(frame.left), lpf[1].filter(frame.right)};
 		}
 
 		if (do_crossfeed) {
-			audio_frames[i] = ApplyCrossfeed(audio_frames[i]);
+			frame = ApplyCrossfeed(frame);
 		}
 	}
+
+	PushFrames(output_buffer);
 }
 
 void MixerChannel::AddSamples_m8(const int num_frames, const uint8_t* data)
@@ -2420,8 +2504,165 @@ static float normalize_sample(float sample)
 	return sample / 32768.0f;
 }
 
+// Renders the channels claimed from the shared counter until none are left;
+// runs on the mixer thread and the render threads at the same time
+static void render_claimed_channels()
+{
+	auto& render = mixer.render;
+
+	const auto num_channels = render.channels.size();
+	for (;;) {
+		const auto i = render.next_channel.fetch_add(1);
+		if (i >= num_channels) {
+			return;
+		}
+		render.channels[i]->Mix(render.frames_requested);
+	}
+}
+
+static void run_render_thread()
+{
+	auto& render = mixer.render;
+
+	uint32_t generation = 0;
+	for (;;) {
+		{
+			std::unique_lock lock(render.mutex);
+			render.start.wait(lock, [&] {
+				return render.should_exit ||
+				       render.generation != generation;
+			});
+			if (render.should_exit) {
+				return;
+			}
+			generation = render.generation;
+		}
+
+		render_claimed_channels();
+
+		std::lock_guard lock(render.mutex);
+		if (--render.num_busy == 0) {
+			render.done.notify_one();
+		}
+	}
+}
+
+static void start_render_threads()
+{
+	auto& render = mixer.render;
+	if (!render.threads.empty()) {
+		return;
+	}
+	const auto num_threads = (render.num_threads > 0)
+	                               ? render.num_threads
+	                               : std::min(std::thread::hardware_concurrency(),
+	                                          MaxRenderThreads);
+	for (unsigned i = 1; i < num_threads; ++i) {
+		render.threads.emplace_back(run_render_thread);
+		set_thread_name(render.threads.back(), "dosbox:mixrend");
+	}
+}
+
+static void stop_render_threads()
+{
+	auto& render = mixer.render;
+	{
+		std::lock_guard lock(render.mutex);
+		render.should_exit = true;
+	}
+	render.start.notify_all();
+
+	for (auto& thread : render.threads) {
+		thread.join();
+	}
+	render.threads.clear();
+	render.should_exit = false;
+}
+
+// Renders the requested frames of all enabled channels into their
+// `audio_frames` buffers. Only the channels with the ParallelRender feature
+// are handed to the render threads. Most device handlers haven't been checked
+// for state they share with other handlers, so they're rendered one after the
+// other on the mixer thread, meanwhile.
+static void render_channels(const int frames_requested)
+{
+	auto& render = mixer.render;
+
+	render.channels.clear();
+	render.serial_channels.clear();
+	for (const auto& [_, channel] : mixer.channels) {
+		if (!channel->is_enabled) {
+			continue;
+		}
+		if (channel->HasFeature(ChannelFeature::ParallelRender)) {
+			render.channels.push_back(channel.get());
+		} else {
+			render.serial_channels.push_back(channel.get());
+		}
+	}
+	render.frames_requested = frames_requested;
+	render.next_channel     = 0;
+
+	auto render_serial_channels = [&] {
+		for (const auto channel : render.serial_channels) {
+			channel->Mix(frames_requested);
+		}
+	};
+
+	// Don't wake up the render threads unless they'd have something to do
+	// while the mixer thread is busy
+	const auto num_jobs = render.channels.size() +
+	                      (render.serial_channels.empty() ? 0 : 1);
+
+	if (!render.channels.empty() && num_jobs > 1) {
+		start_render_threads();
+	}
+	if (render.channels.empty() || num_jobs <= 1 || render.threads.empty()) {
+		render_serial_channels();
+		render_claimed_channels();
+		return;
+	}
+
+	{
+		std::lock_guard lock(render.mutex);
+		render.num_busy = render.threads.size();
+		++render.generation;
+	}
+	render.start.notify_all();
+
+	render_serial_channels();
+	render_claimed_channels();
+
+	std::unique_lock lock(render.mutex);
+	render.done.wait(lock, [&] { return render.num_busy == 0; });
+}
+
+static void split_into_planar(const std::vector<AudioFrame>& frames,
+                              std::array<std::vector<float>, 2>& planar)
+{
+	planar[0].resize(frames.size());
+	planar[1].resize(frames.size());
+
+	for (size_t i = 0; i < frames.size(); ++i) {
+		planar[0][i] = frames[i].left;
+		planar[1][i] = frames[i].right;
+	}
+}
+
+static void add_from_planar(const std::array<std::vector<float>, 2>& planar,
+                            std::vector<AudioFrame>& frames)
+{
+	assert(planar[0].size() == frames.size());
+	assert(planar[1].size() == frames.size());
+
+	for (size_t i = 0; i < frames.size(); ++i) {
+		frames[i] += AudioFrame(planar[0][i], planar[1][i]);
+	}
+}
+
 // Mix a certain amount of new sample frames
-static void mix_samples(const int frames_requested)
+static void mix_samples(const int frames_requested,
+                        MixerBusInputs* bus_inputs = nullptr)
 {
 	assert(frames_requested > 0);
 
@@ -2434,83 +2675,91 @@ static void mix_samples(const int frames_requested)
 	mixer.chorus_aux_buffer.clear();
 	mixer.chorus_aux_buffer.resize(frames_requested);
 
-	// Render all channels and accumulate results in the master mixbuffer
-	for (const auto& [_, channel] : mixer.channels) {
-		channel->Mix(frames_requested);
+	render_channels(frames_requested);
 
+	// Accumulate the rendered channels in the master mixbuffer
+	for (const auto& [_, channel] : mixer.channels) {
 		std::lock_guard lock(channel->mutex);
 
+		const auto& audio_frames = channel->audio_frames;
+
 		const size_t num_frames = std::min(mixer.output_buffer.size(),
-		                                   channel->audio_frames.size());
+		                                   audio_frames.Size());
 
 		for (size_t i = 0; i < num_frames; ++i) {
 			if (channel->do_sleep) {
 				mixer.output_buffer[i] += channel->sleeper.MaybeFadeOrListen(
-				        channel->audio_frames[i]);
+				        audio_frames[i]);
 			} else {
-				mixer.output_buffer[i] += channel->audio_frames[i];
+				mixer.output_buffer[i] += audio_frames[i];
 			}
 
 			if (mixer.do_reverb && channel->do_reverb_send) {
-				mixer.reverb_aux_buffer[i] += channel->audio_frames[i] *
+				mixer.reverb_aux_buffer[i] += audio_frames[i] *
 				                              channel->reverb.send_gain;
 			}
 
 			if (mixer.do_chorus && channel->do_chorus_send) {
-				mixer.chorus_aux_buffer[i] += channel->audio_frames[i] *
+				mixer.chorus_aux_buffer[i] += audio_frames[i] *
 				                              channel->chorus.send_gain;
 			}
 		}
 
-		channel->audio_frames.erase(channel->audio_frames.begin(),
-		                            channel->audio_frames.begin() + num_frames);
+		channel->audio_frames.Pop(num_frames);
 
 		if (channel->do_sleep) {
 			channel->sleeper.MaybeSleep();
 		}
 	}
 
+	if (bus_inputs) {
+		bus_inputs->dry         = mixer.output_buffer;
+		bus_inputs->reverb_send = mixer.reverb_aux_buffer;
+		bus_inputs->chorus_send = mixer.chorus_aux_buffer;
+	}
+
 	if (mixer.do_reverb) {
 		// Apply reverb effect to the reverb aux buffer, then mix the
 		// results to the master output.
 		//
-		for (size_t i = 0; i < mixer.reverb_aux_buffer.size(); ++i) {
-			// High-pass filter the reverb input
-			auto& hpf = mixer.reverb.highpass_filter;
+		// High-pass filter the reverb input
+		mixer.reverb.highpass_filter.Process(mixer.reverb_aux_buffer);
 
-			// MVerb operates on two non-interleaved sample streams
-			AudioFrame in_frame = mixer.reverb_aux_buffer[i];
-			in_frame.left       = hpf[0].filter(in_frame.left);
-			in_frame.right      = hpf[1].filter(in_frame.right);
+		// MVerb operates on two non-interleaved sample streams
+		auto& in  = mixer.effect_in_buffers;
+		auto& out = mixer.effect_out_buffers;
+		split_into_planar(mixer.reverb_aux_buffer, in);
 
-			float* in_buf[2] = {&in_frame.left, &in_frame.right};
+		out[0].resize(in[0].size());
+		out[1].resize(in[1].size());
 
-			AudioFrame out_frame = {};
-			float* out_buf[2] = {&out_frame.left, &out_frame.right};
+		float* in_buf[2]  = {in[0].data(), in[1].data()};
+		float* out_buf[2] = {out[0].data(), out[1].data()};
 
-			constexpr auto NumFrames = 1;
-			mixer.reverb.mverb.process(in_buf, out_buf, NumFrames);
+		// Apply parameter changes at the start of the block like
+		// processing frame by frame did, rather than ramping them
+		mixer.reverb.mverb.processWithoutSmoothing(
+		        in_buf, out_buf, check_cast<int>(in[0].size()));
 
-			mixer.output_buffer[i] += out_frame;
-		}
+		add_from_planar(out, mixer.output_buffer);
 	}
 
 	if (mixer.do_chorus) {
 		// Apply chorus effect to the chorus aux buffer, then mix the
 		// results to the master output.
 		//
-		for (size_t i = 0; i < mixer.chorus_aux_buffer.size(); ++i) {
-			auto frame = mixer.chorus_aux_buffer[i];
-			mixer.chorus.chorus_engine.process(&frame.left, &frame.right);
-			mixer.output_buffer[i] += frame;
-		}
+		auto& buffers = mixer.effect_in_buffers;
+		split_into_planar(mixer.chorus_aux_buffer, buffers);
+
+		mixer.chorus.chorus_engine.process(buffers[0].data(),
+		                                   buffers[1].data(),
+		                                   check_cast<int>(buffers[0].size()));
+
+		add_from_planar(buffers, mixer.output_buffer);
 	}
 
 	// Apply high-pass filter to the master output
-	for (auto& frame : mixer.output_buffer) {
-		auto& hpf = mixer.highpass_filter;
-		frame = {hpf[0].filter(frame.left), hpf[1].filter(frame.right)};
-	}
+	mixer.highpass_filter.Process(mixer.output_buffer);
 
 	// Apply master gain
 	const auto gain = mixer.master_gain.load(std::memory_order_relaxed);
@@ -2554,6 +2803,34 @@ static void mix_samples(const int frames_requested)
 	}
 }
 
+static void init_master_highpass_filter();
+
+void MIXER_SetNumRenderThreads(const int num_threads)
+{
+	assert(num_threads > 0);
+
+	std::lock_guard lock(mixer.mutex);
+
+	stop_render_threads();
+	mixer.render.num_threads = static_cast<unsigned>(num_threads);
+}
+
+const std::vector<AudioFrame>& MIXER_MixBlock(const int num_frames,
+                                              MixerBusInputs* bus_inputs)
+{
+	// The tests and benchmarks mix without MIXER_Init()
+	static bool is_highpass_filter_set_up = false;
+	if (!is_highpass_filter_set_up && !mixer.thread.joinable()) {
+		init_master_highpass_filter();
+		is_highpass_filter_set_up = true;
+	}
+
+	std::lock_guard lock(mixer.mutex);
+
+	mix_samples(num_frames, bus_inputs);
+	return mixer.output_buffer;
+}
+
 // Run in the main thread by a PIC Callback. Drains whatever's currently in
 // the capture queue; never zero-pads. `mix_samples()` produces in
 // ~`blocksize` bursts paced by SDL, while this callback is paced by
@@ -3026,6 +3303,7 @@ void MIXER_CloseAudioDevice()
 		mixer.final_output.Stop();
 		mixer.thread.join();
 	}
+	stop_render_threads();
 
 	for (const auto& [_, channel] : mixer.channels) {
 		channel->Enable(false);
@@ -3182,9 +3460,7 @@ static void init_master_highpass_filter()
 	MIXER_LockMixerThread();
 
 	constexpr auto HighpassCutoffFreqHz = 20.0;
-	for (auto& f : mixer.highpass_filter) {
-		f.setup(mixer.sample_rate_hz, HighpassCutoffFreqHz);
-	}
+	mixer.highpass_filter.Setup(mixer.sample_rate_hz, HighpassCutoffFreqHz);
 
 	MIXER_UnlockMixerThread();
 }
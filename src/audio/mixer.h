@@ -28,6 +28,7 @@
 #include "config/config.h"
 #include "gui/titlebar.h"
 #include "utils/math_utils.h"
+#include "utils/fifo_buffer.h"
 
 // The mixer callback can accept a static function or a member function
 // using a std::bind. The callback typically requests enough frames to
@@ -147,6 +148,13 @@ enum class ChannelFeature {
 	DigitalAudio,
 	FadeOut,
 	NoiseGate,
+
+	// The channel's handler only touches the state of its own device, so
+	// it can run on a render thread at the same time as the handlers of
+	// other channels. The handlers of the other channels run one after the
+	// other on the mixer thread.
+	ParallelRender,
+
 	ReverbSend,
 	Sleep,
 	Stereo,
@@ -239,6 +247,27 @@ public:
 	void SetLineoutMap(const StereoLine map);
 	StereoLine GetLineoutMap();
 
+	// Wall-clock time the channel has spent rendering its audio in
+	// Mix(), including any time spent waiting for the device to produce
+	// it. Shown by the MIXER /timing command.
+	struct RenderTimes {
+		int64_t total_us  = 0;
+		int64_t peak_us   = 0;
+		int64_t frames    = 0;
+		int64_t num_mixes = 0;
+	};
+	RenderTimes GetRenderTimes() const;
+
+	// Fill level of the buffer of frames waiting to be mixed, and the
+	// number of frames added while it was full, which made it grow
+	struct FrameBufferStats {
+		size_t occupancy       = 0;
+		size_t peak_occupancy  = 0;
+		size_t capacity        = 0;
+		int64_t overrun_frames = 0;
+	};
+	FrameBufferStats GetFrameBufferStats();
+
 	std::string DescribeLineout();
 	void SetSampleRate(const int sample_rate_hz);
 	void SetPeakAmplitude(const int peak);
@@ -299,8 +328,12 @@ public:
 	// Pass-through to the sleeper
 	bool WakeUp();
 
-	std::vector<AudioFrame> audio_frames = {};
-	std::recursive_mutex mutex           = {};
+	// Frames rendered by the channel, waiting to be mixed. The mixer pops
+	// them from the front without moving the rest. Guarded by `mutex`, as
+	// adding frames also updates the other state of the channel. The
+	// buffer grows if the mixer falls behind, so frames are never dropped.
+	FifoBuffer<AudioFrame> audio_frames = {};
+	std::recursive_mutex mutex          = {};
 
 	std::atomic<bool> is_enabled = false;
 
@@ -375,17 +408,34 @@ private:
 
 	AudioFrame ApplyCrossfeed(const AudioFrame frame);
 
+	void PushFrames(const std::vector<AudioFrame>& frames);
+
 	std::string name = {};
 	Envelope envelope;
 	MIXER_Handler handler = nullptr;
 
 	std::vector<AudioFrame> convert_buffer = {};
 
+	// The frames being added by AddSamples(), resampled and filtered before
+	// they're pushed to `audio_frames`
+	std::vector<AudioFrame> output_buffer = {};
+
+	// Guarded by `mutex`, like `audio_frames`
+	size_t peak_occupancy  = 0;
+	int64_t overrun_frames = 0;
+
 	std::set<ChannelFeature> features = {};
 
 	// Timing on how many samples were needed by the mixer
 	size_t frames_needed = 0;
 
+	// Written by whichever mixer thread rendered the channel last, read by
+	// GetRenderTimes()
+	std::atomic<int64_t> render_total_us  = 0;
+	std::atomic<int64_t> render_peak_us   = 0;
+	std::atomic<int64_t> render_frames    = 0;
+	std::atomic<int64_t> render_num_mixes = 0;
+
 	// Previous and next sample fames
 	AudioFrame prev_frame = {};
 	AudioFrame next_frame = {};
@@ -546,6 +596,30 @@ void MIXER_RequestAutoUnmute();
 // reaches zero.
 float MIXER_GetPlaybackGain();
 
+// Test and benchmark API
+// ~~~~~~~~~~~~~~~~~~~~~~
+// Not for use by the emulator, which only mixes on the mixer thread.
+
+// The inputs of the master bus in a mixed block: the sum of the channels, and
+// what they send to the reverb and the chorus
+struct MixerBusInputs {
+	std::vector<AudioFrame> dry         = {};
+	std::vector<AudioFrame> reverb_send = {};
+	std::vector<AudioFrame> chorus_send = {};
+};
+
+// Sets how many threads render the channels with the ParallelRender feature,
+// counting the mixer thread; 1 renders all channels on the mixer thread. By
+// default, there's a thread per core, up to 8.
+void MIXER_SetNumRenderThreads(const int num_threads);
+
+// Mixes a block of frames from all channels and returns the master output,
+// like the mixer thread does but without sending it to the audio device.
+// Optionally copies the inputs of the master bus to 'bus_inputs'. Sets up
+// the master high-pass filter on the first call if MIXER_Init() hasn't run.
+const std::vector<AudioFrame>& MIXER_MixBlock(const int num_frames,
+                                              MixerBusInputs* bus_inputs = nullptr);
+
 void MIXER_LockMixerThread();
 void MIXER_UnlockMixerThread();
 void MIXER_CloseAudioDevice();
@@ -10,10 +10,12 @@
 #include <cassert>
 #include <cmath>
 #include <cstring>
+#include <thread>
 
 #include "hardware/memory.h"
 #include "misc/support.h"
 #include "utils/math_utils.h"
+#include "utils/rwqueue.h"
 
 static constexpr auto NumSampleFramesInBuffer = 16 * 1024;
 
@@ -64,9 +66,28 @@ static constexpr int AudioResyncCrossfadeFrames = 128;
 
 static constexpr auto AviHeaderSize = 500;
 
+// Compressing the frames (motion search, XOR, and deflate) and writing the
+// AVI chunks happen on a worker thread. The emulation thread only snapshots
+// the frames into a pool of buffers; when all of them are still waiting to
+// be compressed, the frame is dropped instead of stalling the emulation. A
+// dropped frame is written as an empty chunk that repeats the previous one,
+// so the video stays in sync with the audio.
+//
+// A pool of 8 frames absorbs the occasional slow keyframe at 70 Hz
+static constexpr auto NumPooledFrames = 8;
+
+// The dropped frames don't hold pooled buffers, so the queue has some room
+// for them on top of the pooled ones. The emulation thread only waits for the
+// encoder when even these are used up.
+static constexpr auto MaxQueuedFrames = NumPooledFrames * 4;
+
+// Write a keyframe every this many frames
+static constexpr auto KeyframeInterval = 300;
+
 static struct {
 	FILE* handle = nullptr;
 
+	// Owned by the encoder thread while it's running
 	uint32_t frames          = 0;
 	VideoCodec* codec        = nullptr;
 	int width                = 0;
@@ -105,6 +126,18 @@ static struct {
 		// cadence. See `AudioResyncIntervalVideoFrames`.
 		int num_video_frames_since_resync = 0;
 	} audio = {};
+
+	struct {
+		std::thread thread = {};
+
+		RWQueue<VideoCaptureFrame> queued_frames{MaxQueuedFrames};
+		RWQueue<VideoCaptureFrame> free_frames{NumPooledFrames};
+
+		uint32_t num_queued_frames  = 0;
+		bool is_keyframe_due        = false;
+		uint32_t num_dropped_frames = 0;
+		uint32_t num_delayed_frames = 0;
+	} encoder = {};
 } video = {};
 
 static ZMBV_FORMAT to_zmbv_format(const PixelFormat format)
@@ -180,26 +213,25 @@ static void add_avi_chunk(const char* tag, const uint32_t size,
 	host_writed(index + 12, size);
 }
 
-// Writes the first `num_sample_frames` sample frames from the audio buffer as
-// a single `01wb` AVI chunk, then shifts any remaining frames down to the
-// front of the buffer. A no-op when `num_sample_frames` is zero.
-static void write_audio_chunk(const int num_sample_frames)
+// Moves the first `num_sample_frames` sample frames from the audio buffer into
+// `chunk`, then shifts any remaining frames down to the front of the buffer.
+// Leaves `chunk` empty when `num_sample_frames` is zero.
+static void take_audio_chunk(const int num_sample_frames, std::vector<int16_t>& chunk)
 {
 	assert(num_sample_frames <=
 	       static_cast<int>(video.audio.num_buffered_frames));
 
+	chunk.clear();
 	if (num_sample_frames == 0) {
 		return;
 	}
 
-	add_avi_chunk("01wb",
-	              num_sample_frames * SampleFrameSizeBytes,
-	              video.audio.buf,
-	              0);
+	const auto first_sample = &video.audio.buf[0][0];
+	chunk.assign(first_sample, first_sample + num_sample_frames * NumAudioChannels);
 
 	video.audio.bytes_written += num_sample_frames * SampleFrameSizeBytes;
 
-	// Slide the frames we didn't write down to the front so the next chunk
+	// Slide the frames we didn't take down to the front so the next chunk
 	// starts at index 0.
 	const int num_remaining_frames = static_cast<int>(
 	                                         video.audio.num_buffered_frames) -
@@ -213,6 +245,19 @@ static void write_audio_chunk(const int num_sample_frames)
 	video.audio.num_buffered_frames = num_remaining_frames;
 }
 
+// Writes the sample frames as a single `01wb` AVI chunk. A no-op when the
+// chunk is empty.
+static void write_audio_chunk(const std::vector<int16_t>& chunk)
+{
+	if (chunk.empty()) {
+		return;
+	}
+	add_avi_chunk("01wb",
+	              check_cast<uint32_t>(chunk.size() * sizeof(int16_t)),
+	              chunk.data(),
+	              0);
+}
+
 // Sheds `num_frames_to_drop` sample frames from the front of the audio buffer
 // to pull the captured audio back in step with the video timeline (see
 // `AudioResyncIntervalVideoFrames`). Excising a run of frames outright would
@@ -272,11 +317,93 @@ static void drop_audio_surplus_with_crossfade(const int num_frames_to_drop)
 	video.audio.num_buffered_frames -= num_frames_to_drop;
 }
 
+// Runs on the encoder thread
+static void encode_frame(const VideoCaptureFrame& frame)
+{
+	if (frame.is_dropped) {
+		// An empty chunk tells the players to repeat the previous frame
+		add_avi_chunk("00dc", 0, video.buf.data(), 0);
+		video.frames++;
+
+	} else if (video.codec->PrepareCompressFrame(frame.codec_flags,
+	                                             to_zmbv_format(video.pixel_format),
+	                                             frame.palette.data(),
+	                                             video.buf.data(),
+	                                             video.buf_size)) {
+
+		const auto row_bytes = frame.pixels.size() /
+		                       static_cast<size_t>(video.height);
+
+		auto row = frame.pixels.data();
+		for (auto i = 0; i < video.height; ++i, row += row_bytes) {
+			video.codec->CompressLines(1, &row);
+		}
+
+		const auto written = video.codec->FinishCompressFrame();
+		if (written >= 0) {
+			add_avi_chunk("00dc",
+			              written,
+			              video.buf.data(),
+			              frame.codec_flags & 1 ? 0x10 : 0x0);
+			video.frames++;
+		}
+	}
+
+	write_audio_chunk(frame.audio);
+}
+
+static void encode_queued_frames()
+{
+	while (auto frame = video.encoder.queued_frames.Dequeue()) {
+		encode_frame(*frame);
+
+		// Return the buffer to the pool; the dropped frames never had one
+		if (!frame->is_dropped) {
+			frame->audio.clear();
+			video.encoder.free_frames.NonblockingEnqueue(std::move(*frame));
+		}
+	}
+}
+
+static void start_encoder()
+{
+	auto& encoder = video.encoder;
+
+	encoder.free_frames.Clear();
+	for (auto i = 0; i < NumPooledFrames; ++i) {
+		encoder.free_frames.NonblockingEnqueue(VideoCaptureFrame{});
+	}
+
+	encoder.num_queued_frames  = 0;
+	encoder.is_keyframe_due    = true;
+	encoder.num_dropped_frames = 0;
+	encoder.num_delayed_frames = 0;
+
+	encoder.queued_frames.Start();
+	encoder.thread = std::thread(encode_queued_frames);
+	set_thread_name(encoder.thread, "dosbox:vidcap");
+}
+
+// Blocks until the encoder has written all queued frames
+static void stop_encoder()
+{
+	auto& encoder = video.encoder;
+
+	encoder.queued_frames.Stop();
+	if (encoder.thread.joinable()) {
+		encoder.thread.join();
+	}
+}
+
 void capture_video_finalise()
 {
 	if (!video.handle) {
 		return;
 	}
+
+	// The encoder writes to the file, so it must finish first
+	stop_encoder();
+
 	if (video.codec) {
 		video.codec->FinishVideo();
 	}
@@ -284,7 +411,10 @@ void capture_video_finalise()
 	// Flush all audio still held back by the per-frame prebuffer so the
 	// stream contains every produced sample. Must run before the header is
 	// built below, which reads `bytes_written` as the audio stream length.
-	write_audio_chunk(video.audio.num_buffered_frames);
+	std::vector<int16_t> audio_chunk = {};
+	take_audio_chunk(static_cast<int>(video.audio.num_buffered_frames),
+	                 audio_chunk);
+	write_audio_chunk(audio_chunk);
 
 	uint8_t avi_header[AviHeaderSize];
 	uint32_t header_pos = 0;
@@ -440,6 +570,15 @@ void capture_video_finalise()
 	fclose(video.handle);
 	delete video.codec;
 	video.handle = nullptr;
+
+	const auto& encoder = video.encoder;
+	if (encoder.num_dropped_frames || encoder.num_delayed_frames) {
+		LOG_WARNING("CAPTURE: The video encoder couldn't keep up; %u of %u frames "
+		            "were dropped and the emulation waited for %u frames",
+		            encoder.num_dropped_frames,
+		            encoder.num_queued_frames,
+		            encoder.num_delayed_frames);
+	}
 }
 
 // Buffers freshly captured audio delivered by the capture pipeline until
@@ -480,6 +619,10 @@ static void create_avi_file(const uint16_t width, const uint16_t height,
 	}
 	video.codec = new VideoCodec();
 	if (!video.codec->SetupCompress(width, height)) {
+		fclose(video.handle);
+		delete video.codec;
+		video.handle = nullptr;
+		video.codec  = nullptr;
 		return;
 	}
 
@@ -506,13 +649,15 @@ static void create_avi_file(const uint16_t width, const uint16_t height,
 	video.audio.frame_credit                  = 0.0;
 	video.audio.is_primed                     = false;
 	video.audio.num_video_frames_since_resync = 0;
+
+	start_encoder();
 }
 
 // Performs some transforms on the passed down rendered image to make sure
-// we're capturing the raw output, then passes the result in the same
-// byte-order to the encoder. Endianness varies per pixel format (see
-// PixelFormat in video.h for details); the ZMBV encoder handles all that
-// detail.
+// we're capturing the raw output, then copies the result in the same
+// byte-order into the frame buffer for the encoder. Endianness varies per
+// pixel format (see PixelFormat in video.h for details); the ZMBV encoder
+// handles all that detail.
 //
 // We always write non-double-scanned and non-pixel-doubled frames in raw
 // video capture mode :
@@ -532,7 +677,7 @@ static void create_avi_file(const uint16_t width, const uint16_t height,
 // artifacts (so 320x200 is rendered as 640x200, and 640x200 as 1280x200).
 // These are written as-is, otherwise we'd be losing information.
 //
-static void compress_raw_frame(const RenderedImage& image)
+static void snapshot_raw_frame(const RenderedImage& image, std::vector<uint8_t>& pixels)
 {
 	const auto& src = image.params;
 	auto src_row    = image.image_data;
@@ -548,115 +693,67 @@ static void compress_raw_frame(const RenderedImage& image)
 
 	const auto pixel_skip_count = (src.rendered_pixel_doubling ? 1 : 0);
 
-	auto compress_row = [&](const uint8_t* row_buffer) {
-		video.codec->CompressLines(1, &row_buffer);
-	};
-
 	const auto src_bpp = to_bytes_per_pixel(src.pixel_format);
 	const auto dest_bpp = to_bytes_per_pixel(to_zmbv_format(src.pixel_format));
 
-	// Maybe compress the source rows straight away without copying. Note
-	// that this is a shortcut scenario; hard-code it to false to exercise
-	// the rote version below.
+	// The rows are stored back to back; the buffer only grows on the
+	// first frames and on resolution changes
+	const auto dest_row_bytes = static_cast<size_t>(raw_width) * dest_bpp;
+	pixels.resize(dest_row_bytes * static_cast<size_t>(raw_height));
 
+	auto dest_row = pixels.data();
+
+	// Maybe copy the source rows straight away. Note that this is a
+	// shortcut scenario; hard-code it to false to exercise the rote
+	// version below.
 	const auto can_use_src_directly = (src_bpp == dest_bpp &&
 	                                   pixel_skip_count == 0);
 	if (can_use_src_directly) {
 		for (auto i = 0; i < raw_height; ++i, src_row += src_pitch) {
-			compress_row(src_row);
+			std::memcpy(dest_row, src_row, dest_row_bytes);
+			dest_row += dest_row_bytes;
 		}
 		return;
 	}
 
-	// Otherwise we need to arrange the source bytes before compressing
+	// Otherwise we need to arrange the source bytes
 	assert(!can_use_src_directly);
 
-	// Grow the target row buffer if needed
-	const auto dest_row_bytes = check_cast<uint16_t>(src.width * dest_bpp);
-	static std::vector<uint8_t> dest_row = {};
-	if (dest_row.size() < dest_row_bytes) {
-		dest_row.resize(dest_row_bytes, 0);
-	}
-
 	const auto src_advance = src_bpp * (pixel_skip_count + 1);
 
 	for (auto i = 0; i < raw_height; ++i, src_row += src_pitch) {
 		auto src_pixel  = src_row;
-		auto dest_pixel = dest_row.data();
+		auto dest_pixel = dest_row;
 
 		for (auto j = 0; j < raw_width; ++j, src_pixel += src_advance) {
 			std::memcpy(dest_pixel, src_pixel, src_bpp);
 			dest_pixel += dest_bpp;
 		}
-		compress_row(dest_row.data());
+		dest_row += dest_row_bytes;
 	}
 }
 
-void capture_video_add_frame(const RenderedImage& image, const float frames_per_second)
+// Returns a pooled frame to snapshot the image into, or a dropped frame if
+// the encoder is still busy with all of them
+static VideoCaptureFrame get_free_frame()
 {
-	const auto& src = image.params;
-	assert(src.width <= ScalerMaxWidth);
+	auto& encoder = video.encoder;
 
-	// To reconstruct the raw image, we must skip every second row when
-	// dealing with "baked-in" double scanning.
-	const auto raw_width = check_cast<uint16_t>(
-	        src.width / (src.rendered_pixel_doubling ? 2 : 1));
-
-	// To reconstruct the raw image, we must skip every second pixel
-	// when dealing with "baked-in" pixel doubling.
-	const auto raw_height = check_cast<uint16_t>(
-	        src.height / (src.rendered_double_scan ? 2 : 1));
+	// Only this thread takes frames from the pool, so it can't run dry
+	// between the check and the dequeue
+	if (encoder.free_frames.IsEmpty()) {
+		++encoder.num_dropped_frames;
 
-	// Disable capturing if any of the test fails
-	if (video.handle && (video.width != raw_width || video.height != raw_height ||
-	                     video.pixel_format != src.pixel_format ||
-	                     video.frames_per_second != frames_per_second)) {
-		capture_video_finalise();
+		VideoCaptureFrame frame = {};
+		frame.is_dropped        = true;
+		return frame;
 	}
+	return std::move(*encoder.free_frames.Dequeue());
+}
 
-	const auto zmbv_format = to_zmbv_format(src.pixel_format);
-
-	if (!video.handle) {
-		create_avi_file(raw_width,
-		                raw_height,
-		                src.pixel_format,
-		                frames_per_second,
-		                zmbv_format);
-	}
-	if (!video.handle) {
-		return;
-	}
-
-	const auto codec_flags = (video.frames % 300 == 0) ? 1 : 0;
-
-	static uint8_t palette_data[NumVgaColors * 4] = {};
-
-	for (auto i = 0; i < NumVgaColors; ++i) {
-		const auto color = image.palette[i];
-
-		palette_data[i * 4]     = color.red;
-		palette_data[i * 4 + 1] = color.green;
-		palette_data[i * 4 + 2] = color.blue;
-	}
-
-	if (!video.codec->PrepareCompressFrame(codec_flags,
-	                                       zmbv_format,
-	                                       palette_data,
-	                                       video.buf.data(),
-	                                       video.buf_size)) {
-		return;
-	}
-
-	compress_raw_frame(image);
-
-	const auto written = video.codec->FinishCompressFrame();
-	if (written < 0) {
-		return;
-	}
-
-	add_avi_chunk("00dc", written, video.buf.data(), codec_flags & 1 ? 0x10 : 0x0);
-	video.frames++;
-
+// Meters out the audio to write after the current video frame
+static void take_audio_for_frame(std::vector<int16_t>& audio_chunk)
+{
 	// Meter audio out evenly across video frames instead of dumping every
 	// sample that arrived since the last frame into one `01wb` chunk. We
 	// hold back a reserve (`AudioPrebufferFrames`) and emit a fixed
@@ -690,7 +787,7 @@ void capture_video_add_frame(const RenderedImage& image, const float frames_per_
 	}
 
 	video.audio.frame_credit -= num_audio_frames_to_write;
-	write_audio_chunk(num_audio_frames_to_write);
+	take_audio_chunk(num_audio_frames_to_write, audio_chunk);
 
 	// Shed accumulated surplus to keep the captured audio locked to the
 	// (emulated-time) video timeline. See the `AudioResync*` constants.
@@ -730,3 +827,70 @@ void capture_video_add_frame(const RenderedImage& image, const float frames_per_
 		          AudioPrebufferFrames);
 	}
 }
+
+void capture_video_add_frame(const RenderedImage& image, const float frames_per_second)
+{
+	const auto& src = image.params;
+	assert(src.width <= ScalerMaxWidth);
+
+	// To reconstruct the raw image, we must skip every second row when
+	// dealing with "baked-in" double scanning.
+	const auto raw_width = check_cast<uint16_t>(
+	        src.width / (src.rendered_pixel_doubling ? 2 : 1));
+
+	// To reconstruct the raw image, we must skip every second pixel
+	// when dealing with "baked-in" pixel doubling.
+	const auto raw_height = check_cast<uint16_t>(
+	        src.height / (src.rendered_double_scan ? 2 : 1));
+
+	// Disable capturing if any of the test fails
+	if (video.handle && (video.width != raw_width || video.height != raw_height ||
+	                     video.pixel_format != src.pixel_format ||
+	                     video.frames_per_second != frames_per_second)) {
+		capture_video_finalise();
+	}
+
+	const auto zmbv_format = to_zmbv_format(src.pixel_format);
+
+	if (!video.handle) {
+		create_avi_file(raw_width,
+		                raw_height,
+		                src.pixel_format,
+		                frames_per_second,
+		                zmbv_format);
+	}
+	if (!video.handle) {
+		return;
+	}
+
+	auto& encoder = video.encoder;
+
+	if (encoder.num_queued_frames % KeyframeInterval == 0) {
+		encoder.is_keyframe_due = true;
+	}
+	++encoder.num_queued_frames;
+
+	auto frame = get_free_frame();
+	if (!frame.is_dropped) {
+		for (auto i = 0; i < NumVgaColors; ++i) {
+			const auto color = image.palette[i];
+
+			frame.palette[i * 4]     = color.red;
+			frame.palette[i * 4 + 1] = color.green;
+			frame.palette[i * 4 + 2] = color.blue;
+		}
+
+		snapshot_raw_frame(image, frame.pixels);
+
+		frame.codec_flags       = encoder.is_keyframe_due ? 1 : 0;
+		encoder.is_keyframe_due = false;
+	}
+
+	take_audio_for_frame(frame.audio);
+
+	// Only wait for the encoder when the queue is full of dropped frames
+	if (encoder.queued_frames.IsFull()) {
+		++encoder.num_delayed_frames;
+	}
+	encoder.queued_frames.Enqueue(std::move(frame));
+}
@@ -1,12 +1,34 @@
-// SPDX-FileCopyrightText:  2023-2025 The DOSBox Staging Team
+// SPDX-FileCopyrightText:  2023-2026 The DOSBox Staging Team
 // SPDX-FileCopyrightText:  2002-2021 The DOSBox Team
 // SPDX-License-Identifier: GPL-2.0-or-later
 
 #ifndef DOSBOX_CAPTURE_VIDEO_H
 #define DOSBOX_CAPTURE_VIDEO_H
 
+#include <array>
+#include <cstdint>
+#include <vector>
+
 #include "gui/render/render.h"
 
+// A snapshot of a video frame queued for compression, together with the
+// audio to write after it
+struct VideoCaptureFrame {
+	// Raw rows in the encoder's input format; the buffers are pooled and
+	// reused for the following frames
+	std::vector<uint8_t> pixels = {};
+
+	std::array<uint8_t, NumVgaColors * 4> palette = {};
+
+	int codec_flags = 0;
+
+	// The encoder couldn't keep up, so the frame is written as an empty
+	// chunk to repeat the previous one
+	bool is_dropped = false;
+
+	std::vector<int16_t> audio = {};
+};
+
 void capture_video_add_frame(const RenderedImage& image,
                              const float frames_per_second);
 
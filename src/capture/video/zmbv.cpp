@@ -3,12 +3,14 @@
 
 #include "zmbv.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 
+#include "simde/x86/sse2.h"
 #include "utils/math_utils.h"
 #include "utils/mem_unaligned.h"
 #include "misc/support.h"
@@ -32,6 +34,14 @@ constexpr int ZLIB_MEM_LEVEL           = 9;          // 1 to 9 (default 8)
 constexpr auto ZLIB_STRATEGY           = Z_FILTERED; // Z_DEFAULT_STRATEGY, Z_FILTERED,
                                                      // Z_HUFFMAN_ONLY, Z_RLE, Z_FIXED
 
+// Smaller frames are searched on the compressing thread alone; splitting the
+// work costs more than it saves (320x200 has 260 blocks, 640x480 has 1200)
+constexpr size_t MIN_BLOCKS_FOR_SEARCH_THREADS = 512;
+constexpr unsigned MAX_SEARCH_THREADS           = 4;
+
+// Number of blocks a search thread claims at once
+constexpr size_t SEARCH_BLOCKS_PER_TASK = 16;
+
 ZMBV_FORMAT BPPFormat(const int bpp)
 {
 	switch (bpp) {
@@ -102,6 +112,7 @@ bool VideoCodec::SetupBuffers(const ZMBV_FORMAT _format, const int blockwidth, c
 
 	const auto blocks_needed = check_cast<uint32_t>(xblocks * yblocks);
 	blocks.resize(blocks_needed);
+	block_matches.resize(blocks_needed);
 
 	size_t i = 0;
 	for (auto y = 0; y < yblocks; ++y) {
@@ -163,6 +174,65 @@ int VideoCodec::PossibleBlock(const int vx, const int vy, const FrameBlock & blo
 	return ret;
 }
 
+// The number of pixels of type P in a 128-bit vector, and the mask of the
+// bits that are compared (the padding byte of 32-bit pixels is ignored)
+template <class P>
+constexpr int PixelsPerVector = 16 / static_cast<int>(sizeof(P));
+
+template <class P>
+static simde__m128i pixel_mask()
+{
+	return simde_mm_set1_epi32(sizeof(P) == 4 ? 0x00ffffff : -1);
+}
+
+// Compares the pixels of type P in the vectors; the equal ones are -1 and the
+// others 0 in the returned lanes
+template <class P>
+static simde__m128i compare_pixels(const simde__m128i a, const simde__m128i b)
+{
+	const auto diff = simde_mm_and_si128(simde_mm_xor_si128(a, b), pixel_mask<P>());
+	const auto zero = simde_mm_setzero_si128();
+
+	if constexpr (sizeof(P) == 1) {
+		return simde_mm_cmpeq_epi8(diff, zero);
+	} else if constexpr (sizeof(P) == 2) {
+		return simde_mm_cmpeq_epi16(diff, zero);
+	} else {
+		return simde_mm_cmpeq_epi32(diff, zero);
+	}
+}
+
+// Subtracting the comparison results counts the equal pixels per lane
+template <class P>
+static simde__m128i count_equal_pixels(const simde__m128i counts, const simde__m128i equal)
+{
+	if constexpr (sizeof(P) == 1) {
+		return simde_mm_sub_epi8(counts, equal);
+	} else if constexpr (sizeof(P) == 2) {
+		return simde_mm_sub_epi16(counts, equal);
+	} else {
+		return simde_mm_sub_epi32(counts, equal);
+	}
+}
+
+// Returns the sum of the per-lane counts; a lane counts at most one pixel per
+// row, so even the 8-bit lanes can't overflow within a block
+template <class P>
+static int sum_pixel_counts(const simde__m128i counts)
+{
+	simde__m128i sums = {};
+	if constexpr (sizeof(P) == 1) {
+		sums = simde_mm_sad_epu8(counts, simde_mm_setzero_si128());
+	} else if constexpr (sizeof(P) == 2) {
+		sums = simde_mm_madd_epi16(counts, simde_mm_set1_epi16(1));
+		sums = simde_mm_add_epi32(sums, simde_mm_srli_si128(sums, 4));
+	} else {
+		sums = simde_mm_add_epi32(counts, simde_mm_srli_si128(counts, 4));
+	}
+	sums = simde_mm_add_epi32(sums, simde_mm_srli_si128(sums, 8));
+	return simde_mm_cvtsi128_si32(sums);
+}
+
 template <class P>
 int VideoCodec::CompareBlock(const int vx, const int vy, const FrameBlock & block)
 {
@@ -170,14 +240,29 @@ int VideoCodec::CompareBlock(const int vx, const int vy, const FrameBlock & bloc
 	P *pold = reinterpret_cast<P *>(oldframe) + block.start + (vy * pitch) + vx;
 	P *pnew = reinterpret_cast<P *>(newframe) + block.start;
 
+	// The blocks are 16 pixels wide except at the right edge of the frame;
+	// the scalar loop does the whole row if SIMD is off
+	const auto num_vectors = search.use_simd ? block.dx / PixelsPerVector<P> : 0;
+	const auto vector_end  = num_vectors * PixelsPerVector<P>;
+
+	auto equal_counts = simde_mm_setzero_si128();
+
 	for (auto y = 0; y < block.dy; y++) {
-		for (auto x = 0; x < block.dx; x++) {
+		for (auto x = 0; x < vector_end; x += PixelsPerVector<P>) {
+			const auto old_pixels = simde_mm_loadu_si128(
+			        reinterpret_cast<const simde__m128i *>(pold + x));
+			const auto new_pixels = simde_mm_loadu_si128(
+			        reinterpret_cast<const simde__m128i *>(pnew + x));
+			equal_counts = count_equal_pixels<P>(
+			        equal_counts, compare_pixels<P>(old_pixels, new_pixels));
+		}
+		for (auto x = vector_end; x < block.dx; x++) {
 			diff_count += ((pold[x] ^ pnew[x]) & 0x00ffffff) != 0;
 		}
 		pold += pitch;
 		pnew += pitch;
 	}
-	return diff_count;
+	return diff_count + vector_end * block.dy - sum_pixel_counts<P>(equal_counts);
 }
 
 template <class P>
@@ -185,8 +270,19 @@ void VideoCodec::AddXorBlock(const int vx, const int vy, const FrameBlock & bloc
 {
 	P *pold = reinterpret_cast<P *>(oldframe) + block.start + (vy * pitch) + vx;
 	P *pnew = reinterpret_cast<P *>(newframe) + block.start;
+	const auto vector_end = search.use_simd ? block.dx : 0;
 	for (auto y = 0; y < block.dy; ++y) {
-		for (auto x = 0; x < block.dx; ++x) {
+		auto x = 0;
+		for (; x + PixelsPerVector<P> <= vector_end; x += PixelsPerVector<P>) {
+			const auto old_pixels = simde_mm_loadu_si128(
+			        reinterpret_cast<const simde__m128i *>(pold + x));
+			const auto new_pixels = simde_mm_loadu_si128(
+			        reinterpret_cast<const simde__m128i *>(pnew + x));
+			simde_mm_storeu_si128(reinterpret_cast<simde__m128i *>(&work[workUsed]),
+			                      simde_mm_xor_si128(new_pixels, old_pixels));
+			workUsed += sizeof(simde__m128i);
+		}
+		for (; x < block.dx; ++x) {
 			*reinterpret_cast<P *>(&work[workUsed]) = pnew[x] ^ pold[x];
 			workUsed += sizeof(P);
 		}
@@ -200,6 +296,132 @@ void VideoCodec::AlignWork(size_t & offset) {
 	offset = (offset + blocks.size() * 2u + 3u) & ~3u;
 }
 
+template <class P>
+VideoCodec::BlockMatch VideoCodec::SearchBlock(const FrameBlock & block)
+{
+	BlockMatch match = {};
+	match.change     = CompareBlock<P>(0, 0, block);
+
+	auto possibles = 64;
+
+	for (auto v = 0; v < VectorCount && possibles; v++) {
+		if (match.change < 4)
+			break;
+		auto vx = VectorTable[v].x;
+		auto vy = VectorTable[v].y;
+		if (PossibleBlock<P>(vx, vy, block) < 4) {
+			possibles--;
+			// if (!possibles) Msg("Ran out of possibles, at
+			// %d of %d best%d\n",v,VectorCount,bestchange);
+			auto testchange = CompareBlock<P>(vx, vy, block);
+			if (testchange < match.change) {
+				match.change = testchange;
+				match.vx     = check_cast<int8_t>(vx);
+				match.vy     = check_cast<int8_t>(vy);
+			}
+		}
+	}
+	return match;
+}
+
+// Searches the blocks claimed from the shared counter until none are left;
+// runs on the compressing and the helper threads at the same time
+template <class P>
+void VideoCodec::SearchBlocks()
+{
+	const auto num_blocks = blocks.size();
+	for (;;) {
+		const auto first = search.next_block.fetch_add(SEARCH_BLOCKS_PER_TASK);
+		if (first >= num_blocks) {
+			return;
+		}
+		const auto last = std::min(first + SEARCH_BLOCKS_PER_TASK, num_blocks);
+		for (auto b = first; b < last; ++b) {
+			block_matches[b] = SearchBlock<P>(blocks[b]);
+		}
+	}
+}
+
+template <class P>
+void VideoCodec::SearchAllBlocks()
+{
+	search.next_block = 0;
+
+	if (search.threads.empty()) {
+		SearchBlocks<P>();
+		return;
+	}
+
+	{
+		std::lock_guard lock(search.mutex);
+		search.search_blocks = &VideoCodec::SearchBlocks<P>;
+		search.num_busy      = search.threads.size();
+		++search.generation;
+	}
+	search.start.notify_all();
+
+	SearchBlocks<P>();
+
+	std::unique_lock lock(search.mutex);
+	search.done.wait(lock, [&] { return search.num_busy == 0; });
+}
+
+void VideoCodec::RunSearchThread()
+{
+	uint32_t generation = 0;
+	for (;;) {
+		void (VideoCodec::*search_blocks)() = nullptr;
+		{
+			std::unique_lock lock(search.mutex);
+			search.start.wait(lock, [&] {
+				return search.should_exit || search.generation != generation;
+			});
+			if (search.should_exit) {
+				return;
+			}
+			generation    = search.generation;
+			search_blocks = search.search_blocks;
+		}
+
+		(this->*search_blocks)();
+
+		std::lock_guard lock(search.mutex);
+		if (--search.num_busy == 0) {
+			search.done.notify_one();
+		}
+	}
+}
+
+void VideoCodec::StartSearchThreads()
+{
+	if (!search.threads.empty() || blocks.size() < MIN_BLOCKS_FOR_SEARCH_THREADS) {
+		return;
+	}
+	const auto num_threads = search.num_threads
+	                               ? search.num_threads
+	                               : std::min(std::thread::hardware_concurrency(),
+	                                          MAX_SEARCH_THREADS);
+	for (unsigned i = 1; i < num_threads; ++i) {
+		search.threads.emplace_back(&VideoCodec::RunSearchThread, this);
+		set_thread_name(search.threads.back(), "dosbox:zmbv");
+	}
+}
+
+void VideoCodec::StopSearchThreads()
+{
+	{
+		std::lock_guard lock(search.mutex);
+		search.should_exit = true;
+	}
+	search.start.notify_all();
+
+	for (auto &thread : search.threads) {
+		thread.join();
+	}
+	search.threads.clear();
+	search.should_exit = false;
+}
+
 template <class P>
 void VideoCodec::AddXorFrame()
 {
@@ -207,41 +429,31 @@ void VideoCodec::AddXorFrame()
 
 	AlignWork(workUsed);
 
+	// The blocks are searched in parallel, but their vectors and XOR data
+	// are written in order, so the output is the same as searching them
+	// one by one
+	SearchAllBlocks<P>();
+
 	size_t b = 0;
 	for (const auto & block : blocks) {
+		const auto& match = block_matches[b];
 
-		int8_t bestvx   = 0;
-		int8_t bestvy   = 0;
-		auto bestchange = CompareBlock<P>(0, 0, block);
-		auto possibles  = 64;
-
-		for (auto v = 0; v < VectorCount && possibles; v++) {
-			if (bestchange < 4)
-				break;
-			auto vx = VectorTable[v].x;
-			auto vy = VectorTable[v].y;
-			if (PossibleBlock<P>(vx, vy, block) < 4) {
-				possibles--;
-				// if (!possibles) Msg("Ran out of possibles, at
-				// %d of %d best%d\n",v,VectorCount,bestchange);
-				auto testchange = CompareBlock<P>(vx, vy, block);
-				if (testchange < bestchange) {
-					bestchange = testchange;
-					bestvx     = check_cast<int8_t>(vx);
-					bestvy     = check_cast<int8_t>(vy);
-				}
-			}
-		}
-		vectors[b * 2 + 0] = static_cast<uint8_t>(left_shift_signed(bestvx, 1));
-		vectors[b * 2 + 1] = static_cast<uint8_t>(left_shift_signed(bestvy, 1));
-		if (bestchange) {
+		vectors[b * 2 + 0] = static_cast<uint8_t>(left_shift_signed(match.vx, 1));
+		vectors[b * 2 + 1] = static_cast<uint8_t>(left_shift_signed(match.vy, 1));
+		if (match.change) {
 			vectors[b * 2 + 0] |= 1;
-			AddXorBlock<P>(bestvx, bestvy, block);
+			AddXorBlock<P>(match.vx, match.vy, block);
 		}
 		++b;
 	}
 }
 
+void VideoCodec::SetSearchOptions(const bool use_simd, const unsigned num_threads)
+{
+	search.use_simd    = use_simd;
+	search.num_threads = num_threads;
+}
+
 bool VideoCodec::SetupCompress(const int _width, const int _height)
 {
 	width  = _width;
@@ -271,6 +483,7 @@ bool VideoCodec::PrepareCompressFrame(int flags, const ZMBV_FORMAT _format, cons
 	if (_format != format) {
 		if (!SetupBuffers(_format, 16, 16))
 			return false;
+		StartSearchThreads();
 		flags |= 1; // Force a keyframe
 	}
 	/* replace oldframe with new frame */
@@ -592,3 +805,8 @@ VideoCodec::VideoCodec()
 	CreateVectorTable();
 	memset(&zstream, 0, sizeof(zstream));
 }
+
+VideoCodec::~VideoCodec()
+{
+	StopSearchThreads();
+}
@@ -4,7 +4,11 @@
 #ifndef DOSBOX_ZMBV_H
 #define DOSBOX_ZMBV_H
 
+#include <atomic>
+#include <condition_variable>
 #include <cstdint>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 #include "dosbox_config.h"
@@ -51,6 +55,11 @@ private:
 		int y = 0;
 		int slot = 0;
 	};
+	struct BlockMatch {
+		int8_t vx = 0;
+		int8_t vy = 0;
+		int change = 0;
+	};
 	struct KeyframeHeader {
 		uint8_t high_version = 0;
 		uint8_t low_version = 0;
@@ -81,6 +90,7 @@ private:
 	uint32_t bufsize = 0;
 
 	std::vector<FrameBlock> blocks = {};
+	std::vector<BlockMatch> block_matches = {};
 	size_t workUsed = 0;
 	size_t workPos = 0;
 
@@ -95,6 +105,27 @@ private:
 	Compress compress = {};
 	z_stream zstream = {};
 
+	// The motion search of the blocks is split between the compressing
+	// thread and these helper threads
+	struct {
+		std::vector<std::thread> threads = {};
+
+		std::mutex mutex = {};
+		std::condition_variable start = {};
+		std::condition_variable done = {};
+
+		uint32_t generation = 0;
+		size_t num_busy = 0;
+		bool should_exit = false;
+
+		void (VideoCodec::*search_blocks)() = nullptr;
+		std::atomic<size_t> next_block = 0;
+
+		// Set by the tests to compare against the plain search
+		bool use_simd = true;
+		unsigned num_threads = 0;
+	} search = {};
+
 	// methods
 	void CreateVectorTable();
 	bool SetupBuffers(ZMBV_FORMAT format, int blockwidth, int blockheight);
@@ -110,6 +141,15 @@ private:
 	template <class P>
 	void AddXorBlock(int vx, int vy, const FrameBlock & block);
 	template <class P>
+	BlockMatch SearchBlock(const FrameBlock & block);
+	template <class P>
+	void SearchBlocks();
+	template <class P>
+	void SearchAllBlocks();
+	void StartSearchThreads();
+	void StopSearchThreads();
+	void RunSearchThread();
+	template <class P>
 	void UnXorBlock(int vx, int vy, const FrameBlock & block);
 	template <class P>
 	void CopyBlock(int vx, int vy, const FrameBlock & block);
@@ -118,10 +158,16 @@ private:
 
 public:
 	VideoCodec();
+	~VideoCodec();
 
 	VideoCodec(const VideoCodec &) = delete;            // prevent copy
 	VideoCodec &operator=(const VideoCodec &) = delete; // prevent assignment
 
+	// Picks the plain or the SIMD block compare and XOR, and the number of
+	// threads searching the blocks (0 picks it from the number of cores).
+	// Only takes effect when called before the first frame.
+	void SetSearchOptions(bool use_simd, unsigned num_threads);
+
 	bool SetupCompress(int _width, int _height);
 	bool SetupDecompress(int _width, int _height);
 	ZMBV_FORMAT BPPFormat(int bpp);
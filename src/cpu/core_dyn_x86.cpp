@@ -294,6 +294,12 @@ Bits CPU_Core_Dyn_X86_Run() noexcept
 
 	/* Determine the linear address of CS:EIP */
 restart_core:
+	// no translated code is running here, so it's safe to flush or
+	// resize the code cache; the run code needs to be generated again
+	// after a resize
+	if (cache_apply_pending_changes()) {
+		gen_runcode = gen_runcodeInit;
+	}
 	PhysPt ip_point=SegPhys(cs)+reg_eip;
 #if C_DEBUGGER
 #if C_HEAVY_DEBUGGER
@@ -482,6 +488,11 @@ void CPU_Core_Dyn_X86_Cache_Init(bool enable_cache) {
 	cache_init(enable_cache);
 }
 
+void CPU_Core_Dyn_X86_Cache_SetSize(const int size_mb, const bool auto_grow)
+{
+	cache_set_size(static_cast<size_t>(size_mb) * CacheSizeUnit, auto_grow);
+}
+
 void CPU_Core_Dyn_X86_Cache_Close(void) {
 	cache_close();
 }
@@ -83,6 +83,7 @@ static bool MakeCodePage(Bitu lin_addr,CodePageHandler * &cph) {
 	}
 	/* Find a free CodePage */
 	if (!cache.free_pages && cache.used_pages) {
+		++cache_stats.evicted_pages;
 		if (cache.used_pages != decode.page.code)
 			cache.used_pages->ClearRelease();
 		else {
@@ -1601,6 +1602,8 @@ static void dyn_closeblock(void) {
 	//Shouldn't create empty block normally but let's do it like this
 	gen_protectflags();
 	dyn_fill_blocks();
+	DYNPROF_EndBlock(decode.block->profile_id,
+	                 static_cast<uint16_t>(decode.code - decode.code_start));
 	cache_closeblock();
 }
 
@@ -1928,6 +1931,11 @@ static CacheBlock * CreateCacheBlock(CodePageHandler * codepage,PhysPt start,Bit
 	}
 	gen_reinit();
 	gen_save_host_direct(&cache.block.running,(Bitu)decode.block);
+	/* Count the executions of the block when profiling */
+	decode.block->profile_id = DYNPROF_BeginBlock(start, cpu.code.big);
+	if (decode.block->profile_id) {
+		gen_call_function((void *)&DYNPROF_CountExecution,"%Id",decode.block->profile_id);
+	}
 	/* Start with the cycles check */
 	gen_protectflags();
 	gen_dop_word(DOP_TEST,true,DREG(CYCLES),DREG(CYCLES));
@@ -199,6 +199,10 @@ CacheBlock *LinkBlocks(BlockReturn ret)
 Bits CPU_Core_Dynrec_Run() noexcept
 {
 	for (;;) {
+		// no translated code is running here, so it's safe to flush or
+		// resize the code cache
+		cache_apply_pending_changes();
+
 		// Determine the linear address of CS:EIP
 		PhysPt ip_point=SegPhys(cs)+reg_eip;
 #if C_HEAVY_DEBUGGER
@@ -351,6 +355,11 @@ void CPU_Core_Dynrec_Cache_Init(bool enable_cache) {
 	cache_init(enable_cache);
 }
 
+void CPU_Core_Dynrec_Cache_SetSize(const int size_mb, const bool auto_grow)
+{
+	cache_set_size(static_cast<size_t>(size_mb) * CacheSizeUnit, auto_grow);
+}
+
 void CPU_Core_Dynrec_Cache_Close(void) {
 	cache_close();
 }
@@ -41,6 +41,13 @@ static CacheBlock *CreateCacheBlock(CodePageHandler *codepage, PhysPt start, Bit
 	// so the block linking knows the last executed block
 	gen_mov_direct_ptr(&cache.block.running,(Bitu)decode.block);
 
+	// count the executions of the block when profiling
+	decode.block->profile_id = DYNPROF_BeginBlock(start, cpu.code.big);
+	if (decode.block->profile_id) {
+		gen_call_function_I((void*)&DYNPROF_CountExecution,
+		                    decode.block->profile_id);
+	}
+
 	// start with the cycles check
 	gen_mov_word_to_reg(FC_RETOP,&CPU_Cycles,true);
 	save_info_dynrec[used_save_info_dynrec].branch_pos=gen_create_branch_long_leqzero(FC_RETOP);
@@ -890,17 +897,24 @@ static CacheBlock *CreateCacheBlock(CodePageHandler *codepage, PhysPt start, Bit
 			dyn_call_near_imm();
 			goto finish_block;
 		// 'jmp near imm16/32'
-		case 0xe9:
-			dyn_exit_link(decode.big_op ? (int32_t)decode_fetchd() : (int16_t)decode_fetchw());
+		case 0xe9: {
+			const Bits eip_change = decode.big_op ? (int32_t)decode_fetchd()
+			                                      : (int16_t)decode_fetchw();
+			if (max_opcodes && dyn_follow_jump(eip_change)) break;
+			dyn_exit_link(eip_change);
 			goto finish_block;
+		}
 		// 'jmp far'
 		case 0xea:
 			dyn_jmp_far_imm();
 			goto finish_block;
 		// 'jmp short imm8'
-		case 0xeb:
-			dyn_exit_link((int8_t)decode_fetchb());
+		case 0xeb: {
+			const Bits eip_change = (int8_t)decode_fetchb();
+			if (max_opcodes && dyn_follow_jump(eip_change)) break;
+			dyn_exit_link(eip_change);
 			goto finish_block;
+		}
 
 
 		// repeat prefixes
@@ -968,6 +982,7 @@ static CacheBlock *CreateCacheBlock(CodePageHandler *codepage, PhysPt start, Bit
 	dyn_set_eip_end();
 	dyn_reduce_cycles();
 	gen_jmp_ptr(&decode.block->link[0].to, offsetof(CacheBlock, cache.start));
+	InvalidateFlagsAtExit(decode.code);
 	dyn_closeblock();
     goto finish_block;
 core_close_block:
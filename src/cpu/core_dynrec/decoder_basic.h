@@ -150,6 +150,7 @@ static bool MakeCodePage(Bitu lin_addr, CodePageHandler *&cph)
 	}
 	// find a free CodePage
 	if (!cache.free_pages) {
+		++cache_stats.evicted_pages;
 		if (cache.used_pages!=decode.page.code) cache.used_pages->ClearRelease();
 		else {
 			// try another page to avoid clearing our source-crosspage
@@ -617,6 +618,8 @@ static void dyn_fill_blocks(void) {
 static void dyn_closeblock(void) {
 	//Shouldn't create empty block normally but let's do it like this
 	dyn_fill_blocks();
+	DYNPROF_EndBlock(decode.block->profile_id,
+	                 static_cast<uint16_t>(decode.code - decode.code_start));
 	cache_block_before_close();
 	cache_closeblock();
 	cache_block_closing(decode.block->cache.start,decode.block->cache.size);
@@ -1203,3 +1206,185 @@ static void AcquireFlags([[maybe_unused]] Bitu flags_mask) {
 	mf_functions_num=0;
 #endif
 }
+
+
+// The flags optimization only works within a block as the code that is run
+// after the block is unknown while translating it, so all functions that are
+// still queued at the exits of the block generate their flags. For exits to
+// code that belongs to the block or directly follows it, the first few
+// instructions that are run next can be inspected instead: if they overwrite
+// all condition flags before reading any of them, the flags are dead at the
+// exit as well.
+
+// maximum number of instructions that are inspected after an exit
+static constexpr Bitu FlagsLookaheadOpcodes = 4;
+
+static struct {
+	Bitu index; // page index of the next byte to inspect
+	Bitu start; // first page index that may be inspected
+	Bitu end;   // first page index that may not be inspected anymore
+	bool claim; // the inspected bytes follow the block
+} flags_lookahead;
+
+static bool lookahead_fetchb(uint8_t &val) {
+	const Bitu index=flags_lookahead.index;
+	if (index<flags_lookahead.start || index>=flags_lookahead.end) return false;
+	if (flags_lookahead.claim) {
+		// bytes that are known to be modified are not inspected
+		if (decode.page.invmap && decode.page.invmap[index]) return false;
+	} else {
+		// bytes the block was translated without (jumped over or fetched
+		// at runtime) are not covered by its write map
+		const auto& block_cache=decode.block->cache;
+		if (block_cache.wmapmask && index>=block_cache.maskstart &&
+			index-block_cache.maskstart<block_cache.masklen &&
+			block_cache.wmapmask[index-block_cache.maskstart]) return false;
+	}
+	val=mem_readb((PhysPt)((decode.page.first << 12)+index));
+	++flags_lookahead.index;
+	return true;
+}
+
+static bool lookahead_skip(Bitu bytes) {
+	uint8_t val;
+	while (bytes--) {
+		if (!lookahead_fetchb(val)) return false;
+	}
+	return true;
+}
+
+// skip the modrm byte and the address operand; reg receives the reg field
+static bool lookahead_skip_modrm(uint8_t &reg) {
+	uint8_t modrm;
+	if (!lookahead_fetchb(modrm)) return false;
+	const uint8_t mod=modrm >> 6;
+	const uint8_t rm=modrm & 7;
+	reg=(modrm >> 3) & 7;
+	if (mod==3) return true;
+	if (!cpu.code.big) {
+		if (mod==1) return lookahead_skip(1);
+		if (mod==2 || rm==6) return lookahead_skip(2);
+		return true;
+	}
+	if (rm==4) {
+		uint8_t sib;
+		if (!lookahead_fetchb(sib)) return false;
+		if (mod==0 && (sib & 7)==5) return lookahead_skip(4);
+	}
+	if (mod==1) return lookahead_skip(1);
+	if (mod==2 || (mod==0 && rm==5)) return lookahead_skip(4);
+	return true;
+}
+
+enum class LookaheadFlags { Unchanged, Overwritten, Unknown };
+
+// Classify the next instruction by its effect on the condition flags. Only
+// a few common instructions are recognized, everything else may read them.
+static LookaheadFlags lookahead_instruction(void) {
+	const Bitu imm_size=cpu.code.big ? 4 : 2;
+	uint8_t opcode;
+	uint8_t reg;
+	if (!lookahead_fetchb(opcode)) return LookaheadFlags::Unknown;
+	switch (opcode) {
+	// add/or/and/sub/xor/cmp, but not adc/sbb as they read the carry flag
+	case 0x00:case 0x01:case 0x02:case 0x03:
+	case 0x08:case 0x09:case 0x0a:case 0x0b:
+	case 0x20:case 0x21:case 0x22:case 0x23:
+	case 0x28:case 0x29:case 0x2a:case 0x2b:
+	case 0x30:case 0x31:case 0x32:case 0x33:
+	case 0x38:case 0x39:case 0x3a:case 0x3b:
+	// test
+	case 0x84:case 0x85:
+		return LookaheadFlags::Overwritten;
+	case 0x04:case 0x0c:case 0x24:case 0x2c:case 0x34:case 0x3c:
+	case 0xa8:
+		return LookaheadFlags::Overwritten;
+	case 0x05:case 0x0d:case 0x25:case 0x2d:case 0x35:case 0x3d:
+	case 0xa9:
+		return LookaheadFlags::Overwritten;
+	case 0x80:case 0x81:case 0x83:
+		if (!lookahead_skip_modrm(reg)) return LookaheadFlags::Unknown;
+		if (reg==2 || reg==3) return LookaheadFlags::Unknown;
+		return LookaheadFlags::Overwritten;
+
+	// mov, lea, nop and push/pop of registers don't touch the flags
+	case 0x88:case 0x89:case 0x8a:case 0x8b:case 0x8d:
+		if (!lookahead_skip_modrm(reg)) return LookaheadFlags::Unknown;
+		return LookaheadFlags::Unchanged;
+	case 0x50:case 0x51:case 0x52:case 0x53:case 0x54:case 0x55:case 0x56:case 0x57:
+	case 0x58:case 0x59:case 0x5a:case 0x5b:case 0x5c:case 0x5d:case 0x5e:case 0x5f:
+	case 0x90:
+		return LookaheadFlags::Unchanged;
+	case 0xb0:case 0xb1:case 0xb2:case 0xb3:case 0xb4:case 0xb5:case 0xb6:case 0xb7:
+		if (!lookahead_skip(1)) return LookaheadFlags::Unknown;
+		return LookaheadFlags::Unchanged;
+	case 0xb8:case 0xb9:case 0xba:case 0xbb:case 0xbc:case 0xbd:case 0xbe:case 0xbf:
+		if (!lookahead_skip(imm_size)) return LookaheadFlags::Unknown;
+		return LookaheadFlags::Unchanged;
+	default:
+		return LookaheadFlags::Unknown;
+	}
+}
+
+// Returns true if the condition flags are dead when continuing at the given
+// linear address after the block
+static bool FlagsDeadAt(PhysPt address) {
+	if ((address >> 12)!=decode.page.first) return false;
+	const Bitu index=address & 4095;
+	if (address==decode.code) {
+		// the code directly following the block, the inspected bytes
+		// become part of the block so it's invalidated when they change
+		flags_lookahead.start=decode.page.index;
+		flags_lookahead.end=4096;
+		flags_lookahead.claim=true;
+	} else if (decode.active_block==decode.block && address<decode.code &&
+	           index>=decode.block->page.start) {
+		// code of the block itself, for example the start of a loop
+		flags_lookahead.start=decode.block->page.start;
+		flags_lookahead.end=decode.page.index;
+		flags_lookahead.claim=false;
+	} else {
+		return false;
+	}
+	flags_lookahead.index=index;
+
+	for (Bitu ct=0; ct<FlagsLookaheadOpcodes; ct++) {
+		switch (lookahead_instruction()) {
+		case LookaheadFlags::Unchanged:
+			continue;
+		case LookaheadFlags::Overwritten:
+			if (flags_lookahead.claim) {
+				for (Bitu i=index; i<flags_lookahead.index; i++) {
+					decode.page.wmap[i]+=0x01;
+				}
+				decode.page.index=flags_lookahead.index;
+			}
+			return true;
+		case LookaheadFlags::Unknown:
+			return false;
+		}
+	}
+	return false;
+}
+
+// the queued functions don't need to generate flags if they are dead at the
+// exit of the block
+static void InvalidateFlagsAtExit(PhysPt address) {
+#ifdef DRC_FLAGS_INVALIDATION
+	if (mf_functions_num && FlagsDeadAt(address)) InvalidateFlags();
+#endif
+}
+
+// same for a block with two exits, the address inside the block is passed
+// first as inspecting the following code adds it to the block
+static void InvalidateFlagsAtExits(PhysPt address1,PhysPt address2) {
+#ifdef DRC_FLAGS_INVALIDATION
+	if (address1==address2) {
+		InvalidateFlagsAtExit(address1);
+		return;
+	}
+	if (mf_functions_num && FlagsDeadAt(address1) && FlagsDeadAt(address2)) {
+		InvalidateFlags();
+	}
+#endif
+}
@@ -631,20 +631,20 @@ static void dyn_grp2_eb(grp2_types type) {
 	switch (type) {
 	case grp2_1:
 		gen_mov_byte_to_reg_low_imm_canuseword(FC_OP2,1);
-		dyn_shift_byte_gencall((ShiftOps)decode.modrm.reg);
+		dyn_shift_byte_gencall((ShiftOps)decode.modrm.reg,true);
 		break;
 	case grp2_imm: {
 		uint8_t imm=decode_fetchb();
 		if (imm) {
 			gen_mov_byte_to_reg_low_imm_canuseword(FC_OP2,imm&0x1f);
-			dyn_shift_byte_gencall((ShiftOps)decode.modrm.reg);
+			dyn_shift_byte_gencall((ShiftOps)decode.modrm.reg,(imm&0x1f)!=0);
 		} else return;
 		}
 		break;
 	case grp2_cl:
 		MOV_REG_BYTE_TO_HOST_REG_LOW_CANUSEWORD(FC_OP2,DRC_REG_ECX,0);
 		gen_and_imm(FC_OP2,0x1f);
-		dyn_shift_byte_gencall((ShiftOps)decode.modrm.reg);
+		dyn_shift_byte_gencall((ShiftOps)decode.modrm.reg,false);
 		break;
 	}
 	if (decode.modrm.mod<3) {
@@ -667,27 +667,27 @@ static void dyn_grp2_ev(grp2_types type) {
 	switch (type) {
 	case grp2_1:
 		gen_mov_byte_to_reg_low_imm_canuseword(FC_OP2,1);
-		dyn_shift_word_gencall((ShiftOps)decode.modrm.reg,decode.big_op);
+		dyn_shift_word_gencall((ShiftOps)decode.modrm.reg,decode.big_op,true);
 		break;
 	case grp2_imm: {
 		Bitu val;
 		if (decode_fetchb_imm(val)) {
 			gen_mov_byte_to_reg_low_canuseword(FC_OP2,(void*)val);
 			gen_and_imm(FC_OP2,0x1f);
-			dyn_shift_word_gencall((ShiftOps)decode.modrm.reg,decode.big_op);
+			dyn_shift_word_gencall((ShiftOps)decode.modrm.reg,decode.big_op,false);
 			break;
 		}
 		const auto imm = static_cast<uint8_t>(val);
 		if (imm) {
 			gen_mov_byte_to_reg_low_imm_canuseword(FC_OP2,imm&0x1f);
-			dyn_shift_word_gencall((ShiftOps)decode.modrm.reg,decode.big_op);
+			dyn_shift_word_gencall((ShiftOps)decode.modrm.reg,decode.big_op,(imm&0x1f)!=0);
 		} else return;
 		}
 		break;
 	case grp2_cl:
 		MOV_REG_BYTE_TO_HOST_REG_LOW_CANUSEWORD(FC_OP2,DRC_REG_ECX,0);
 		gen_and_imm(FC_OP2,0x1f);
-		dyn_shift_word_gencall((ShiftOps)decode.modrm.reg,decode.big_op);
+		dyn_shift_word_gencall((ShiftOps)decode.modrm.reg,decode.big_op,false);
 		break;
 	}
 	if (decode.modrm.mod<3) {
@@ -997,7 +997,8 @@ static bool dyn_grp7(void) {
 			case 0x07:	// INVLPG
 //				if (cpu.pmode && cpu.cpl) EXCEPTION(EXCEPTION_GP);
 				if (cpu.pmode && cpu.cpl) IllegalOptionDynrec("invlpg nonpriviledged");
-				gen_call_function_raw((void*)PAGING_ClearTLB);
+				dyn_fill_ea(FC_ADDR);
+				gen_call_function_R((void*)PAGING_InvalidatePage,FC_ADDR);
 				break;
 			default: IllegalOptionDynrec("dyn_grp7_1");
 		}
@@ -1093,13 +1094,60 @@ static void dyn_sahf(void) {
 }
 
 
+// Get the linear address of the target of a relative jump, this fails if
+// it depends on the eip the block is entered with
+static bool dyn_jump_target(Bits eip_change, PhysPt &target) {
+	// the operand size has to match, as jumps with a 16-bit operand size
+	// truncate the eip
+	if (decode.big_op != cpu.code.big) return false;
+	target = decode.code + (PhysPt)eip_change;
+	if (!cpu.code.big) {
+		// the ip must not wrap around
+		const int64_t ip = (int64_t)reg_eip + (int32_t)(target - decode.code_start);
+		if (ip < 0 || ip > 0xffff) return false;
+	}
+	return true;
+}
+
 static void dyn_exit_link(Bits eip_change) {
 	gen_add_direct_word(&reg_eip,(decode.code-decode.code_start)+eip_change,decode.big_op);
 	dyn_reduce_cycles();
 	gen_jmp_ptr(&decode.block->link[0].to, offsetof(CacheBlock, cache.start));
+	PhysPt target;
+	if (dyn_jump_target(eip_change, target)) InvalidateFlagsAtExit(target);
 	dyn_closeblock();
 }
 
+// Try to continue the translation at the target of an unconditional jump
+// instead of ending the block, so chains of small blocks that are connected
+// by jumps get translated into a single block (a superblock). This saves the
+// block exit and the dispatch to the linked block, and lets the flags
+// optimization work across the jump.
+//
+// Only forward jumps within the page of the first block are followed, so the
+// translation always terminates, and the bytes that are jumped over can be
+// masked in the write map of the block. As the eip is updated relative to the
+// start of the block, the code following the jump needs no special treatment.
+static bool dyn_follow_jump(Bits eip_change) {
+	if (eip_change < 0) return false;
+	if (decode.active_block != decode.block) return false;
+
+	PhysPt target;
+	if (!dyn_jump_target(eip_change, target)) return false;
+	if ((target >> 12) != decode.page.first) return false;
+	const Bitu target_index = target & 4095;
+	if (decode.page.invmap && (decode.page.invmap[target_index] >= 4)) return false;
+
+	// the skipped bytes are not part of the translated code
+	if (target_index > decode.page.index) {
+		const auto num_bytes = (uint16_t)(target_index - decode.page.index);
+		decode.block->cache.AddRangeToWriteMaskAt(decode.page.index, num_bytes);
+	}
+	decode.code = target;
+	decode.page.index = target_index;
+	return true;
+}
+
 
 static void dyn_branched_exit(BranchTypes btype,int32_t eip_add) {
 	Bitu eip_base=decode.code-decode.code_start;
@@ -1178,6 +1226,11 @@ static void dyn_loop(LoopTypes type) {
 	gen_fill_branch(branch2);
 	gen_add_direct_word(&reg_eip,eip_base,decode.big_op);
 	gen_jmp_ptr(&decode.block->link[1].to, offsetof(CacheBlock, cache.start));
+	// loope/loopne read the zero flag
+	PhysPt target;
+	if (!branch1 && dyn_jump_target(eip_add, target)) {
+		InvalidateFlagsAtExits(target, decode.code);
+	}
 	dyn_closeblock();
 }
 
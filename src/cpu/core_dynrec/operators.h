@@ -1098,7 +1098,14 @@ static uint32_t DRC_CALL_CONV dynrec_sar_dword_simple(uint32_t op1,uint8_t op2)
 	else return op1 >> op2;
 }
 
-static void dyn_shift_byte_gencall(ShiftOps op) {
+// shifts by a count other than zero overwrite all condition flags, while
+// they are left unchanged if the count is zero
+static void InvalidateFlagsShift(void* current_simple_function,Bitu flags_type,bool nonzero_count) {
+	if (nonzero_count) InvalidateFlags(current_simple_function,flags_type);
+	else InvalidateFlagsPartially(current_simple_function,flags_type);
+}
+
+static void dyn_shift_byte_gencall(ShiftOps op,bool nonzero_count) {
 	switch (op) {
 		case SHIFT_ROL:
 			InvalidateFlagsPartially((void*)&dynrec_rol_byte_simple,t_ROLb);
@@ -1118,22 +1125,22 @@ static void dyn_shift_byte_gencall(ShiftOps op) {
 			break;
 		case SHIFT_SHL:
 		case SHIFT_SAL:
-			InvalidateFlagsPartially((void*)&dynrec_shl_byte_simple,t_SHLb);
+			InvalidateFlagsShift((void*)&dynrec_shl_byte_simple,t_SHLb,nonzero_count);
 			gen_call_function_raw((void*)&dynrec_shl_byte);
 			break;
 		case SHIFT_SHR:
-			InvalidateFlagsPartially((void*)&dynrec_shr_byte_simple,t_SHRb);
+			InvalidateFlagsShift((void*)&dynrec_shr_byte_simple,t_SHRb,nonzero_count);
 			gen_call_function_raw((void*)&dynrec_shr_byte);
 			break;
 		case SHIFT_SAR:
-			InvalidateFlagsPartially((void*)&dynrec_sar_byte_simple,t_SARb);
+			InvalidateFlagsShift((void*)&dynrec_sar_byte_simple,t_SARb,nonzero_count);
 			gen_call_function_raw((void*)&dynrec_sar_byte);
 			break;
 		default: IllegalOptionDynrec("dyn_shift_byte_gencall");
 	}
 }
 
-static void dyn_shift_word_gencall(ShiftOps op,bool dword) {
+static void dyn_shift_word_gencall(ShiftOps op,bool dword,bool nonzero_count) {
 	if (dword) {
 		switch (op) {
 			case SHIFT_ROL:
@@ -1154,15 +1161,15 @@ static void dyn_shift_word_gencall(ShiftOps op,bool dword) {
 				break;
 			case SHIFT_SHL:
 			case SHIFT_SAL:
-				InvalidateFlagsPartially((void*)&dynrec_shl_dword_simple,t_SHLd);
+				InvalidateFlagsShift((void*)&dynrec_shl_dword_simple,t_SHLd,nonzero_count);
 				gen_call_function_raw((void*)&dynrec_shl_dword);
 				break;
 			case SHIFT_SHR:
-				InvalidateFlagsPartially((void*)&dynrec_shr_dword_simple,t_SHRd);
+				InvalidateFlagsShift((void*)&dynrec_shr_dword_simple,t_SHRd,nonzero_count);
 				gen_call_function_raw((void*)&dynrec_shr_dword);
 				break;
 			case SHIFT_SAR:
-				InvalidateFlagsPartially((void*)&dynrec_sar_dword_simple,t_SARd);
+				InvalidateFlagsShift((void*)&dynrec_sar_dword_simple,t_SARd,nonzero_count);
 				gen_call_function_raw((void*)&dynrec_sar_dword);
 				break;
 			default: IllegalOptionDynrec("dyn_shift_dword_gencall");
@@ -1187,15 +1194,15 @@ static void dyn_shift_word_gencall(ShiftOps op,bool dword) {
 				break;
 			case SHIFT_SHL:
 			case SHIFT_SAL:
-				InvalidateFlagsPartially((void*)&dynrec_shl_word_simple,t_SHLw);
+				InvalidateFlagsShift((void*)&dynrec_shl_word_simple,t_SHLw,nonzero_count);
 				gen_call_function_raw((void*)&dynrec_shl_word);
 				break;
 			case SHIFT_SHR:
-				InvalidateFlagsPartially((void*)&dynrec_shr_word_simple,t_SHRw);
+				InvalidateFlagsShift((void*)&dynrec_shr_word_simple,t_SHRw,nonzero_count);
 				gen_call_function_raw((void*)&dynrec_shr_word);
 				break;
 			case SHIFT_SAR:
-				InvalidateFlagsPartially((void*)&dynrec_sar_word_simple,t_SARw);
+				InvalidateFlagsShift((void*)&dynrec_sar_word_simple,t_SARw,nonzero_count);
 				gen_call_function_raw((void*)&dynrec_sar_word);
 				break;
 			default: IllegalOptionDynrec("dyn_shift_word_gencall");
@@ -76,7 +76,7 @@
 					break;
 				case 0x07:										/* INVLPG */
 					if (cpu.pmode && cpu.cpl) EXCEPTION(EXCEPTION_GP);
-					PAGING_ClearTLB();
+					PAGING_InvalidatePage(eaa);
 					break;
 				}
 			} else {
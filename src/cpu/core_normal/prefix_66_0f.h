@@ -78,7 +78,7 @@
 					break;
 				case 0x07:										/* INVLPG */
 					if (cpu.pmode && cpu.cpl) EXCEPTION(EXCEPTION_GP);
-					PAGING_ClearTLB();
+					PAGING_InvalidatePage(eaa);
 					break;
 				}
 			} else {
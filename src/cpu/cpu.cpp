@@ -12,6 +12,7 @@
 #include "config/config.h"
 #include "config/setup.h"
 #include "cpu/cpu.h"
+#include "cpu/dyn_profiler.h"
 #include "cpu/paging.h"
 #include "debugger/debugger.h"
 #include "dos/programs.h"
@@ -107,12 +108,14 @@ void CPU_Core_Simple_Init();
 #if C_DYNAMIC_X86
 void CPU_Core_Dyn_X86_Init();
 void CPU_Core_Dyn_X86_Cache_Init(bool enable_cache);
+void CPU_Core_Dyn_X86_Cache_SetSize(int size_mb, bool auto_grow);
 void CPU_Core_Dyn_X86_Cache_Close();
 void CPU_Core_Dyn_X86_SetFPUMode(bool dh_fpu);
 
 #elif C_DYNREC
 void CPU_Core_Dynrec_Init();
 void CPU_Core_Dynrec_Cache_Init(bool enable_cache);
+void CPU_Core_Dynrec_Cache_SetSize(int size_mb, bool auto_grow);
 void CPU_Core_Dynrec_Cache_Close();
 #endif
 
@@ -3586,6 +3589,37 @@ public:
 #endif
 	}
 
+#if C_DYNAMIC_X86 || C_DYNREC
+	void ConfigureDynamicCoreCacheSize(const std::string& cache_size_pref)
+	{
+		auto size_mb   = DynamicCoreCacheSizeDefault;
+		auto auto_grow = false;
+
+		if (cache_size_pref == "auto") {
+			auto_grow = true;
+
+		} else if (const auto maybe_int = parse_int(cache_size_pref);
+		           maybe_int && *maybe_int >= DynamicCoreCacheSizeMin &&
+		           *maybe_int <= DynamicCoreCacheSizeMax) {
+			size_mb = *maybe_int;
+
+		} else {
+			LOG_WARNING("CPU: Invalid 'dynamic_core_cache_size' setting: '%s', "
+			            "using 'auto'",
+			            cache_size_pref.c_str());
+
+			set_section_property_value("cpu", "dynamic_core_cache_size", "auto");
+			auto_grow = true;
+		}
+
+#if C_DYNAMIC_X86
+		CPU_Core_Dyn_X86_Cache_SetSize(size_mb, auto_grow);
+#elif C_DYNREC
+		CPU_Core_Dynrec_Cache_SetSize(size_mb, auto_grow);
+#endif
+	}
+#endif
+
 	void ConfigureCpuType(const std::string& cpu_core, const std::string& cpu_type)
 	{
 		if (cpu_type == "auto") {
@@ -3683,6 +3717,15 @@ public:
 		const std::string cpu_core = secprop->GetString("core");
 		const std::string cpu_type = secprop->GetString("cputype");
 
+#if C_DYNAMIC_X86 || C_DYNREC
+		const auto may_use_dynamic_core = (cpu_core != "normal" &&
+		                                   cpu_core != "simple");
+		ConfigureDynamicCoreCacheSize(
+		        secprop->GetString("dynamic_core_cache_size"));
+		DYNPROF_SetEnabled(may_use_dynamic_core &&
+		                   secprop->GetBool("dynamic_core_profiling"));
+#endif
+
 		ConfigureCpuCore(cpu_core);
 		ConfigureCpuType(cpu_core, cpu_type);
 
@@ -3745,6 +3788,11 @@ void CPU_Destroy()
 	CPU_Core_Dynrec_Cache_Close();
 #endif
 
+	if (DYNPROF_IsEnabled()) {
+		constexpr size_t NumLoggedBlocks = 20;
+		DYNPROF_LogSummary(NumLoggedBlocks);
+	}
+
 	cpu_instance.reset();
 }
 
@@ -3856,6 +3904,34 @@ void init_cpu_config_settings(SectionProp& secprop)
 	        "            Programs that self-modify their code might misbehave or crash on\n"
 	        "            the 'dynamic' core; use the 'normal' core for such programs.");
 
+	pstring = secprop.AddString("dynamic_core_cache_size", WhenIdle, "auto");
+	pstring->SetHelp(
+	        format_str("Size of the code cache of the 'dynamic' core in megabytes ('auto' by default).\n"
+	                   "When the cache is full, the oldest translated code is discarded and has to be\n"
+	                   "translated again when it's run next; programs with a large amount of code\n"
+	                   "(e.g., Windows 9x and its applications) can cause this to happen constantly.\n"
+	                   "Possible values:\n"
+	                   "\n"
+	                   "  auto:      Start with %d MB and double the size whenever the cache fills up\n"
+	                   "             quickly, up to %d MB (default).\n"
+	                   "\n"
+	                   "  <number>:  Use a fixed size between %d and %d MB.\n"
+	                   "\n"
+	                   "The number of flushes and evicted blocks is logged on exit to help choose a\n"
+	                   "fixed size.",
+	                   DynamicCoreCacheSizeDefault,
+	                   DynamicCoreCacheSizeAutoMax,
+	                   DynamicCoreCacheSizeMin,
+	                   DynamicCoreCacheSizeMax));
+
+	auto pbool = secprop.AddBool("dynamic_core_profiling", WhenIdle, false);
+	pbool->SetHelp(
+	        "Count how often each block of code translated by the 'dynamic' core runs,\n"
+	        "gets translated, and gets invalidated by self-modifying code ('off' by\n"
+	        "default). The most executed blocks are logged on exit and can be inspected\n"
+	        "via the debugger and the web server API. This slows down the 'dynamic' core\n"
+	        "noticeably; only enable it to investigate performance issues.");
+
 	pstring = secprop.AddString("cputype", Always, "auto");
 	pstring->SetValues(
 	        {"auto", "386", "386_fast", "386_prefetch", "486", "pentium", "pentium_mmx"});
@@ -3968,7 +4044,7 @@ void init_cpu_config_settings(SectionProp& secprop)
 	        CpuCyclesMin,
 	        CpuCyclesMax));
 
-	auto pbool = secprop.AddBool("cpu_throttle", Always, CpuThrottleDefault);
+	pbool = secprop.AddBool("cpu_throttle", Always, CpuThrottleDefault);
 	pbool->SetHelp(
 	        format_str("Throttle down the number of emulated CPU cycles dynamically if your host CPU\n"
 	                   "cannot keep up (%s by default). Only affects fixed cycles settings. When\n"
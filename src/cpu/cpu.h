@@ -26,6 +26,12 @@ constexpr auto CpuCyclesRealModeDefault      = 3000;
 constexpr auto CpuCyclesProtectedModeDefault = 60000;
 constexpr auto CpuThrottleDefault            = false;
 
+// Dynamic core code cache sizes in megabytes
+constexpr auto DynamicCoreCacheSizeMin     = 4;
+constexpr auto DynamicCoreCacheSizeMax     = 512;
+constexpr auto DynamicCoreCacheSizeDefault = 8;
+constexpr auto DynamicCoreCacheSizeAutoMax = 128;
+
 enum class ArchitectureType {
 	Intel86         = 0x05,
 	Intel186        = 0x15,
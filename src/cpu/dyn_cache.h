@@ -2,13 +2,17 @@
 // SPDX-FileCopyrightText:  2002-2021 The DOSBox Team
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
 #include <cassert>
 #include <cerrno>
 #include <new>
 #include <type_traits>
+#include <vector>
 
 #include "utils/mem_unaligned.h"
+#include "cpu/dyn_profiler.h"
 #include "cpu/paging.h"
+#include "hardware/pic.h"
 #include "misc/types.h"
 
 #if defined(HAVE_MMAP)
@@ -30,6 +34,12 @@
 
 class CodePageHandler;
 
+// The translated code only lives as long as the emulator runs; it's not
+// saved to disk to be reused by the next run. Both backends emit absolute
+// host addresses into the code (the register file, the helper functions,
+// and the links between the blocks), which move between runs due to ASLR.
+// Reloading the code would take a relocation record for each of them.
+
 // basic cache block representation
 class CacheBlock {
 public:
@@ -49,6 +59,7 @@ public:
 	void LinkTo(Bitu index, CacheBlock *toblock)
 	{
 		assert(toblock);
+		DYNPROF_CountLink();
 		link[index].to=toblock;
 		link[index].next = toblock->link[index].from; // set target block
 		toblock->link[index].from = this; // remember who links me
@@ -77,10 +88,12 @@ public:
 		inline void AddByteToWriteMaskAt(const size_t page_index);
 		inline void AddWordToWriteMaskAt(const size_t page_index);
 		inline void AddDwordToWriteMaskAt(const size_t page_index);
+		inline void AddRangeToWriteMaskAt(const size_t page_index,
+		                                  const uint16_t num_bytes);
 
 	private:
 		inline void GrowWriteMask(const uint16_t new_mask_len);
-		size_t GrowMaskForTypeAt(const uint8_t type_size,
+		size_t GrowMaskForTypeAt(const uint16_t type_size,
 		                         const size_t page_index);
 	} cache = {};
 
@@ -99,6 +112,8 @@ public:
 	} link[2] = {};                // maximum two links (conditional jumps)
 
 	CacheBlock* crossblock = {};
+
+	dyn_profile_id_t profile_id = 0; // set if the block is profiled
 };
 
 static_assert(std::is_standard_layout_v<CacheBlock::Page>, "standard-layout is required for offsetof");
@@ -134,9 +149,47 @@ static uint8_t* cache_code_start_ptr   = {};
 static uint8_t* cache_code             = {};
 static uint8_t* cache_code_link_blocks = {};
 
-static std::vector<CacheBlock> cache_blocks(CACHE_BLOCKS);
+static std::vector<CacheBlock> cache_blocks = {};
 static CacheBlock link_blocks[2] = {}; // default linking (specially marked)
 
+// Code cache sizing
+// ~~~~~~~~~~~~~~~~~
+// The code cache holds CACHE_TOTAL bytes of translated code by default, or
+// the size set via the 'dynamic_core_cache_size' setting. Once it's full,
+// translation restarts from the beginning of the cache, overwriting (and thus
+// evicting) the oldest blocks. The number of cache blocks and code page
+// handlers scale with the size of the cache.
+//
+// In auto-grow mode, a cache that fills up again within CacheThrashInterval
+// milliseconds is considered too small for the working set of the program;
+// its size is then doubled (up to CacheMaxAutoSize) at the next safe point,
+// which is the top of the core's run loop where no translated code is being
+// executed.
+constexpr size_t CacheSizeUnit    = 1024 * 1024;
+constexpr size_t CacheMaxAutoSize = DynamicCoreCacheSizeAutoMax * CacheSizeUnit;
+constexpr uint32_t CacheThrashInterval = 10000;
+
+static_assert(CACHE_TOTAL == DynamicCoreCacheSizeDefault * CacheSizeUnit);
+
+static struct {
+	size_t total      = CACHE_TOTAL;  // usable bytes of the code region
+	size_t num_blocks = CACHE_BLOCKS; // cache blocks in the free list
+	size_t num_pages  = 0;            // allocated code page handlers
+	size_t allocated  = 0;            // bytes of the code region mapping
+
+	size_t pending  = 0; // requested new size, 0 if none
+	bool auto_grow = false;
+
+	uint32_t last_flush_ticks = 0;
+} cache_size = {};
+
+static struct {
+	uint64_t flushes        = 0; // the cache was full and restarted
+	uint64_t evicted_blocks = 0; // live blocks overwritten by new code
+	uint64_t evicted_pages  = 0; // code pages released to make room
+	uint64_t resizes        = 0;
+} cache_stats = {};
+
 // the CodePageHandler class provides access to the contained
 // cache blocks and intercepts writes to the code for special treatment
 class CodePageHandler final : public PageHandler {
@@ -195,6 +248,7 @@ public:
 				// test if this block is in the range
 				if (start<=block->page.end && end>=block->page.start) {
 					if (ip_point<=block->page.end && ip_point>=block->page.start) is_current_block=true;
+					DYNPROF_CountInvalidation(block->profile_id);
 					block->Clear(); // clear the block,
 					                // decrements the
 					                // write_map accordingly
@@ -596,15 +650,17 @@ inline void CacheBlock::Cache::GrowWriteMask(const uint16_t new_mask_len)
 
 // Grow the mask to accomodate the given type size at the give page index.
 // Returns the offset into the write mask for incoming index.
-size_t CacheBlock::Cache::GrowMaskForTypeAt(const uint8_t type_size,
+size_t CacheBlock::Cache::GrowMaskForTypeAt(const uint16_t type_size,
                                             const size_t page_index)
 {
 	size_t map_offset = 0;
 
 	// Make the map mask if needed
 	if (!wmapmask) {
-		constexpr uint8_t initial_mask_len = 64;
-		GrowWriteMask(initial_mask_len);
+		constexpr size_t initial_mask_len = 64;
+		const auto mask_len = std::max(initial_mask_len,
+		                               static_cast<size_t>(type_size & ~3) * 2);
+		GrowWriteMask(check_cast<uint16_t>(mask_len));
 		maskstart = check_cast<uint16_t>(page_index);
 	}
 	// Do we need a larger mask to accomodate the added type?
@@ -641,6 +697,17 @@ inline void CacheBlock::Cache::AddDwordToWriteMaskAt(const size_t page_index)
 	add_to_unaligned_uint32(wmapmask + map_offset, 0x01010101);
 }
 
+// Masks a range of bytes that the block spans but didn't translate, such as
+// the bytes skipped by a jump that was followed during the translation
+inline void CacheBlock::Cache::AddRangeToWriteMaskAt(const size_t page_index,
+                                                     const uint16_t num_bytes)
+{
+	const auto map_offset = GrowMaskForTypeAt(num_bytes, page_index);
+	for (size_t i = 0; i < num_bytes; ++i) {
+		wmapmask[map_offset + i] += 0x01;
+	}
+}
+
 void CacheBlock::Clear()
 {
 	Bitu ind;
@@ -654,6 +721,7 @@ void CacheBlock::Clear()
 			// standard linkcode
 			fromlink->link[ind].next=nullptr;
 			fromlink->link[ind].to=&link_blocks[ind];
+			DYNPROF_CountUnlink();
 
 			fromlink=nextlink;
 		}
@@ -665,10 +733,12 @@ void CacheBlock::Clear()
 				wherelink = &(*wherelink)->link[ind].next;
 			}
 			// now remove the link
-			if (*wherelink)
+			if (*wherelink) {
 				*wherelink = (*wherelink)->link[ind].next;
-			else
+				DYNPROF_CountUnlink();
+			} else {
 				LOG(LOG_CPU, LOG_ERROR)("Cache anomaly. please investigate");
+			}
 		}
 	} else {
 		cache_add_unused_block(this);
@@ -685,6 +755,7 @@ void CacheBlock::Clear()
 		page.handler=nullptr;
 	}
 	cache.DeleteWriteMask();
+	profile_id = 0;
 }
 
 static CacheBlock *cache_openblock()
@@ -693,8 +764,10 @@ static CacheBlock *cache_openblock()
 	// check for enough space in this block
 	Bitu size=block->cache.size;
 	CacheBlock *nextblock = block->cache.next;
-	if (block->page.handler)
+	if (block->page.handler) {
+		++cache_stats.evicted_blocks;
 		block->Clear();
+	}
 	// block size must be at least CACHE_MAXSIZE
 	while (size<CACHE_MAXSIZE) {
 		if (!nextblock)
@@ -702,8 +775,10 @@ static CacheBlock *cache_openblock()
 		// merge blocks
 		size+=nextblock->cache.size;
 		CacheBlock *tempblock = nextblock->cache.next;
-		if (nextblock->page.handler)
+		if (nextblock->page.handler) {
+			++cache_stats.evicted_blocks;
 			nextblock->Clear();
+		}
 		// block is free now
 		cache_add_unused_block(nextblock);
 		nextblock=tempblock;
@@ -756,12 +831,20 @@ static void cache_closeblock()
 #if (C_DYNAMIC_X86)
 	const bool cache_is_full = !block->cache.next;
 #elif (C_DYNREC)
-	const uint8_t *limit = (cache_code_start_ptr + CACHE_TOTAL - CACHE_MAXSIZE);
+	const uint8_t *limit = (cache_code_start_ptr + cache_size.total - CACHE_MAXSIZE);
 	const bool cache_is_full = (!block->cache.next ||
 	                            (block->cache.next->cache.start > limit));
 #endif
 	if (cache_is_full) {
 		// LOG_DEBUG("Cache full; restarting");
+		++cache_stats.flushes;
+		const auto elapsed = PIC_Ticks - cache_size.last_flush_ticks;
+		if (cache_size.auto_grow && cache_stats.flushes > 1 &&
+		    elapsed < CacheThrashInterval &&
+		    cache_size.total < CacheMaxAutoSize && !cache_size.pending) {
+			cache_size.pending = cache_size.total * 2;
+		}
+		cache_size.last_flush_ticks = PIC_Ticks;
 		cache.block.active=cache.block.first;
 	} else {
 		cache.block.active=block->cache.next;
@@ -841,7 +924,10 @@ static void cache_block_before_close();
 static void cache_block_closing(const uint8_t *block_start, Bitu block_size);
 #endif
 
-static constexpr size_t cache_code_size = CACHE_TOTAL + CACHE_MAXSIZE + HostPageSize - 1 + HostPageSize;
+static constexpr size_t get_cache_code_size(const size_t total)
+{
+	return total + CACHE_MAXSIZE + HostPageSize - 1 + HostPageSize;
+}
 constexpr bool is_64bit_platform = sizeof(void *) == 8;
 
 static inline void dyn_mem_adjust(void *&ptr, size_t &size)
@@ -950,124 +1036,258 @@ static inline void dyn_cache_invalidate([[maybe_unused]] void *ptr,
 
 static bool cache_initialized = false;
 
-static void cache_init(bool enable) {
-	if (enable) {
-		// see if cache is already initialized
-		if (cache_initialized) {
-			return;
-		}
-		cache_initialized = true;
-		cache.block.free = &cache_blocks[0];
-		// initialize the cache blocks
-		for (int i=0;i<CACHE_BLOCKS-1;i++) {
-			cache_blocks[i].link[0].to = (CacheBlock *)1;
-			cache_blocks[i].link[1].to = (CacheBlock *)1;
-			cache_blocks[i].cache.next = &cache_blocks[i + 1];
-		}
-		if (cache_code_start_ptr == nullptr) {
-			// allocate the code cache memory
+static void cache_alloc_code(const size_t total)
+{
+	assert(cache_code_start_ptr == nullptr);
+	const auto code_size = get_cache_code_size(total);
 #if defined (WIN32)
-			LPVOID lp_vmem = nullptr;
-			if (CPU_UseRwxMemProtect) {
-				lp_vmem = VirtualAlloc(nullptr, cache_code_size,
-				                       MEM_COMMIT,
-				                       PAGE_EXECUTE_READWRITE); // all operations allowed
-			} else {
-				lp_vmem = VirtualAlloc(nullptr, cache_code_size,
-				                       MEM_COMMIT | MEM_RESERVE,
-				                       PAGE_READWRITE); // needs on-going management
-			}
-			assert(lp_vmem);
-			cache_code_start_ptr = static_cast<uint8_t *>(lp_vmem);
+	LPVOID lp_vmem = nullptr;
+	if (CPU_UseRwxMemProtect) {
+		lp_vmem = VirtualAlloc(nullptr, code_size,
+		                       MEM_COMMIT,
+		                       PAGE_EXECUTE_READWRITE); // all operations allowed
+	} else {
+		lp_vmem = VirtualAlloc(nullptr, code_size,
+		                       MEM_COMMIT | MEM_RESERVE,
+		                       PAGE_READWRITE); // needs on-going management
+	}
+	assert(lp_vmem);
+	cache_code_start_ptr = static_cast<uint8_t *>(lp_vmem);
 #elif defined(HAVE_MMAP)
-			int map_flags = MAP_PRIVATE | MAP_ANON;
-			int prot_flags = PROT_READ | PROT_WRITE | PROT_EXEC;
+	int map_flags = MAP_PRIVATE | MAP_ANON;
+	int prot_flags = PROT_READ | PROT_WRITE | PROT_EXEC;
 #if defined(HAVE_MAP_JIT)
-			map_flags |= MAP_JIT;
+	map_flags |= MAP_JIT;
 #endif
-			cache_code_start_ptr=static_cast<uint8_t *>(mmap(nullptr, cache_code_size, prot_flags, map_flags, -1, 0));
-			if (cache_code_start_ptr == MAP_FAILED) {
-				E_Exit("DYNCACHE: Failed memory-mapping cache memory because: %s", strerror(errno));
-			}
+	cache_code_start_ptr=static_cast<uint8_t *>(mmap(nullptr, code_size, prot_flags, map_flags, -1, 0));
+	if (cache_code_start_ptr == MAP_FAILED) {
+		E_Exit("DYNCACHE: Failed memory-mapping cache memory because: %s", strerror(errno));
+	}
 #else
-			cache_code_start_ptr=static_cast<uint8_t *>(malloc(cache_code_size));
-			if (!cache_code_start_ptr) {
-				E_Exit("DYNCACHE: Failed allocating cache memory because: %s", strerror(errno));
-			}
+	cache_code_start_ptr=static_cast<uint8_t *>(malloc(code_size));
+	if (!cache_code_start_ptr) {
+		E_Exit("DYNCACHE: Failed allocating cache memory because: %s", strerror(errno));
+	}
 #endif
-			// align the cache at a page boundary
-			cache_code = reinterpret_cast<uint8_t *>(
-			    (reinterpret_cast<uintptr_t>(cache_code_start_ptr) +
-			    static_cast<size_t>(HostPageSize) - 1) & ~(static_cast<size_t>(HostPageSize) - 1));
-
-			cache_code_link_blocks=cache_code;
-			cache_code=cache_code+HostPageSize;
-			CacheBlock *block = cache_getblock();
-			cache.block.first=block;
-			cache.block.active=block;
-			block->cache.start=&cache_code[0];
-			block->cache.size=CACHE_TOTAL;
-			block->cache.next = nullptr; // last block in the list
-		}
+	cache_size.allocated = code_size;
+	cache_size.total     = total;
 
-		auto cache_addr = static_cast<void *>(cache_code);
-		constexpr size_t cache_bytes = CACHE_MAXSIZE;
+	// align the cache at a page boundary
+	cache_code = reinterpret_cast<uint8_t *>(
+	    (reinterpret_cast<uintptr_t>(cache_code_start_ptr) +
+	    static_cast<size_t>(HostPageSize) - 1) & ~(static_cast<size_t>(HostPageSize) - 1));
 
-		dyn_mem_write(cache_addr, cache_bytes);
+	cache_code_link_blocks=cache_code;
+	cache_code=cache_code+HostPageSize;
+}
+
+static void cache_free_code()
+{
+	if (cache_code_start_ptr == nullptr) {
+		return;
+	}
+#if defined (WIN32)
+	[[maybe_unused]] const auto vf_res = VirtualFree(cache_code_start_ptr,
+	                                                 0,
+	                                                 MEM_RELEASE);
+	assert(vf_res != 0);
+#elif defined(HAVE_MMAP)
+	[[maybe_unused]] const auto mu_res = munmap(cache_code_start_ptr,
+	                                            cache_size.allocated);
+	assert(mu_res == 0);
+#else
+	free(cache_code_start_ptr);
+#endif
+	cache_code_start_ptr   = nullptr;
+	cache_code             = nullptr;
+	cache_code_link_blocks = nullptr;
+	cache_size.allocated   = 0;
+}
 
-		auto close_link_block_num_at_code_pos = [&](const uint8_t block_num,
-		                                            const uint16_t code_pos) {
-			// setup the default blocks for block linkage returns
-			cache.pos = &cache_code_link_blocks[code_pos];
-			link_blocks[block_num].cache.start = cache.pos;
-			// link code that returns with a special return code
-			// must be less than 32 bytes
-			dyn_return(block_num == 0 ? BR_Link1 : BR_Link2, false);
+// Scales a count tuned for the default cache size to the current size
+static size_t cache_scale_count(const size_t default_count)
+{
+	constexpr auto default_units = CACHE_TOTAL / CacheSizeUnit;
+	const auto units = cache_size.total / CacheSizeUnit;
+	return std::max(default_count, default_count * units / default_units);
+}
+
+// (Re)builds the free list of cache blocks and hands the whole code region
+// to the first block
+static void cache_setup_blocks()
+{
+	cache_size.num_blocks = cache_scale_count(CACHE_BLOCKS);
+	cache_blocks = std::vector<CacheBlock>(cache_size.num_blocks);
+
+	cache.block.free = &cache_blocks[0];
+	// initialize the cache blocks
+	for (size_t i = 0; i < cache_size.num_blocks - 1; i++) {
+		cache_blocks[i].link[0].to = (CacheBlock *)1;
+		cache_blocks[i].link[1].to = (CacheBlock *)1;
+		cache_blocks[i].cache.next = &cache_blocks[i + 1];
+	}
+	CacheBlock *block = cache_getblock();
+	cache.block.first=block;
+	cache.block.active=block;
+	cache.block.running=nullptr;
+	block->cache.start=&cache_code[0];
+	block->cache.size=cache_size.total;
+	block->cache.next = nullptr; // last block in the list
+}
+
+static void cache_generate_link_code()
+{
+	auto cache_addr = static_cast<void *>(cache_code);
+	constexpr size_t cache_bytes = CACHE_MAXSIZE;
+
+	dyn_mem_write(cache_addr, cache_bytes);
+
+	auto close_link_block_num_at_code_pos = [&](const uint8_t block_num,
+	                                            const uint16_t code_pos) {
+		// setup the default blocks for block linkage returns
+		cache.pos = &cache_code_link_blocks[code_pos];
+		link_blocks[block_num].cache.start = cache.pos;
+		// link code that returns with a special return code
+		// must be less than 32 bytes
+		dyn_return(block_num == 0 ? BR_Link1 : BR_Link2, false);
 #if C_DYNREC
-			cache_block_before_close();
-			cache_block_closing(link_blocks[block_num].cache.start,
-			                    cache.pos -
-			                            link_blocks[block_num].cache.start);
+		cache_block_before_close();
+		cache_block_closing(link_blocks[block_num].cache.start,
+		                    cache.pos -
+		                            link_blocks[block_num].cache.start);
 #endif
-		};
+	};
 
 #if C_DYNAMIC_X86
-		close_link_block_num_at_code_pos(0, 0);
-		close_link_block_num_at_code_pos(1, 32);
+	close_link_block_num_at_code_pos(0, 0);
+	close_link_block_num_at_code_pos(1, 32);
 
 #elif C_DYNREC
-		cache.pos = &cache_code_link_blocks[0];
-		using generate_run_code_f = decltype(&generate_run_code);
-		core_dynrec.runcode = (generate_run_code_f)cache.pos;
-		dyn_run_code(); // writes up to HostPageSize - 64 bytes
+	cache.pos = &cache_code_link_blocks[0];
+	using generate_run_code_f = decltype(&generate_run_code);
+	core_dynrec.runcode = (generate_run_code_f)cache.pos;
+	dyn_run_code(); // writes up to HostPageSize - 64 bytes
 
-		cache_block_before_close();
-		cache_block_closing(cache_code_link_blocks,
-		                    cache.pos - cache_code_link_blocks);
+	cache_block_before_close();
+	cache_block_closing(cache_code_link_blocks,
+	                    cache.pos - cache_code_link_blocks);
 
-		close_link_block_num_at_code_pos(0, HostPageSize - 64);
-		close_link_block_num_at_code_pos(1, HostPageSize - 32);
+	close_link_block_num_at_code_pos(0, HostPageSize - 64);
+	close_link_block_num_at_code_pos(1, HostPageSize - 32);
 #endif
 
-		dyn_mem_execute(cache_addr, cache_bytes);
-		dyn_cache_invalidate(cache_addr, cache_bytes);
+	dyn_mem_execute(cache_addr, cache_bytes);
+	dyn_cache_invalidate(cache_addr, cache_bytes);
+}
+
+// Grows the list of code page handlers to scale with the size of the cache;
+// surplus handlers are kept when the cache shrinks
+static void cache_add_pages()
+{
+	const auto wanted_pages = cache_scale_count(CACHE_PAGES);
+	while (cache_size.num_pages < wanted_pages) {
+		auto newpage = new (std::nothrow) CodePageHandler();
+		if (!newpage) {
+			E_Exit("DYN_CACHE: Failed to allocate code-page handler");
+		}
+		newpage->next = cache.free_pages;
+		cache.free_pages=newpage;
+		++cache_size.num_pages;
+	}
+}
+
+static void cache_log_stats()
+{
+	LOG_MSG("DYNCACHE: %d MB code cache, flushed %llu times, "
+	        "evicted %llu blocks and %llu code pages",
+	        static_cast<int>(cache_size.total / CacheSizeUnit),
+	        static_cast<unsigned long long>(cache_stats.flushes),
+	        static_cast<unsigned long long>(cache_stats.evicted_blocks),
+	        static_cast<unsigned long long>(cache_stats.evicted_pages));
+}
+
+// Sets the size of the code cache in bytes; takes effect immediately if the
+// cache hasn't been initialized yet, otherwise at the next safe point
+static void cache_set_size(const size_t total, const bool auto_grow)
+{
+	cache_size.auto_grow = auto_grow;
+	if (!cache_initialized) {
+		cache_size.total = total;
+	} else if (!auto_grow && total != cache_size.total) {
+		// an auto-grown cache keeps its size
+		cache_size.pending = total;
+	}
+}
+
+// Drops all translated code by releasing all code pages, which also clears
+// all their blocks
+static void cache_release_all_pages()
+{
+	while (cache.used_pages) {
+		cache.used_pages->ClearRelease();
+	}
+}
+
+// Applies a pending resize of the code cache or a flush requested by the
+// profiler. Both drop all translated code, so this must only be called when
+// no cache block is running. Returns true if the cache has been reallocated.
+static bool cache_apply_pending_changes()
+{
+	if (DYNPROF_TakeFlushRequest() && cache_initialized) {
+		cache_release_all_pages();
+	}
+	if (!cache_size.pending) {
+		return false;
+	}
+	const auto new_total = cache_size.pending;
+	cache_size.pending   = 0;
+	if (!cache_initialized || new_total == cache_size.total) {
+		return false;
+	}
+
+	cache_release_all_pages();
+	cache_free_code();
+	cache_alloc_code(new_total);
+	cache_setup_blocks();
+	cache_generate_link_code();
+	cache_add_pages();
+
+	++cache_stats.resizes;
+	LOG_MSG("DYNCACHE: Resized the code cache to %d MB after %llu flushes",
+	        static_cast<int>(new_total / CacheSizeUnit),
+	        static_cast<unsigned long long>(cache_stats.flushes));
+	return true;
+}
+
+static void cache_init(bool enable) {
+	if (enable) {
+		// see if cache is already initialized
+		if (cache_initialized) {
+			return;
+		}
+		cache_initialized = true;
+		cache_size.pending = 0;
+
+		if (cache_code_start_ptr == nullptr) {
+			// allocate the code cache memory
+			cache_alloc_code(cache_size.total);
+		}
+		cache_setup_blocks();
+		cache_generate_link_code();
 
 		cache.free_pages=nullptr;
 		cache.last_page=nullptr;
 		cache.used_pages=nullptr;
 		// setup the code pages
-		for (int i=0;i<CACHE_PAGES;i++) {
-			auto newpage = new (std::nothrow) CodePageHandler();
-			if (!newpage) {
-				E_Exit("DYN_CACHE: Failed to allocate code-page handler");
-			}
-			newpage->next = cache.free_pages;
-			cache.free_pages=newpage;
-		}
+		cache_size.num_pages = 0;
+		cache_add_pages();
 	}
 }
 
 static void cache_close(void) {
+	if (cache_initialized) {
+		cache_log_stats();
+	}
 /*	for (;;) {
 		if (cache.used_pages) {
 			CodePageHandler * cpage=cache.used_pages;
@@ -0,0 +1,193 @@
+// SPDX-FileCopyrightText:  2026-2026 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "cpu/dyn_profiler.h"
+
+#include <algorithm>
+#include <cassert>
+#include <unordered_map>
+
+#include "dosbox.h"
+#include "misc/logging.h"
+#include "utils/checks.h"
+
+CHECK_NARROWING();
+
+// Upper limit of profiled blocks to bound the memory use on programs that
+// generate code on the fly; later blocks are still run but not profiled
+constexpr size_t MaxProfiles = 256 * 1024;
+
+static struct {
+	bool enabled         = false;
+	bool flush_requested = false;
+
+	// Profile IDs are indices into the list plus one
+	std::vector<DynBlockProfile> profiles = {};
+	std::unordered_map<uint64_t, dyn_profile_id_t> ids = {};
+
+	DynProfileCounters counters = {};
+} profiler = {};
+
+static uint64_t get_profile_key(const uint32_t address, const bool code32)
+{
+	return (static_cast<uint64_t>(code32) << 32) | address;
+}
+
+static DynBlockProfile* get_profile(const dyn_profile_id_t id)
+{
+	if (id == 0 || id > profiler.profiles.size()) {
+		return nullptr;
+	}
+	return &profiler.profiles[id - 1];
+}
+
+void DYNPROF_SetEnabled(const bool enabled)
+{
+	if (profiler.enabled == enabled) {
+		return;
+	}
+	profiler.enabled         = enabled;
+	profiler.flush_requested = true;
+	if (enabled) {
+		LOG_MSG("DYNPROF: Dynamic core profiling enabled");
+	} else {
+		LOG_MSG("DYNPROF: Dynamic core profiling disabled");
+	}
+}
+
+bool DYNPROF_IsEnabled()
+{
+	return profiler.enabled;
+}
+
+void DYNPROF_Reset()
+{
+	// Instrumented blocks keep their IDs, so only clear the counts
+	for (auto& profile : profiler.profiles) {
+		profile.executions    = 0;
+		profile.translations  = 0;
+		profile.invalidations = 0;
+	}
+	profiler.counters = {};
+}
+
+bool DYNPROF_TakeFlushRequest()
+{
+	const auto requested     = profiler.flush_requested;
+	profiler.flush_requested = false;
+	return requested;
+}
+
+dyn_profile_id_t DYNPROF_BeginBlock(const uint32_t address, const bool code32)
+{
+	if (!profiler.enabled) {
+		return 0;
+	}
+	++profiler.counters.translations;
+
+	const auto key = get_profile_key(address, code32);
+	auto it        = profiler.ids.find(key);
+	if (it == profiler.ids.end()) {
+		if (profiler.profiles.size() >= MaxProfiles) {
+			return 0;
+		}
+		DynBlockProfile profile = {};
+		profile.address         = address;
+		profile.code32          = code32;
+		profiler.profiles.push_back(profile);
+
+		const auto id = static_cast<dyn_profile_id_t>(profiler.profiles.size());
+		it = profiler.ids.emplace(key, id).first;
+	}
+	++profiler.profiles[it->second - 1].translations;
+	return it->second;
+}
+
+void DYNPROF_EndBlock(const dyn_profile_id_t id, const uint16_t size)
+{
+	if (auto profile = get_profile(id); profile) {
+		profile->size = size;
+	}
+}
+
+void DYNPROF_CountExecution(const uint32_t id)
+{
+	assert(id != 0 && id <= profiler.profiles.size());
+	++profiler.profiles[id - 1].executions;
+	++profiler.counters.executions;
+}
+
+void DYNPROF_CountInvalidation(const dyn_profile_id_t id)
+{
+	if (!profiler.enabled) {
+		return;
+	}
+	++profiler.counters.invalidations;
+	if (auto profile = get_profile(id); profile) {
+		++profile->invalidations;
+	}
+}
+
+void DYNPROF_CountLink()
+{
+	if (profiler.enabled) {
+		++profiler.counters.links;
+	}
+}
+
+void DYNPROF_CountUnlink()
+{
+	if (profiler.enabled) {
+		++profiler.counters.unlinks;
+	}
+}
+
+DynProfileCounters DYNPROF_GetCounters()
+{
+	return profiler.counters;
+}
+
+std::vector<DynBlockProfile> DYNPROF_GetHotBlocks(const size_t num_blocks)
+{
+	std::vector<DynBlockProfile> hot_blocks = {};
+	hot_blocks.reserve(profiler.profiles.size());
+	for (const auto& profile : profiler.profiles) {
+		if (profile.executions) {
+			hot_blocks.push_back(profile);
+		}
+	}
+
+	const auto by_executions = [](const auto& a, const auto& b) {
+		return a.executions > b.executions;
+	};
+	const auto count = std::min(num_blocks, hot_blocks.size());
+	std::partial_sort(hot_blocks.begin(),
+	                  hot_blocks.begin() + static_cast<ptrdiff_t>(count),
+	                  hot_blocks.end(),
+	                  by_executions);
+	hot_blocks.resize(count);
+	return hot_blocks;
+}
+
+void DYNPROF_LogSummary(const size_t num_blocks)
+{
+	const auto& counters = profiler.counters;
+	LOG_MSG("DYNPROF: %llu block executions, %llu translations, "
+	        "%llu invalidations, %llu links, %llu unlinks",
+	        static_cast<unsigned long long>(counters.executions),
+	        static_cast<unsigned long long>(counters.translations),
+	        static_cast<unsigned long long>(counters.invalidations),
+	        static_cast<unsigned long long>(counters.links),
+	        static_cast<unsigned long long>(counters.unlinks));
+
+	for (const auto& block : DYNPROF_GetHotBlocks(num_blocks)) {
+		LOG_MSG("DYNPROF:   %08x (%2d-bit, %3d bytes): %llu executions, "
+		        "%u translations, %u invalidations",
+		        block.address,
+		        block.code32 ? 32 : 16,
+		        block.size,
+		        static_cast<unsigned long long>(block.executions),
+		        block.translations,
+		        block.invalidations);
+	}
+}
@@ -0,0 +1,78 @@
+// SPDX-FileCopyrightText:  2026-2026 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef DOSBOX_DYN_PROFILER_H
+#define DOSBOX_DYN_PROFILER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Hot-block profiler for the dynamic cores
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// When enabled, every block translated by the dynamic cores gets a small
+// prologue that counts its executions, so the counts stay exact even when
+// the blocks are linked directly to each other. The profiles are kept per
+// linear start address of the guest code, so a block that gets translated
+// again (e.g., after being invalidated by self-modifying code) keeps adding
+// to the same profile.
+//
+// Enabling or disabling the profiler drops all translated code at the next
+// opportunity, so every block gets translated again with or without the
+// instrumentation. The instrumentation slows the dynamic cores down
+// noticeably, hence it's opt-in.
+
+struct DynBlockProfile {
+	uint32_t address = 0; // linear address of the first instruction
+	uint16_t size    = 0; // number of guest code bytes
+	bool code32      = false;
+
+	uint64_t executions    = 0;
+	uint32_t translations  = 0;
+	uint32_t invalidations = 0; // caused by self-modifying code
+};
+
+struct DynProfileCounters {
+	uint64_t executions    = 0;
+	uint64_t translations  = 0;
+	uint64_t invalidations = 0;
+	uint64_t links         = 0;
+	uint64_t unlinks       = 0;
+};
+
+// Handle of a block profile; 0 means the block isn't profiled
+using dyn_profile_id_t = uint32_t;
+
+void DYNPROF_SetEnabled(bool enabled);
+bool DYNPROF_IsEnabled();
+
+// Clears the counts of all profiles and the counters
+void DYNPROF_Reset();
+
+// Returns true once after the profiler has been enabled or disabled; the
+// dynamic cores then drop their translated code so it gets translated again
+// with or without the instrumentation.
+bool DYNPROF_TakeFlushRequest();
+
+// Called by the dynamic cores when they translate a block; returns the
+// profile to pass to DYNPROF_CountExecution() from the block's prologue.
+dyn_profile_id_t DYNPROF_BeginBlock(uint32_t address, bool code32);
+void DYNPROF_EndBlock(dyn_profile_id_t id, uint16_t size);
+
+// Called from the prologue of instrumented blocks
+void DYNPROF_CountExecution(uint32_t id);
+
+void DYNPROF_CountInvalidation(dyn_profile_id_t id);
+void DYNPROF_CountLink();
+void DYNPROF_CountUnlink();
+
+DynProfileCounters DYNPROF_GetCounters();
+
+// Returns up to 'num_blocks' profiles with the highest execution counts,
+// most executed first
+std::vector<DynBlockProfile> DYNPROF_GetHotBlocks(size_t num_blocks);
+
+// Writes the counters and the hot blocks to the log
+void DYNPROF_LogSummary(size_t num_blocks);
+
+#endif // DOSBOX_DYN_PROFILER_H
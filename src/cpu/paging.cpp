@@ -772,6 +772,9 @@ void PAGING_InitTLB()
 
 void PAGING_ClearTLB()
 {
+	++paging.stats.flushes;
+	paging.stats.flushed_pages += paging.links.used;
+
 	uint32_t * entries=&paging.links.entries[0];
 	for (;paging.links.used>0;paging.links.used--) {
 		const auto page=*entries++;
@@ -824,6 +827,7 @@ void PAGING_LinkPage(uint32_t lin_page,uint32_t phys_page) {
 	else paging.tlb.write[lin_page]=nullptr;
 
 	paging.links.entries[paging.links.used++]=lin_page;
+	++paging.stats.misses;
 	paging.tlb.readhandler[lin_page]=handler;
 	paging.tlb.writehandler[lin_page]=handler;
 }
@@ -846,6 +850,7 @@ void PAGING_LinkPage_ReadOnly(uint32_t lin_page,uint32_t phys_page) {
 	paging.tlb.write[lin_page]=nullptr;
 
 	paging.links.entries[paging.links.used++]=lin_page;
+	++paging.stats.misses;
 	paging.tlb.readhandler[lin_page]=handler;
 	paging.tlb.writehandler[lin_page]=&init_page_handler_userro;
 }
@@ -875,6 +880,9 @@ void PAGING_InitTLB()
 
 void PAGING_ClearTLB()
 {
+	++paging.stats.flushes;
+	paging.stats.flushed_pages += paging.links.used;
+
 	uint32_t* entries = &paging.links.entries[0];
 	for (;paging.links.used>0;paging.links.used--) {
 		Bitu page=*entries++;
@@ -930,6 +938,7 @@ void PAGING_LinkPage(uint32_t lin_page, uint32_t phys_page)
 	else entry->write=0;
 
  	paging.links.entries[paging.links.used++]=lin_page;
+	++paging.stats.misses;
 	entry->readhandler=handler;
 	entry->writehandler=handler;
 }
@@ -953,6 +962,7 @@ void PAGING_LinkPage_ReadOnly(uint32_t lin_page, uint32_t phys_page)
 	entry->write=0;
 
  	paging.links.entries[paging.links.used++]=lin_page;
+	++paging.stats.misses;
 	entry->readhandler=handler;
 	entry->writehandler=&init_page_handler_userro;
 }
@@ -960,6 +970,26 @@ void PAGING_LinkPage_ReadOnly(uint32_t lin_page, uint32_t phys_page)
 #endif
 
 
+void PAGING_InvalidatePage(const PhysPt lin_addr)
+{
+	const auto lin_page = lin_addr >> 12;
+	++paging.stats.invalidations;
+
+	// Drop the link as well if it's the most recent one, so invalidating
+	// the same page over and over doesn't fill up the links and cause a
+	// flush of the whole TLB
+	if (paging.links.used &&
+	    paging.links.entries[paging.links.used - 1] == lin_page) {
+		paging.links.used--;
+	}
+	PAGING_UnlinkPages(lin_page, 1);
+}
+
+void PAGING_ResetTlbStats()
+{
+	paging.stats = {};
+}
+
 void PAGING_SetDirBase(Bitu cr3) {
 	assert(cr3 <= UINT32_MAX);
 	paging.cr3=static_cast<uint32_t>(cr3);
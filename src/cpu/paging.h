@@ -15,6 +15,10 @@
 // NOTE: does not work with the dynamic core (dynrec is fine)
 #define USE_FULL_TLB
 
+// enable this to count the memory accesses served directly by the TLB
+// NOTE: slows down every memory access
+// #define PAGING_COUNT_TLB_HITS
+
 class PageDirectory;
 
 #define MEM_PAGE_SIZE	(4096)
@@ -80,6 +84,9 @@ void PAGING_SetDirBase(Bitu cr3);
 void PAGING_InitTLB();
 void PAGING_ClearTLB();
 
+// Drops the TLB entry of a single page, as done by INVLPG
+void PAGING_InvalidatePage(PhysPt lin_addr);
+
 void PAGING_LinkPage(uint32_t lin_page,uint32_t phys_page);
 void PAGING_LinkPage_ReadOnly(uint32_t lin_page,uint32_t phys_page);
 void PAGING_UnlinkPages(Bitu lin_page,Bitu pages);
@@ -150,6 +157,16 @@ typedef struct {
 } tlb_entry = {};
 #endif
 
+struct PagingTlbStats {
+	uint64_t hits          = 0; // only counted with PAGING_COUNT_TLB_HITS
+	uint64_t misses        = 0; // pages linked into the TLB
+	uint64_t flushes       = 0; // on CR3 reloads and memory remapping
+	uint64_t flushed_pages = 0;
+	uint64_t invalidations = 0; // single pages, by INVLPG
+};
+
+void PAGING_ResetTlbStats();
+
 struct PagingBlock {
 	uint32_t cr3 = 0;
 	uint32_t cr2 = 0;
@@ -178,6 +195,8 @@ struct PagingBlock {
 
 	std::vector<uint32_t> firstmb = std::vector<uint32_t>(LINK_START);
 	bool enabled = false;
+
+	PagingTlbStats stats = {};
 };
 
 extern PagingBlock paging; 
@@ -187,6 +206,13 @@ extern PagingBlock paging;
 PageHandler * MEM_GetPageHandler(Bitu phys_page);
 
 
+static inline void PAGING_CountTlbHit()
+{
+#if defined(PAGING_COUNT_TLB_HITS)
+	++paging.stats.hits;
+#endif
+}
+
 /* Unaligned address handlers */
 uint16_t mem_unalignedreadw(PhysPt address);
 uint32_t mem_unalignedreadd(PhysPt address);
@@ -297,6 +323,7 @@ static inline uint8_t mem_readb_inline(const PhysPt address)
 	}
 	HostPt tlb_addr = get_tlb_read(address);
 	if (tlb_addr) {
+		PAGING_CountTlbHit();
 		return host_readb(tlb_addr + address);
 	} else {
 		return (get_tlb_readhandler(address))->readb(address);
@@ -312,6 +339,7 @@ static inline uint16_t mem_readw_inline(const PhysPt address)
 	if ((address & 0xfff) < 0xfff) {
 		HostPt tlb_addr = get_tlb_read(address);
 		if (tlb_addr) {
+			PAGING_CountTlbHit();
 			return host_readw(tlb_addr + address);
 		} else {
 			return (get_tlb_readhandler(address))->readw(address);
@@ -329,10 +357,12 @@ static inline uint32_t mem_readd_inline(const PhysPt address)
 	}
 	if ((address & 0xfff) < 0xffd) {
 		HostPt tlb_addr = get_tlb_read(address);
-		if (tlb_addr)
+		if (tlb_addr) {
+			PAGING_CountTlbHit();
 			return host_readd(tlb_addr + address);
-		else
+		} else {
 			return get_tlb_readhandler(address)->readd(address);
+		}
 	} else {
 		return mem_unalignedreadd(address);
 	}
@@ -347,6 +377,7 @@ static inline uint64_t mem_readq_inline(PhysPt address)
 	if ((address & 0xfff) < 0xff9) {
 		HostPt tlb_addr = get_tlb_read(address);
 		if (tlb_addr) {
+			PAGING_CountTlbHit();
 			return host_readq(tlb_addr + address);
 		} else {
 			return get_tlb_readhandler(address)->readq(address);
@@ -359,23 +390,35 @@ static inline uint64_t mem_readq_inline(PhysPt address)
 static inline void mem_writeb_inline(PhysPt address, uint8_t val)
 {
 	HostPt tlb_addr = get_tlb_write(address);
-	if (tlb_addr) host_writeb(tlb_addr+address,val);
-	else (get_tlb_writehandler(address))->writeb(address,val);
+	if (tlb_addr) {
+		PAGING_CountTlbHit();
+		host_writeb(tlb_addr + address, val);
+	} else {
+		(get_tlb_writehandler(address))->writeb(address, val);
+	}
 }
 
 static inline void mem_writew_inline(PhysPt address,uint16_t val) {
 	if ((address & 0xfff)<0xfff) {
 		HostPt tlb_addr=get_tlb_write(address);
-		if (tlb_addr) host_writew(tlb_addr+address,val);
-		else (get_tlb_writehandler(address))->writew(address,val);
+		if (tlb_addr) {
+			PAGING_CountTlbHit();
+			host_writew(tlb_addr + address, val);
+		} else {
+			(get_tlb_writehandler(address))->writew(address, val);
+		}
 	} else mem_unalignedwritew(address,val);
 }
 
 static inline void mem_writed_inline(PhysPt address,uint32_t val) {
 	if ((address & 0xfff)<0xffd) {
 		HostPt tlb_addr=get_tlb_write(address);
-		if (tlb_addr) host_writed(tlb_addr+address,val);
-		else (get_tlb_writehandler(address))->writed(address,val);
+		if (tlb_addr) {
+			PAGING_CountTlbHit();
+			host_writed(tlb_addr + address, val);
+		} else {
+			(get_tlb_writehandler(address))->writed(address, val);
+		}
 	} else mem_unalignedwrited(address,val);
 }
 
@@ -384,6 +427,7 @@ static inline void mem_writeq_inline(PhysPt address, uint64_t val)
 	if ((address & 0xfff) < 0xff9) {
 		HostPt tlb_addr = get_tlb_write(address);
 		if (tlb_addr) {
+			PAGING_CountTlbHit();
 			host_writeq(tlb_addr + address, val);
 		} else {
 			(get_tlb_writehandler(address))->writeq(address, val);
@@ -396,6 +440,7 @@ static inline void mem_writeq_inline(PhysPt address, uint64_t val)
 static inline bool mem_readb_checked(PhysPt address, uint8_t * val) {
 	HostPt tlb_addr=get_tlb_read(address);
 	if (tlb_addr) {
+		PAGING_CountTlbHit();
 		*val=host_readb(tlb_addr+address);
 		return false;
 	} else return (get_tlb_readhandler(address))->readb_checked(address, val);
@@ -405,6 +450,7 @@ static inline bool mem_readw_checked(PhysPt address, uint16_t * val) {
 	if ((address & 0xfff)<0xfff) {
 		HostPt tlb_addr=get_tlb_read(address);
 		if (tlb_addr) {
+			PAGING_CountTlbHit();
 			*val=host_readw(tlb_addr+address);
 			return false;
 		} else return (get_tlb_readhandler(address))->readw_checked(address, val);
@@ -415,6 +461,7 @@ static inline bool mem_readd_checked(PhysPt address, uint32_t * val) {
 	if ((address & 0xfff)<0xffd) {
 		HostPt tlb_addr=get_tlb_read(address);
 		if (tlb_addr) {
+			PAGING_CountTlbHit();
 			*val=host_readd(tlb_addr+address);
 			return false;
 		} else return (get_tlb_readhandler(address))->readd_checked(address, val);
@@ -426,6 +473,7 @@ static inline bool mem_readq_checked(PhysPt address, uint64_t* val)
 	if ((address & 0xfff) < 0xff9) {
 		HostPt tlb_addr = get_tlb_read(address);
 		if (tlb_addr) {
+			PAGING_CountTlbHit();
 			*val = host_readq(tlb_addr + address);
 			return false;
 		} else {
@@ -440,6 +488,7 @@ static inline bool mem_writeb_checked(PhysPt address, uint8_t val)
 {
 	HostPt tlb_addr = get_tlb_write(address);
 	if (tlb_addr) {
+		PAGING_CountTlbHit();
 		host_writeb(tlb_addr+address,val);
 		return false;
 	} else return (get_tlb_writehandler(address))->writeb_checked(address,val);
@@ -449,6 +498,7 @@ static inline bool mem_writew_checked(PhysPt address,uint16_t val) {
 	if ((address & 0xfff)<0xfff) {
 		HostPt tlb_addr=get_tlb_write(address);
 		if (tlb_addr) {
+			PAGING_CountTlbHit();
 			host_writew(tlb_addr+address,val);
 			return false;
 		} else return (get_tlb_writehandler(address))->writew_checked(address,val);
@@ -459,6 +509,7 @@ static inline bool mem_writed_checked(PhysPt address,uint32_t val) {
 	if ((address & 0xfff)<0xffd) {
 		HostPt tlb_addr=get_tlb_write(address);
 		if (tlb_addr) {
+			PAGING_CountTlbHit();
 			host_writed(tlb_addr+address,val);
 			return false;
 		} else return (get_tlb_writehandler(address))->writed_checked(address,val);
@@ -470,6 +521,7 @@ static inline bool mem_writeq_checked(PhysPt address, uint64_t val)
 	if ((address & 0xfff) < 0xff9) {
 		HostPt tlb_addr = get_tlb_write(address);
 		if (tlb_addr) {
+			PAGING_CountTlbHit();
 			host_writeq(tlb_addr + address, val);
 			return false;
 		} else {
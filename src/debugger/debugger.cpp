@@ -19,6 +19,7 @@
 #include "config/setup.h"
 #include "cpu/callback.h"
 #include "cpu/cpu.h"
+#include "cpu/dyn_profiler.h"
 #include "cpu/lazyflags.h"
 #include "cpu/paging.h"
 #include "debugger.h"
@@ -50,7 +51,9 @@ static void LogGDT(void);
 static void LogLDT(void);
 static void LogIDT(void);
 static void LogPages(char* selname);
+static void LogTlbStats();
 static void LogCPUInfo(void);
+static void LogDynamicCoreProfile(size_t num_blocks);
 static void OutputVecTable(char* filename);
 static void DrawVariables(void);
 
@@ -2216,11 +2219,42 @@ bool ParseCommand(char* str)
 		return true;
 	}
 
+	if (command == "TLB") {
+		std::string action;
+		stream >> action;
+		if (action == "RESET") {
+			PAGING_ResetTlbStats();
+			DEBUG_ShowMsg("DEBUG: TLB counters cleared.\n");
+		} else {
+			LogTlbStats();
+		}
+		return true;
+	}
+
 	if (command == "CPU") {
 		LogCPUInfo();
 		return true;
 	}
 
+	if (command == "DYNPROF") { // Dynamic core profiling
+		std::string action;
+		stream >> action;
+		if (action == "ON" || action == "OFF") {
+			DYNPROF_SetEnabled(action == "ON");
+			DEBUG_ShowMsg("DEBUG: Dynamic core profiling %s.\n",
+			              DYNPROF_IsEnabled() ? "on" : "off");
+		} else if (action == "RESET") {
+			DYNPROF_Reset();
+			DEBUG_ShowMsg("DEBUG: Dynamic core profile cleared.\n");
+		} else {
+			constexpr size_t DefaultNumBlocks = 0x10;
+			const auto num_blocks = found[0] ? GetHexValue(found, found)
+			                                 : DefaultNumBlocks;
+			LogDynamicCoreProfile(num_blocks);
+		}
+		return true;
+	}
+
 	if (command == "INTVEC") {
 		if (found[0] != 0) {
 			OutputVecTable(found);
@@ -2308,10 +2342,13 @@ bool ParseCommand(char* str)
 		DEBUG_ShowMsg("INTHAND [intNum]          - Set code view to interrupt handler.\n");
 
 		DEBUG_ShowMsg("CPU                       - Display CPU status information.\n");
+		DEBUG_ShowMsg("DYNPROF [ON/OFF/RESET]    - Enable/Disable/Clear dynamic core profiling.\n");
+		DEBUG_ShowMsg("DYNPROF [num]             - Show most executed dynamic core blocks.\n");
 		DEBUG_ShowMsg("GDT                       - Lists descriptors of the GDT.\n");
 		DEBUG_ShowMsg("LDT                       - Lists descriptors of the LDT.\n");
 		DEBUG_ShowMsg("IDT                       - Lists descriptors of the IDT.\n");
 		DEBUG_ShowMsg("PAGING [page]             - Display content of page table.\n");
+		DEBUG_ShowMsg("TLB [RESET]               - Show/Clear TLB hit, miss and flush counters.\n");
 		DEBUG_ShowMsg("EXTEND                    - Toggle additional info.\n");
 		DEBUG_ShowMsg("TIMERIRQ                  - Run the system timer.\n");
 
@@ -3164,6 +3201,52 @@ void LogPages(char* selname)
 	}
 }
 
+static void LogTlbStats()
+{
+	const auto& stats = paging.stats;
+#if defined(PAGING_COUNT_TLB_HITS)
+	DEBUG_ShowMsg("TLB hits: %llu, misses: %llu\n",
+	              static_cast<unsigned long long>(stats.hits),
+	              static_cast<unsigned long long>(stats.misses));
+#else
+	DEBUG_ShowMsg("TLB misses: %llu (hits are counted with PAGING_COUNT_TLB_HITS)\n",
+	              static_cast<unsigned long long>(stats.misses));
+#endif
+	DEBUG_ShowMsg("TLB flushes: %llu (%llu pages), invalidated pages: %llu, linked pages: %u\n",
+	              static_cast<unsigned long long>(stats.flushes),
+	              static_cast<unsigned long long>(stats.flushed_pages),
+	              static_cast<unsigned long long>(stats.invalidations),
+	              paging.links.used);
+}
+
+static void LogDynamicCoreProfile(const size_t num_blocks)
+{
+	if (!DYNPROF_IsEnabled()) {
+		DEBUG_ShowMsg("DEBUG: Dynamic core profiling is off; enable it with DYNPROF ON.\n");
+		return;
+	}
+
+	const auto counters = DYNPROF_GetCounters();
+	DEBUG_ShowMsg("Block executions: %llu, translations: %llu, invalidations: %llu\n",
+	              static_cast<unsigned long long>(counters.executions),
+	              static_cast<unsigned long long>(counters.translations),
+	              static_cast<unsigned long long>(counters.invalidations));
+	DEBUG_ShowMsg("Links: %llu, unlinks: %llu\n",
+	              static_cast<unsigned long long>(counters.links),
+	              static_cast<unsigned long long>(counters.unlinks));
+
+	DEBUG_ShowMsg("Address   Bits Size  Executions  Translations Invalidations\n");
+	for (const auto& block : DYNPROF_GetHotBlocks(num_blocks)) {
+		DEBUG_ShowMsg("%08X  %4d %4d  %10llu  %12u %13u\n",
+		              block.address,
+		              block.code32 ? 32 : 16,
+		              block.size,
+		              static_cast<unsigned long long>(block.executions),
+		              block.translations,
+		              block.invalidations);
+	}
+}
+
 static void LogCPUInfo(void)
 {
 	char out1[512];
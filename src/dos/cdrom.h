@@ -7,16 +7,24 @@
 
 #include "dosbox.h"
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstring>
 #include <fstream>
 #include <iostream>
 #include <limits>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "audio/mixer.h"
+#include "dos/cdrom_chd.h"
+#include "dos/cdrom_read_ahead.h"
 #include "hardware/memory.h"
 #include "misc/support.h"
 #include "utils/rwqueue.h"
@@ -180,6 +188,17 @@ public:
 
 class CDROM_Interface_Image final : public CDROM_Interface
 {
+public:
+	// Number of reads served by the read-ahead of data sectors and by the
+	// decode-ahead of compressed audio tracks (hits), and the number that
+	// had to wait for the image (misses)
+	struct PrefetchStats {
+		uint64_t sector_hits   = 0;
+		uint64_t sector_misses = 0;
+		uint64_t audio_hits    = 0;
+		uint64_t audio_misses  = 0;
+	};
+
 private:
 	// Nested Class Definitions
 	class TrackFile {
@@ -205,6 +224,7 @@ private:
 		virtual uint8_t getChannels()               = 0;
 		virtual int getLength()                     = 0;
 		virtual void setAudioPosition(uint32_t pos) = 0;
+		virtual void addPrefetchStats(PrefetchStats& stats) const = 0;
 		const uint16_t chunkSize                    = 0;
 	};
 
@@ -237,9 +257,17 @@ private:
 		{
 			audio_pos = pos;
 		}
+		void addPrefetchStats(PrefetchStats& stats) const override
+		{
+			stats.sector_hits += read_ahead.GetNumHits();
+			stats.sector_misses += read_ahead.GetNumMisses();
+		}
 
 	private:
+		std_fs::path filename;
 		std::ifstream* file;
+
+		ImageReadAhead read_ahead;
 	};
 
 	class AudioFile final : public TrackFile {
@@ -264,9 +292,84 @@ private:
 		// This is a no-op because we track the audio position in all
 		// areas of this class.
 		void setAudioPosition([[maybe_unused]] uint32_t pos) override {}
+		void addPrefetchStats(PrefetchStats& stats) const override
+		{
+			stats.audio_hits += decode_ahead_hits;
+			stats.audio_misses += decode_ahead_misses;
+		}
 
 	private:
+		// During playback, a background thread decodes the track ahead
+		// of the mixer into a ring of samples, so slow codecs don't
+		// hold up the mixer thread. The thread is started by the first
+		// decode and exits once the mixer stops taking the audio, so
+		// only the tracks being played have one.
+		static constexpr uint32_t DecodeAheadFrames = 2048;
+		static constexpr auto DecodeAheadIdleTimeout = std::chrono::seconds(5);
+
+		bool seekSample(const uint32_t requested_pos);
+		void startDecodeAhead();
+		void discardDecodedAhead();
+		void decodeAheadLoop();
+
 		Sound_Sample* sample = nullptr;
+
+		// Lock order: sample_mutex, then decoded_mutex
+		std::thread decode_ahead_thread             = {};
+		std::mutex sample_mutex                     = {};
+		std::mutex decoded_mutex                    = {};
+		std::condition_variable decode_ahead_waiter = {};
+		std::vector<int16_t> decoded                = {};
+		std::atomic<uint64_t> decode_ahead_hits     = 0;
+		std::atomic<uint64_t> decode_ahead_misses   = 0;
+		size_t decoded_start                        = 0; // in samples
+		size_t decoded_count                        = 0; // in samples
+		bool decoded_eof                            = false;
+		bool is_decoding_ahead                      = false;
+		bool should_exit                            = false;
+	};
+
+	// A track of a CHD image. Offsets are in the image's 2448-byte frames
+	// (a raw sector followed by its subcode), relative to the track's
+	// first frame.
+	class ChdFile final : public TrackFile {
+	public:
+		ChdFile(const std::shared_ptr<ChdImage>& image,
+		        const uint32_t first_frame, const uint32_t num_frames,
+		        const bool is_audio);
+
+		ChdFile()                          = delete;
+		ChdFile(const ChdFile&)            = delete;
+		ChdFile& operator=(const ChdFile&) = delete;
+
+		bool read(uint8_t* buffer, const uint32_t offset,
+		          const uint32_t requested_bytes) override;
+		bool seek(const uint32_t offset) override;
+		uint32_t decode(int16_t* buffer,
+		                const uint32_t desired_track_frames) override;
+		uint16_t getEndian() override;
+		uint32_t getRate() override
+		{
+			return 44100;
+		}
+		uint8_t getChannels() override
+		{
+			return 2;
+		}
+		int getLength() override;
+		void setAudioPosition(uint32_t pos) override
+		{
+			audio_pos = pos;
+		}
+		// The image's hunk cache keeps its own statistics
+		void addPrefetchStats([[maybe_unused]] PrefetchStats& stats) const override
+		{}
+
+	private:
+		std::shared_ptr<ChdImage> image = {};
+		uint64_t start_offset           = 0;
+		uint32_t num_frames             = 0;
+		bool is_audio                   = false;
 	};
 
 public:
@@ -312,6 +415,8 @@ public:
 		return true;
 	}
 
+	PrefetchStats GetPrefetchStats() const;
+
 private:
 	static struct imagePlayer {
 		// Objects, pointers, and then scalars; in descending size-order.
@@ -352,6 +457,7 @@ private:
 	bool PlayAudioTrack(const Track& track, const uint32_t sector_offset);
 
 	bool LoadMdsFile(const char *filename);
+	bool LoadChdFile(const char *filename);
 
 	// Private functions for cue sheet processing
 	bool  LoadCueSheet(const char *cuefile);
@@ -0,0 +1,883 @@
+// SPDX-FileCopyrightText:  2026-2026 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "cdrom_chd.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <iterator>
+#include <sstream>
+
+#include "dosbox_config.h"
+#include "misc/cross.h"
+#include "misc/logging.h"
+#include "utils/checks.h"
+
+#if C_ZLIB_NG
+#include <zlib-ng.h>
+#define inflateInit2 zng_inflateInit2
+#define inflate zng_inflate
+#define inflateEnd zng_inflateEnd
+#define z_stream zng_stream
+#else
+#include <zlib.h>
+#endif
+
+#include "decoders/dr_flac.h"
+
+CHECK_NARROWING();
+
+constexpr uint32_t HeaderSize    = 124;
+constexpr uint32_t HeaderVersion = 5;
+
+constexpr uint32_t make_tag(const char (&tag)[5])
+{
+	return (static_cast<uint32_t>(tag[0]) << 24) |
+	       (static_cast<uint32_t>(tag[1]) << 16) |
+	       (static_cast<uint32_t>(tag[2]) << 8) | static_cast<uint32_t>(tag[3]);
+}
+
+constexpr auto CodecZlib   = make_tag("zlib");
+constexpr auto CodecCdZlib = make_tag("cdzl");
+constexpr auto CodecCdFlac = make_tag("cdfl");
+
+constexpr auto TrackMetadataTag  = make_tag("CHTR");
+constexpr auto TrackMetadata2Tag = make_tag("CHT2");
+
+// Types of the entries in the hunk map
+enum : uint8_t {
+	CompressionType0 = 0, // compressed with codecs[0]
+	CompressionType1,
+	CompressionType2,
+	CompressionType3,
+	CompressionNone,
+	CompressionSelf, // copy of another hunk
+	CompressionParent,
+
+	// Pseudo-types only used in the compressed map
+	CompressionRleSmall,
+	CompressionRleLarge,
+	CompressionSelf0,
+	CompressionSelf1,
+	CompressionParentSelf,
+	CompressionParent0,
+	CompressionParent1,
+
+	// Not stored, reads as zeros
+	CompressionZero = 0xff,
+};
+
+constexpr size_t MaxCachedHunks = 256;
+
+// Hunks can be copies of hunks that are copies themselves
+constexpr int MaxSelfReferenceDepth = 16;
+
+static uint64_t read_be(const uint8_t* data, const int num_bytes)
+{
+	uint64_t value = 0;
+	for (auto i = 0; i < num_bytes; ++i) {
+		value = (value << 8) | data[i];
+	}
+	return value;
+}
+
+static std::string tag_to_string(const uint32_t tag)
+{
+	std::string str = {};
+	for (auto shift = 24; shift >= 0; shift -= 8) {
+		str += static_cast<char>((tag >> shift) & 0xff);
+	}
+	return str;
+}
+
+// CRC-16/CCITT, as used for the map and the hunks
+static uint16_t crc16(const uint8_t* data, const size_t num_bytes)
+{
+	uint16_t crc = 0xffff;
+	for (size_t i = 0; i < num_bytes; ++i) {
+		crc ^= static_cast<uint16_t>(data[i] << 8);
+		for (auto bit = 0; bit < 8; ++bit) {
+			crc = static_cast<uint16_t>((crc & 0x8000) ? (crc << 1) ^ 0x1021
+			                                           : (crc << 1));
+		}
+	}
+	return crc;
+}
+
+// Reads a stream of bits, most significant bit first
+class BitReader {
+public:
+	BitReader(const uint8_t* data, const size_t num_bytes)
+	        : data(data),
+	          num_bits(num_bytes * 8)
+	{}
+
+	uint32_t Peek(const int count) const
+	{
+		uint32_t value = 0;
+		for (auto i = 0; i < count; ++i) {
+			const auto bit_pos = pos + static_cast<size_t>(i);
+			const auto bit = (bit_pos < num_bits)
+			                       ? (data[bit_pos / 8] >> (7 - bit_pos % 8)) & 1
+			                       : 0;
+			value = (value << 1) | static_cast<uint32_t>(bit);
+		}
+		return value;
+	}
+
+	void Skip(const int count)
+	{
+		pos += static_cast<size_t>(count);
+	}
+
+	uint32_t Read(const int count)
+	{
+		const auto value = Peek(count);
+		Skip(count);
+		return value;
+	}
+
+	bool HasOverflowed() const
+	{
+		return pos > num_bits;
+	}
+
+private:
+	const uint8_t* data = nullptr;
+	size_t num_bits     = 0;
+	size_t pos          = 0;
+};
+
+// Canonical Huffman decoder for the entry types of the compressed map
+class MapTypeDecoder {
+public:
+	static constexpr int NumCodes = 16;
+	static constexpr int MaxBits  = 8;
+
+	// Reads the run-length encoded code lengths
+	bool Import(BitReader& bits)
+	{
+		constexpr auto BitsPerLength = 4;
+
+		int code = 0;
+		while (code < NumCodes) {
+			auto length = bits.Read(BitsPerLength);
+			if (length != 1) {
+				lengths[code++] = static_cast<uint8_t>(length);
+				continue;
+			}
+			// A one is an escape; two ones are a literal one,
+			// otherwise it's a length with a repeat count
+			length = bits.Read(BitsPerLength);
+			if (length == 1) {
+				lengths[code++] = 1;
+				continue;
+			}
+			const auto count = static_cast<int>(bits.Read(BitsPerLength)) + 3;
+			if (code + count > NumCodes) {
+				return false;
+			}
+			for (auto i = 0; i < count; ++i) {
+				lengths[code++] = static_cast<uint8_t>(length);
+			}
+		}
+		return !bits.HasOverflowed() && BuildLookup();
+	}
+
+	uint8_t Decode(BitReader& bits) const
+	{
+		const auto& entry = lookup[bits.Peek(MaxBits)];
+		bits.Skip(entry.num_bits);
+		return entry.value;
+	}
+
+private:
+	// Assigns the codes starting with the longest ones, like chdman
+	bool BuildLookup()
+	{
+		std::array<uint32_t, MaxBits + 1> histogram = {};
+		for (const auto length : lengths) {
+			if (length > MaxBits) {
+				return false;
+			}
+			++histogram[length];
+		}
+
+		std::array<uint32_t, MaxBits + 1> next_code = {};
+		uint32_t start = 0;
+		for (auto length = MaxBits; length > 0; --length) {
+			const auto next_start = (start + histogram[length]) >> 1;
+			if (length != 1 && next_start * 2 != start + histogram[length]) {
+				return false;
+			}
+			next_code[length] = start;
+			start             = next_start;
+		}
+
+		for (auto value = 0; value < NumCodes; ++value) {
+			const auto length = lengths[value];
+			if (length == 0) {
+				continue;
+			}
+			const auto code  = next_code[length]++;
+			const auto shift = MaxBits - length;
+			for (auto i = code << shift; i < ((code + 1) << shift); ++i) {
+				lookup[i] = {static_cast<uint8_t>(value), length};
+			}
+		}
+		return true;
+	}
+
+	struct Entry {
+		uint8_t value    = 0;
+		uint8_t num_bits = 0;
+	};
+
+	std::array<uint8_t, NumCodes> lengths  = {};
+	std::array<Entry, 1 << MaxBits> lookup = {};
+};
+
+// Inflates a raw deflate stream, as written by chdman
+static bool inflate_raw(const uint8_t* src, const uint32_t src_size,
+                        uint8_t* dest, const uint32_t dest_size)
+{
+	z_stream stream = {};
+	if (inflateInit2(&stream, -15) != Z_OK) {
+		return false;
+	}
+	stream.next_in   = const_cast<uint8_t*>(src);
+	stream.avail_in  = src_size;
+	stream.next_out  = dest;
+	stream.avail_out = dest_size;
+
+	const auto result = inflate(&stream, Z_FINISH);
+	const auto success = (result == Z_STREAM_END || result == Z_OK ||
+	                      result == Z_BUF_ERROR) &&
+	                     stream.avail_out == 0;
+	inflateEnd(&stream);
+	return success;
+}
+
+// Decodes the headerless stereo 44.1 kHz FLAC stream of 'cdfl' hunks into
+// big-endian samples, the byte order of audio in CHD images. Returns the size
+// of the FLAC frames in 'flac_size', as the subcode follows them.
+static bool decode_flac(const uint8_t* src, const uint32_t src_size,
+                        uint8_t* dest, const uint32_t num_samples,
+                        uint32_t& flac_size)
+{
+	// chdman only stores the FLAC frames, so we make up the header
+	auto block_size = num_samples / 2;
+	while (block_size > ChdImage::SectorSize) {
+		block_size /= 2;
+	}
+	std::array<uint8_t, 42> header = {
+	        'f',  'L',  'a',  'C',
+	        0x80, 0x00, 0x00, 0x22, // last metadata block, STREAMINFO
+	        0x00, 0x00, 0x00, 0x00, // minimum and maximum block size
+	        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // frame sizes (unknown)
+	        0x0a, 0xc4, 0x42, 0xf0, // 44100 Hz, 2 channels, 16 bits
+	        0x00, 0x00, 0x00, 0x00, // number of samples (unknown)
+	};
+	// Leave some headroom in case the encoder used larger blocks
+	const auto max_block_size = block_size * 2;
+	header[8] = header[10] = static_cast<uint8_t>(max_block_size >> 8);
+	header[9] = header[11] = static_cast<uint8_t>(max_block_size & 0xff);
+
+	struct Stream {
+		std::array<uint8_t, 42>& header;
+		const uint8_t* src = nullptr;
+		size_t src_size    = 0;
+		size_t pos         = 0;
+	} stream = {header, src, src_size, 0};
+
+	auto on_read = [](void* user_data, void* buffer, size_t num_bytes) -> size_t {
+		auto& stream    = *static_cast<Stream*>(user_data);
+		auto out        = static_cast<uint8_t*>(buffer);
+		const auto size = stream.header.size() + stream.src_size;
+
+		size_t num_read = 0;
+		while (num_read < num_bytes && stream.pos < size) {
+			out[num_read++] = (stream.pos < stream.header.size())
+			                        ? stream.header[stream.pos]
+			                        : stream.src[stream.pos -
+			                                     stream.header.size()];
+			++stream.pos;
+		}
+		return num_read;
+	};
+	auto on_seek = [](void*, int, drflac_seek_origin) -> drflac_bool32 {
+		return DRFLAC_FALSE;
+	};
+
+	drflac* flac = drflac_open(on_read, on_seek, &stream, nullptr);
+	if (!flac) {
+		return false;
+	}
+	std::vector<int16_t> samples(num_samples);
+	const auto num_frames = drflac_read_pcm_frames_s16(flac,
+	                                                   num_samples / 2,
+	                                                   samples.data());
+
+	// drflac reads ahead into its bit cache, so the end of the last frame
+	// it decoded is as far as it has read less what's still cached
+	const auto& bs = flac->bs;
+	const auto num_cached = (sizeof(bs.cache) * 8 - bs.consumedBits) / 8 +
+	                        (std::size(bs.cacheL2) - bs.nextL2Line) *
+	                                sizeof(bs.cache) +
+	                        bs.unalignedByteCount;
+	drflac_close(flac);
+
+	if (num_frames != num_samples / 2 ||
+	    stream.pos < header.size() + num_cached) {
+		return false;
+	}
+	flac_size = static_cast<uint32_t>(stream.pos - header.size() - num_cached);
+	for (const auto sample : samples) {
+		*dest++ = static_cast<uint8_t>(static_cast<uint16_t>(sample) >> 8);
+		*dest++ = static_cast<uint8_t>(sample & 0xff);
+	}
+	return true;
+}
+
+// Regenerates the sync pattern and the ECC of a Mode 1 or Mode 2 Form 1
+// sector, which chdman strips before compressing if they can be recomputed
+static void regenerate_ecc(uint8_t* sector)
+{
+	constexpr std::array<uint8_t, 12> SyncPattern = {
+	        0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x00};
+	std::copy(SyncPattern.begin(), SyncPattern.end(), sector);
+
+	// Multiplication by two in GF(2^8), and its inverse of x ^ 2x
+	static const auto tables = [] {
+		std::array<std::array<uint8_t, 256>, 2> t = {};
+		for (auto i = 0; i < 256; ++i) {
+			const auto j = static_cast<uint8_t>((i << 1) ^ ((i & 0x80) ? 0x11d : 0));
+			t[0][i]                          = j;
+			t[1][static_cast<uint8_t>(i ^ j)] = static_cast<uint8_t>(i);
+		}
+		return t;
+	}();
+	const auto& ecc_low  = tables[0];
+	const auto& ecc_high = tables[1];
+
+	// The header only counts for Mode 1 sectors
+	const auto is_mode1 = sector[15] == 1;
+	auto source_byte    = [&](const uint32_t offset) -> uint8_t {
+		return (!is_mode1 && offset < 4) ? 0 : sector[12 + offset];
+	};
+
+	auto compute = [&](const uint32_t major_count,
+	                   const uint32_t minor_count,
+	                   const uint32_t major_mult,
+	                   const uint32_t minor_inc,
+	                   uint8_t* dest) {
+		const auto size = major_count * minor_count;
+		for (uint32_t major = 0; major < major_count; ++major) {
+			auto index = (major >> 1) * major_mult + (major & 1);
+			uint8_t a = 0;
+			uint8_t b = 0;
+			for (uint32_t minor = 0; minor < minor_count; ++minor) {
+				const auto value = source_byte(index);
+				index += minor_inc;
+				if (index >= size) {
+					index -= size;
+				}
+				a ^= value;
+				b ^= value;
+				a = ecc_low[a];
+			}
+			a                       = ecc_high[ecc_low[a] ^ b];
+			dest[major]             = a;
+			dest[major + major_count] = a ^ b;
+		}
+	};
+
+	// P parity, then Q parity, which covers P as well
+	compute(86, 24, 2, 86, sector + 2076);
+	compute(52, 43, 86, 88, sector + 2076 + 172);
+}
+
+std::shared_ptr<ChdImage> ChdImage::Open(const std_fs::path& path)
+{
+	std::shared_ptr<ChdImage> image(new ChdImage());
+	image->path = path;
+	image->file = fopen(path.string().c_str(), "rb");
+	if (!image->file) {
+		return nullptr;
+	}
+	if (!image->ReadHeader() || !image->ReadMap() || !image->ReadTracks()) {
+		return nullptr;
+	}
+	LOG_MSG("CDROM: Opened CHD image '%s' with %zu tracks",
+	        path.string().c_str(),
+	        image->tracks.size());
+	return image;
+}
+
+ChdImage::~ChdImage()
+{
+	const uint64_t num_hits  = num_cache_hits;
+	const uint64_t num_reads = num_hits + num_cache_misses;
+	if (num_reads > 0) {
+		LOG_MSG("CDROM: CHD hunk cache served %llu of %llu hunk reads",
+		        static_cast<unsigned long long>(num_hits),
+		        static_cast<unsigned long long>(num_reads));
+	}
+	if (file) {
+		fclose(file);
+	}
+}
+
+bool ChdImage::ReadFileAt(const uint64_t offset, uint8_t* data, const size_t num_bytes)
+{
+	return cross_fseeko(file, static_cast<cross_off_t>(offset), SEEK_SET) == 0 &&
+	       fread(data, 1, num_bytes, file) == num_bytes;
+}
+
+bool ChdImage::ReadHeader()
+{
+	std::array<uint8_t, HeaderSize> header = {};
+	if (!ReadFileAt(0, header.data(), header.size()) ||
+	    memcmp(header.data(), "MComprHD", 8) != 0) {
+		// Not a CHD image, so stay quiet
+		return false;
+	}
+
+	const auto version = static_cast<uint32_t>(read_be(&header[12], 4));
+	if (version != HeaderVersion) {
+		LOG_ERR("CDROM: CHD image '%s' is version %u, only version %u is supported",
+		        path.string().c_str(),
+		        version,
+		        HeaderVersion);
+		return false;
+	}
+
+	for (size_t i = 0; i < codecs.size(); ++i) {
+		codecs[i] = static_cast<uint32_t>(read_be(&header[16 + i * 4], 4));
+	}
+	logical_bytes = read_be(&header[32], 8);
+	map_offset    = read_be(&header[40], 8);
+	meta_offset   = read_be(&header[48], 8);
+	hunk_bytes    = static_cast<uint32_t>(read_be(&header[56], 4));
+	unit_bytes    = static_cast<uint32_t>(read_be(&header[60], 4));
+
+	const auto parent_sha1 = header.begin() + 104;
+	if (std::any_of(parent_sha1, parent_sha1 + 20, [](auto b) { return b != 0; })) {
+		LOG_ERR("CDROM: CHD image '%s' needs a parent image, which is not supported",
+		        path.string().c_str());
+		return false;
+	}
+
+	if (unit_bytes != FrameSize || hunk_bytes == 0 || hunk_bytes % FrameSize != 0) {
+		LOG_ERR("CDROM: CHD image '%s' is not a CD image", path.string().c_str());
+		return false;
+	}
+
+	for (const auto codec : codecs) {
+		if (codec != 0 && codec != CodecZlib && codec != CodecCdZlib &&
+		    codec != CodecCdFlac) {
+			LOG_ERR("CDROM: CHD image '%s' uses the unsupported '%s' compression; "
+			        "recompress it with 'chdman copy -c cdzl,cdfl'",
+			        path.string().c_str(),
+			        tag_to_string(codec).c_str());
+			return false;
+		}
+	}
+
+	const auto num_hunks_64 = (logical_bytes + hunk_bytes - 1) / hunk_bytes;
+	if (num_hunks_64 > UINT32_MAX) {
+		return false;
+	}
+	num_hunks = static_cast<uint32_t>(num_hunks_64);
+	return true;
+}
+
+bool ChdImage::ReadMap()
+{
+	map.resize(num_hunks);
+
+	const auto success = (codecs[0] == 0) ? ReadRawMap() : ReadCompressedMap();
+	if (!success) {
+		LOG_ERR("CDROM: CHD image '%s' has an invalid hunk map",
+		        path.string().c_str());
+	}
+	return success;
+}
+
+// Uncompressed images store the hunk offsets in units of hunks
+bool ChdImage::ReadRawMap()
+{
+	std::vector<uint8_t> raw_map(static_cast<size_t>(num_hunks) * 4);
+	if (!ReadFileAt(map_offset, raw_map.data(), raw_map.size())) {
+		return false;
+	}
+	for (uint32_t i = 0; i < num_hunks; ++i) {
+		const auto offset = read_be(&raw_map[i * 4], 4) * hunk_bytes;
+
+		map[i].type   = (offset == 0) ? CompressionZero : CompressionNone;
+		map[i].offset = offset;
+		map[i].length = hunk_bytes;
+	}
+	return true;
+}
+
+bool ChdImage::ReadCompressedMap()
+{
+	std::array<uint8_t, 16> map_header = {};
+	if (!ReadFileAt(map_offset, map_header.data(), map_header.size())) {
+		return false;
+	}
+	const auto map_bytes    = static_cast<uint32_t>(read_be(&map_header[0], 4));
+	const auto first_offset = read_be(&map_header[4], 6);
+	const auto map_crc      = static_cast<uint16_t>(read_be(&map_header[10], 2));
+	const auto length_bits  = map_header[12];
+	const auto self_bits    = map_header[13];
+	const auto parent_bits  = map_header[14];
+
+	if (length_bits > 32 || self_bits > 32 || parent_bits > 32) {
+		return false;
+	}
+
+	std::vector<uint8_t> data(map_bytes);
+	if (!ReadFileAt(map_offset + map_header.size(), data.data(), data.size())) {
+		return false;
+	}
+	BitReader bits(data.data(), data.size());
+
+	// The entry types come first, Huffman and run-length encoded
+	MapTypeDecoder decoder = {};
+	if (!decoder.Import(bits)) {
+		return false;
+	}
+	uint8_t last_type = 0;
+	int repeat_count  = 0;
+	for (auto& entry : map) {
+		if (repeat_count > 0) {
+			entry.type = last_type;
+			--repeat_count;
+			continue;
+		}
+		const auto type = decoder.Decode(bits);
+		if (type == CompressionRleSmall) {
+			entry.type   = last_type;
+			repeat_count = 2 + decoder.Decode(bits);
+		} else if (type == CompressionRleLarge) {
+			entry.type   = last_type;
+			repeat_count = 2 + 16 + (decoder.Decode(bits) << 4);
+			repeat_count += decoder.Decode(bits);
+		} else {
+			entry.type = last_type = type;
+		}
+	}
+
+	// Then the offsets, lengths and CRCs
+	auto offset        = first_offset;
+	uint64_t last_self = 0;
+	for (uint32_t i = 0; i < num_hunks; ++i) {
+		auto& entry = map[i];
+		switch (entry.type) {
+		case CompressionType0:
+		case CompressionType1:
+		case CompressionType2:
+		case CompressionType3:
+			entry.offset = offset;
+			entry.length = bits.Read(length_bits);
+			entry.crc    = static_cast<uint16_t>(bits.Read(16));
+			offset += entry.length;
+			break;
+		case CompressionNone:
+			entry.offset = offset;
+			entry.length = hunk_bytes;
+			entry.crc    = static_cast<uint16_t>(bits.Read(16));
+			offset += entry.length;
+			break;
+		case CompressionSelf:
+			entry.offset = last_self = bits.Read(self_bits);
+			break;
+		case CompressionSelf1:
+			++last_self;
+			[[fallthrough]];
+		case CompressionSelf0:
+			entry.type   = CompressionSelf;
+			entry.offset = last_self;
+			break;
+		case CompressionParent:
+			bits.Skip(parent_bits);
+			break;
+		case CompressionParentSelf:
+		case CompressionParent0:
+		case CompressionParent1:
+			entry.type = CompressionParent;
+			break;
+		default: return false;
+		}
+	}
+	if (bits.HasOverflowed()) {
+		return false;
+	}
+
+	// The CRC covers the map in chdman's expanded form
+	std::vector<uint8_t> raw_map(static_cast<size_t>(num_hunks) * 12);
+	for (uint32_t i = 0; i < num_hunks; ++i) {
+		const auto& entry = map[i];
+		auto raw          = &raw_map[i * 12];
+		raw[0]            = entry.type;
+		for (auto b = 0; b < 3; ++b) {
+			raw[1 + b] = static_cast<uint8_t>(entry.length >> (16 - b * 8));
+		}
+		for (auto b = 0; b < 6; ++b) {
+			raw[4 + b] = static_cast<uint8_t>(entry.offset >> (40 - b * 8));
+		}
+		raw[10] = static_cast<uint8_t>(entry.crc >> 8);
+		raw[11] = static_cast<uint8_t>(entry.crc & 0xff);
+	}
+	return crc16(raw_map.data(), raw_map.size()) == map_crc;
+}
+
+bool ChdImage::ReadTracks()
+{
+	auto offset = meta_offset;
+	while (offset != 0) {
+		std::array<uint8_t, 16> entry_header = {};
+		if (!ReadFileAt(offset, entry_header.data(), entry_header.size())) {
+			return false;
+		}
+		const auto tag    = static_cast<uint32_t>(read_be(&entry_header[0], 4));
+		const auto length = static_cast<uint32_t>(read_be(&entry_header[5], 3));
+		const auto next   = read_be(&entry_header[8], 8);
+
+		if (tag == TrackMetadataTag || tag == TrackMetadata2Tag) {
+			std::string text(length, '\0');
+			if (!ReadFileAt(offset + entry_header.size(),
+			                reinterpret_cast<uint8_t*>(text.data()),
+			                length)) {
+				return false;
+			}
+
+			// e.g. "TRACK:1 TYPE:MODE1_RAW SUBTYPE:NONE FRAMES:1234
+			//       PREGAP:0 PGTYPE:MODE1 PGSUB:RW POSTGAP:0"
+			ChdTrack track   = {};
+			std::istringstream fields(text.c_str());
+			std::string field = {};
+			while (fields >> field) {
+				const auto colon = field.find(':');
+				if (colon == std::string::npos) {
+					continue;
+				}
+				const auto key   = field.substr(0, colon);
+				const auto value = field.substr(colon + 1);
+				if (key == "TRACK") {
+					track.number = std::atoi(value.c_str());
+				} else if (key == "TYPE") {
+					track.type = value;
+				} else if (key == "FRAMES") {
+					track.num_frames = static_cast<uint32_t>(
+					        std::strtoul(value.c_str(), nullptr, 10));
+				} else if (key == "PREGAP") {
+					track.pregap = static_cast<uint32_t>(
+					        std::strtoul(value.c_str(), nullptr, 10));
+				} else if (key == "PGTYPE") {
+					// A 'V' prefix means the pregap is stored
+					track.is_pregap_stored = value.starts_with('V');
+				} else if (key == "POSTGAP") {
+					track.postgap = static_cast<uint32_t>(
+					        std::strtoul(value.c_str(), nullptr, 10));
+				}
+			}
+			tracks.push_back(track);
+		}
+		offset = next;
+	}
+
+	if (tracks.empty()) {
+		LOG_ERR("CDROM: CHD image '%s' has no CD tracks", path.string().c_str());
+		return false;
+	}
+
+	std::sort(tracks.begin(), tracks.end(), [](const auto& a, const auto& b) {
+		return a.number < b.number;
+	});
+
+	constexpr uint32_t TrackPadding = 4;
+
+	uint32_t frame = 0;
+	for (auto& track : tracks) {
+		track.first_frame = frame;
+		frame += (track.num_frames + TrackPadding - 1) / TrackPadding * TrackPadding;
+	}
+	if (static_cast<uint64_t>(frame) * FrameSize > logical_bytes) {
+		LOG_ERR("CDROM: CHD image '%s' has more frames in its tracks than it holds",
+		        path.string().c_str());
+		return false;
+	}
+	return true;
+}
+
+bool ChdImage::Read(const uint64_t offset, uint8_t* data, const uint32_t num_bytes)
+{
+	std::lock_guard lock(mutex);
+
+	uint32_t bytes_read = 0;
+	while (bytes_read < num_bytes) {
+		const auto pos          = offset + bytes_read;
+		const auto hunk_index   = pos / hunk_bytes;
+		const auto pos_in_hunk  = static_cast<uint32_t>(pos % hunk_bytes);
+		const auto bytes_to_copy = std::min(num_bytes - bytes_read,
+		                                    hunk_bytes - pos_in_hunk);
+
+		if (hunk_index >= num_hunks) {
+			return false;
+		}
+		const auto hunk = GetHunk(static_cast<uint32_t>(hunk_index));
+		if (!hunk) {
+			return false;
+		}
+		memcpy(data + bytes_read, hunk + pos_in_hunk, bytes_to_copy);
+		bytes_read += bytes_to_copy;
+	}
+	return true;
+}
+
+// Returns the decompressed hunk from the cache, decompressing it if needed;
+// the caller needs to hold the mutex
+const uint8_t* ChdImage::GetHunk(const uint32_t index, const int depth)
+{
+	if (const auto it = cache_index.find(index); it != cache_index.end()) {
+		++num_cache_hits;
+		cache.splice(cache.begin(), cache, it->second);
+		return it->second->data.data();
+	}
+	++num_cache_misses;
+
+	// Reuse the least recently used hunk's buffer once the cache is full
+	std::vector<uint8_t> data = {};
+	if (cache.size() >= MaxCachedHunks) {
+		cache_index.erase(cache.back().index);
+		data = std::move(cache.back().data);
+		cache.pop_back();
+	}
+	data.resize(hunk_bytes);
+
+	if (!DecompressHunk(index, data.data(), depth)) {
+		LOG_ERR("CDROM: Could not decompress hunk %u of CHD image '%s'",
+		        index,
+		        path.string().c_str());
+		return nullptr;
+	}
+
+	cache.push_front({index, std::move(data)});
+	cache_index[index] = cache.begin();
+	return cache.front().data.data();
+}
+
+bool ChdImage::DecompressHunk(const uint32_t index, uint8_t* dest, const int depth)
+{
+	const auto& entry = map[index];
+	switch (entry.type) {
+	case CompressionType0:
+	case CompressionType1:
+	case CompressionType2:
+	case CompressionType3:
+		compressed.resize(entry.length);
+		if (!ReadFileAt(entry.offset, compressed.data(), entry.length) ||
+		    !Decompress(codecs[entry.type], compressed.data(), entry.length, dest)) {
+			return false;
+		}
+		return crc16(dest, hunk_bytes) == entry.crc;
+
+	case CompressionNone:
+		if (!ReadFileAt(entry.offset, dest, hunk_bytes)) {
+			return false;
+		}
+		// Uncompressed images have no CRCs in their map
+		return codecs[0] == 0 || crc16(dest, hunk_bytes) == entry.crc;
+
+	case CompressionSelf: {
+		if (entry.offset >= num_hunks || entry.offset == index ||
+		    depth >= MaxSelfReferenceDepth) {
+			return false;
+		}
+		// Getting the other hunk might evict this one's buffer from
+		// the cache, so don't hold on to its pointer
+		const auto other = GetHunk(static_cast<uint32_t>(entry.offset), depth + 1);
+		if (!other) {
+			return false;
+		}
+		memcpy(dest, other, hunk_bytes);
+		return true;
+	}
+
+	case CompressionZero: memset(dest, 0, hunk_bytes); return true;
+
+	default:
+		// Parent references; we reject images with parents
+		return false;
+	}
+}
+
+bool ChdImage::Decompress(const uint32_t codec, const uint8_t* src,
+                          const uint32_t src_size, uint8_t* dest)
+{
+	if (codec == CodecZlib) {
+		return inflate_raw(src, src_size, dest, hunk_bytes);
+	}
+
+	// The CD codecs compress the sectors and the subcode separately
+	const auto num_frames    = hunk_bytes / FrameSize;
+	const auto sectors_bytes = num_frames * SectorSize;
+	const auto subcode_bytes = num_frames * SubcodeSize;
+
+	std::vector<uint8_t> buffer(sectors_bytes + subcode_bytes);
+
+	auto ecc_flags = src;
+	if (codec == CodecCdZlib) {
+		// A bit per frame telling if its ECC was stripped, then the
+		// size of the compressed sectors
+		const auto ecc_bytes    = (num_frames + 7) / 8;
+		const auto length_bytes = (hunk_bytes < 65536) ? 2 : 3;
+		const auto header_bytes = ecc_bytes + static_cast<uint32_t>(length_bytes);
+		if (src_size < header_bytes) {
+			return false;
+		}
+		const auto sectors_size = static_cast<uint32_t>(
+		        read_be(src + ecc_bytes, length_bytes));
+		if (header_bytes + sectors_size > src_size) {
+			return false;
+		}
+		if (!inflate_raw(src + header_bytes, sectors_size, buffer.data(), sectors_bytes) ||
+		    !inflate_raw(src + header_bytes + sectors_size,
+		                 src_size - header_bytes - sectors_size,
+		                 buffer.data() + sectors_bytes,
+		                 subcode_bytes)) {
+			return false;
+		}
+	} else {
+		assert(codec == CodecCdFlac);
+
+		// Only audio is compressed with FLAC, and the subcode follows
+		// the FLAC frames as a deflate stream
+		uint32_t flac_size = 0;
+		if (!decode_flac(src, src_size, buffer.data(), sectors_bytes / 2, flac_size) ||
+		    !inflate_raw(src + flac_size,
+		                 src_size - flac_size,
+		                 buffer.data() + sectors_bytes,
+		                 subcode_bytes)) {
+			return false;
+		}
+		ecc_flags = nullptr;
+	}
+
+	for (uint32_t frame = 0; frame < num_frames; ++frame) {
+		auto dest_frame = dest + frame * FrameSize;
+		memcpy(dest_frame, &buffer[frame * SectorSize], SectorSize);
+		memcpy(dest_frame + SectorSize,
+		       &buffer[sectors_bytes + frame * SubcodeSize],
+		       SubcodeSize);
+
+		if (ecc_flags && (ecc_flags[frame / 8] & (1 << (frame % 8)))) {
+			regenerate_ecc(dest_frame);
+		}
+	}
+	return true;
+}
@@ -0,0 +1,141 @@
+// SPDX-FileCopyrightText:  2026-2026 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef DOSBOX_CDROM_CHD_H
+#define DOSBOX_CDROM_CHD_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "misc/std_filesystem.h"
+
+// Compressed CD images (CHD)
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~
+// CHD ("Compressed Hunks of Data") is MAME's compressed disk image format,
+// created with 'chdman createcd'. The disc is stored as a stream of frames,
+// each a 2352-byte raw sector followed by 96 bytes of subcode, grouped into
+// hunks that are compressed individually. The track layout is kept in the
+// metadata.
+//
+// Only version 5 images without a parent are supported, compressed with the
+// 'cdzl' (deflate) and 'cdfl' (FLAC for audio) codecs, or not at all. Images
+// compressed with 'cdlz' (LZMA) or 'cdzs' (Zstandard) need to be recompressed:
+//
+//   chdman copy -c cdzl,cdfl -i game.chd -o game-dosbox.chd
+//
+// Hunks are decompressed on demand and kept in an LRU cache, so random sector
+// reads and audio playback only decompress the hunks they need.
+
+struct ChdTrack {
+	int number = 0;
+
+	// Track type as named by chdman, e.g. "MODE1_RAW" or "AUDIO"
+	std::string type = {};
+
+	// Number of frames stored for the track, including the pregap if it's
+	// stored (as the first frames)
+	uint32_t num_frames = 0;
+
+	uint32_t pregap       = 0;
+	uint32_t postgap      = 0;
+	bool is_pregap_stored = false;
+
+	// Position of the first frame in the image's stream of frames; tracks
+	// are padded to a multiple of four frames
+	uint32_t first_frame = 0;
+};
+
+class ChdImage {
+public:
+	static constexpr uint32_t FrameSize   = 2448;
+	static constexpr uint32_t SectorSize  = 2352;
+	static constexpr uint32_t SubcodeSize = FrameSize - SectorSize;
+
+	// Returns nullptr if the file is not a CHD image or can't be used
+	static std::shared_ptr<ChdImage> Open(const std_fs::path& path);
+
+	ChdImage(const ChdImage&)            = delete;
+	ChdImage& operator=(const ChdImage&) = delete;
+
+	~ChdImage();
+
+	const std::vector<ChdTrack>& GetTracks() const
+	{
+		return tracks;
+	}
+
+	// Reads from the stream of frames; safe to call from multiple threads
+	bool Read(uint64_t offset, uint8_t* data, uint32_t num_bytes);
+
+	uint64_t GetNumCacheHits() const
+	{
+		return num_cache_hits;
+	}
+	uint64_t GetNumCacheMisses() const
+	{
+		return num_cache_misses;
+	}
+
+private:
+	struct MapEntry {
+		uint64_t offset = 0;
+		uint32_t length = 0;
+		uint16_t crc    = 0;
+		uint8_t type    = 0;
+	};
+
+	struct CachedHunk {
+		uint32_t index            = 0;
+		std::vector<uint8_t> data = {};
+	};
+
+	ChdImage() = default;
+
+	bool ReadHeader();
+	bool ReadMap();
+	bool ReadRawMap();
+	bool ReadCompressedMap();
+	bool ReadTracks();
+
+	const uint8_t* GetHunk(uint32_t index, int depth = 0);
+	bool DecompressHunk(uint32_t index, uint8_t* dest, int depth);
+	bool Decompress(uint32_t codec, const uint8_t* src, uint32_t src_size,
+	                uint8_t* dest);
+	bool ReadFileAt(uint64_t offset, uint8_t* data, size_t num_bytes);
+
+	std_fs::path path = {};
+	FILE* file        = nullptr;
+
+	std::array<uint32_t, 4> codecs = {};
+
+	uint64_t logical_bytes = 0;
+	uint64_t map_offset    = 0;
+	uint64_t meta_offset   = 0;
+	uint32_t hunk_bytes    = 0;
+	uint32_t unit_bytes    = 0;
+	uint32_t num_hunks     = 0;
+
+	std::vector<MapEntry> map    = {};
+	std::vector<ChdTrack> tracks = {};
+
+	// Guards the file and the cache
+	std::mutex mutex = {};
+
+	std::list<CachedHunk> cache = {};
+	std::unordered_map<uint32_t, std::list<CachedHunk>::iterator> cache_index = {};
+
+	std::vector<uint8_t> compressed = {};
+
+	std::atomic<uint64_t> num_cache_hits   = 0;
+	std::atomic<uint64_t> num_cache_misses = 0;
+};
+
+#endif // DOSBOX_CDROM_CHD_H
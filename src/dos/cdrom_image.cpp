@@ -44,6 +44,8 @@ using tracks_size_t    = std::vector<CDROM_Interface_Image::Track>::size_type;
 // Ensure the maximum allowed redbook bytes stays within the API type sizes
 static_assert(MAX_REDBOOK_BYTES <= UINT32_MAX);
 
+static_assert(ImageReadAhead::MaxSequentialGap == BYTES_PER_RAW_REDBOOK_FRAME);
+
 // Report bad seeks that would go beyond the end of the track
 bool CDROM_Interface_Image::TrackFile::offsetInsideTrack(const uint32_t offset)
 {
@@ -83,7 +85,9 @@ uint32_t CDROM_Interface_Image::TrackFile::adjustOverRead(const uint32_t offset,
 
 CDROM_Interface_Image::BinaryFile::BinaryFile(const std_fs::path &filename, bool &error)
         : TrackFile(BYTES_PER_RAW_REDBOOK_FRAME),
-          file(nullptr)
+          filename(filename),
+          file(nullptr),
+          read_ahead(filename)
 {
 	file = new std::ifstream(filename, std::ios::in | std::ios::binary);
 	// If new fails, an exception is generated and scope leaves this constructor
@@ -113,6 +117,10 @@ bool CDROM_Interface_Image::BinaryFile::read(uint8_t *buffer,
 	if (adjusted_bytes == 0) // no work to do!
 		return true;
 
+	if (read_ahead.Read(buffer, offset, adjusted_bytes)) {
+		return true;
+	}
+
 	// Reposition if needed
 	if (!seek(offset))
 		return false;
@@ -223,6 +231,15 @@ CDROM_Interface_Image::AudioFile::AudioFile(const char *filename, bool &error)
 
 CDROM_Interface_Image::AudioFile::~AudioFile()
 {
+	if (decode_ahead_thread.joinable()) {
+		{
+			std::lock_guard lock(decoded_mutex);
+			should_exit = true;
+		}
+		decode_ahead_waiter.notify_all();
+		decode_ahead_thread.join();
+	}
+
 	// Guard to prevent double-free or nullptr free
 	if (sample == nullptr)
 		return;
@@ -244,6 +261,13 @@ CDROM_Interface_Image::AudioFile::~AudioFile()
  *  time-offset, and use the Sound_Seek() function to move the read position.
  */
 bool CDROM_Interface_Image::AudioFile::seek(const uint32_t requested_pos)
+{
+	std::lock_guard lock(sample_mutex);
+	return seekSample(requested_pos);
+}
+
+// The caller needs to hold the sample mutex
+bool CDROM_Interface_Image::AudioFile::seekSample(const uint32_t requested_pos)
 {
 	// Check for logic bugs and if the track is already positioned as requested
 	assertm(sample, "Audio sample needs to be valid, but is the nullptr");
@@ -252,6 +276,8 @@ bool CDROM_Interface_Image::AudioFile::seek(const uint32_t requested_pos)
 	if (!offsetInsideTrack(requested_pos))
 		return false;
 
+	// The audio decoded ahead continues from the audio position, so it
+	// stays valid
 	if (audio_pos == requested_pos) {
 #ifdef DEBUG
 		LOG_MSG("CDROM: seek to %u avoided with position-tracking", requested_pos);
@@ -259,6 +285,8 @@ bool CDROM_Interface_Image::AudioFile::seek(const uint32_t requested_pos)
 		return true;
 	}
 
+	discardDecodedAhead();
+
 	// Convert the position from a byte offset to time offset, in milliseconds.
 	const uint32_t ms_per_s = 1000;
 	const uint32_t pos_in_frames = ceil_udivide(requested_pos, BYTES_PER_RAW_REDBOOK_FRAME);
@@ -332,7 +360,11 @@ bool CDROM_Interface_Image::AudioFile::read(uint8_t *buffer,
 		return false; // we always correctly return false to the application in this case.
 	}
 
-	if (!seek(requested_pos))
+	// We decode straight from the sample, so drop what was decoded ahead
+	std::lock_guard lock(sample_mutex);
+	discardDecodedAhead();
+
+	if (!seekSample(requested_pos))
 		return false;
 
 	const uint32_t adjusted_bytes = adjustOverRead(requested_pos, requested_bytes);
@@ -415,9 +447,56 @@ uint32_t CDROM_Interface_Image::AudioFile::decode(int16_t *buffer,
 	assertm(audio_pos < MAX_REDBOOK_BYTES,
 	        "Tried to decode audio before the playback position was set");
 
-	// Sound_Decode_Direct returns frames (agnostic of bitrate and channels)
-	const uint32_t frames_decoded =
-	    Sound_Decode_Direct(sample, (void*)buffer, desired_track_frames);
+	startDecodeAhead();
+
+	const auto channels = getChannels();
+	const auto desired_samples = desired_track_frames * channels;
+
+	// Copies up to the desired number of samples from the decoded ring;
+	// the caller needs to hold the decoded mutex
+	size_t samples_taken = 0;
+	auto take_decoded = [&] {
+		const auto num_samples = std::min(decoded_count,
+		                                  desired_samples - samples_taken);
+		for (size_t i = 0; i < num_samples; ++i) {
+			buffer[samples_taken++] = decoded[decoded_start];
+			decoded_start = (decoded_start + 1) % decoded.size();
+		}
+		decoded_count -= num_samples;
+	};
+
+	auto is_hit = false;
+	{
+		std::lock_guard decoded_lock(decoded_mutex);
+		if (decoded_count >= desired_samples || decoded_eof) {
+			take_decoded();
+			is_hit = true;
+		}
+	}
+
+	uint32_t frames_decoded = 0;
+	if (is_hit) {
+		++decode_ahead_hits;
+		frames_decoded = check_cast<uint32_t>(samples_taken / channels);
+	} else {
+		// The decode-ahead fell behind, so decode the rest ourselves.
+		// Holding the sample mutex ensures no frames are in flight.
+		++decode_ahead_misses;
+
+		std::lock_guard sample_lock(sample_mutex);
+		{
+			std::lock_guard decoded_lock(decoded_mutex);
+			take_decoded();
+		}
+		const auto frames_taken = check_cast<uint32_t>(samples_taken / channels);
+
+		// Sound_Decode_Direct returns frames (agnostic of bitrate and channels)
+		frames_decoded = frames_taken +
+		                 Sound_Decode_Direct(sample,
+		                                     buffer + samples_taken,
+		                                     desired_track_frames - frames_taken);
+	}
+	decode_ahead_waiter.notify_one();
 
 	// decoding is an audio-task, so update our audio position
 	// in terms of Redbook-equivalent bytes
@@ -427,6 +506,94 @@ uint32_t CDROM_Interface_Image::AudioFile::decode(int16_t *buffer,
 	return frames_decoded;
 }
 
+// Starts the decode-ahead thread unless it's running; only the mixer thread
+// calls this, while holding the player mutex
+void CDROM_Interface_Image::AudioFile::startDecodeAhead()
+{
+	{
+		std::lock_guard lock(decoded_mutex);
+		if (is_decoding_ahead) {
+			return;
+		}
+		is_decoding_ahead = true;
+
+		// Buffer one second of audio. The audio decoded before the
+		// thread went idle is still valid, e.g., after a long pause.
+		if (decoded.empty()) {
+			decoded.resize(static_cast<size_t>(getRate()) * getChannels());
+		}
+	}
+
+	// Reap the thread that exited when it went idle
+	if (decode_ahead_thread.joinable()) {
+		decode_ahead_thread.join();
+	}
+	decode_ahead_thread = std::thread(&AudioFile::decodeAheadLoop, this);
+}
+
+// Drops the audio decoded ahead, as the sample is about to be repositioned or
+// read from directly; the caller needs to hold the sample mutex
+void CDROM_Interface_Image::AudioFile::discardDecodedAhead()
+{
+	{
+		std::lock_guard lock(decoded_mutex);
+
+		// The sample is ahead of the audio position by what's been
+		// decoded, so a seek to the audio position needs to happen
+		if (decoded_count > 0 || decoded_eof) {
+			audio_pos = std::numeric_limits<uint32_t>::max();
+		}
+		decoded_start = 0;
+		decoded_count = 0;
+		decoded_eof   = false;
+	}
+	decode_ahead_waiter.notify_one();
+}
+
+void CDROM_Interface_Image::AudioFile::decodeAheadLoop()
+{
+	const auto channels      = getChannels();
+	const auto chunk_samples = DecodeAheadFrames * channels;
+
+	std::vector<int16_t> chunk(chunk_samples);
+
+	std::unique_lock decoded_lock(decoded_mutex);
+	while (true) {
+		const auto has_work = decode_ahead_waiter.wait_for(
+		        decoded_lock, DecodeAheadIdleTimeout, [&] {
+			        return should_exit ||
+			               (!decoded_eof &&
+			                decoded.size() - decoded_count >= chunk_samples);
+		        });
+		if (should_exit) {
+			return;
+		}
+		if (!has_work) {
+			// Playback has stopped, paused or reached the end of
+			// the track; the next decode starts a new thread
+			is_decoding_ahead = false;
+			return;
+		}
+		decoded_lock.unlock();
+
+		std::lock_guard sample_lock(sample_mutex);
+		const auto frames = Sound_Decode_Direct(sample,
+		                                        chunk.data(),
+		                                        DecodeAheadFrames);
+		decoded_lock.lock();
+
+		// Only this thread adds to the ring, so the space is still free
+		auto pos = (decoded_start + decoded_count) % decoded.size();
+		for (size_t i = 0; i < frames * channels; ++i) {
+			decoded[pos] = chunk[i];
+			pos          = (pos + 1) % decoded.size();
+		}
+		decoded_count += frames * channels;
+		decoded_eof = (frames == 0) ||
+		              (sample->flags & (SOUND_SAMPLEFLAG_ERROR | SOUND_SAMPLEFLAG_EOF));
+	}
+}
+
 uint16_t CDROM_Interface_Image::AudioFile::getEndian()
 {
 	return sample ? sample->actual.format : static_cast<uint16_t>(SDL_AUDIO_S16);
@@ -461,6 +628,88 @@ int CDROM_Interface_Image::AudioFile::getLength()
 	return length_redbook_bytes;
 }
 
+CDROM_Interface_Image::ChdFile::ChdFile(const std::shared_ptr<ChdImage>& image,
+                                        const uint32_t first_frame,
+                                        const uint32_t num_frames, const bool is_audio)
+        : TrackFile(BYTES_PER_RAW_REDBOOK_FRAME),
+          image(image),
+          start_offset(static_cast<uint64_t>(first_frame) * ChdImage::FrameSize),
+          num_frames(num_frames),
+          is_audio(is_audio)
+{}
+
+bool CDROM_Interface_Image::ChdFile::read(uint8_t* buffer, const uint32_t offset,
+                                          const uint32_t requested_bytes)
+{
+	if (!offsetInsideTrack(offset)) {
+		return false;
+	}
+	const auto num_bytes = adjustOverRead(offset, requested_bytes);
+	if (!image->Read(start_offset + offset, buffer, num_bytes)) {
+		return false;
+	}
+
+	// Audio is stored big-endian in CHD images, but sector reads should
+	// return the same bytes as a BIN image
+	if (is_audio) {
+		for (uint32_t i = offset % 2; i + 1 < num_bytes; i += 2) {
+			std::swap(buffer[i], buffer[i + 1]);
+		}
+	}
+	return true;
+}
+
+bool CDROM_Interface_Image::ChdFile::seek(const uint32_t offset)
+{
+	// Every read is at an absolute position
+	return offsetInsideTrack(offset);
+}
+
+uint32_t CDROM_Interface_Image::ChdFile::decode(int16_t* buffer,
+                                                const uint32_t desired_track_frames)
+{
+	assertm(desired_track_frames <= MAX_REDBOOK_FRAMES,
+	        "Requested number of frames exceeds the maximum for a CDROM");
+	assertm(audio_pos < MAX_REDBOOK_BYTES,
+	        "Tried to decode audio before the playback position was set");
+
+	// Gather the samples from consecutive frames, skipping their subcode
+	const auto length  = static_cast<uint32_t>(getLength());
+	const auto out     = reinterpret_cast<uint8_t*>(buffer);
+	const auto desired = desired_track_frames * BYTES_PER_REDBOOK_PCM_FRAME;
+
+	uint32_t bytes_decoded = 0;
+	while (bytes_decoded < desired && audio_pos < length) {
+		const auto pos_in_frame = audio_pos % ChdImage::FrameSize;
+		if (pos_in_frame >= ChdImage::SectorSize) {
+			audio_pos += ChdImage::FrameSize - pos_in_frame;
+			continue;
+		}
+		const auto num_bytes = std::min(desired - bytes_decoded,
+		                                ChdImage::SectorSize - pos_in_frame);
+		if (!image->Read(start_offset + audio_pos, out + bytes_decoded, num_bytes)) {
+			break;
+		}
+		bytes_decoded += num_bytes;
+		audio_pos += num_bytes;
+	}
+	return ceil_udivide(bytes_decoded, BYTES_PER_REDBOOK_PCM_FRAME);
+}
+
+uint16_t CDROM_Interface_Image::ChdFile::getEndian()
+{
+	// Playback gets the samples as they're stored
+	return is_audio ? SDL_AUDIO_S16BE : SDL_AUDIO_S16LE;
+}
+
+int CDROM_Interface_Image::ChdFile::getLength()
+{
+	if (length_redbook_bytes < 0) {
+		length_redbook_bytes = static_cast<int>(num_frames * ChdImage::FrameSize);
+	}
+	return length_redbook_bytes;
+}
+
 // initialize static members
 int CDROM_Interface_Image::refCount = 0;
 CDROM_Interface_Image::imagePlayer CDROM_Interface_Image::player;
@@ -494,6 +743,18 @@ CDROM_Interface_Image::CDROM_Interface_Image()
 
 CDROM_Interface_Image::~CDROM_Interface_Image()
 {
+	if (const auto stats = GetPrefetchStats();
+	    stats.sector_hits + stats.audio_hits > 0) {
+		LOG_MSG("CDROM: Read-ahead served %llu of %llu sector reads, "
+		        "decode-ahead %llu of %llu audio reads",
+		        static_cast<unsigned long long>(stats.sector_hits),
+		        static_cast<unsigned long long>(stats.sector_hits +
+		                                        stats.sector_misses),
+		        static_cast<unsigned long long>(stats.audio_hits),
+		        static_cast<unsigned long long>(stats.audio_hits +
+		                                        stats.audio_misses));
+	}
+
 	MIXER_LockMixerThread();
 	refCount--;
 
@@ -513,10 +774,26 @@ CDROM_Interface_Image::~CDROM_Interface_Image()
 	MIXER_UnlockMixerThread();
 }
 
+CDROM_Interface_Image::PrefetchStats CDROM_Interface_Image::GetPrefetchStats() const
+{
+	PrefetchStats stats = {};
+
+	// Tracks in the same file share it, so only count each file once
+	const TrackFile* previous_file = nullptr;
+	for (const auto& track : tracks) {
+		if (track.file && track.file.get() != previous_file) {
+			track.file->addPrefetchStats(stats);
+			previous_file = track.file.get();
+		}
+	}
+	return stats;
+}
+
 bool CDROM_Interface_Image::SetDevice(const char* path)
 {
 	std::lock_guard lock(player.mutex);
-	const bool result = LoadMdsFile(path) || LoadCueSheet(path) || LoadIsoFile(path);
+	const bool result = LoadMdsFile(path) || LoadChdFile(path) ||
+	                    LoadCueSheet(path) || LoadIsoFile(path);
 	if (!result) {
 		// print error message on dosbox console
 		char buf[MAX_LINE_LENGTH];
@@ -1424,6 +1701,80 @@ bool CDROM_Interface_Image::LoadMdsFile(const char *mds_filename)
 	return true;
 }
 
+// Every CHD track is stored in 2448-byte frames. Cooked sectors sit at the
+// start of their frame, so the padding after them counts as subchannel data.
+static bool set_chd_track_mode(CDROM_Interface_Image::Track& track,
+                               const std::string& type)
+{
+	track.sector_size = ChdImage::FrameSize;
+	track.attr        = 0x40;
+	track.mode2       = false;
+
+	if (type == "AUDIO") {
+		track.attr            = 0;
+		track.subchannel_size = ChdImage::SubcodeSize;
+	} else if (type == "MODE1") {
+		track.subchannel_size = ChdImage::FrameSize - BYTES_PER_COOKED_REDBOOK_FRAME;
+	} else if (type == "MODE1_RAW") {
+		track.subchannel_size = ChdImage::SubcodeSize;
+	} else if (type == "MODE2" || type == "MODE2_FORM_MIX") {
+		track.subchannel_size = ChdImage::FrameSize - 2336;
+		track.mode2           = true;
+	} else if (type == "MODE2_RAW") {
+		track.subchannel_size = ChdImage::SubcodeSize;
+		track.mode2           = true;
+	} else {
+		// Form 1/2 are CDROM-XA modes which will need deeper
+		// integration to support, like in MDS images
+		LOG_ERR("CDROM: Unsupported CHD track type: %s", type.c_str());
+		return false;
+	}
+	return true;
+}
+
+bool CDROM_Interface_Image::LoadChdFile(const char* filename)
+{
+	const auto image = ChdImage::Open(to_native_path(filename));
+	if (!image) {
+		return false;
+	}
+
+	uint32_t disc_pos = 0;
+	for (const auto& chd_track : image->GetTracks()) {
+		Track track = {};
+		track.number = check_cast<uint8_t>(chd_track.number);
+		if (!set_chd_track_mode(track, chd_track.type)) {
+			tracks.clear();
+			return false;
+		}
+		if (track.number != static_cast<int>(tracks.size()) + 1 ||
+		    (chd_track.is_pregap_stored && chd_track.pregap > chd_track.num_frames)) {
+			LOG_ERR("CDROM: Invalid track layout in CHD file");
+			tracks.clear();
+			return false;
+		}
+
+		// Leave out a stored pregap, like the INDEX 00 part of a cue
+		// sheet track
+		const auto stored_pregap = chd_track.is_pregap_stored ? chd_track.pregap : 0;
+
+		disc_pos += chd_track.pregap;
+		track.start  = disc_pos;
+		track.length = chd_track.num_frames - stored_pregap;
+		track.file   = std::make_shared<ChdFile>(image,
+		                                         chd_track.first_frame + stored_pregap,
+		                                         track.length,
+		                                         track.attr == 0);
+		disc_pos += track.length + chd_track.postgap;
+
+		tracks.push_back(track);
+	}
+	Track lead_out = {};
+	lead_out.start = tracks.back().start + tracks.back().length;
+	tracks.push_back(lead_out);
+	return true;
+}
+
 bool CDROM_Interface_Image::LoadCueSheet(const char *cuefile)
 {
 	tracks.clear();
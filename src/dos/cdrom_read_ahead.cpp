@@ -0,0 +1,163 @@
+// SPDX-FileCopyrightText:  2026-2026 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "cdrom_read_ahead.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <system_error>
+
+#include "utils/checks.h"
+#include "utils/math_utils.h"
+
+CHECK_NARROWING();
+
+ImageReadAhead::ImageReadAhead(const std_fs::path& _filename)
+        : filename(_filename)
+{
+	std::error_code ec = {};
+	const auto file_size = std_fs::file_size(filename, ec);
+	if (!ec) {
+		num_file_chunks = static_cast<uint32_t>(
+		        ceil_udivide(static_cast<uint64_t>(file_size), ChunkSize));
+	}
+}
+
+ImageReadAhead::~ImageReadAhead()
+{
+	if (thread.joinable()) {
+		{
+			std::lock_guard lock(mutex);
+			should_exit = true;
+		}
+		waiter.notify_all();
+		thread.join();
+	}
+}
+
+bool ImageReadAhead::Read(uint8_t* buffer, const uint32_t offset,
+                          const uint32_t num_bytes)
+{
+	bool is_hit           = false;
+	bool has_window_moved = false;
+	{
+		std::lock_guard lock(mutex);
+		has_window_moved = UpdateWindow(offset, num_bytes);
+		is_hit           = CopyFromChunks(buffer, offset, num_bytes);
+	}
+	if (has_window_moved) {
+		waiter.notify_all();
+	}
+
+	if (is_hit) {
+		++num_hits;
+	} else {
+		++num_misses;
+	}
+	return is_hit;
+}
+
+void ImageReadAhead::WaitUntilFilled()
+{
+	std::unique_lock lock(mutex);
+	waiter.wait(lock, [&] {
+		return should_exit || (next_chunk >= end_chunk && !is_reading);
+	});
+}
+
+// Moves the read-ahead window along with the sequential reads, and starts the
+// thread on the first of them. Returns true if the window has moved. The
+// caller needs to hold the mutex.
+bool ImageReadAhead::UpdateWindow(const uint32_t offset, const uint32_t num_bytes)
+{
+	const auto is_sequential = (offset >= next_sequential_offset) &&
+	                           (offset - next_sequential_offset < MaxSequentialGap);
+
+	num_sequential_reads = is_sequential ? num_sequential_reads + 1 : 0;
+	next_sequential_offset = offset + num_bytes;
+
+	if (num_sequential_reads < MinSequentialReads) {
+		return false;
+	}
+
+	const auto current_chunk = offset / ChunkSize;
+
+	// Start over if the reads moved out of the window
+	if (next_chunk < current_chunk || next_chunk > current_chunk + Distance) {
+		next_chunk = current_chunk;
+	}
+	end_chunk = std::min(current_chunk + Distance + 1, num_file_chunks);
+
+	if (!thread.joinable()) {
+		thread = std::thread(&ImageReadAhead::ReadAheadLoop, this);
+	}
+	return true;
+}
+
+// The caller needs to hold the mutex
+bool ImageReadAhead::CopyFromChunks(uint8_t* buffer, const uint32_t offset,
+                                    const uint32_t num_bytes) const
+{
+	// A read might span two chunks
+	uint32_t bytes_copied = 0;
+	while (bytes_copied < num_bytes) {
+		const auto pos           = offset + bytes_copied;
+		const auto index         = pos / ChunkSize;
+		const auto pos_in_chunk  = pos % ChunkSize;
+		const auto bytes_to_copy = std::min(num_bytes - bytes_copied,
+		                                    ChunkSize - pos_in_chunk);
+
+		const auto& chunk = chunks[index % NumChunks];
+		if (chunk.index != index || pos_in_chunk + bytes_to_copy > chunk.num_bytes) {
+			return false;
+		}
+		memcpy(buffer + bytes_copied, chunk.data.data() + pos_in_chunk, bytes_to_copy);
+		bytes_copied += bytes_to_copy;
+	}
+	return true;
+}
+
+void ImageReadAhead::ReadAheadLoop()
+{
+	std::ifstream reader(filename, std::ios::in | std::ios::binary);
+	std::vector<uint8_t> data = {};
+
+	std::unique_lock lock(mutex);
+	auto has_work = [&] {
+		return should_exit || next_chunk < end_chunk;
+	};
+	while (true) {
+		if (!has_work()) {
+			// The window is filled; wake up the waits for it
+			waiter.notify_all();
+			waiter.wait(lock, has_work);
+		}
+		if (should_exit) {
+			return;
+		}
+
+		const auto index = next_chunk++;
+		if (chunks[index % NumChunks].index == index) {
+			continue;
+		}
+
+		// Don't hold up the readers while reading
+		is_reading = true;
+		lock.unlock();
+
+		data.resize(ChunkSize);
+		reader.clear();
+		reader.seekg(static_cast<std::streamoff>(index) * ChunkSize, std::ios::beg);
+		reader.read(reinterpret_cast<char*>(data.data()), ChunkSize);
+		const auto num_bytes = static_cast<uint32_t>(reader.gcount());
+
+		lock.lock();
+		is_reading = false;
+
+		auto& chunk = chunks[index % NumChunks];
+		chunk.data.swap(data);
+		chunk.index     = index;
+		chunk.num_bytes = num_bytes;
+	}
+}
@@ -0,0 +1,95 @@
+// SPDX-FileCopyrightText:  2026-2026 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef DOSBOX_CDROM_READ_AHEAD_H
+#define DOSBOX_CDROM_READ_AHEAD_H
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "misc/std_filesystem.h"
+
+// Read-ahead of CD image files
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Games streaming video or data from a CD read it sector by sector, and on
+// slow storage every read of a large BIN image would hold up the emulation.
+// Once the reads are sequential, a background thread keeps a ring of chunks of
+// the image filled ahead of the read position. It reads through its own
+// stream, so the reads that miss the ring go to the image as before.
+//
+// The emulation thread reads data sectors while the mixer thread plays audio
+// from the same image, so all the state is guarded by the one mutex.
+
+class ImageReadAhead {
+public:
+	static constexpr uint32_t ChunkSize     = 64 * 1024;
+	static constexpr uint32_t NumChunks     = 16;
+	static constexpr uint32_t Distance      = 8; // in chunks
+	static constexpr int MinSequentialReads = 2;
+
+	// Cooked reads of raw sectors skip the sector headers, so a read
+	// starting less than a raw sector after the previous one still counts
+	// as sequential
+	static constexpr uint32_t MaxSequentialGap = 2352;
+
+	explicit ImageReadAhead(const std_fs::path& filename);
+	~ImageReadAhead();
+
+	// prevent copying
+	ImageReadAhead(const ImageReadAhead&) = delete;
+	// prevent assignment
+	ImageReadAhead& operator=(const ImageReadAhead&) = delete;
+
+	// Follows the read position, and copies the data if it's been read
+	// ahead. Returns false if the caller needs to read it from the image.
+	bool Read(uint8_t* buffer, const uint32_t offset, const uint32_t num_bytes);
+
+	// Waits until the chunks ahead of the read position have been read
+	void WaitUntilFilled();
+
+	uint64_t GetNumHits() const
+	{
+		return num_hits;
+	}
+
+	uint64_t GetNumMisses() const
+	{
+		return num_misses;
+	}
+
+private:
+	struct Chunk {
+		uint32_t index            = UINT32_MAX;
+		uint32_t num_bytes        = 0;
+		std::vector<uint8_t> data = {};
+	};
+
+	bool UpdateWindow(const uint32_t offset, const uint32_t num_bytes);
+	bool CopyFromChunks(uint8_t* buffer, const uint32_t offset,
+	                    const uint32_t num_bytes) const;
+	void ReadAheadLoop();
+
+	const std_fs::path filename = {};
+	uint32_t num_file_chunks    = 0;
+
+	std::array<Chunk, NumChunks> chunks = {};
+
+	std::thread thread               = {};
+	std::mutex mutex                 = {};
+	std::condition_variable waiter   = {};
+	std::atomic<uint64_t> num_hits   = 0;
+	std::atomic<uint64_t> num_misses = 0;
+	uint32_t next_chunk              = 0;
+	uint32_t end_chunk               = 0;
+	uint32_t next_sequential_offset  = UINT32_MAX;
+	int num_sequential_reads         = 0;
+	bool is_reading                  = false;
+	bool should_exit                 = false;
+};
+
+#endif // DOSBOX_CDROM_READ_AHEAD_H
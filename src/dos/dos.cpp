@@ -131,6 +131,25 @@ static uint16_t DOS_GetAmount(void) {
 	return amount;
 }
 
+// Files are read and written straight from and into the guest memory when
+// it's plain RAM, skipping the copy through dos_copybuf and the per-byte page
+// handler calls. Devices keep using the copy as reading them can run guest
+// code (e.g., CON waits for keypresses), which could remap the memory.
+static uint8_t* get_direct_file_transfer_ptr(const uint16_t entry, const PhysPt pt,
+                                             const uint16_t size, const bool writing)
+{
+	const auto handle = RealHandle(entry);
+	if (handle >= DOS_FILES || !Files[handle]) {
+		return nullptr;
+	}
+	constexpr uint16_t IsDeviceFlag = 0x8000;
+	if (Files[handle]->GetInformation() & IsDeviceFlag) {
+		return nullptr;
+	}
+	return writing ? MEM_GetHostWriteSpan(pt, size)
+	               : MEM_GetHostReadSpan(pt, size);
+}
+
 #define DATA_TRANSFERS_TAKE_CYCLES 1
 #ifdef DATA_TRANSFERS_TAKE_CYCLES
 
@@ -1051,9 +1070,13 @@ static Bitu DOS_21Handler(void) {
 		{ 
 			uint16_t toread=DOS_GetAmount();
 			dos.echo=true;
-			if (DOS_ReadFile(reg_bx,dos_copybuf,&toread)) {
+			const PhysPt dest = SegPhys(ds) + reg_dx;
+			const auto host_dest = get_direct_file_transfer_ptr(reg_bx, dest, toread, true);
+			if (DOS_ReadFile(reg_bx, host_dest ? host_dest : dos_copybuf, &toread)) {
 			        DOS_PerformDiskIoDelayByHandle(toread, reg_bx);
-			        MEM_BlockWrite(SegPhys(ds)+reg_dx,dos_copybuf,toread);
+			        if (!host_dest) {
+				        MEM_BlockWrite(dest, dos_copybuf, toread);
+			        }
 				reg_ax=toread;
 				CALLBACK_SCF(false);
 			} else {
@@ -1067,8 +1090,13 @@ static Bitu DOS_21Handler(void) {
 	case 0x40:					/* WRITE Write to file or device */
 		{
 			uint16_t towrite=DOS_GetAmount();
-			MEM_BlockRead(SegPhys(ds)+reg_dx,dos_copybuf,towrite);
-		        if (DOS_WriteFile(reg_bx, dos_copybuf, &towrite)) {
+			const PhysPt src = SegPhys(ds) + reg_dx;
+			auto host_src = get_direct_file_transfer_ptr(reg_bx, src, towrite, false);
+			if (!host_src) {
+				MEM_BlockRead(src, dos_copybuf, towrite);
+				host_src = dos_copybuf;
+			}
+		        if (DOS_WriteFile(reg_bx, host_src, &towrite)) {
 			        DOS_PerformDiskIoDelayByHandle(towrite, reg_bx);
 			        reg_ax = towrite;
 			        CALLBACK_SCF(false);
@@ -2062,6 +2090,17 @@ static void init_dos_settings(SectionProp& section)
 	        "  auto:  Enable file locking only when Windows 3.1 is running.\n"
 	        "  on:    Always enable file locking.\n"
 	        "  off:   Always disable file locking.");
+
+	auto pint = section.AddInt("file_buffer_size", WhenIdle, 16);
+	pint->SetMinMax(0, 1024);
+	pint->SetHelp(
+	        "Size of the read-ahead and write-behind buffer of the files opened on mounted\n"
+	        "host directories, in kilobytes (16 by default). Small consecutive reads and\n"
+	        "writes done by DOS programs are served from the buffer instead of going to the\n"
+	        "host one by one. Buffered writes are committed to the host when the file is\n"
+	        "closed or flushed, or when another program looks at it. Set to 0 to disable\n"
+	        "the buffering, e.g., if a program shares files with host applications while\n"
+	        "running.");
 }
 
 void DOS_AddConfigSection([[maybe_unused]] const ConfigPtr& conf)
@@ -241,6 +241,10 @@ bool DOS_UnlockFile(const uint16_t entry, const uint32_t pos, const uint32_t len
 void DOS_InitFileLocking(Section* sec);
 bool DOS_IsFileLocking();
 
+// Size of the read-ahead and write-behind buffer of files on mounted host
+// directories in bytes; 0 if the buffering is disabled
+size_t DOS_GetFileBufferSize();
+
 /* Helper Functions */
 bool DOS_MakeName(const char* const name, char* const fullname, uint8_t* drive);
 
@@ -39,6 +39,9 @@ std::array<std::shared_ptr<DOS_Drive>, DOS_DRIVES> Drives = {};
 enum class FileLockingConfig { Auto, On, Off };
 static FileLockingConfig emulate_file_locking = FileLockingConfig::Auto;
 
+// Set by "file_buffer_size" config, in bytes
+static size_t file_buffer_size = 16 * 1024;
+
 enum class FileSharingMode
 {
 	Compatibility,
@@ -761,6 +764,10 @@ bool DOS_FlushFile(uint16_t entry) {
 		return false;
 	};
 	LOG(LOG_DOSMISC,LOG_NORMAL)("FFlush used.");
+	if (!Files[handle]->Flush()) {
+		DOS_SetError(DOSERR_ACCESS_DENIED);
+		return false;
+	}
 	return true;
 }
 
@@ -1883,6 +1890,11 @@ void DOS_ClearDrivesAndFiles()
 	Drives.fill(nullptr);
 }
 
+size_t DOS_GetFileBufferSize()
+{
+	return file_buffer_size;
+}
+
 bool DOS_IsFileLocking()
 {
 	switch (emulate_file_locking) {
@@ -1910,4 +1922,8 @@ void DOS_Files_Init(SectionProp& section)
 		        "file_locking config set to invalid string");
 		emulate_file_locking = FileLockingConfig::Auto;
 	}
+
+	constexpr size_t BytesPerKb = 1024;
+	file_buffer_size = static_cast<size_t>(section.GetInt("file_buffer_size")) *
+	                   BytesPerKb;
 }
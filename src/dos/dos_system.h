@@ -8,6 +8,7 @@
 #include "dosbox.h"
 
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "utils/bit_view.h"
@@ -119,6 +120,9 @@ public:
 	virtual uint16_t	GetInformation(void)=0;
 	virtual bool IsOnReadOnlyMedium() const = 0;
 
+	// Commits any data buffered by the file to the host
+	virtual bool Flush() { return true; }
+
 	virtual void AddRef() { refCtr++; }
 	virtual Bits RemoveRef() { return --refCtr; }
 
@@ -202,6 +206,12 @@ public:
 	void SetLabel(const char *name, bool cdrom, bool allowupdate);
 	const char *GetLabel() const { return label; }
 
+	// Keeps the cached directories in sync with the files created and
+	// deleted on the host while the drive is mounted, without a full
+	// rescan. Only supported on Linux; elsewhere the cache is only
+	// refreshed by EmptyCache().
+	void SetWatchHost(bool enable);
+
 	class CFileInfo final {
 	public:
 		CFileInfo(void)
@@ -232,6 +242,14 @@ public:
 		unsigned    shortNr;
 		// contents
 		std::vector<CFileInfo*> fileList;
+
+		// Hashed lookup of the entries in fileList by short name and by
+		// host name; not maintained for the copies made by FindFirst
+		std::unordered_map<std::string, CFileInfo*> shortNameIndex = {};
+		std::unordered_map<std::string, CFileInfo*> longNameIndex  = {};
+
+		// Host watch of the directory, if it's being watched
+		int watchId = -1;
 	};
 
 private:
@@ -248,11 +266,16 @@ private:
 	CFileInfo*	FindDirInfo		(const char* path, char* expandedPath);
 	bool		RemoveSpaces		(char* str);
 	bool		OpenDir			(CFileInfo* dir, const char* path, uint16_t& id);
-	void		CreateEntry		(CFileInfo* dir, const char* name, bool is_directory);
+	size_t		CreateEntry		(CFileInfo* dir, const char* name, bool is_directory);
+	void		RemoveEntry		(CFileInfo* dir, const char* name);
 	void		CopyEntry		(CFileInfo* dir, CFileInfo* from);
 	uint16_t		GetFreeID		(CFileInfo* dir);
 	void		Clear			(void);
 
+	void		WatchDir		(CFileInfo* dir, const char* path);
+	void		UnwatchDir		(CFileInfo* dir);
+	void		ProcessHostChanges	(void);
+
 	CFileInfo*	dirBase;
 	char		dirPath				[CROSS_LEN];
 	char		basePath			[CROSS_LEN];
@@ -268,6 +291,10 @@ private:
 
 	char		label				[CROSS_LEN];
 	bool		updatelabel;
+
+	bool		watchHost			= false;
+	int		watchFd				= -1;
+	std::unordered_map<int, CFileInfo*> watchedDirs = {};
 };
 
 enum class DosDriveType : uint16_t {
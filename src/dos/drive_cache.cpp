@@ -9,6 +9,11 @@
 #include <numeric>
 #include <vector>
 
+#if defined(LINUX)
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
 #include "dos.h"
 #include "dos/drives.h"
 #include "misc/cross.h"
@@ -18,6 +23,24 @@
 
 int fileInfoCounter = 0;
 
+// Key of the host name index; host names are case-insensitive on Windows
+static std::string long_name_key(const char* name)
+{
+#if defined(WIN32)
+	std::string key = name;
+	lowcase(key);
+	return key;
+#else
+	return name;
+#endif
+}
+
+static bool has_lower_shortname(const DOS_Drive_Cache::CFileInfo* const info,
+                                const char* shortname)
+{
+	return strcmp(info->shortname, shortname) < 0;
+}
+
 bool SortByName(DOS_Drive_Cache::CFileInfo* const a,
                 DOS_Drive_Cache::CFileInfo* const b)
 {
@@ -87,6 +110,7 @@ DOS_Drive_Cache::~DOS_Drive_Cache(void) {
 		DeleteFileInfo(dirFindFirst[i]);
 		dirFindFirst[i] = nullptr;
 	}
+	SetWatchHost(false);
 }
 
 void DOS_Drive_Cache::Clear(void) {
@@ -171,6 +195,8 @@ char* DOS_Drive_Cache::GetExpandNameAndNormaliseCase(const char* path)
 	static char work [CROSS_LEN] = { 0 };
 	char dir [CROSS_LEN];
 
+	ProcessHostChanges();
+
 	work[0] = 0;
 	safe_strcpy (dir, path);
 
@@ -213,6 +239,8 @@ void DOS_Drive_Cache::AddEntry(const char* path, bool checkExists) {
 		if (checkExists) {
 			if (GetLongName(dir, file, sizeof(file))>=0) return;
 		}
+		// The host watcher might have added it already
+		if (dir->longNameIndex.contains(long_name_key(file))) return;
 
 		CreateEntry(dir,file,false);
 
@@ -352,6 +380,8 @@ void DOS_Drive_Cache::CacheOut(const char* path, bool ignoreLastDir) {
 	}
 	// clear lists
 	dir->fileList.clear();
+	dir->shortNameIndex.clear();
+	dir->longNameIndex.clear();
 	save_dir = nullptr;
 }
 
@@ -362,6 +392,8 @@ bool DOS_Drive_Cache::IsCachedIn(CFileInfo* curDir)
 
 
 bool DOS_Drive_Cache::GetShortName(const char* fullname, char* shortname) {
+	ProcessHostChanges();
+
 	// Get Dir Info
 	char expand[CROSS_LEN] = {0};
 	CFileInfo* curDir = FindDirInfo(fullname,expand);
@@ -372,23 +404,14 @@ bool DOS_Drive_Cache::GetShortName(const char* fullname, char* shortname) {
 	else
 		return false;
 
-	std::vector<CFileInfo*>::size_type filelist_size = curDir->fileList.size();
-	if (filelist_size <= 0) {
+	// The orgname part of the list is not sorted (shortname is), so look
+	// it up in the index
+	const auto it = curDir->longNameIndex.find(long_name_key(pos));
+	if (it == curDir->longNameIndex.end()) {
 		return false;
 	}
-
-	// The orgname part of the list is not sorted (shortname is)! So we can only walk through it.
-	for(Bitu i = 0; i < filelist_size; i++) {
-#if defined (WIN32)
-		if (strcasecmp(pos,curDir->fileList[i]->orgname) == 0) {
-#else
-		if (strcmp(pos,curDir->fileList[i]->orgname) == 0) {
-#endif
-			safe_strncpy(shortname, curDir->fileList[i]->shortname, DOS_NAMELENGTH_ASCII);
-			return true;
-		}
-	}
-	return false;
+	safe_strncpy(shortname, it->second->shortname, DOS_NAMELENGTH_ASCII);
+	return true;
 }
 
 int DOS_Drive_Cache::CompareShortname(const char* compareName, const char* shortName) {
@@ -472,19 +495,19 @@ Bits DOS_Drive_Cache::GetLongName(CFileInfo* curDir, char* shortName, const size
 
 	// Remove dot, if no extension...
 	RemoveTrailingDot(shortName);
-	// Search long name and return array number of element
-	Bits low	= 0;
-	auto high	= (Bits)(filelist_size-1);
-	Bits mid,res;
-	while (low<=high) {
-		mid = std::midpoint(low, high);
-		res = strcmp(shortName,curDir->fileList[mid]->shortname);
-		if (res>0)	low  = mid+1; else
-		if (res<0)	high = mid-1; else
-		{	// Found
-			safe_strncpy(shortName, curDir->fileList[mid]->orgname, shortName_len);
-			return mid;
-		};
+
+	// Search long name and return array number of element; the index
+	// answers most lookups of names that don't exist without a search
+	if (curDir->shortNameIndex.contains(shortName)) {
+		const auto it = std::lower_bound(curDir->fileList.begin(),
+		                                 curDir->fileList.end(),
+		                                 shortName,
+		                                 has_lower_shortname);
+		if (it != curDir->fileList.end() &&
+		    strcmp(shortName, (*it)->shortname) == 0) {
+			safe_strncpy(shortName, (*it)->orgname, shortName_len);
+			return std::distance(curDir->fileList.begin(), it);
+		}
 	}
 	// not available
 	const std::string host_name = dos_437_to_fs_utf8(shortName);
@@ -678,6 +701,8 @@ DOS_Drive_Cache::CFileInfo* DOS_Drive_Cache::FindDirInfo(const char* path, char*
 }
 
 bool DOS_Drive_Cache::OpenDir(const char* path, uint16_t& id) {
+	ProcessHostChanges();
+
 	char expand[CROSS_LEN] = {0};
 	CFileInfo* dir = FindDirInfo(path,expand);
 	if (OpenDir(dir,expand,id)) {
@@ -716,7 +741,7 @@ bool DOS_Drive_Cache::OpenDir(CFileInfo* dir, const char* expand, uint16_t& id)
 	return false;
 }
 
-void DOS_Drive_Cache::CreateEntry(CFileInfo* dir, const char* name, bool is_directory) {
+size_t DOS_Drive_Cache::CreateEntry(CFileInfo* dir, const char* name, bool is_directory) {
 	auto info = new CFileInfo;
 	safe_strcpy(info->orgname, name);
 	info->shortNr = 0;
@@ -725,30 +750,58 @@ void DOS_Drive_Cache::CreateEntry(CFileInfo* dir, const char* name, bool is_dire
 	// Check for long filenames...
 	CreateShortName(dir, info);		
 
-	bool found = false;
-
 	// keep list sorted (so GetLongName works correctly, used by CreateShortName in this routine)
-	if (!dir->fileList.empty()) {
-		if (!(strcmp(info->shortname,dir->fileList.back()->shortname)<0)) {
-			// append at end of list
-			dir->fileList.push_back(info);
-		} else {
-			// look for position where to insert this element
-			std::vector<CFileInfo*>::iterator it;
-			for (it=dir->fileList.begin(); it!=dir->fileList.end(); ++it) {
-				if (strcmp(info->shortname,(*it)->shortname)<0) {
-					found = true;
-					break;
-				}
-			}
-			// Put file in lists
-			if (found) dir->fileList.insert(it,info);
-			else dir->fileList.push_back(info);
+	auto it = dir->fileList.end();
+	if (!dir->fileList.empty() &&
+	    strcmp(info->shortname, dir->fileList.back()->shortname) < 0) {
+		// look for position where to insert this element
+		it = std::upper_bound(dir->fileList.begin(),
+		                      dir->fileList.end(),
+		                      info,
+		                      SortByName);
+	}
+	it = dir->fileList.insert(it, info);
+
+	dir->shortNameIndex.try_emplace(info->shortname, info);
+	dir->longNameIndex.try_emplace(long_name_key(info->orgname), info);
+
+	return static_cast<size_t>(std::distance(dir->fileList.begin(), it));
+}
+
+void DOS_Drive_Cache::RemoveEntry(CFileInfo* dir, const char* name)
+{
+	const auto index_it = dir->longNameIndex.find(long_name_key(name));
+	if (index_it == dir->longNameIndex.end()) {
+		return;
+	}
+	CFileInfo* info = index_it->second;
+	dir->longNameIndex.erase(index_it);
+
+	if (const auto it = dir->shortNameIndex.find(info->shortname);
+	    it != dir->shortNameIndex.end() && it->second == info) {
+		dir->shortNameIndex.erase(it);
+	}
+
+	auto it = std::lower_bound(dir->fileList.begin(),
+	                           dir->fileList.end(),
+	                           info->shortname,
+	                           has_lower_shortname);
+	while (it != dir->fileList.end() && *it != info) {
+		++it;
+	}
+	assert(it != dir->fileList.end());
+	const auto index = static_cast<Bitu>(std::distance(dir->fileList.begin(), it));
+	dir->fileList.erase(it);
+
+	// Check if there are any open search dir that are affected by this...
+	for (uint32_t i = 0; i < MAX_OPENDIRS; i++) {
+		if ((dirSearch[i] == dir) && (dirSearch[i]->nextEntry > index)) {
+			dirSearch[i]->nextEntry--;
 		}
-	} else {
-		// empty file list, append
-		dir->fileList.push_back(info);
 	}
+
+	DeleteFileInfo(info);
+	save_dir = nullptr;
 }
 
 void DOS_Drive_Cache::CopyEntry(CFileInfo* dir, CFileInfo* from) {
@@ -777,6 +830,9 @@ bool DOS_Drive_Cache::ReadDir(uint16_t id, char* &result) {
 			}
 			return false;
 		}
+
+		// Watch it before reading it, so no changes get lost in between
+		WatchDir(dirSearch[id], dirPath);
 		// Read complete directory
 		char dir_name[CROSS_LEN];
 		bool is_directory;
@@ -825,6 +881,8 @@ bool DOS_Drive_Cache::SetResult(CFileInfo* dir, char* &result, Bitu entryNr)
 
 // FindFirst / FindNext
 bool DOS_Drive_Cache::FindFirst(char* path, uint16_t& id) {
+	ProcessHostChanges();
+
 	uint16_t	dirID;
 	// Cache directory in 
 	if (!OpenDir(path,dirID)) return false;
@@ -901,6 +959,7 @@ void DOS_Drive_Cache::ClearFileInfo(CFileInfo *dir) {
 		dirSearch[dir->id] = nullptr;
 		dir->id = MAX_OPENDIRS;
 	}
+	UnwatchDir(dir);
 }
 
 void DOS_Drive_Cache::DeleteFileInfo(CFileInfo *dir) {
@@ -909,3 +968,132 @@ void DOS_Drive_Cache::DeleteFileInfo(CFileInfo *dir) {
 		delete dir;
 	}
 }
+
+void DOS_Drive_Cache::SetWatchHost(const bool enable)
+{
+	watchHost = enable;
+#if defined(LINUX)
+	if (enable && watchFd < 0) {
+		watchFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+		if (watchFd < 0) {
+			LOG_WARNING("DIRCACHE: Could not watch '%s' for changes: %s",
+			            basePath,
+			            strerror(errno));
+			watchHost = false;
+		}
+	} else if (!enable && watchFd >= 0) {
+		// Closing the descriptor removes all the watches
+		close(watchFd);
+		watchFd = -1;
+		for (const auto& [wd, dir] : watchedDirs) {
+			dir->watchId = -1;
+		}
+		watchedDirs.clear();
+	}
+#endif
+}
+
+void DOS_Drive_Cache::WatchDir([[maybe_unused]] CFileInfo* dir,
+                               [[maybe_unused]] const char* path)
+{
+#if defined(LINUX)
+	if (!watchHost || watchFd < 0 || dir->watchId >= 0) {
+		return;
+	}
+	constexpr uint32_t Mask = IN_CREATE | IN_DELETE | IN_MOVED_FROM |
+	                          IN_MOVED_TO | IN_ONLYDIR | IN_EXCL_UNLINK;
+
+	const auto wd = inotify_add_watch(watchFd, path, Mask);
+	if (wd < 0) {
+		LOG(LOG_DOSMISC, LOG_WARN)("DIRCACHE: Could not watch '%s': %s",
+		                           path,
+		                           strerror(errno));
+		return;
+	}
+	// Watching a directory twice through different paths (e.g. links)
+	// returns the same watch; the newest entry gets the updates
+	if (const auto it = watchedDirs.find(wd); it != watchedDirs.end()) {
+		it->second->watchId = -1;
+	}
+	dir->watchId    = wd;
+	watchedDirs[wd] = dir;
+#endif
+}
+
+void DOS_Drive_Cache::UnwatchDir([[maybe_unused]] CFileInfo* dir)
+{
+#if defined(LINUX)
+	if (dir->watchId < 0) {
+		return;
+	}
+	if (watchFd >= 0) {
+		inotify_rm_watch(watchFd, dir->watchId);
+	}
+	watchedDirs.erase(dir->watchId);
+	dir->watchId = -1;
+#endif
+}
+
+// Applies the changes made on the host to the cached directories since the
+// last call; only the entries of the affected files are updated.
+void DOS_Drive_Cache::ProcessHostChanges()
+{
+#if defined(LINUX)
+	if (watchFd < 0) {
+		return;
+	}
+
+	alignas(inotify_event) char buffer[16 * 1024];
+	bool lost_events = false;
+
+	while (true) {
+		const auto len = read(watchFd, buffer, sizeof(buffer));
+		if (len <= 0) {
+			break;
+		}
+		for (auto pos = buffer; pos < buffer + len;) {
+			const auto event = reinterpret_cast<const inotify_event*>(pos);
+			pos += sizeof(inotify_event) + event->len;
+
+			if (event->mask & IN_Q_OVERFLOW) {
+				lost_events = true;
+				continue;
+			}
+			const auto it = watchedDirs.find(event->wd);
+			if (it == watchedDirs.end() || event->len == 0) {
+				continue;
+			}
+			CFileInfo* dir = it->second;
+
+			// Directories not cached in yet get read in full when
+			// they're needed
+			if (!IsCachedIn(dir)) {
+				continue;
+			}
+
+			if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+				if (!dir->longNameIndex.contains(long_name_key(event->name))) {
+					const auto index = CreateEntry(dir,
+					                               event->name,
+					                               event->mask & IN_ISDIR);
+					for (uint32_t i = 0; i < MAX_OPENDIRS; i++) {
+						if ((dirSearch[i] == dir) &&
+						    (index <= dirSearch[i]->nextEntry)) {
+							dirSearch[i]->nextEntry++;
+						}
+					}
+					save_dir = nullptr;
+				}
+			} else if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+				RemoveEntry(dir, event->name);
+			}
+		}
+	}
+
+	if (lost_events) {
+		LOG(LOG_DOSMISC, LOG_NORMAL)("DIRCACHE: Too many changes on the host, rescanning '%s'",
+		                             basePath);
+		EmptyCache();
+	}
+#endif
+}
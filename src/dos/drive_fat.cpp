@@ -33,8 +33,14 @@ public:
 	bool Write(uint8_t * data,uint16_t * size) override;
 	bool Seek(uint32_t * pos,uint32_t type) override;
 	void Close() override;
+	bool Flush() override;
 	uint16_t GetInformation(void) override;
 	bool IsOnReadOnlyMedium() const override;
+
+private:
+	void WriteCurrentSector();
+	void FlushWrittenSectors();
+
 public:
 	std::shared_ptr<fatDrive> myDrive   = nullptr;
 	uint32_t firstCluster               = 0;
@@ -50,6 +56,9 @@ public:
 	bool set_archive_on_close   = false;
 	bool loadedSector           = false;
 	const bool read_only_medium = false;
+
+	// The sectors written since the last flush
+	std::vector<fatDrive::SectorRange> written_sectors = {};
 };
 
 /* IN - char * filename: Name in regular filename format, e.g. bob.txt */
@@ -215,7 +224,7 @@ bool fatFile::Write(uint8_t * data, uint16_t *size) {
 		sectorBuffer[curSectOff++] = data[sizecount++];
 		seekpos++;
 		if(curSectOff >= myDrive->getSectorSize()) {
-			if(loadedSector) myDrive->writeSector(currentSector, sectorBuffer);
+			if(loadedSector) WriteCurrentSector();
 
 			currentSector = myDrive->getAbsoluteSectFromBytePos(firstCluster, seekpos);
 			if(currentSector == 0) loadedSector = false;
@@ -227,7 +236,7 @@ bool fatFile::Write(uint8_t * data, uint16_t *size) {
 		}
 		--sizedec;
 	}
-	if(curSectOff>0 && loadedSector) myDrive->writeSector(currentSector, sectorBuffer);
+	if(curSectOff>0 && loadedSector) WriteCurrentSector();
 
 finalizeWrite:
 	myDrive->directoryBrowse(dirCluster, &tmpentry, dirIndex);
@@ -278,8 +287,9 @@ bool fatFile::Seek(uint32_t *pos, uint32_t type) {
 
 void fatFile::Close()
 {
-	if (flush_time_on_close == FlushTimeOnClose::ManuallySet ||
-	    set_archive_on_close) {
+	const auto is_modified = flush_time_on_close == FlushTimeOnClose::ManuallySet ||
+	                         set_archive_on_close;
+	if (is_modified) {
 		assert(!IsOnReadOnlyMedium());
 		direntry tmpentry;
 		myDrive->directoryBrowse(dirCluster, &tmpentry, dirIndex);
@@ -297,12 +307,62 @@ void fatFile::Close()
 
 	// Flush buffer
 	if (loadedSector) {
-		myDrive->writeSector(currentSector, sectorBuffer);
+		WriteCurrentSector();
+	}
+
+	if (is_modified || !written_sectors.empty()) {
+		FlushWrittenSectors();
 	}
 
 	set_archive_on_close = false;
 }
 
+bool fatFile::Flush()
+{
+	if (loadedSector) {
+		WriteCurrentSector();
+	}
+	if (set_archive_on_close || !written_sectors.empty()) {
+		FlushWrittenSectors();
+	}
+	return true;
+}
+
+void fatFile::WriteCurrentSector()
+{
+	myDrive->writeSector(currentSector, sectorBuffer);
+
+	// Files are mostly written sequentially, so the sectors are
+	// remembered as runs
+	if (!written_sectors.empty()) {
+		auto& last = written_sectors.back();
+		if (currentSector >= last.first &&
+		    currentSector <= last.first + last.count) {
+			if (currentSector == last.first + last.count) {
+				++last.count;
+			}
+			return;
+		}
+	}
+
+	// Write back the sectors of a file written all over the place early,
+	// rather than keeping track of them all
+	constexpr size_t MaxWrittenRanges = 64;
+	if (written_sectors.size() >= MaxWrittenRanges) {
+		FlushWrittenSectors();
+	}
+	written_sectors.push_back({currentSector, 1});
+}
+
+// Writes only this file's changes back to the image file, so closing a file
+// doesn't also write out whatever the other open files have left in the disk
+// cache
+void fatFile::FlushWrittenSectors()
+{
+	myDrive->flushFileSectors(written_sectors, dirCluster, dirIndex);
+	written_sectors.clear();
+}
+
 bool fatFile::IsOnReadOnlyMedium() const
 {
 	return read_only_medium;
@@ -317,6 +377,8 @@ uint32_t fatDrive::getClustFirstSect(uint32_t clustNum) {
 }
 
 uint32_t fatDrive::getClusterValue(uint32_t clustNum) {
+	SyncWithDisk();
+
 	uint32_t fatoffset=0;
 	uint32_t fatsectnum;
 	uint32_t fatentoff;
@@ -365,6 +427,9 @@ uint32_t fatDrive::getClusterValue(uint32_t clustNum) {
 }
 
 void fatDrive::setClusterValue(uint32_t clustNum, uint32_t clustValue) {
+	SyncWithDisk();
+	ClearChainCursors();
+
 	uint32_t fatoffset=0;
 	uint32_t fatsectnum;
 	uint32_t fatentoff;
@@ -577,15 +642,26 @@ uint8_t fatDrive::writeSector(uint32_t sectnum, void * data) {
 		return 0;
 	}
 
+	// Our own writes keep the chain cursors valid; the FAT itself is only
+	// changed through setClusterValue(), which clears them
+	const auto is_in_sync = (loadedDisk->GetWriteCount() == disk_write_count);
+
+	uint8_t result = 0;
 	if (absolute) {
-		return loadedDisk->Write_AbsoluteSector(sectnum, data);
+		result = loadedDisk->Write_AbsoluteSector(sectnum, data);
+	} else {
+		uint32_t cylindersize = bootbuffer.headcount * bootbuffer.sectorspertrack;
+		uint32_t cylinder = sectnum / cylindersize;
+		sectnum %= cylindersize;
+		uint32_t head = sectnum / bootbuffer.sectorspertrack;
+		uint32_t sector = sectnum % bootbuffer.sectorspertrack + 1L;
+		result = loadedDisk->Write_Sector(head, cylinder, sector, data);
 	}
-	uint32_t cylindersize = bootbuffer.headcount * bootbuffer.sectorspertrack;
-	uint32_t cylinder = sectnum / cylindersize;
-	sectnum %= cylindersize;
-	uint32_t head = sectnum / bootbuffer.sectorspertrack;
-	uint32_t sector = sectnum % bootbuffer.sectorspertrack + 1L;
-	return loadedDisk->Write_Sector(head, cylinder, sector, data);
+
+	if (is_in_sync) {
+		disk_write_count = loadedDisk->GetWriteCount();
+	}
+	return result;
 }
 
 uint32_t fatDrive::getSectorCount()
@@ -609,13 +685,103 @@ uint32_t fatDrive::getAbsoluteSectFromBytePos(uint32_t startClustNum, uint32_t b
 	return  getAbsoluteSectFromChain(startClustNum, bytePos / bootbuffer.bytespersector);
 }
 
+void fatDrive::ClearChainCursors()
+{
+	chain_cursors.fill({});
+}
+
+// Returns the sector of the image file that holds the given sector of the
+// drive, the same way as writeSector() addresses it
+uint32_t fatDrive::getImageSector(uint32_t sectnum) const
+{
+	if (absolute) {
+		return sectnum;
+	}
+	const uint32_t cylindersize = bootbuffer.headcount * bootbuffer.sectorspertrack;
+	const uint32_t cylinder = sectnum / cylindersize;
+	sectnum %= cylindersize;
+	const uint32_t head = sectnum / bootbuffer.sectorspertrack;
+	const uint32_t sector = sectnum % bootbuffer.sectorspertrack;
+	return (cylinder * loadedDisk->heads + head) * loadedDisk->sectors + sector;
+}
+
+void fatDrive::flushFileSectors(const std::vector<SectorRange>& file_sectors,
+                                const uint32_t dirClustNumber, const uint32_t entNum)
+{
+	if (!loadedDisk) {
+		return;
+	}
+
+	// The FAT copies, followed by the root directory on FAT12 and FAT16
+	const auto fat_start = bootbuffer.reservedsectors + partSectOff;
+	std::vector<SectorRange> ranges = {{fat_start, firstDataSector - fat_start}};
+
+	const auto logentsector = entNum / 16; // 16 directory entries per sector
+	if (dirClustNumber == 0) {
+		ranges.push_back({firstRootDirSect + logentsector, 1});
+	} else if (const auto sector = getAbsoluteSectFromChain(dirClustNumber, logentsector);
+	           sector != 0) {
+		ranges.push_back({sector, 1});
+	}
+	ranges.insert(ranges.end(), file_sectors.begin(), file_sectors.end());
+
+	// Pass on runs of consecutive image sectors
+	SectorRange run = {};
+	for (const auto& range : ranges) {
+		for (uint32_t i = 0; i < range.count; ++i) {
+			const auto sector = getImageSector(range.first + i);
+			if (run.count > 0 && sector == run.first + run.count) {
+				++run.count;
+				continue;
+			}
+			if (run.count > 0) {
+				loadedDisk->Flush(run.first, run.count);
+			}
+			run = {sector, 1};
+		}
+	}
+	if (run.count > 0) {
+		loadedDisk->Flush(run.first, run.count);
+	}
+}
+
+void fatDrive::SyncWithDisk()
+{
+	if (loadedDisk && loadedDisk->GetWriteCount() != disk_write_count) {
+		ClearChainCursors();
+		curFatSect       = NoFatSector;
+		disk_write_count = loadedDisk->GetWriteCount();
+	}
+}
+
 uint32_t fatDrive::getAbsoluteSectFromChain(uint32_t startClustNum, uint32_t logicalSector) {
-	int32_t skipClust = logicalSector / bootbuffer.sectorspercluster;
+	const uint32_t clusterIndex = logicalSector / bootbuffer.sectorspercluster;
+
+	int32_t skipClust = clusterIndex;
 	uint32_t sectClust = logicalSector % bootbuffer.sectorspercluster;
 
 	uint32_t currentClust = startClustNum;
 	uint32_t testvalue;
 
+	SyncWithDisk();
+
+	// Resume from the furthest cursor in the same chain that isn't past
+	// the wanted cluster
+	ChainCursor* cursor = nullptr;
+	for (auto& c : chain_cursors) {
+		if (c.start_cluster == startClustNum && c.cluster_index <= clusterIndex &&
+		    (!cursor || c.cluster_index > cursor->cluster_index)) {
+			cursor = &c;
+		}
+	}
+	if (cursor && cursor->cluster_index > 0) {
+		currentClust = cursor->cluster;
+		skipClust    = check_cast<int32_t>(clusterIndex - cursor->cluster_index);
+	}
+	if (skipClust == 0) {
+		return (getClustFirstSect(currentClust) + sectClust);
+	}
+
 	while(skipClust!=0) {
 		bool isEOF = false;
 		testvalue = getClusterValue(currentClust);
@@ -642,6 +808,12 @@ uint32_t fatDrive::getAbsoluteSectFromChain(uint32_t startClustNum, uint32_t log
 		--skipClust;
 	}
 
+	if (!cursor) {
+		cursor = &chain_cursors[next_chain_cursor];
+		next_chain_cursor = (next_chain_cursor + 1) % chain_cursors.size();
+	}
+	*cursor = {startClustNum, clusterIndex, currentClust};
+
 	return (getClustFirstSect(currentClust) + sectClust);
 }
 
@@ -766,7 +938,7 @@ constexpr uint16_t dta_pages()
 
 fatDrive::fatDrive(const char* sysFilename, uint32_t bytesector,
                    uint32_t cylsector, uint32_t headscyl, uint32_t cylinders,
-                   uint8_t mediaid, bool roflag)
+                   uint8_t mediaid, bool roflag, const std_fs::path& diff_path)
         : loadedDisk(nullptr),
           created_successfully(true),
           partSectOff(0),
@@ -780,7 +952,7 @@ fatDrive::fatDrive(const char* sysFilename, uint32_t bytesector,
           firstRootDirSect(0),
           cwdDirCluster(0),
           fatSectBuffer{0},
-          curFatSect(0)
+          curFatSect(NoFatSector)
 {
 	FILE *diskfile;
 	uint32_t filesize;
@@ -793,7 +965,12 @@ fatDrive::fatDrive(const char* sysFilename, uint32_t bytesector,
 		imgDTA    = new DOS_DTA(imgDTAPtr);
 	}
 	assert(sysFilename);
-	diskfile = fopen_wrap_ro_fallback(sysFilename, readonly);
+	if (diff_path.empty()) {
+		diskfile = fopen_wrap_ro_fallback(sysFilename, readonly);
+	} else {
+		// The image is shared, the changes go to the differencing image
+		diskfile = fopen(sysFilename, "rb");
+	}
 	created_successfully = (diskfile != nullptr);
 	if (!created_successfully)
 		return;
@@ -806,7 +983,16 @@ fatDrive::fatDrive(const char* sysFilename, uint32_t bytesector,
 	is_hdd   = (filesize > 2880);
 
 	/* Load disk image */
-	loadedDisk = std::make_shared<imageDisk>(diskfile, sysFilename, filesize, is_hdd);
+	loadedDisk = std::make_shared<imageDisk>(diskfile,
+	                                         sysFilename,
+	                                         filesize,
+	                                         is_hdd,
+	                                         readonly || !diff_path.empty());
+
+	if (!diff_path.empty() && !loadedDisk->AttachDifferencingImage(diff_path)) {
+		created_successfully = false;
+		return;
+	}
 
 	if(is_hdd) {
 		/* Set user specified harddrive parameters */
@@ -1016,7 +1202,7 @@ fatDrive::fatDrive(const char* sysFilename, uint32_t bytesector,
 	cwdDirCluster = 0;
 
 	memset(fatSectBuffer,0,1024);
-	curFatSect = 0xffffffff;
+	curFatSect = NoFatSector;
 
 	type = DosDriveType::Fat;
 	safe_strcpy(info, sysFilename);
@@ -8,6 +8,7 @@
 #include "dos/drives.h"
 #include "drive_local.h"
 
+#include <algorithm>
 #include <cerrno>
 #include <climits>
 #include <cstdio>
@@ -63,6 +64,11 @@ std::unique_ptr<DOS_File> localDrive::FileCreate(const char* name,
 
 	const bool file_exists = FileExists(expanded_name);
 
+	// Creating an existing file truncates it, so the buffered writes of
+	// its open handles must land first and their read-ahead data is stale
+	FlushPendingWrites();
+	MarkFileChanged(expanded_name);
+
 	attributes.archive = true;
 	NativeFileHandle file_handle = create_native_file(expanded_name, attributes);
 
@@ -227,6 +233,7 @@ std::unique_ptr<DOS_File> localDrive::FileOpen(const char* name, uint8_t flags)
 
 FILE* localDrive::GetHostFilePtr(const char* const name, const char* const type)
 {
+	FlushPendingWrites();
 	return fopen(MapDosToHostFilename(name).c_str(), type);
 }
 
@@ -243,6 +250,7 @@ std::string localDrive::MapDosToHostFilename(const char* const dos_name)
 bool localDrive::FileUnlink(const char* name)
 {
 	assert(!IsReadOnly());
+	FlushPendingWrites();
 
 	if (!FileExists(name)) {
 		LOG_DEBUG("FS: Skipping removal of '%s' because it doesn't exist",
@@ -340,6 +348,9 @@ bool localDrive::FindFirst(const char* _dir, DOS_DTA& dta, bool fcb_findfirst)
 
 bool localDrive::FindNext(DOS_DTA& dta)
 {
+	// The reported file sizes must include the buffered writes
+	FlushPendingWrites();
+
 	char* dir_ent;
 	char full_name[CROSS_LEN];
 	char dir_entcopy[CROSS_LEN];
@@ -415,6 +426,8 @@ bool localDrive::FindNext(DOS_DTA& dta)
 
 bool localDrive::GetFileAttr(const char* name, FatAttributeFlags* attr)
 {
+	FlushPendingWrites();
+
 	if (local_drive_get_attributes(MapDosToHostFilename(name).c_str(), *attr) != DOSERR_NONE) {
 		// The caller is responsible to act accordingly, possibly
 		// it should set DOS error code (setting it here is not allowed)
@@ -428,6 +441,7 @@ bool localDrive::GetFileAttr(const char* name, FatAttributeFlags* attr)
 bool localDrive::SetFileAttr(const char* name, const FatAttributeFlags attr)
 {
 	assert(!IsReadOnly());
+	FlushPendingWrites();
 	const std::string host_filename = MapDosToHostFilename(name);
 
 	const auto result = local_drive_set_attributes(host_filename.c_str(), attr);
@@ -492,6 +506,7 @@ bool localDrive::TestDir(const char* dir)
 bool localDrive::Rename(const char* oldname, const char* newname)
 {
 	assert(!IsReadOnly());
+	FlushPendingWrites();
 	const std::string old_host_filename = MapDosToHostFilename(oldname);
 
 	char newnew[CROSS_LEN];
@@ -558,9 +573,170 @@ localDrive::localDrive(const char* startdir, uint16_t _bytes_sector,
 	type = DosDriveType::Local;
 	safe_strcpy(basedir, startdir);
 	safe_strcpy(info, startdir);
+	dirCache.SetWatchHost(true);
 	dirCache.SetBaseDir(basedir);
 }
 
+std::shared_ptr<LocalFileShare> localDrive::GetFileShare(const std::string& host_filename)
+{
+	auto& entry = file_shares[host_filename];
+
+	auto share = entry.lock();
+	if (!share) {
+		share = std::make_shared<LocalFileShare>();
+		entry = share;
+	}
+	return share;
+}
+
+void localDrive::FlushPendingWrites()
+{
+	for (auto it = file_shares.begin(); it != file_shares.end();) {
+		const auto share = it->second.lock();
+		if (!share) {
+			// All the handles to the file have been closed
+			it = file_shares.erase(it);
+			continue;
+		}
+		if (share->pending_writer) {
+			share->pending_writer->Flush();
+		}
+		++it;
+	}
+}
+
+void localDrive::MarkFileChanged(const std::string& host_filename)
+{
+	const auto it = file_shares.find(host_filename);
+	if (it == file_shares.end()) {
+		return;
+	}
+	if (const auto share = it->second.lock(); share) {
+		++share->generation;
+	}
+}
+
+// Brings the buffer up to date with the writes done through the other
+// handles open to the same host file
+void localFile::SyncWithOtherHandles()
+{
+	if (!share) {
+		return;
+	}
+	if (share->pending_writer && share->pending_writer != this) {
+		share->pending_writer->Flush();
+	}
+	if (buffer_mode == BufferMode::Reading && buffer_generation != share->generation) {
+		Flush();
+	}
+}
+
+void localFile::MarkContentsChanged()
+{
+	if (share) {
+		++share->generation;
+	}
+}
+
+bool localFile::Flush()
+{
+	if (file_handle == InvalidNativeFileHandle) {
+		return true;
+	}
+
+	const auto mode = buffer_mode;
+	buffer_mode     = BufferMode::Empty;
+
+	switch (mode) {
+	case BufferMode::Empty: return true;
+
+	case BufferMode::Reading:
+		// Move the host file position back to where DOS left off
+		if (buffer_index != buffer_used) {
+			const auto pos = buffer_offset + static_cast<int64_t>(buffer_index);
+			if (seek_native_file(file_handle, pos, NativeSeek::Set) ==
+			    NativeSeekFailed) {
+				LOG_WARNING("FS: File seek failed for '%s'", path.c_str());
+				return false;
+			}
+		}
+		return true;
+
+	case BufferMode::Writing: {
+		if (share && share->pending_writer == this) {
+			share->pending_writer = nullptr;
+		}
+		const auto ret = write_native_file(file_handle,
+		                                   buffer.data(),
+		                                   static_cast<int64_t>(buffer_used));
+		if (ret.error || ret.num_bytes != static_cast<int64_t>(buffer_used)) {
+			LOG_WARNING("FS: Failed writing buffered data to '%s'",
+			            path.c_str());
+			return false;
+		}
+		return true;
+	}
+	}
+	return true;
+}
+
+bool localFile::ReadBuffered(uint8_t* data, uint16_t* num_bytes)
+{
+	const size_t requested = *num_bytes;
+	size_t num_read        = 0;
+
+	if (buffer_mode == BufferMode::Reading) {
+		num_read = std::min(requested, buffer_used - buffer_index);
+		std::memcpy(data, buffer.data() + buffer_index, num_read);
+		buffer_index += num_read;
+		if (num_read == requested) {
+			return true;
+		}
+		// The buffer has been drained, so the host file position is
+		// the DOS file position again
+		buffer_mode = BufferMode::Empty;
+	}
+
+	const auto remaining = requested - num_read;
+
+	// Reading large chunks through the buffer would only add a copy
+	if (remaining >= buffer_capacity) {
+		const auto ret = read_native_file(file_handle,
+		                                  data + num_read,
+		                                  static_cast<int64_t>(remaining));
+		*num_bytes = check_cast<uint16_t>(static_cast<int64_t>(num_read) +
+		                                  ret.num_bytes);
+		return !ret.error;
+	}
+
+	// Read ahead
+	if (buffer.size() < buffer_capacity) {
+		buffer.resize(buffer_capacity);
+	}
+	const auto pos = get_native_file_position(file_handle);
+	if (pos == NativeSeekFailed) {
+		*num_bytes = check_cast<uint16_t>(num_read);
+		return false;
+	}
+	const auto ret = read_native_file(file_handle,
+	                                  buffer.data(),
+	                                  static_cast<int64_t>(buffer_capacity));
+	if (ret.error) {
+		*num_bytes = check_cast<uint16_t>(num_read);
+		return false;
+	}
+
+	buffer_mode       = BufferMode::Reading;
+	buffer_offset     = pos;
+	buffer_used       = static_cast<size_t>(ret.num_bytes);
+	buffer_index      = std::min(remaining, buffer_used);
+	buffer_generation = share ? share->generation : 0;
+
+	std::memcpy(data + num_read, buffer.data(), buffer_index);
+	*num_bytes = check_cast<uint16_t>(num_read + buffer_index);
+	return true;
+}
+
 bool localFile::Read(uint8_t* data, uint16_t* num_bytes)
 {
 	assert(file_handle != InvalidNativeFileHandle);
@@ -580,9 +756,24 @@ bool localFile::Read(uint8_t* data, uint16_t* num_bytes)
 		                                   local_drive.lock()->GetMediaByte()));
 	}
 
-	const auto ret = read_native_file(file_handle, data, *num_bytes);
-	*num_bytes     = check_cast<uint16_t>(ret.num_bytes);
-	if (ret.error) {
+	SyncWithOtherHandles();
+
+	// Reading after writing needs the written data on the host first
+	if (buffer_mode == BufferMode::Writing && !Flush()) {
+		*num_bytes = 0;
+		DOS_SetError(DOSERR_ACCESS_DENIED);
+		return false;
+	}
+
+	bool success = false;
+	if (buffer_capacity > 0) {
+		success = ReadBuffered(data, num_bytes);
+	} else {
+		const auto ret = read_native_file(file_handle, data, *num_bytes);
+		*num_bytes     = check_cast<uint16_t>(ret.num_bytes);
+		success        = !ret.error;
+	}
+	if (!success) {
 		DOS_SetError(DOSERR_ACCESS_DENIED);
 		return false;
 	}
@@ -598,6 +789,45 @@ bool localFile::Read(uint8_t* data, uint16_t* num_bytes)
 	return true;
 }
 
+bool localFile::WriteDirect(const uint8_t* data, uint16_t* num_bytes)
+{
+	const auto ret = write_native_file(file_handle, data, *num_bytes);
+	*num_bytes     = check_cast<uint16_t>(ret.num_bytes);
+	MarkContentsChanged();
+	return !ret.error;
+}
+
+bool localFile::WriteBuffered(const uint8_t* data, const uint16_t num_bytes)
+{
+	// Only consecutive writes get coalesced, so the buffer always holds a
+	// single run of data
+	if (buffer_mode == BufferMode::Writing &&
+	    buffer_used + num_bytes > buffer_capacity && !Flush()) {
+		return false;
+	}
+	if (buffer_mode == BufferMode::Empty) {
+		const auto pos = get_native_file_position(file_handle);
+		if (pos == NativeSeekFailed) {
+			return false;
+		}
+		if (buffer.size() < buffer_capacity) {
+			buffer.resize(buffer_capacity);
+		}
+		buffer_mode   = BufferMode::Writing;
+		buffer_offset = pos;
+		buffer_used   = 0;
+	}
+
+	std::memcpy(buffer.data() + buffer_used, data, num_bytes);
+	buffer_used += num_bytes;
+
+	if (share) {
+		share->pending_writer = this;
+	}
+	MarkContentsChanged();
+	return true;
+}
+
 bool localFile::Write(uint8_t* data, uint16_t* num_bytes)
 {
 	assert(file_handle != InvalidNativeFileHandle);
@@ -612,12 +842,21 @@ bool localFile::Write(uint8_t* data, uint16_t* num_bytes)
 
 	set_archive_on_close = true;
 
+	SyncWithOtherHandles();
+
+	// Writes are never coalesced with the read-ahead data, so drop it
+	if (buffer_mode == BufferMode::Reading && !Flush()) {
+		DOS_SetError(DOSERR_ACCESS_DENIED);
+		return false;
+	}
+
 	// Truncate the file
 	if (*num_bytes == 0) {
-		if (!truncate_native_file(file_handle)) {
+		if (!Flush() || !truncate_native_file(file_handle)) {
 			LOG_DEBUG("FS: Failed truncating file '%s'", name.c_str());
 			return false;
 		}
+		MarkContentsChanged();
 		// Truncation succeeded if we made it here
 		return true;
 	}
@@ -633,9 +872,14 @@ bool localFile::Write(uint8_t* data, uint16_t* num_bytes)
 	}
 
 	// Otherwise we have some data to write
-	const auto ret = write_native_file(file_handle, data, *num_bytes);
-	*num_bytes     = check_cast<uint16_t>(ret.num_bytes);
-	if (ret.error) {
+	bool success = false;
+	if (*num_bytes < buffer_capacity) {
+		success = WriteBuffered(data, *num_bytes);
+	} else {
+		// Large writes go straight to the host, after the buffered data
+		success = Flush() && WriteDirect(data, num_bytes);
+	}
+	if (!success) {
 		DOS_SetError(DOSERR_ACCESS_DENIED);
 		return false;
 	}
@@ -647,6 +891,21 @@ bool localFile::Seek(uint32_t *pos_addr, uint32_t type)
 {
 	assert(file_handle != InvalidNativeFileHandle);
 
+	// The DOS file position, which is only the host file position when
+	// nothing is buffered
+	int64_t current_pos = 0;
+	switch (buffer_mode) {
+	case BufferMode::Empty:
+		current_pos = get_native_file_position(file_handle);
+		break;
+	case BufferMode::Reading:
+		current_pos = buffer_offset + static_cast<int64_t>(buffer_index);
+		break;
+	case BufferMode::Writing:
+		current_pos = buffer_offset + static_cast<int64_t>(buffer_used);
+		break;
+	}
+
 	// Tested this interrupt on MS-DOS 6.22
 	// The values for SEEK_CUR and SEEK_END can be negative
 	// But some games/programs depend on the wrapping behavior of a 32-bit integer
@@ -660,7 +919,6 @@ bool localFile::Seek(uint32_t *pos_addr, uint32_t type)
 			break;
 		}
 		case DOS_SEEK_CUR: {
-			const auto current_pos = get_native_file_position(file_handle);
 			if (current_pos == NativeSeekFailed) {
 				LOG_WARNING("FS: File seek failed for '%s'", path.c_str());
 				DOS_SetError(DOSERR_ACCESS_DENIED);
@@ -670,6 +928,13 @@ bool localFile::Seek(uint32_t *pos_addr, uint32_t type)
 			break;
 		}
 		case DOS_SEEK_END: {
+			// The file size must include the writes buffered by any
+			// of the handles
+			SyncWithOtherHandles();
+			if (!Flush()) {
+				DOS_SetError(DOSERR_ACCESS_DENIED);
+				return false;
+			}
 			const auto end_pos = seek_native_file(file_handle, 0, NativeSeek::End);
 			if (end_pos == NativeSeekFailed) {
 				LOG_WARNING("FS: File seek failed for '%s'", path.c_str());
@@ -687,6 +952,24 @@ bool localFile::Seek(uint32_t *pos_addr, uint32_t type)
 		}
 	}
 
+	// Seeking within the read-ahead data or to the current position keeps
+	// the buffer, as programs often seek back and forth between records
+	const auto end_of_buffer = buffer_offset + static_cast<int64_t>(buffer_used);
+	if (buffer_mode == BufferMode::Reading && seek_to >= buffer_offset &&
+	    seek_to <= end_of_buffer) {
+		buffer_index = static_cast<size_t>(seek_to - buffer_offset);
+		*pos_addr    = seek_to;
+		return true;
+	}
+	if (buffer_mode == BufferMode::Writing && seek_to == end_of_buffer) {
+		*pos_addr = seek_to;
+		return true;
+	}
+	if (!Flush()) {
+		DOS_SetError(DOSERR_ACCESS_DENIED);
+		return false;
+	}
+
 	// Always use NativeSeek::Set set since we calculate the absolute value above
 	auto returned_pos = seek_native_file(file_handle, seek_to, NativeSeek::Set);
 
@@ -743,6 +1026,10 @@ void localFile::Close()
 {
 	assert(file_handle != InvalidNativeFileHandle);
 
+	// Closing any of the duplicated handles commits the buffered data,
+	// like on DOS
+	Flush();
+
 	// only close if one reference left
 	if (refCtr == 1) {
 		if (set_archive_on_close) {
@@ -793,6 +1080,11 @@ localFile::localFile(const char* _name, const char* path,
 	attr = FatAttributeFlags::Archive;
 
 	SetName(_name);
+
+	buffer_capacity = DOS_GetFileBufferSize();
+	if (const auto drive_ptr = local_drive.lock(); drive_ptr) {
+		share = drive_ptr->GetFileShare(path);
+	}
 }
 
 localFile::~localFile()
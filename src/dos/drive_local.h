@@ -5,6 +5,11 @@
 #ifndef DOSBOX_DRIVE_LOCAL_H
 #define DOSBOX_DRIVE_LOCAL_H
 
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "dos/dos_system.h"
 #include "dos/drives.h"
 
@@ -23,6 +28,7 @@ public:
 	void Close() override;
 	uint16_t GetInformation() override;
 	bool IsOnReadOnlyMedium() const override { return read_only_medium; }
+	bool Flush() override;
 	const char* GetBaseDir() const
 	{
 		return basedir;
@@ -36,11 +42,44 @@ public:
 
 private:
 	void MaybeFlushTime();
+	void SyncWithOtherHandles();
+	bool ReadBuffered(uint8_t* data, uint16_t* num_bytes);
+	bool WriteBuffered(const uint8_t* data, uint16_t num_bytes);
+	bool WriteDirect(const uint8_t* data, uint16_t* num_bytes);
+	void MarkContentsChanged();
+
 	const std::string path = {};
 	const char* basedir     = nullptr;
 
 	const bool read_only_medium = false;
 	bool set_archive_on_close   = false;
+
+	// Read-ahead and write-behind buffer
+	// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+	// DOS programs tend to read and write files in small chunks, often a
+	// record or a few bytes at a time, and each of them would be a host
+	// system call. The buffer turns them into fewer, larger host reads and
+	// writes. It holds either read-ahead data or coalesced writes:
+	//
+	//  - Empty:   the host file position is the DOS file position
+	//  - Reading: the host file position is at the end of the buffered data,
+	//             and the DOS file position is 'buffer_index' into it
+	//  - Writing: the host file position is at the start of the buffered
+	//             data, and the DOS file position is at the end of it
+	//
+	enum class BufferMode { Empty, Reading, Writing };
+
+	std::vector<uint8_t> buffer = {};
+	size_t buffer_capacity      = 0; // 0 if the buffering is disabled
+	BufferMode buffer_mode      = BufferMode::Empty;
+	int64_t buffer_offset       = 0; // host file position of the first byte
+	size_t buffer_used          = 0;
+	size_t buffer_index         = 0;
+
+	// The shared generation at the time the read-ahead data was read
+	uint32_t buffer_generation = 0;
+
+	std::shared_ptr<LocalFileShare> share = {};
 };
 
 #endif // DOSBOX_DRIVE_LOCAL_H
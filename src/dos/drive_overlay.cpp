@@ -210,6 +210,10 @@ public:
 	{
 		refCtr = file->refCtr;
 
+		// The buffered data must be on the host before the handle
+		// changes hands
+		file->Flush();
+
 		// We are taking ownership of the file handle.
 		// Set this to invalid so localFile's destructor won't close it.
 		file->file_handle = InvalidNativeFileHandle;
@@ -223,6 +227,8 @@ public:
 			if (*data == 0) {
 				if (logoverlay) LOG_MSG("OPTIMISE: truncate on switch!!!!");
 			}
+			// The copy is made from the host file
+			if (!Flush()) return false;
 			const auto a = logoverlay ? GetTicks() : 0;
 			bool r = create_copy();
 			const auto b = logoverlay ? GetTicksSince(a) : 0;
@@ -370,6 +376,10 @@ Overlay_Drive::Overlay_Drive(const char *startdir,
           DOSdirs_cache{},
           special_prefix("DBOVERLAY")
 {
+	// The overlay keeps its own bookkeeping of the files in both
+	// directories, so host changes are only picked up on a rescan
+	dirCache.SetWatchHost(false);
+
 	//Currently this flag does nothing, as the current behavior is to not reread due to caching everything.
 #if defined (WIN32)	
 	if (strcasecmp(startdir,overlay) == 0) {
@@ -872,6 +882,7 @@ void Overlay_Drive::update_cache(bool read_directory_contents) {
 }
 
 bool Overlay_Drive::FindNext(DOS_DTA & dta) {
+	FlushPendingWrites();
 
 	char * dir_ent;
 	struct stat stat_block;
@@ -985,6 +996,7 @@ again:
 
 
 bool Overlay_Drive::FileUnlink(const char * name) {
+	FlushPendingWrites();
 	// TODO check the basedir for file existence in order if we need to add the file to deleted file list.
 	const auto a = logoverlay ? GetTicks() : 0;
 	if (logoverlay)
@@ -1257,6 +1269,8 @@ bool Overlay_Drive::Rename(const char * oldname, const char * newname) {
 	//if oldname is on base => copy file to overlay with new name and mark old file as deleted. 
 	//More advanced version. keep track of the file being renamed in order to detect that the file is being renamed back.
 
+	FlushPendingWrites();
+
 	FatAttributeFlags attr = {};
 	if (!GetFileAttr(oldname, &attr)) {
 		E_Exit("rename, but source doesn't exist, should not happen %s",
@@ -7,6 +7,7 @@
 
 #include "dosbox.h"
 
+#include <array>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -16,6 +17,7 @@
 #include "config/setup.h"
 #include "dos/dos.h"
 #include "dos/dos_system.h"
+#include "misc/std_filesystem.h"
 
 // GCC throws a warning about non-virtual destructor for std::enable_shared_from_this
 // This is normally a helpful warning. Ex: If DOS_Drive had a non-virtual destructor, it would be a problem.
@@ -63,6 +65,18 @@ private:
 	static drive_infos_t drive_infos;
 };
 
+class localFile;
+
+// State shared by all the handles open to the same host file, so the
+// buffered handles can keep a coherent view of the file contents
+struct LocalFileShare {
+	// Incremented whenever the contents change through any of the handles
+	uint32_t generation = 0;
+
+	// The handle holding buffered writes not yet written to the host
+	localFile* pending_writer = nullptr;
+};
+
 // Must be constructed with a shared_ptr as it uses weak_from_this()
 class localDrive : public DOS_Drive,
                    public std::enable_shared_from_this<localDrive> {
@@ -101,6 +115,17 @@ public:
 
 	std::unordered_map<std::string, DosDateTime> timestamp_cache = {};
 
+	// Returns the state shared by the handles open to the host file
+	std::shared_ptr<LocalFileShare> GetFileShare(const std::string& host_filename);
+
+	// Writes the buffered data of all open handles to the host, so
+	// operations bypassing the handles see the up-to-date files
+	void FlushPendingWrites();
+
+	// Invalidates the read-ahead data of the open handles to a host file
+	// changed by other means than the handles
+	void MarkFileChanged(const std::string& host_filename);
+
 protected:
 	char basedir[CROSS_LEN] = "";
 	struct {
@@ -114,6 +139,7 @@ private:
 	const bool readonly;
 	const bool always_open_ro_files;
 	std::unordered_set<std::string> write_protected_files;
+	std::unordered_map<std::string, std::weak_ptr<LocalFileShare>> file_shares = {};
 	struct {
 		uint16_t bytes_sector;
 		uint8_t sectors_cluster;
@@ -183,9 +209,11 @@ struct partTable {
 // Must be constructed with a shared_ptr or it will throw an exception on internal call to shared_from_this()
 class fatDrive final : public DOS_Drive, public std::enable_shared_from_this<fatDrive> {
 public:
+	// If 'diff_path' is set, the image is opened read-only and the changes
+	// are written to the differencing image at that path instead
 	fatDrive(const char* sysFilename, uint32_t bytesector,
 	         uint32_t cylsector, uint32_t headscyl, uint32_t cylinders,
-	         uint8_t mediaid, bool roflag);
+	         uint8_t mediaid, bool roflag, const std_fs::path& diff_path = {});
 	fatDrive(const fatDrive&)            = delete; // prevent copying
 	fatDrive& operator=(const fatDrive&) = delete; // prevent assignment
 	std::unique_ptr<DOS_File> FileOpen(const char* name, uint8_t flags) override;
@@ -219,6 +247,19 @@ public:
 	uint32_t getSectorSize(void);
 	uint32_t getClusterSize(void);
 	uint32_t getAbsoluteSectFromChain(uint32_t startClustNum, uint32_t logicalSector);
+
+	// A run of consecutive sectors
+	struct SectorRange {
+		uint32_t first = 0;
+		uint32_t count = 0;
+	};
+
+	// Writes the given sectors of a file, the FAT, and the file's
+	// directory entry back to the image file, if the disk cache holds
+	// modified copies of them
+	void flushFileSectors(const std::vector<SectorRange>& file_sectors,
+	                      uint32_t dirClustNumber, uint32_t entNum);
+
 	bool allocateCluster(uint32_t useCluster, uint32_t prevCluster);
 	uint32_t appendCluster(uint32_t startCluster);
 	void deleteClustChain(uint32_t startCluster, uint32_t bytePos);
@@ -255,6 +296,29 @@ private:
 
 	uint8_t fatSectBuffer[1024];
 	uint32_t curFatSect;
+
+	// 'curFatSect' value when 'fatSectBuffer' holds no FAT sector
+	static constexpr uint32_t NoFatSector = 0xffffffff;
+
+	// Recently walked positions in cluster chains, so reading a file
+	// sequentially doesn't walk its chain from the start for every sector
+	struct ChainCursor {
+		uint32_t start_cluster = 0;
+		uint32_t cluster_index = 0;
+		uint32_t cluster       = 0;
+	};
+	std::array<ChainCursor, 8> chain_cursors = {};
+	size_t next_chain_cursor                 = 0;
+
+	// Write count of the disk the cursors and the FAT sector buffer are
+	// valid for; writes that don't go through this drive (e.g. INT 13h, or
+	// discarding a differencing image) might change the chains
+	uint32_t disk_write_count = 0;
+
+	void ClearChainCursors();
+	void SyncWithDisk();
+
+	uint32_t getImageSector(uint32_t sectnum) const;
 };
 
 class cdromDrive final : public localDrive
@@ -25,7 +25,7 @@
 #include "utils/string_utils.h"
 
 FILE* BOOT::getFSFile_mounted(const char* filename, uint32_t* ksize,
-                              uint32_t* bsize, uint8_t* error)
+                              uint32_t* bsize, bool* is_read_only, uint8_t* error)
 {
 	// if return NULL then put in error the errormessage code if an error
 	// was requested
@@ -61,11 +61,14 @@ FILE* BOOT::getFSFile_mounted(const char* filename, uint32_t* ksize,
 		*bsize = ftell(tmpfile);
 		fclose(tmpfile);
 
+		*is_read_only = false;
+
 		tmpfile = ldp->GetHostFilePtr(fullname, "rb+");
 		if (tmpfile == nullptr) {
 			//				if (!tryload) *error=2;
 			//				return NULL;
 			WriteOut(MSG_Get("PROGRAM_BOOT_WRITE_PROTECTED"));
+			*is_read_only = true;
 			tmpfile = ldp->GetHostFilePtr(fullname, "rb");
 			if (tmpfile == nullptr) {
 				if (!tryload)
@@ -81,15 +84,16 @@ FILE* BOOT::getFSFile_mounted(const char* filename, uint32_t* ksize,
 }
 
 FILE* BOOT::getFSFile(const char* filename, uint32_t* ksize, uint32_t* bsize,
-                      bool tryload)
+                      bool* is_read_only, bool tryload)
 {
 	uint8_t error = tryload ? 1 : 0;
-	FILE *tmpfile = getFSFile_mounted(filename, ksize, bsize, &error);
+	FILE *tmpfile = getFSFile_mounted(filename, ksize, bsize, is_read_only, &error);
 	if (tmpfile)
 		return tmpfile;
 	// File not found on mounted filesystem. Try regular filesystem
 	const auto filename_s = resolve_home(filename).string();
 	tmpfile = fopen(filename_s.c_str(), "rb+");
+	*is_read_only = false;
 
 	// Used for logging in check_fseek()
 	constexpr auto ModuleName = "BOOT";
@@ -102,6 +106,7 @@ FILE* BOOT::getFSFile(const char* filename, uint32_t* ksize, uint32_t* bsize,
 			//				fclose(tmpfile);
 			//				if (tryload) error = 2;
 			WriteOut(MSG_Get("PROGRAM_BOOT_WRITE_PROTECTED"));
+			*is_read_only = true;
 			if (!check_fseek(ModuleName, FileDescription, filename, tmpfile, 0L, SEEK_END)) {
 				return nullptr;
 			}
@@ -243,11 +248,16 @@ void BOOT::Run(void)
 			WriteOut(MSG_Get("PROGRAM_BOOT_IMAGE_OPEN"),
 			         temp_line.c_str());
 			uint32_t rombytesize;
+			bool is_read_only = false;
 			FILE *usefile = getFSFile(temp_line.c_str(),
-			                          &floppysize, &rombytesize);
+			                          &floppysize, &rombytesize,
+			                          &is_read_only);
 			if (usefile != nullptr) {
-				diskSwap[i] = std::make_shared<imageDisk>(
-				        usefile, temp_line.c_str(), floppysize, false);
+				diskSwap[i] = std::make_shared<imageDisk>(usefile,
+				                                          temp_line.c_str(),
+				                                          floppysize,
+				                                          false,
+				                                          is_read_only);
 				if (usefile_1 == nullptr) {
 					usefile_1 = usefile;
 					rombytesize_1 = rombytesize;
@@ -382,8 +392,9 @@ void BOOT::Run(void)
 				return;
 
 			uint32_t sz1, sz2;
+			bool is_read_only = false;
 			constexpr auto rom_filename = "system.rom";
-			FILE* tfile = getFSFile(rom_filename, &sz1, &sz2, true);
+			FILE* tfile = getFSFile(rom_filename, &sz1, &sz2, &is_read_only, true);
 			if (tfile != nullptr) {
 				if (!check_fseek("BOOT", "system ROM", rom_filename, tfile, 0x3000L, SEEK_SET)) {
 					return;
@@ -23,11 +23,13 @@ public:
 private:
 	static void AddMessages();
 
+	// The files are opened for writing if possible; 'is_read_only' is set
+	// to tell whether they could only be opened for reading
 	FILE* getFSFile_mounted(const char* filename, uint32_t* ksize,
-	                        uint32_t* bsize, uint8_t* error);
+	                        uint32_t* bsize, bool* is_read_only, uint8_t* error);
 
 	FILE* getFSFile(const char* filename, uint32_t* ksize, uint32_t* bsize,
-	                bool tryload = false);
+	                bool* is_read_only, bool tryload = false);
 
 	void printError();
 
@@ -3,6 +3,7 @@
 
 #include "mixer.h"
 
+#include <algorithm>
 #include <cctype>
 #include <optional>
 
@@ -755,6 +756,10 @@ void MIXER::Run()
 		output.Display();
 		return;
 	}
+	if (cmd->FindExist("/TIMING")) {
+		ShowRenderTimes();
+		return;
+	}
 
 	constexpr auto remove = true;
 
@@ -795,6 +800,7 @@ void MIXER::AddMessages()
 	        "Usage:\n"
 	        "  [color=light-green]mixer[reset] [color=light-cyan][CHANNEL][reset] [color=white]COMMANDS[reset] [/noshow]\n"
 	        "  [color=light-green]mixer[reset] [/listmidi]\n"
+	        "  [color=light-green]mixer[reset] [/timing]\n"
 	        "\n"
 	        "Parameters:\n"
 	        "  [color=light-cyan]CHANNEL[reset]   mixer channel to change the settings of\n"
@@ -810,6 +816,8 @@ void MIXER::AddMessages()
 	        "Notes:\n"
 	        "  - Run [color=light-green]mixer[reset] without arguments to view the current settings.\n"
 	        "  - Run [color=light-green]mixer[reset] /listmidi to list all available MIDI devices.\n"
+	        "  - Run [color=light-green]mixer[reset] /timing to show how long each channel took to render,\n"
+	        "    and how full its frame buffer got.\n"
 	        "  - You may change the settings of more than one channel in a single command.\n"
 	        "  - If no channel is specified, you can set crossfeed, reverb, or chorus\n"
 	        "    of all channels globally.\n"
@@ -825,6 +833,11 @@ void MIXER::AddMessages()
 	MSG_Add("SHELL_CMD_MIXER_HEADER_LABELS",
 	        "[color=white]Channel      Volume    Volume (dB)   Mode     Xfeed  Reverb  Chorus[reset]");
 
+	MSG_Add("SHELL_CMD_MIXER_TIMING_LAYOUT", "%-22s %8s %10s %10s %7.1f%% %9s %9s");
+
+	MSG_Add("SHELL_CMD_MIXER_TIMING_LABELS",
+	        "[color=white]Channel          Mixes   Avg (us)  Peak (us)     Load  Peak buf  Overruns[reset]");
+
 	MSG_Add("SHELL_CMD_MIXER_CHANNEL_OFF", "off");
 	MSG_Add("SHELL_CMD_MIXER_CHANNEL_STEREO", "Stereo");
 	MSG_Add("SHELL_CMD_MIXER_CHANNEL_REVERSE", "Reverse");
@@ -991,3 +1004,68 @@ void MIXER::ShowMixerStatus()
 
 	WriteOut("\n");
 }
+
+void MIXER::ShowRenderTimes()
+{
+	std::string column_layout = MSG_Get("SHELL_CMD_MIXER_TIMING_LAYOUT");
+	column_layout.append({'\n'});
+
+	WriteOut(MSG_Get("SHELL_CMD_MIXER_TIMING_LABELS"));
+	WriteOut("\n");
+
+	struct ChannelTimes {
+		std::string name                      = {};
+		MixerChannel::RenderTimes times       = {};
+		MixerChannel::FrameBufferStats buffer = {};
+	};
+	std::vector<ChannelTimes> channels = {};
+
+	for (auto& [name, chan] : MIXER_GetChannels()) {
+		channels.push_back(
+		        {name, chan->GetRenderTimes(), chan->GetFrameBufferStats()});
+	}
+
+	// Show the most expensive channels first
+	std::stable_sort(channels.begin(),
+	                 channels.end(),
+	                 [](const auto& a, const auto& b) {
+		                 return a.times.total_us > b.times.total_us;
+	                 });
+
+	const auto sample_rate_hz = static_cast<double>(MIXER_GetSampleRate());
+
+	for (const auto& [name, times, buffer] : channels) {
+		constexpr auto none_value = "-";
+
+		std::string avg_us  = none_value;
+		std::string peak_us = none_value;
+		auto load_percent   = 0.0;
+
+		if (times.num_mixes > 0) {
+			avg_us  = std::to_string(times.total_us / times.num_mixes);
+			peak_us = std::to_string(times.peak_us);
+
+			// The render time relative to the duration of the
+			// rendered audio
+			const auto audio_us = static_cast<double>(times.frames) *
+			                      1'000'000.0 / sample_rate_hz;
+
+			load_percent = static_cast<double>(times.total_us) * 100.0 /
+			               audio_us;
+		}
+
+		auto channel_name = std::string("[color=light-cyan]") + name +
+		                    std::string("[reset]");
+
+		WriteOut(column_layout,
+		         convert_ansi_markup(channel_name).c_str(),
+		         std::to_string(times.num_mixes).c_str(),
+		         avg_us.c_str(),
+		         peak_us.c_str(),
+		         load_percent,
+		         std::to_string(buffer.peak_occupancy).c_str(),
+		         std::to_string(buffer.overrun_frames).c_str());
+	}
+
+	WriteOut("\n");
+}
@@ -135,6 +135,7 @@ public:
 
 private:
 	void ShowMixerStatus();
+	void ShowRenderTimes();
 
 	static void AddMessages();
 };
@@ -8,6 +8,7 @@
 #include "dosbox.h"
 
 #include <algorithm>
+#include <system_error>
 #include <vector>
 
 #include "config/config.h"
@@ -235,8 +236,13 @@ bool MOUNT::MountImageFat(MountParameters& params)
 	                      params.sizes[2] == 0 && params.sizes[3] == 0);
 
 	if (imgsizedetect) {
+		// The image itself is never written with a differencing image
+		bool diff_readonly  = true;
+		auto& open_readonly = params.diff_path.empty() ? params.roflag
+		                                               : diff_readonly;
+
 		FILE* diskfile = fopen_wrap_ro_fallback(params.paths[0],
-		                                        params.roflag);
+		                                        open_readonly);
 		if (!diskfile) {
 			NOTIFY_DisplayWarning(Notification::Source::Console,
 			                      "MOUNT",
@@ -311,7 +317,8 @@ bool MOUNT::MountImageFat(MountParameters& params)
 		                                            params.sizes[2],
 		                                            params.sizes[3],
 		                                            params.mediaid,
-		                                            params.roflag);
+		                                            params.roflag,
+		                                            params.diff_path);
 		if (fat_image->created_successfully) {
 			fat_images.push_back(fat_image);
 
@@ -469,7 +476,10 @@ bool MOUNT::MountImageIso(MountParameters& params)
 
 bool MOUNT::MountImageRaw(MountParameters& params)
 {
-	auto new_disk = fopen_wrap_ro_fallback(params.paths[0], params.roflag);
+	// The image itself is never written with a differencing image
+	auto new_disk = params.diff_path.empty()
+	                      ? fopen_wrap_ro_fallback(params.paths[0], params.roflag)
+	                      : fopen(params.paths[0].c_str(), "rb");
 	if (!new_disk) {
 		NOTIFY_DisplayWarning(Notification::Source::Console,
 		                      "MOUNT",
@@ -506,8 +516,24 @@ bool MOUNT::MountImageRaw(MountParameters& params)
 
 	const auto drv_idx = params.drive - '0';
 
-	imageDiskList.at(drv_idx) = std::make_shared<imageDisk>(
-	        new_disk, params.paths[0].c_str(), imagesize, is_hdd);
+	// Only the differencing image gets written if there's one
+	const auto is_read_only = params.roflag || !params.diff_path.empty();
+
+	auto disk = std::make_shared<imageDisk>(new_disk,
+	                                        params.paths[0].c_str(),
+	                                        imagesize,
+	                                        is_hdd,
+	                                        is_read_only);
+
+	if (!params.diff_path.empty() &&
+	    !disk->AttachDifferencingImage(params.diff_path)) {
+		NOTIFY_DisplayWarning(Notification::Source::Console,
+		                      "MOUNT",
+		                      "PROGRAM_IMGMOUNT_INVALID_DIFF_IMAGE");
+		return false;
+	}
+
+	imageDiskList.at(drv_idx) = std::move(disk);
 
 	if (is_hdd) {
 		imageDiskList.at(drv_idx)->Set_Geometry(params.sizes[2],
@@ -533,6 +559,15 @@ bool MOUNT::MountImage(MountParameters& params)
 	params.mediaid = (params.type == "floppy") ? MediaId::Floppy1_44MB
 	                                           : MediaId::HardDisk;
 
+	// A differencing image holds the changes of a single disk image
+	if (!params.diff_path.empty() &&
+	    (params.fstype == "iso" || params.paths.size() != 1)) {
+		NOTIFY_DisplayWarning(Notification::Source::Console,
+		                      "MOUNT",
+		                      "PROGRAM_IMGMOUNT_DIFF_SINGLE_IMAGE");
+		return false;
+	}
+
 	if (params.fstype == "fat") {
 		return MountImageFat(params);
 
@@ -569,6 +604,102 @@ bool MOUNT::HandleUnmount()
 	return false;
 }
 
+// Returns the disk image mounted at the given drive letter or BIOS drive
+// number, if any
+static std::shared_ptr<imageDisk> get_image_disk(const char drive)
+{
+	if (drive >= '0' && drive <= '3') {
+		return imageDiskList.at(drive - '0');
+	}
+	if (drive >= 'A' && drive <= 'Z') {
+		const auto fat_drive = std::dynamic_pointer_cast<fatDrive>(
+		        Drives.at(drive_index(drive)));
+		if (fat_drive) {
+			return fat_drive->loadedDisk;
+		}
+	}
+	return nullptr;
+}
+
+// Returns whether the image file of the disk is mounted as another disk as
+// well. Committing the changes rewrites the image file, so the other disk's
+// contents would change underneath it.
+static bool is_image_mounted_elsewhere(const std::shared_ptr<imageDisk>& disk)
+{
+	const auto is_other_disk_of_image = [&](const std::shared_ptr<imageDisk>& other) {
+		if (!other || other == disk) {
+			return false;
+		}
+		std::error_code ec = {};
+		return std_fs::equivalent(other->diskname, disk->diskname, ec);
+	};
+
+	if (std::any_of(imageDiskList.begin(), imageDiskList.end(), is_other_disk_of_image) ||
+	    std::any_of(diskSwap.begin(), diskSwap.end(), is_other_disk_of_image)) {
+		return true;
+	}
+	for (const auto& drive : Drives) {
+		const auto fat_drive = std::dynamic_pointer_cast<fatDrive>(drive);
+		if (fat_drive && is_other_disk_of_image(fat_drive->loadedDisk)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool MOUNT::HandleDifferencingImage()
+{
+	std::string drive_arg = {};
+
+	const auto commit = cmd->FindString("-commit", drive_arg, false);
+	if (!commit && !cmd->FindString("-discard", drive_arg, false)) {
+		return false;
+	}
+	if (drive_arg.empty()) {
+		ShowUsage();
+		return true;
+	}
+
+	const auto drive = static_cast<char>(toupper(drive_arg[0]));
+	const auto disk  = get_image_disk(drive);
+
+	if (!disk || !disk->HasDifferencingImage()) {
+		NOTIFY_DisplayWarning(Notification::Source::Console,
+		                      "MOUNT",
+		                      "PROGRAM_MOUNT_NO_DIFF_IMAGE",
+		                      drive);
+		return true;
+	}
+
+	if (commit) {
+		if (is_image_mounted_elsewhere(disk)) {
+			NOTIFY_DisplayWarning(Notification::Source::Console,
+			                      "MOUNT",
+			                      "PROGRAM_MOUNT_DIFF_IMAGE_IN_USE",
+			                      drive);
+			return true;
+		}
+		if (disk->CommitDifferencingImage()) {
+			WriteOut(MSG_Get("PROGRAM_MOUNT_DIFF_IMAGE_COMMITTED"), drive);
+		} else {
+			NOTIFY_DisplayWarning(Notification::Source::Console,
+			                      "MOUNT",
+			                      "PROGRAM_MOUNT_DIFF_IMAGE_COMMIT_FAILED",
+			                      drive);
+		}
+	} else {
+		if (disk->DiscardDifferencingImage()) {
+			WriteOut(MSG_Get("PROGRAM_MOUNT_DIFF_IMAGE_DISCARDED"), drive);
+		} else {
+			NOTIFY_DisplayWarning(Notification::Source::Console,
+			                      "MOUNT",
+			                      "PROGRAM_MOUNT_DIFF_IMAGE_DISCARD_FAILED",
+			                      drive);
+		}
+	}
+	return true;
+}
+
 bool MOUNT::ParseArguments(MountParameters& params, bool& explicit_fs,
                            bool& path_relative_to_last_config)
 {
@@ -618,6 +749,12 @@ bool MOUNT::ParseArguments(MountParameters& params, bool& explicit_fs,
 	// Label
 	cmd->FindString("-label", params.label, true);
 
+	// Differencing image
+	if (cmd->FindString("-diff", params.diff_path, true)) {
+		params.diff_path = ApplyRelativePath(resolve_home(params.diff_path).string(),
+		                                     path_relative_to_last_config);
+	}
+
 	return true;
 }
 
@@ -1009,7 +1146,7 @@ bool MOUNT::ProcessPaths(MountParameters& params, bool path_relative_to_last_con
 
 					if (ext == "iso" || ext == "cue" ||
 					    ext == "bin" || ext == "mds" ||
-					    ext == "ccd") {
+					    ext == "ccd" || ext == "chd") {
 						params.type   = "iso";
 						params.fstype = "iso";
 
@@ -1290,6 +1427,11 @@ void MOUNT::Run(void)
 		return;
 	}
 
+	// Check for committing or discarding a differencing image
+	if (HandleDifferencingImage()) {
+		return;
+	}
+
 	bool explicit_fs                  = false;
 	bool path_relative_to_last_config = false;
 
@@ -1329,6 +1471,8 @@ void MOUNT::AddMessages()
 	        "  [color=light-green]mount[reset] [color=white]DRIVE[reset] [color=light-cyan]IMAGEFILE[reset] [IMAGEFILE2...] [PARAMETERS]\n"
 	        "  [color=light-green]mount[reset] [color=white]DRIVE[reset] [color=light-cyan]IMAGE-SET[reset] [PARAMETERS]\n"
 	        "  [color=light-green]mount[reset] -u [color=white]DRIVE[reset]  (unmounts [color=white]DRIVE[reset])\n"
+	        "  [color=light-green]mount[reset] -commit [color=white]DRIVE[reset]  (writes the changes of [color=white]DRIVE[reset] to the image)\n"
+	        "  [color=light-green]mount[reset] -discard [color=white]DRIVE[reset]  (throws away the changes of [color=white]DRIVE[reset])\n"
 	        "\n"
 	        "Common parameters:\n"
 	        "  [color=white]DRIVE[reset]           drive letter (A-Z) to mount to\n"
@@ -1353,6 +1497,8 @@ void MOUNT::AddMessages()
 	        "  -size [color=white]B,S,H,C[reset]   specify geometry ([color=white]B[reset]ytesPerSector,[color=white]S[reset]ectors,[color=white]H[reset]eads,[color=white]C[reset]ylinders);\n"
 	        "                  alternative to -chs for HDD images\n"
 	        "  -ide            attach as IDE device (for CD-ROM and HDD images)\n"
+	        "  -diff [color=white]FILE[reset]      write the changes to the differencing image [color=white]FILE[reset] instead of\n"
+	        "                  the image; [color=white]FILE[reset] is created if it doesn't exist\n"
 	        "  -pr             path is relative to the configuration file location\n"
 	        "\n"
 	        "Notes:\n"
@@ -1364,6 +1510,12 @@ void MOUNT::AddMessages()
 	        "    for CD-based games that need a real DOS environment via a bootable HDD\n"
 	        "    image.\n"
 	        "\n"
+	        "  - With -diff, the image is only read and can be shared by several\n"
+	        "    instances, each with its own differencing image. Use -commit to write the\n"
+	        "    changes to the image, or -discard to revert to it. Close the open files on\n"
+	        "    the drive before discarding the changes. Committing rewrites the image\n"
+	        "    itself, so only do it while no other instance is using the image.\n"
+	        "\n"
 	        "  - Type [color=light-cyan]overlay[reset] requires [color=white]DRIVE[reset] to be already mounted. It mounts [color=light-cyan]PATH[reset] on the\n"
 	        "    host OS as a write-layer over the drive. Modified files are stored in [color=light-cyan]PATH[reset],\n"
 	        "    leaving the original drive data unchanged.\n"
@@ -1484,6 +1636,33 @@ void MOUNT::AddMessages()
 
 	MSG_Add("PROGRAM_IMGMOUNT_FILE_NOT_FOUND", "Image file not found.\n");
 
+	MSG_Add("PROGRAM_IMGMOUNT_INVALID_DIFF_IMAGE",
+	        "Could not open the differencing image.\n"
+	        "Check that it was created for the same image.\n");
+
+	MSG_Add("PROGRAM_IMGMOUNT_DIFF_SINGLE_IMAGE",
+	        "Differencing images can only be used with a single FAT or raw image.\n");
+
+	MSG_Add("PROGRAM_MOUNT_NO_DIFF_IMAGE",
+	        "Drive %c doesn't have a differencing image.\n");
+
+	MSG_Add("PROGRAM_MOUNT_DIFF_IMAGE_COMMITTED",
+	        "The changes to drive %c have been written to the image.\n");
+
+	MSG_Add("PROGRAM_MOUNT_DIFF_IMAGE_COMMIT_FAILED",
+	        "Could not write the changes to drive %c to the image.\n"
+	        "Check that the image is writable.\n");
+
+	MSG_Add("PROGRAM_MOUNT_DIFF_IMAGE_IN_USE",
+	        "The image of drive %c is also mounted as another drive, so the changes\n"
+	        "can't be written to it. Unmount the other drive first.\n");
+
+	MSG_Add("PROGRAM_MOUNT_DIFF_IMAGE_DISCARDED",
+	        "The changes to drive %c have been discarded.\n");
+
+	MSG_Add("PROGRAM_MOUNT_DIFF_IMAGE_DISCARD_FAILED",
+	        "Could not discard the changes to drive %c.\n");
+
 	MSG_Add("PROGRAM_IMGMOUNT_ALREADY_MOUNTED",
 	        "Drive already mounted at that letter.\n");
 
@@ -19,6 +19,9 @@ struct MountParameters {
 	std::string fstype             = "fat";
 	std::string label              = "";
 
+	// Differencing image to write the changes of an image to
+	std::string diff_path = "";
+
 	// Geometry: [0]=BytesPerSector, [1]=Sectors, [2]=Heads, [3]=Cylinders
 	std::array<uint16_t, 4> sizes = {0, 0, 0, 0};
 
@@ -54,6 +57,7 @@ private:
 	void ShowUsage();
 
 	bool HandleUnmount();
+	bool HandleDifferencingImage();
 	bool ParseArguments(MountParameters& params, bool& explicit_fs,
 	                    bool& path_relative_to_last_config);
 	bool ParseGeometry(MountParameters& params);
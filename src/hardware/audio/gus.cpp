@@ -4,6 +4,7 @@
 
 #include "private/gus.h"
 
+#include <algorithm>
 #include <array>
 #include <iomanip>
 #include <memory>
@@ -669,10 +670,44 @@ bool Gus::SizedDmaTransfer()
 	// Will the maximum transfer stay within the GUS RAM's size?
 	assert(static_cast<size_t>(offset) + desired <= ram.size());
 
-	// Perform the DMA transfer
-	const auto transfered = dma_control_register.is_direction_gus_to_host
-	                              ? dma_channel->Write(desired, &ram.at(offset))
-	                              : dma_channel->Read(desired, &ram.at(offset));
+	// Perform the DMA transfer, copying straight between the guest memory
+	// and the GUS RAM
+	const auto transfer_start = ram.begin() + offset;
+	auto ram_pos              = transfer_start;
+
+	const auto is_host_to_gus = !dma_control_register.is_direction_gus_to_host;
+	const auto should_invert_high_bits =
+	        is_host_to_gus && dma_control_register.are_samples_high_bit_inverted;
+
+	// Position of the most-significant byte within little-endian samples
+	constexpr auto high_byte = (sample_size == SampleSize::Bits16) ? 1 : 0;
+	constexpr auto skip      = (sample_size == SampleSize::Bits16) ? 2 : 1;
+
+	auto read_span = [&](const DmaSpan& span) {
+		assert(static_cast<size_t>(ram.end() - ram_pos) >= span.num_bytes);
+		const auto span_start = ram_pos;
+		ram_pos = std::copy_n(span.data, span.num_bytes, ram_pos);
+
+		// If requested, invert the loaded samples' most-significant
+		// bits as we go
+		if (should_invert_high_bits) {
+			const auto pos_in_transfer = span_start - transfer_start;
+			for (auto pos = span_start + (high_byte + pos_in_transfer) % skip;
+			     pos < ram_pos;
+			     pos += skip) {
+				*pos ^= 0x80;
+			}
+		}
+	};
+	auto write_span = [&](const DmaSpan& span) {
+		assert(static_cast<size_t>(ram.end() - ram_pos) >= span.num_bytes);
+		std::copy_n(ram_pos, span.num_bytes, span.data);
+		ram_pos += span.num_bytes;
+	};
+
+	const auto transfered = is_host_to_gus
+	                              ? dma_channel->ReadSpans(desired, read_span)
+	                              : dma_channel->WriteSpans(desired, write_span);
 
 	// Did we get everything we asked for?
 	assert(transfered == desired);
@@ -683,24 +718,6 @@ bool Gus::SizedDmaTransfer()
 	// Update the GUS's DMA address with the current position
 	UpdateDmaAddr(check_cast<uint32_t>(offset + bytes_transfered));
 
-	// If requested, invert the loaded samples' most-significant bits
-	if (!dma_control_register.is_direction_gus_to_host &&
-	    dma_control_register.are_samples_high_bit_inverted) {
-		auto ram_pos           = ram.begin() + offset;
-		const auto ram_pos_end = ram_pos + bytes_transfered;
-
-		// adjust our start and skip size if handling 16-bit PCM samples
-		ram_pos += (sample_size == SampleSize::Bits16) ? 1 : 0;
-		const auto skip = (sample_size == SampleSize::Bits16) ? 2 : 1;
-
-		assert(ram_pos >= ram.begin() && ram_pos <= ram_pos_end &&
-		       ram_pos_end <= ram.end());
-		while (ram_pos < ram_pos_end) {
-			*ram_pos ^= 0x80;
-			ram_pos += skip;
-		}
-	}
-
 	if (dma_channel->has_reached_terminal_count) {
 		dma_control_register.has_pending_terminal_count_irq = true;
 
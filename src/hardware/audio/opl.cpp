@@ -4,7 +4,9 @@
 #include "opl.h"
 
 #include "private/gus.h"
+#include "private/opl_write_timing.h"
 
+#include <algorithm>
 #include <cmath>
 #include <cstdlib>
 #include <cstring>
@@ -300,30 +302,70 @@ void Opl::Init()
 
 void Opl::WriteReg(const io_port_t selected_reg, const uint8_t val)
 {
-	if (opl.mode == OplMode::Esfm) {
-		ESFM_write_reg_buffered_fast(&esfm.chip, selected_reg, val);
+	QueueWrite(WriteType::Register, selected_reg, val);
 
+	if (opl.mode != OplMode::Esfm && selected_reg == 0x105) {
+		opl.newm = selected_reg & 0x01;
+	}
+}
 
-	} else { // OPL
-		OPL3_WriteRegBuffered(&opl.chip, selected_reg, val);
-		if (selected_reg == 0x105) {
-			opl.newm = selected_reg & 0x01;
+void Opl::QueueWrite(const WriteType type, const io_port_t reg, const uint8_t val)
+{
+	const QueuedWrite write = {PIC_FullIndex(), type, reg, val};
+
+	if (!write_queue.Push(write)) {
+		// The mixer thread hasn't kept up (e.g., the mixer is paused),
+		// so apply the pending writes now to make room. They lose
+		// their exact timing, but none of them get dropped.
+		std::lock_guard lock(mutex);
+		ApplyQueuedWrites();
+		write_queue.Push(write);
+	}
+}
+
+void Opl::ApplyWrite(const QueuedWrite& write)
+{
+	switch (write.type) {
+	case WriteType::Register:
+		if (opl.mode == OplMode::Esfm) {
+			ESFM_write_reg_buffered_fast(&esfm.chip, write.reg, write.val);
+		} else {
+			OPL3_WriteRegBuffered(&opl.chip, write.reg, write.val);
 		}
+		break;
+
+	case WriteType::EsfmLegacyMode: ESFM_write_port(&esfm.chip, 0, 0); break;
 	}
 }
 
+// Applies all pending writes straight away; the caller must hold the mutex
+void Opl::ApplyQueuedWrites()
+{
+	const auto num_writes = write_queue.Size();
+	for (size_t i = 0; i < num_writes; ++i) {
+		ApplyWrite(write_queue[i]);
+	}
+	write_queue.Pop(num_writes);
+}
+
 io_port_t Opl::WriteAddr(const io_port_t port, const uint8_t val)
 {
 	if (opl.mode == OplMode::Esfm) {
 		uint16_t addr;
-		if (esfm.chip.native_mode) {
-			ESFM_write_port(&esfm.chip,
-			                check_cast<uint8_t>((port & 3) | 2),
-			                val);
-			return check_cast<io_port_t>(esfm.chip.addr_latch & 0x7ff);
+		if (esfm.mode == EsfmMode::Native) {
+			// Set the low or high byte of the address latch, like
+			// port offsets 2 and 3 of the chip do in native mode
+			if (port & 1) {
+				esfm.addr_latch = check_cast<uint16_t>(
+				        (esfm.addr_latch & 0xff) | (val << 8));
+			} else {
+				esfm.addr_latch = check_cast<uint16_t>(
+				        (esfm.addr_latch & 0xff00) | val);
+			}
+			return check_cast<io_port_t>(esfm.addr_latch & 0x7ff);
 		} else {
 			addr = val;
-			if ((port & 2) && (addr == 0x05 || esfm.chip.emu_newmode)) {
+			if ((port & 2) && (addr == 0x05 || esfm.newm)) {
 				addr |= 0x100;
 			}
 			return addr;
@@ -340,7 +382,11 @@ io_port_t Opl::WriteAddr(const io_port_t port, const uint8_t val)
 
 void Opl::EsfmSetLegacyMode()
 {
-	ESFM_write_port(&esfm.chip, 0, 0);
+	QueueWrite(WriteType::EsfmLegacyMode, 0, 0);
+
+	// Writing the first port of the chip in native mode also clears its
+	// address latch
+	esfm.addr_latch = 0;
 }
 
 template <LineIndex line_index>
@@ -380,54 +426,35 @@ int16_t remove_dc_bias(const int16_t back_sample)
 	return static_cast<int16_t>(front_sample - average);
 }
 
-AudioFrame Opl::RenderFrame()
+void Opl::RenderFrames(AudioFrame* frames, const int num_frames)
 {
-	static int16_t buf[2] = {};
-
-	if (opl.mode == OplMode::Esfm) {
-		ESFM_generate_stream(&esfm.chip, buf, 1);
-
-		if (ctrl.wants_dc_bias_removed) {
-			buf[0] = remove_dc_bias<Left>(buf[0]);
-			buf[1] = remove_dc_bias<Right>(buf[1]);
-		}
+	assert(num_frames > 0);
 
-		AudioFrame frame = {buf[0], buf[1]};
-		return frame;
+	const auto num_samples = check_cast<size_t>(num_frames * 2);
+	if (sample_buf.size() < num_samples) {
+		sample_buf.resize(num_samples);
+	}
+	auto buf = sample_buf.data();
 
+	if (opl.mode == OplMode::Esfm) {
+		ESFM_generate_stream(&esfm.chip, buf, check_cast<uint32_t>(num_frames));
 	} else { // OPL
-		OPL3_GenerateStream(&opl.chip, buf, 1);
-
-		if (ctrl.wants_dc_bias_removed) {
-			buf[0] = remove_dc_bias<Left>(buf[0]);
-			buf[1] = remove_dc_bias<Right>(buf[1]);
-		}
+		OPL3_GenerateStream(&opl.chip, buf, check_cast<uint32_t>(num_frames));
+	}
 
-		AudioFrame frame = {};
-		if (adlib_gold) {
-			adlib_gold->Process(buf, 1, &frame[0]);
-		} else {
-			frame.left  = buf[0];
-			frame.right = buf[1];
+	if (ctrl.wants_dc_bias_removed) {
+		for (size_t i = 0; i < num_samples; i += 2) {
+			buf[i]     = remove_dc_bias<Left>(buf[i]);
+			buf[i + 1] = remove_dc_bias<Right>(buf[i + 1]);
 		}
-		return frame;
 	}
-}
 
-void Opl::RenderUpToNow()
-{
-	const auto now = PIC_FullIndex();
-
-	// Wake up the channel and update the last rendered time datum.
-	assert(channel);
-	if (channel->WakeUp()) {
-		last_rendered_ms = now;
-		return;
-	}
-	// Keep rendering until we're current
-	while (last_rendered_ms < now) {
-		last_rendered_ms += ms_per_frame;
-		fifo.emplace(RenderFrame());
+	if (adlib_gold) {
+		adlib_gold->Process(buf, num_frames, &frames[0][0]);
+	} else {
+		for (auto i = 0; i < num_frames; ++i) {
+			frames[i] = {buf[i * 2], buf[i * 2 + 1]};
+		}
 	}
 }
 
@@ -435,32 +462,22 @@ void Opl::AudioCallback(const int requested_frames)
 {
 	std::lock_guard lock(mutex);
 	assert(channel);
-#if 0
-	if (fifo.size()) {
-		LOG_MSG("%s: Queued %2lu cycle-accurate frames",
-		        channel->GetName().c_str(),
-		        fifo.size());
-	}
-#endif
 
-	render_buf.clear();
+	render_buf.resize(check_cast<size_t>(requested_frames));
 
-	auto frames_remaining = requested_frames;
-
-	// Drain any cycle-accurate frames queued by RenderUpToNow
-	while (frames_remaining && fifo.size()) {
-		render_buf.push_back(fifo.front());
-		fifo.pop();
-		--frames_remaining;
-	}
-	// Render the remainder
-	while (frames_remaining) {
-		render_buf.emplace_back(RenderFrame());
-		--frames_remaining;
-	}
+	render_block_with_queued_writes(
+	        write_queue,
+	        last_rendered_ms,
+	        ms_per_frame,
+	        PIC_AtomicIndex(),
+	        requested_frames,
+	        [&](const QueuedWrite& write) { ApplyWrite(write); },
+	        [&](const int first_frame, const int num_frames) {
+		        RenderFrames(&render_buf[check_cast<size_t>(first_frame)],
+		                     num_frames);
+	        });
 
 	channel->AddAudioFrames(render_buf);
-	last_rendered_ms = PIC_AtomicIndex();
 }
 
 void Opl::CacheWrite(const io_port_t port, const uint8_t val)
@@ -573,8 +590,8 @@ uint8_t Opl::AdlibGoldControlRead()
 
 void Opl::PortWrite(const io_port_t port, const io_val_t value, const io_width_t)
 {
-	std::lock_guard lock(mutex);
-	RenderUpToNow();
+	assert(channel);
+	channel->WakeUp();
 
 	const auto val = check_cast<uint8_t>(value);
 
@@ -612,6 +629,9 @@ void Opl::PortWrite(const io_port_t port, const io_val_t value, const io_width_t
 		case OplMode::Opl3Gold:
 			if (port == 0x38b) {
 				if (ctrl.active) {
+					// The mixer thread uses the AdLib Gold
+					// processors while rendering
+					std::lock_guard lock(mutex);
 					AdlibGoldControlWrite(val);
 					break;
 				}
@@ -640,6 +660,9 @@ void Opl::PortWrite(const io_port_t port, const io_val_t value, const io_width_t
 
 		case OplMode::Esfm:
 			if (!chip[0].Write(reg.normal, val)) {
+				if (reg.normal == 0x105) {
+					esfm.newm = val & 0x01;
+				}
 				if (reg.normal == 0x105 && (val & 0x80)) {
 					esfm.mode = EsfmMode::Native;
 
@@ -772,6 +795,11 @@ uint8_t Opl::PortRead(const io_port_t port, const io_width_t)
 					return chip[0].EsfmReadbackReg(
 					        reg.normal & 0xff);
 				}
+				// Reading back needs the pending writes to be
+				// applied first, at the cost of their timing.
+				// Games only do this when detecting the card.
+				std::lock_guard lock(mutex);
+				ApplyQueuedWrites();
 				return ESFM_readback_reg(&esfm.chip, reg.normal);
 			} else {
 				return 0x00;
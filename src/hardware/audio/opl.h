@@ -8,7 +8,7 @@
 
 #include <cmath>
 #include <memory>
-#include <queue>
+#include <mutex>
 #include <vector>
 
 #include "ESFMu/esfm.h"
@@ -20,6 +20,7 @@
 #include "config/config.h"
 #include "hardware/pic.h"
 #include "hardware/port.h"
+#include "utils/spsc_ring_buffer.h"
 
 enum class OplMode { None, Opl2, DualOpl2, Opl3, Opl3Gold, Esfm };
 
@@ -101,7 +102,30 @@ private:
 	IO_ReadHandleObject ReadHandler[3];
 	IO_WriteHandleObject WriteHandler[3];
 
-	std::queue<AudioFrame> fifo = {};
+	// Register writes are recorded on the emulation thread with the
+	// emulated time they happened at, then applied by the mixer thread at
+	// the matching frame offsets while it renders the audio in blocks.
+	enum class WriteType { Register, EsfmLegacyMode };
+
+	struct QueuedWrite {
+		double timestamp_ms = 0.0;
+		WriteType type      = WriteType::Register;
+		io_port_t reg       = 0;
+		uint8_t val         = 0;
+	};
+
+	static constexpr auto WriteQueueCapacity = 8192;
+
+	// Only the emulation thread pushes, from QueueWrite(). The queue has
+	// two consumers: the mixer thread in AudioCallback(), and the
+	// emulation thread in ApplyQueuedWrites() when the queue is full in
+	// QueueWrite() or when the ESFM registers are read back in PortRead().
+	// The ring buffer only supports one consumer at a time, so anything
+	// that reads or pops from the queue must hold `mutex` while doing so;
+	// that's what makes the two consumers take turns.
+	SpscRingBuffer<QueuedWrite> write_queue{WriteQueueCapacity};
+
+	// Guards the chip state; held by the mixer thread while rendering
 	std::mutex mutex = {};
 
 	OplChip chip[2]  = {};
@@ -117,6 +141,11 @@ private:
 	struct {
 		esfm_chip chip = {};
 		EsfmMode mode  = EsfmMode::Legacy;
+
+		// Copies of the chip's state the emulation thread needs for
+		// decoding the port writes, so it doesn't touch the chip
+		uint16_t addr_latch = 0;
+		uint8_t newm        = 0;
 	} esfm = {};
 
 	// Playback related
@@ -124,6 +153,7 @@ private:
 	double ms_per_frame     = 0.0;
 
 	std::vector<AudioFrame> render_buf = {};
+	std::vector<int16_t> sample_buf    = {};
 
 	// Last selected address in the chip for the different modes
 	union {
@@ -146,8 +176,12 @@ private:
 	void Init();
 
 	void AudioCallback(const int frames);
-	AudioFrame RenderFrame();
-	void RenderUpToNow();
+	void RenderFrames(AudioFrame* frames, const int num_frames);
+
+	void QueueWrite(const WriteType type, const io_port_t reg, const uint8_t val);
+	void ApplyWrite(const QueuedWrite& write);
+	// Pops from the write queue, so the caller must hold the mutex
+	void ApplyQueuedWrites();
 
 	void PortWrite(const io_port_t port, const io_val_t value,
 	               const io_width_t width);
@@ -0,0 +1,68 @@
+// SPDX-FileCopyrightText:  2026-2026 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef DOSBOX_OPL_WRITE_TIMING_H
+#define DOSBOX_OPL_WRITE_TIMING_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+#include "utils/spsc_ring_buffer.h"
+
+// Sample-accurate timing of queued OPL writes
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Renders a block of frames, applying the queued writes at the frame offsets
+// matching their timestamps. The render clock normally runs on continuously
+// from the previous block so the writes keep their exact spacing, but it's
+// resynced to the emulated time when the two drift more than a block apart
+// (e.g., after the channel woke up, or in fast-forward mode).
+//
+// 'apply_write(write)' applies a write to the chip, and
+// 'render(first_frame, num_frames)' renders that part of the block. Writes
+// past the end of the block stay queued for the next one.
+//
+template <typename Write, typename ApplyWrite, typename Render>
+void render_block_with_queued_writes(SpscRingBuffer<Write>& write_queue,
+                                     double& last_rendered_ms,
+                                     const double ms_per_frame,
+                                     const double now_ms,
+                                     const int requested_frames,
+                                     ApplyWrite&& apply_write, Render&& render)
+{
+	const auto block_ms = requested_frames * ms_per_frame;
+
+	if (std::abs(now_ms - (last_rendered_ms + block_ms)) > block_ms) {
+		last_rendered_ms = now_ms - block_ms;
+	}
+
+	auto frame = 0;
+	while (frame < requested_frames) {
+		const auto frame_ms = last_rendered_ms + frame * ms_per_frame;
+
+		// Apply the writes that happened up to the current frame
+		size_t num_applied = 0;
+		while (num_applied < write_queue.Size() &&
+		       write_queue[num_applied].timestamp_ms <= frame_ms) {
+			apply_write(write_queue[num_applied]);
+			++num_applied;
+		}
+		write_queue.Pop(num_applied);
+
+		// Then render up to the frame of the next write in one go
+		auto num_frames = requested_frames - frame;
+		if (!write_queue.IsEmpty()) {
+			const auto frames_until_next_write = static_cast<int>(std::ceil(
+			        (write_queue[0].timestamp_ms - frame_ms) / ms_per_frame));
+
+			num_frames = std::clamp(frames_until_next_write, 1, num_frames);
+		}
+
+		render(frame, num_frames);
+		frame += num_frames;
+	}
+
+	last_rendered_ms += block_ms;
+}
+
+#endif // DOSBOX_OPL_WRITE_TIMING_H
@@ -982,11 +982,23 @@ static constexpr float to_float(T sample)
 	return 0.0f;
 }
 
-// Returns a vector of AudioFrames from the source samples. If the Sound Blaster
-// is still warming up or the speaker's off, then the frames will be silent.
+// Returns true if the frames of a DMA transfer should be silent, because the
+// Sound Blaster is still warming up or the speaker's off. Each call counts down
+// the warmup.
+static bool is_dma_transfer_silent()
+{
+	if (sb.dsp.warmup_remaining_ms > 0) {
+		--sb.dsp.warmup_remaining_ms;
+		return true;
+	}
+	return !sb.speaker_enabled;
+}
+
+// Returns a vector of AudioFrames from the source samples, or silent frames.
 template <FrameType frame_type, typename T>
-static std::vector<AudioFrame>& maybe_silence(const T* samples,
-                                              const uint32_t num_samples)
+static std::vector<AudioFrame>& to_frames(const T* samples,
+                                          const uint32_t num_samples,
+                                          const bool is_silent)
 {
 	assert(samples);
 	assert(num_samples > 0);
@@ -999,12 +1011,7 @@ static std::vector<AudioFrame>& maybe_silence(const T* samples,
 	frames.clear();
 	frames.reserve(num_frames);
 
-	// Return silent frames if still in warmup
-	if (sb.dsp.warmup_remaining_ms > 0) {
-		frames.resize(num_frames);
-		--sb.dsp.warmup_remaining_ms;
-		return frames;
-	} else if (!sb.speaker_enabled) {
+	if (is_silent) {
 		frames.resize(num_frames);
 		return frames;
 	}
@@ -1026,6 +1033,15 @@ static std::vector<AudioFrame>& maybe_silence(const T* samples,
 	return frames;
 }
 
+// Returns a vector of AudioFrames from the source samples. If the Sound Blaster
+// is still warming up or the speaker's off, then the frames will be silent.
+template <FrameType frame_type, typename T>
+static std::vector<AudioFrame>& maybe_silence(const T* samples,
+                                              const uint32_t num_samples)
+{
+	return to_frames<frame_type>(samples, num_samples, is_dma_transfer_silent());
+}
+
 static uint32_t read_dma_8bit(const uint32_t bytes_to_read,
                               const uint32_t buffer_index = 0)
 {
@@ -1057,58 +1073,75 @@ static uint32_t read_dma_8bit(const uint32_t bytes_to_read,
 	return check_cast<uint32_t>(bytes_read);
 }
 
-static uint32_t read_dma_16bit(const uint32_t words_to_read,
-                               const uint32_t buffer_index = 0)
+static void enqueue_frames(std::vector<AudioFrame>& frames)
 {
-	static_assert(sizeof(sb.dma.buf.b16[0]) == 2);
+	assert(sblaster);
+	frames_added_this_tick += static_cast<int>(frames.size());
+	sblaster->output_queue.NonblockingBulkEnqueue(frames);
+}
 
-	if (buffer_index >= DmaBufSize) {
-		// Should never happen as the code is currently written.
-		// Calling code has buffer_index either 0 or 1 to handle a
-		// dangling sample from the last read. This is to solve an edge
-		// case for stereo sound when the DMA buffer has an odd number
-		// of samples.
-		assertm(false,
-		        "SBLASTER: Read requested out of bounds of sb.dma.buf.b16");
-		return 0;
-	}
+// Reads the PCM samples of a DMA transfer and converts them straight from the
+// guest memory into frames, without copying them into the DMA buffer first.
+// Frames split across spans of guest memory or across transfers are put
+// together in the DMA buffer; 'sb.dma.remain_size' holds the number of bytes
+// carried over. Returns the number of DMA words read and the number of samples
+// and frames that includes.
+template <FrameType frame_type, typename T>
+static std::tuple<uint32_t, uint32_t, uint16_t> play_dma_pcm(const uint32_t words_to_read)
+{
+	constexpr auto SamplesPerFrame = (frame_type == FrameType::Mono) ? 1 : 2;
+	constexpr auto FrameBytes      = sizeof(T) * SamplesPerFrame;
 
-	// In dma.cpp, if sb.dma.chan->is_16bit is set, we're dealing with
-	// 16-bit words. Otherwise, we're dealing with 8-bit words (bytes).
-	// Calling code handles this case and conditionally divides by two.
-	uint32_t bytes_requested = words_to_read;
-	if (sb.dma.chan->is_16bit) {
-		bytes_requested *= 2;
-		// Calling code uses these internal SoundBlaster variables.
-		// sb.dma.chan->is_16bit is the source of truth in terms of
-		// memory safety. Assert that these two always match up.
-		assertm(sb.dma.mode == DmaMode::Pcm16Bit,
-		        "SoundBlaster expected 8-bit read but DMA controller is 16-bit");
-	} else {
-		assertm(sb.dma.mode == DmaMode::Pcm16BitAliased,
-		        "SoundBlaster expected 16-bit read but DMA controller is 8-bit");
-	}
+	// Limit the transfer to what fits in the DMA buffer, like the other
+	// DMA modes
+	const auto max_words = sb.dma.chan->is_16bit ? DmaBufSize
+	                                             : DmaBufSize * sizeof(T);
+	const auto clamped_words = std::min<uint32_t>(words_to_read,
+	                                              check_cast<uint32_t>(max_words));
 
-	// Clamp words to read so we don't overflow our buffer.
-	const uint32_t bytes_available = (DmaBufSize - buffer_index) * 2;
-	uint32_t clamped_words = std::min(bytes_requested, bytes_available);
-	if (sb.dma.chan->is_16bit) {
-		clamped_words /= 2;
-	}
+	auto carried = sb.dma.buf.b8;
 
-	const auto unsigned_buf = reinterpret_cast<uint8_t*>(sb.dma.buf.b16 +
-	                                                     buffer_index);
-	const auto words_read = sb.dma.chan->Read(clamped_words, unsigned_buf);
-	assert(words_read <= clamped_words);
+	uint32_t num_bytes  = sb.dma.remain_size;
+	uint32_t num_frames = 0;
 
-	return check_cast<uint32_t>(words_read);
-}
+	// The warmup counts down once per transfer, however many pieces its
+	// frames are converted in
+	const auto is_silent = is_dma_transfer_silent();
 
-static void enqueue_frames(std::vector<AudioFrame>& frames)
-{
-	assert(sblaster);
-	frames_added_this_tick += static_cast<int>(frames.size());
-	sblaster->output_queue.NonblockingBulkEnqueue(frames);
+	auto convert = [&](const uint8_t* data, const size_t bytes) {
+		const auto num_samples = check_cast<uint32_t>(bytes / sizeof(T));
+
+		// 16-bit samples might not be aligned in guest memory
+		if (reinterpret_cast<uintptr_t>(data) % alignof(T) != 0) {
+			assert(data != carried && bytes <= sizeof(sb.dma.buf));
+			std::memcpy(carried, data, bytes);
+			data = carried;
+		}
+		enqueue_frames(to_frames<frame_type>(reinterpret_cast<const T*>(data),
+		                                     num_samples,
+		                                     is_silent));
+		num_frames += num_samples / SamplesPerFrame;
+	};
+
+	const auto words_read = sb.dma.chan->ReadSpans(clamped_words, [&](const DmaSpan& span) {
+		num_bytes += check_cast<uint32_t>(span.num_bytes);
+
+		for_each_dma_frame_run<FrameBytes>(
+		        span, carried, sb.dma.remain_size, [&](const uint8_t* data, const size_t bytes) {
+			        // Unaligned samples are converted via the DMA
+			        // buffer, so at most that much at a time
+			        constexpr auto MaxBytes = sizeof(sb.dma.buf) /
+			                                  FrameBytes * FrameBytes;
+			        for (size_t pos = 0; pos < bytes; pos += MaxBytes) {
+				        convert(data + pos, std::min(bytes - pos, MaxBytes));
+			        }
+		        });
+	});
+
+	const auto num_samples = check_cast<uint32_t>(num_bytes / sizeof(T));
+	return {check_cast<uint32_t>(words_read),
+	        num_samples,
+	        check_cast<uint16_t>(num_frames)};
 }
 
 static void play_dma_transfer(const uint32_t bytes_requested)
@@ -1125,17 +1158,6 @@ static void play_dma_transfer(const uint32_t bytes_requested)
 	uint32_t samples    = 0;
 	uint16_t frames     = 0;
 
-	// In DmaMode::Pcm16BitAliased mode temporarily divide by 2 to get
-	// number of 16-bit samples, because 8-bit DMA Read returns byte size,
-	// while in DmaMode::Pcm16Bit mode 16-bit DMA Read returns word size.
-	const uint8_t dma16_to_sample_divisor = sb.dma.mode == DmaMode::Pcm16BitAliased
-	                                              ? 2
-	                                              : 1;
-
-	// Used to convert from samples to frames (which is what AddSamples
-	// unintuitively uses.. )
-	const uint8_t channels = sb.dma.stereo ? 2 : 1;
-
 	last_dma_callback = PIC_FullIndex();
 
 	// Temporary counter for ADPCM modes
@@ -1190,101 +1212,37 @@ static void play_dma_transfer(const uint32_t bytes_requested)
 
 	case DmaMode::Pcm8Bit:
 		if (sb.dma.stereo) {
-			bytes_read = read_dma_8bit(bytes_to_read, sb.dma.remain_size);
-			samples = bytes_read + sb.dma.remain_size;
-			frames  = check_cast<uint16_t>(samples / channels);
-
-			// Only add whole frames when in stereo DMA mode. The
-			// number of frames comes from the DMA request, and
-			// therefore user-space data.
-			if (frames) {
-				if (sb.dma.sign) {
-					const auto signed_buf = reinterpret_cast<int8_t*>(
-					        sb.dma.buf.b8);
-					enqueue_frames(maybe_silence<FrameType::Stereo>(
-					        signed_buf, samples));
-				} else {
-					enqueue_frames(maybe_silence<FrameType::Stereo>(
-					        sb.dma.buf.b8, samples));
-				}
-			}
-			// Otherwise there's an unhandled dangling sample from
-			// the last round
-			if (samples & 1) {
-				sb.dma.remain_size = 1;
-				sb.dma.buf.b8[0]   = sb.dma.buf.b8[samples - 1];
-			} else {
-				sb.dma.remain_size = 0;
-			}
-
-		} else { // Mono
-			bytes_read = read_dma_8bit(bytes_to_read);
-			samples    = bytes_read;
-			// mono sanity-check
-			assert(channels == 1);
-			if (sb.dma.sign) {
-				const auto signed_buf = reinterpret_cast<int8_t*>(
-				        sb.dma.buf.b8);
-				enqueue_frames(
-				        maybe_silence<FrameType::Mono>(signed_buf,
-				                                       samples));
-			} else {
-				enqueue_frames(maybe_silence<FrameType::Mono>(
-				        sb.dma.buf.b8, samples));
-			}
+			std::tie(bytes_read, samples, frames) =
+			        sb.dma.sign
+			                ? play_dma_pcm<FrameType::Stereo, int8_t>(bytes_to_read)
+			                : play_dma_pcm<FrameType::Stereo, uint8_t>(bytes_to_read);
+		} else {
+			std::tie(bytes_read, samples, frames) =
+			        sb.dma.sign
+			                ? play_dma_pcm<FrameType::Mono, int8_t>(bytes_to_read)
+			                : play_dma_pcm<FrameType::Mono, uint8_t>(bytes_to_read);
 		}
 		break;
 
 	case DmaMode::Pcm16BitAliased:
-		assert(dma16_to_sample_divisor == 2);
+		// The 8-bit DMA channel counts the 16-bit samples in bytes
+		assertm(!sb.dma.chan->is_16bit,
+		        "SoundBlaster expected 16-bit read but DMA controller is 8-bit");
 		[[fallthrough]];
 
 	case DmaMode::Pcm16Bit:
+		assertm(sb.dma.mode == DmaMode::Pcm16BitAliased || sb.dma.chan->is_16bit,
+		        "SoundBlaster expected 8-bit read but DMA controller is 16-bit");
 		if (sb.dma.stereo) {
-			bytes_read = read_dma_16bit(bytes_to_read, sb.dma.remain_size);
-			samples = (bytes_read + sb.dma.remain_size) /
-			          dma16_to_sample_divisor;
-			frames = check_cast<uint16_t>(samples / channels);
-
-			// Only add whole frames when in stereo DMA mode
-			if (frames) {
-				if (sb.dma.sign) {
-					enqueue_frames(maybe_silence<FrameType::Stereo>(
-					        sb.dma.buf.b16, samples));
-				} else {
-					const auto unsigned_buf =
-					        reinterpret_cast<uint16_t*>(
-					                sb.dma.buf.b16);
-					enqueue_frames(maybe_silence<FrameType::Stereo>(
-					        unsigned_buf, samples));
-				}
-			}
-			if (samples & 1) {
-				// Carry over the dangling sample into the next
-				// round, or...
-				sb.dma.remain_size = 1;
-				sb.dma.buf.b16[0] = sb.dma.buf.b16[samples - 1];
-			} else {
-				// ...the DMA transfer is done
-				sb.dma.remain_size = 0;
-			}
-		} else { // 16-bit mono
-			bytes_read = read_dma_16bit(bytes_to_read);
-			samples    = bytes_read / dma16_to_sample_divisor;
-
-			// mono sanity check
-			assert(channels == 1);
-
-			if (sb.dma.sign) {
-				enqueue_frames(maybe_silence<FrameType::Mono>(
-				        sb.dma.buf.b16, samples));
-			} else {
-				const auto unsigned_buf = reinterpret_cast<uint16_t*>(
-				        sb.dma.buf.b16);
-				enqueue_frames(
-				        maybe_silence<FrameType::Mono>(unsigned_buf,
-				                                       samples));
-			}
+			std::tie(bytes_read, samples, frames) =
+			        sb.dma.sign
+			                ? play_dma_pcm<FrameType::Stereo, int16_t>(bytes_to_read)
+			                : play_dma_pcm<FrameType::Stereo, uint16_t>(bytes_to_read);
+		} else {
+			std::tie(bytes_read, samples, frames) =
+			        sb.dma.sign
+			                ? play_dma_pcm<FrameType::Mono, int16_t>(bytes_to_read)
+			                : play_dma_pcm<FrameType::Mono, uint16_t>(bytes_to_read);
 		}
 		break;
 
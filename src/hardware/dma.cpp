@@ -5,6 +5,7 @@
 #include "dma.h"
 
 #include <algorithm>
+#include <array>
 #include <cstring>
 #include <memory>
 
@@ -38,11 +39,27 @@ static void UpdateEMSMapping()
 	}
 }
 
-// Generic function to read or write a block of data to or from memory.
-// Don't use this directly; call two helpers: DMA_BlockRead or DMA_BlockWrite
-static void perform_dma_io(const DmaDirection direction, const PhysPt spage,
-                           PhysPt mem_address, void* const data_start,
-                           const size_t num_words, const uint8_t is_dma16)
+// Translates the DMA address of a 4 KB page to the physical page, which
+// differs for the EMS page frame
+static uint32_t get_physical_page(uint32_t page)
+{
+	if (page < EMM_PAGEFRAME4K) {
+		page = paging.firstmb[page];
+	} else if (page < EMM_PAGEFRAME4K + 0x10) {
+		page = ems_board_mapping[page];
+	} else if (page < LINK_START) {
+		page = paging.firstmb[page];
+	}
+	return page;
+}
+
+// Splits a block of DMA memory into spans of host memory and hands them to the
+// callback. Runs of pages that are consecutive after translation are passed as
+// a single span.
+static void for_each_dma_span(const DmaDirection direction, const PhysPt spage,
+                              PhysPt mem_address, const size_t num_words,
+                              const uint8_t is_dma16,
+                              const DMA_SpanCallback& callback)
 {
 	assert(is_dma16 == 0 || is_dma16 == 1);
 
@@ -51,53 +68,57 @@ static void perform_dma_io(const DmaDirection direction, const PhysPt spage,
 	// Maybe move the mem_address into the 16-bit range
 	mem_address <<= is_dma16;
 
-	// The data pointer will be incremented per transfer
-	auto data_pt = reinterpret_cast<uint8_t*>(data_start);
-
-	// Convert from DMA 'words' to actual bytes, no greater than 64 KB
+	// Convert from DMA 'words' to actual bytes
 	auto remaining_bytes = check_cast<uint32_t>(num_words << is_dma16);
-	
-	assert(remaining_bytes <= 65536);
-
-	do {
-		// Find the right EMS page that contains the current address
-		auto page = highpart_addr_page + (mem_address >> 12);
-		if (page < EMM_PAGEFRAME4K) {
-			page = paging.firstmb[page];
-		} else if (page < EMM_PAGEFRAME4K + 0x10) {	
-			page = ems_board_mapping[page];
-		} else if (page < LINK_START) {
-			page = paging.firstmb[page];
-		}
+
+	const auto mem_end = static_cast<uint64_t>(MEM_TotalPages()) * DosPageSize;
+
+	while (remaining_bytes) {
+		const auto page = get_physical_page(highpart_addr_page +
+		                                    (mem_address >> 12));
 
 		// Calculate the offset within the page
 		const auto pos_in_page = mem_address & (DosPageSize - 1);
-		const auto bytes_to_page_end = check_cast<uint32_t>(DosPageSize -
-		                                                    pos_in_page);
-		const auto chunk_start = check_cast<PhysPt>(page * DosPageSize +
-		                                            pos_in_page);
-
-		// Determine how many bytes to transfer within this page
-		const auto chunk_bytes = std::min(remaining_bytes, bytes_to_page_end);
-
-		// Copy the data from the page address into the data pointer
-		if (direction == DmaDirection::Read) {
-			for (uint32_t i = 0; i < chunk_bytes; ++i) {
-				data_pt[i] = phys_readb(chunk_start + i);
-			}
+		const auto span_start  = check_cast<PhysPt>(page * DosPageSize +
+		                                             pos_in_page);
+
+		// Extend the span over the following pages for as long as
+		// they're mapped consecutively
+		auto span_bytes = std::min(remaining_bytes,
+		                           check_cast<uint32_t>(DosPageSize - pos_in_page));
+		auto next_page = page + 1;
+		while (span_bytes < remaining_bytes &&
+		       get_physical_page(highpart_addr_page +
+		                         ((mem_address + span_bytes) >> 12)) == next_page) {
+			span_bytes = std::min(remaining_bytes, span_bytes + DosPageSize);
+			++next_page;
 		}
 
-		// Copy the data from the data pointer into the page address
-		else if (direction == DmaDirection::Write) {
-			for (uint32_t i = 0; i < chunk_bytes; ++i) {
-				phys_writeb(chunk_start + i, data_pt[i]);
+		const auto ram_bytes = (span_start < mem_end)
+		                             ? static_cast<uint32_t>(std::min<uint64_t>(
+		                                       span_bytes, mem_end - span_start))
+		                             : 0;
+		if (ram_bytes) {
+			callback({MemBase + span_start, ram_bytes});
+		}
+
+		// Past the end of the RAM, reads see an open bus and writes are
+		// lost
+		auto open_bus_bytes = span_bytes - ram_bytes;
+		while (open_bus_bytes) {
+			static std::array<uint8_t, DosPageSize> open_bus = {};
+			if (direction == DmaDirection::Read) {
+				open_bus.fill(0xff);
 			}
+			const auto chunk_bytes = std::min<uint32_t>(open_bus_bytes,
+			                                            DosPageSize);
+			callback({open_bus.data(), chunk_bytes});
+			open_bus_bytes -= chunk_bytes;
 		}
 
-		mem_address += chunk_bytes;
-		data_pt += chunk_bytes;
-		remaining_bytes -= chunk_bytes;
-	} while (remaining_bytes);
+		mem_address += span_bytes;
+		remaining_bytes -= span_bytes;
+	}
 }
 
 static bool activate_primary()
@@ -409,49 +430,71 @@ void DmaChannel::ClearRequest()
 
 size_t DmaChannel::Read(const size_t words, uint8_t* const dest_buffer)
 {
-	return ReadOrWrite(DmaDirection::Read, words, dest_buffer);
+	auto dest = dest_buffer;
+	return ReadSpans(words, [&](const DmaSpan& span) {
+		std::memcpy(dest, span.data, span.num_bytes);
+		dest += span.num_bytes;
+	});
 }
 
 size_t DmaChannel::Write(const size_t words, uint8_t* const src_buffer)
 {
-	return ReadOrWrite(DmaDirection::Write, words, src_buffer);
+	auto src = src_buffer;
+	return WriteSpans(words, [&](const DmaSpan& span) {
+		std::memcpy(span.data, src, span.num_bytes);
+		src += span.num_bytes;
+	});
 }
 
-size_t DmaChannel::ReadOrWrite(const DmaDirection direction, const size_t words,
-                               uint8_t* const buffer)
+size_t DmaChannel::ReadSpans(const size_t words, const DMA_SpanCallback& callback)
+{
+	return Transfer(DmaDirection::Read, words, callback);
+}
+
+size_t DmaChannel::WriteSpans(const size_t words, const DMA_SpanCallback& callback)
+{
+	return Transfer(DmaDirection::Write, words, callback);
+}
+
+size_t DmaChannel::Transfer(const DmaDirection direction, const size_t words,
+                            const DMA_SpanCallback& callback)
 {
 	auto want     = check_cast<uint32_t>(words);
 	uint32_t done = 0;
 	curr_addr &= dma_wrapping;
 
-	// incremented per transfer
-	auto curr_buffer = buffer;
-again:
-	uint32_t left = (curr_count + 1);
-	if (want < left) {
-		perform_dma_io(direction, page_base, curr_addr, curr_buffer, want, is_16bit);
-		done += want;
-		curr_addr += check_cast<uint32_t>(want);
-		curr_count -= check_cast<uint16_t>(want);
-	} else {
-		perform_dma_io(direction, page_base, curr_addr, curr_buffer, left, is_16bit);
-		curr_buffer += left << is_16bit;
+	while (want) {
+		const uint32_t left = (curr_count + 1);
+		if (want < left) {
+			for_each_dma_span(
+			        direction, page_base, curr_addr, want, is_16bit, callback);
+			done += want;
+			curr_addr += want;
+			curr_count -= check_cast<uint16_t>(want);
+			break;
+		}
+
+		// Transfer up to the terminal count
+		for_each_dma_span(
+		        direction, page_base, curr_addr, left, is_16bit, callback);
 		want -= left;
 		done += left;
 		ReachedTerminalCount();
+
 		if (is_autoiniting) {
+			// Wrap around to the start of the buffer and carry on
 			curr_count = base_count;
 			curr_addr  = base_addr;
-			if (want) {
-				goto again;
+			if (!want) {
+				UpdateEMSMapping();
 			}
-			UpdateEMSMapping();
 		} else {
 			curr_addr += left;
 			curr_count = 0xffff;
 			is_masked  = true;
 			UpdateEMSMapping();
 			DoCallback(DmaEvent::IsMasked);
+			break;
 		}
 	}
 	return done;
@@ -7,7 +7,9 @@
 
 #include "dosbox.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cstring>
 #include <functional>
 
 #include "config/setup.h"
@@ -30,6 +32,56 @@ using DMA_EvictCallback = std::function<void(Section*)>;
 class DmaChannel;
 using DMA_Callback = std::function<void(const DmaChannel* chan, DmaEvent event)>;
 
+// A run of guest memory covered by a DMA transfer that's contiguous in host
+// memory. Transfers are split into spans at page boundaries where the guest
+// memory isn't contiguous on the host, and where they wrap around to the
+// start of an auto-initialising DMA buffer.
+struct DmaSpan {
+	uint8_t* data    = nullptr;
+	size_t num_bytes = 0;
+};
+
+using DMA_SpanCallback = std::function<void(const DmaSpan& span)>;
+
+// Hands the whole frames of a device's sample data in a span to the callback,
+// which gets them as runs of bytes: the frames within the span in place, and a
+// frame split across spans or transfers once it's been put together in
+// 'carried'. The start of a frame left at the end of the span is kept there
+// until the next span; 'num_carried' holds its number of bytes.
+template <size_t FrameBytes, typename Callback>
+void for_each_dma_frame_run(const DmaSpan& span, uint8_t* carried,
+                            uint32_t& num_carried, Callback&& callback)
+{
+	assert(num_carried < FrameBytes);
+
+	const uint8_t* data = span.data;
+	auto bytes_left     = span.num_bytes;
+
+	// Complete the frame carried over from the previous span
+	if (num_carried > 0) {
+		const auto bytes = std::min(bytes_left, FrameBytes - num_carried);
+		std::memcpy(carried + num_carried, data, bytes);
+		num_carried += static_cast<uint32_t>(bytes);
+		data += bytes;
+		bytes_left -= bytes;
+
+		if (num_carried < FrameBytes) {
+			return;
+		}
+		callback(static_cast<const uint8_t*>(carried), FrameBytes);
+		num_carried = 0;
+	}
+
+	const auto whole_frame_bytes = bytes_left - bytes_left % FrameBytes;
+	if (whole_frame_bytes > 0) {
+		callback(data, whole_frame_bytes);
+	}
+
+	// Carry over the start of a split frame
+	std::memcpy(carried, data + whole_frame_bytes, bytes_left - whole_frame_bytes);
+	num_carried = static_cast<uint32_t>(bytes_left - whole_frame_bytes);
+}
+
 class DmaChannel {
 public:
 	// Defaults at the time of initialization
@@ -64,6 +116,15 @@ public:
 	void ClearRequest();
 	size_t Read(size_t words, uint8_t* const dest_buffer);
 	size_t Write(size_t words, uint8_t* const src_buffer);
+
+	// Transfer up to 'words' like Read() and Write(), but instead of
+	// copying, hand each span of guest memory to the callback, which
+	// reads the device's data from it (ReadSpans) or writes the device's
+	// data to it (WriteSpans). This lets devices convert samples straight
+	// from guest memory. Returns the number of words transferred.
+	size_t ReadSpans(size_t words, const DMA_SpanCallback& callback);
+	size_t WriteSpans(size_t words, const DMA_SpanCallback& callback);
+
 	void LogDetails() const;
 
 	// Reset the channel back to defaults, without callbacks or reservations.
@@ -85,8 +146,8 @@ private:
 	void EvictReserver();
 	bool HasReservation() const;
 
-	size_t ReadOrWrite(DmaDirection direction, size_t words,
-	                   uint8_t* const buffer);
+	size_t Transfer(DmaDirection direction, size_t words,
+	                const DMA_SpanCallback& callback);
 
 	DMA_EvictCallback evict_callback   = {};
 	std::string reservation_owner_name = {};
@@ -211,6 +211,71 @@ void MEM_BlockWrite(PhysPt pt, const void *data, size_t size)
 	}
 }
 
+template <bool Writing>
+static HostPt get_host_span(const PhysPt pt, const size_t size)
+{
+	if (size == 0) {
+		return nullptr;
+	}
+	const auto first_page = pt >> 12;
+	const auto last_page  = (pt + size - 1) >> 12;
+	if (last_page < first_page) {
+		// Wraps around the address space
+		return nullptr;
+	}
+
+	const auto get_host_page = [](const PhysPt address) -> HostPt {
+		const auto handler = Writing ? get_tlb_writehandler(address)
+		                             : get_tlb_readhandler(address);
+		if (handler != &ram_page_handler) {
+			return nullptr;
+		}
+		const auto tlb_addr = Writing ? get_tlb_write(address)
+		                              : get_tlb_read(address);
+		return tlb_addr ? tlb_addr + address : nullptr;
+	};
+
+	// Without paging, linking the pages that haven't been accessed yet has
+	// no side effects; with paging, it could raise page faults, so these
+	// pages go through the handlers.
+	if (!PAGING_Enabled()) {
+		for (auto page = first_page; page <= last_page; ++page) {
+			if (!get_host_page(page << 12)) {
+				PAGING_ForcePageInit(page << 12);
+			}
+		}
+	}
+
+	// Checked in a second pass as linking pages can flush the TLB
+	const auto base = get_host_page(pt);
+	if (!base) {
+		return nullptr;
+	}
+	for (auto page = first_page + 1; page <= last_page; ++page) {
+		const auto address = page << 12;
+		if (get_host_page(address) != base + (address - pt)) {
+			return nullptr;
+		}
+	}
+	return base;
+}
+
+HostPt MEM_GetHostReadSpan(const PhysPt pt, const size_t size)
+{
+#if C_DEBUGGER && C_HEAVY_DEBUGGER
+	// The memory read breakpoints only trigger on accesses through the
+	// handlers
+	return nullptr;
+#else
+	return get_host_span<false>(pt, size);
+#endif
+}
+
+HostPt MEM_GetHostWriteSpan(const PhysPt pt, const size_t size)
+{
+	return get_host_span<true>(pt, size);
+}
+
 void MEM_BlockCopy(PhysPt dest,PhysPt src,Bitu size) {
 	mem_memcpy(dest,src,size);
 }
@@ -180,6 +180,14 @@ void MEM_BlockRead(PhysPt pt, void *data, Bitu size);
 void MEM_BlockCopy(PhysPt dest, PhysPt src, Bitu size);
 void MEM_StrCopy(PhysPt pt, char *data, Bitu size);
 
+// Return a host pointer to 'size' bytes of guest memory at the linear address
+// 'pt' if they're plain RAM pages that are contiguous in host memory and can
+// be accessed directly, bypassing the page handlers; nullptr otherwise (ROM,
+// the LFB, memory-mapped devices, pages holding translated code, etc.). The
+// pointer is only valid until the paging or EMS mappings change.
+HostPt MEM_GetHostReadSpan(PhysPt pt, size_t size);
+HostPt MEM_GetHostWriteSpan(PhysPt pt, size_t size);
+
 void mem_memcpy(PhysPt dest, PhysPt src, Bitu size);
 Bitu mem_strlen(PhysPt pt);
 void mem_strcpy(PhysPt dest, PhysPt src);
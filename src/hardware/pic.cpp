@@ -4,7 +4,10 @@
 
 #include "pic.h"
 
+#include <limits>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 #include "cpu/callback.h"
 #include "cpu/cpu.h"
@@ -26,8 +29,6 @@
 // "master-slave" relationship, which is misleading given that fact that the
 // primary has no control over the secondary.
 
-#define PIC_QUEUESIZE 512
-
 struct PIC_Controller {
 	Bitu icw_words;
 	Bitu icw_index;
@@ -180,18 +181,268 @@ void PIC_Controller::start_irq(uint8_t val) {
 }
 
 
-struct PICEntry {
-	double index;
-	Bitu value;
-	PIC_EventHandler pic_event;
-	PICEntry * next;
+// PIC Event Queue
+// ~~~~~~~~~~~~~~~
+// Pending events are kept in a binary min-heap ordered by their index (the
+// due time relative to the current tick, in milliseconds). Events with equal
+// indices are ordered by an ever-increasing serial number assigned when they
+// are added, so they fire in the order they were scheduled -- this is exactly
+// the order the original sorted linked list produced.
+//
+// Entries live in a growable pool addressed by slot number, and all pending
+// entries of the same handler are linked together, so removing the events of
+// a given handler doesn't require walking the whole queue.
+
+class PicEventQueue {
+public:
+	using Slot = uint32_t;
+
+	static constexpr Slot InvalidSlot = std::numeric_limits<Slot>::max();
+
+	struct Entry {
+		double index           = 0.0;
+		uint64_t serial        = 0;
+		PIC_EventHandler event = nullptr;
+		uint32_t value         = 0;
+
+		// Position of the entry in the heap
+		size_t heap_pos = 0;
+
+		// Neighbours in the list of entries sharing the same handler
+		Slot prev_same = InvalidSlot;
+		Slot next_same = InvalidSlot;
+	};
+
+	void Clear()
+	{
+		entries.clear();
+		free_slots.clear();
+		heap.clear();
+		handler_heads.clear();
+		next_serial = 0;
+
+		// Pre-allocate enough room for typical workloads so adding events
+		// doesn't need to allocate in the common case
+		constexpr auto InitialCapacity = 512;
+		entries.reserve(InitialCapacity);
+		free_slots.reserve(InitialCapacity);
+		heap.reserve(InitialCapacity);
+	}
+
+	bool IsEmpty() const
+	{
+		return heap.empty();
+	}
+
+	const Entry& Top() const
+	{
+		assert(!heap.empty());
+		return entries[heap.front()];
+	}
+
+	void Add(const PIC_EventHandler event, const double index, const uint32_t value)
+	{
+		const auto slot = AllocateSlot();
+
+		auto& entry  = entries[slot];
+		entry.index  = index;
+		entry.serial = next_serial++;
+		entry.event  = event;
+		entry.value  = value;
+
+		LinkToHandler(slot);
+
+		entry.heap_pos = heap.size();
+		heap.push_back(slot);
+		SiftUp(entry.heap_pos);
+	}
+
+	// Removes the first (earliest) entry and returns a copy of it
+	Entry Pop()
+	{
+		assert(!heap.empty());
+
+		const auto slot   = heap.front();
+		const Entry entry = entries[slot];
+
+		RemoveAt(0);
+		return entry;
+	}
+
+	void RemoveEvents(const PIC_EventHandler event)
+	{
+		auto it = handler_heads.find(event);
+		while (it != handler_heads.end()) {
+			// Removing the head entry advances (or erases) the head
+			RemoveAt(entries[it->second].heap_pos);
+			it = handler_heads.find(event);
+		}
+	}
+
+	void RemoveSpecificEvents(const PIC_EventHandler event, const uint32_t value)
+	{
+		const auto it = handler_heads.find(event);
+		if (it == handler_heads.end()) {
+			return;
+		}
+		auto slot = it->second;
+		while (slot != InvalidSlot) {
+			const auto next = entries[slot].next_same;
+			if (entries[slot].value == value) {
+				RemoveAt(entries[slot].heap_pos);
+			}
+			slot = next;
+		}
+	}
+
+	// Lowers the index of every pending event by the given amount. The
+	// subtraction rounds, so indices close together (such as overdue ones
+	// just below zero) can end up equal, and their serials then decide
+	// the order. That can put a child ahead of its parent, so the heap is
+	// rebuilt afterwards.
+	void ShiftIndices(const double amount)
+	{
+		for (const auto slot : heap) {
+			entries[slot].index -= amount;
+		}
+		for (auto pos = heap.size() / 2; pos-- > 0;) {
+			SiftDown(pos);
+		}
+	}
+
+private:
+	bool IsEarlier(const Slot a, const Slot b) const
+	{
+		const auto& lhs = entries[a];
+		const auto& rhs = entries[b];
+
+		if (lhs.index != rhs.index) {
+			return lhs.index < rhs.index;
+		}
+		return lhs.serial < rhs.serial;
+	}
+
+	void Place(const size_t pos, const Slot slot)
+	{
+		heap[pos]              = slot;
+		entries[slot].heap_pos = pos;
+	}
+
+	void SiftUp(size_t pos)
+	{
+		const auto slot = heap[pos];
+		while (pos > 0) {
+			const auto parent = (pos - 1) / 2;
+			if (!IsEarlier(slot, heap[parent])) {
+				break;
+			}
+			Place(pos, heap[parent]);
+			pos = parent;
+		}
+		Place(pos, slot);
+	}
+
+	void SiftDown(size_t pos)
+	{
+		const auto slot = heap[pos];
+		const auto size = heap.size();
+		while (true) {
+			auto child = pos * 2 + 1;
+			if (child >= size) {
+				break;
+			}
+			if (child + 1 < size && IsEarlier(heap[child + 1], heap[child])) {
+				++child;
+			}
+			if (!IsEarlier(heap[child], slot)) {
+				break;
+			}
+			Place(pos, heap[child]);
+			pos = child;
+		}
+		Place(pos, slot);
+	}
+
+	// Removes the entry at the given heap position and releases its slot
+	void RemoveAt(const size_t pos)
+	{
+		const auto slot = heap[pos];
+		UnlinkFromHandler(slot);
+
+		const auto last = heap.back();
+		heap.pop_back();
+
+		if (pos < heap.size()) {
+			Place(pos, last);
+			if (pos > 0 && IsEarlier(last, heap[(pos - 1) / 2])) {
+				SiftUp(pos);
+			} else {
+				SiftDown(pos);
+			}
+		}
+		free_slots.push_back(slot);
+	}
+
+	Slot AllocateSlot()
+	{
+		if (!free_slots.empty()) {
+			const auto slot = free_slots.back();
+			free_slots.pop_back();
+			return slot;
+		}
+		assert(entries.size() < InvalidSlot);
+		entries.emplace_back();
+		return static_cast<Slot>(entries.size() - 1);
+	}
+
+	void LinkToHandler(const Slot slot)
+	{
+		auto& entry = entries[slot];
+
+		const auto [it, inserted] = handler_heads.try_emplace(entry.event, slot);
+		if (!inserted) {
+			const auto head = it->second;
+
+			entry.next_same         = head;
+			entries[head].prev_same = slot;
+			it->second              = slot;
+		}
+	}
+
+	void UnlinkFromHandler(const Slot slot)
+	{
+		auto& entry = entries[slot];
+
+		if (entry.prev_same != InvalidSlot) {
+			entries[entry.prev_same].next_same = entry.next_same;
+		} else {
+			// The entry is the head of its handler's list
+			const auto it = handler_heads.find(entry.event);
+			assert(it != handler_heads.end() && it->second == slot);
+
+			if (entry.next_same == InvalidSlot) {
+				handler_heads.erase(it);
+			} else {
+				it->second = entry.next_same;
+			}
+		}
+		if (entry.next_same != InvalidSlot) {
+			entries[entry.next_same].prev_same = entry.prev_same;
+		}
+		entry.prev_same = InvalidSlot;
+		entry.next_same = InvalidSlot;
+	}
+
+	std::vector<Entry> entries   = {};
+	std::vector<Slot> free_slots = {};
+	std::vector<Slot> heap       = {};
+
+	std::unordered_map<PIC_EventHandler, Slot> handler_heads = {};
+
+	uint64_t next_serial = 0;
 };
 
-static struct {
-	PICEntry entries[PIC_QUEUESIZE];
-	PICEntry * free_entry;
-	PICEntry * next_entry;
-} pic_queue;
+static PicEventQueue pic_queue = {};
 
 static void write_command(io_port_t port, io_val_t value, io_width_t)
 {
@@ -423,110 +674,33 @@ void PIC_SetIRQMask(uint32_t irq, bool masked)
 	pic->set_imr(newmask);
 }
 
-static void AddEntry(PICEntry * entry) {
-	PICEntry * find_entry=pic_queue.next_entry;
-	if (find_entry == nullptr) {
-		entry->next=nullptr;
-		pic_queue.next_entry=entry;
-	} else if (find_entry->index > entry->index) {
-		pic_queue.next_entry=entry;
-		entry->next=find_entry;
-	} else {
-		while (find_entry) {
-			if (find_entry->next) {
-				/* See if the next index comes later than this
-				 * one */
-				if (find_entry->next->index > entry->index) {
-					entry->next      = find_entry->next;
-					find_entry->next = entry;
-					break;
-				} else {
-					find_entry = find_entry->next;
-				}
-			} else {
-				entry->next      = find_entry->next;
-				find_entry->next = entry;
-				break;
-			}
-		}
-	}
-	Bits cycles=PIC_MakeCycles(pic_queue.next_entry->index-PIC_TickIndex());
-	if (cycles<CPU_Cycles) {
-		CPU_CycleLeft+=CPU_Cycles;
-		CPU_Cycles=0;
-	}
-}
 static bool InEventService = false;
 static double srv_lag = 0.0;
 
 void PIC_AddEvent(PIC_EventHandler handler, double delay, uint32_t val)
 {
-	if (!pic_queue.free_entry) {
-		LOG(LOG_PIC,LOG_ERROR)("Event queue full");
-		return;
-	}
-	PICEntry * entry=pic_queue.free_entry;
-	if(InEventService) entry->index = delay + srv_lag;
-	else entry->index = delay + PIC_TickIndex();
+	const auto index = InEventService ? (delay + srv_lag)
+	                                  : (delay + PIC_TickIndex());
+
+	pic_queue.Add(handler, index, val);
 
-	entry->pic_event=handler;
-	entry->value=val;
-	pic_queue.free_entry=pic_queue.free_entry->next;
-	AddEntry(entry);
+	Bits cycles = PIC_MakeCycles(pic_queue.Top().index - PIC_TickIndex());
+	if (cycles < CPU_Cycles) {
+		CPU_CycleLeft += CPU_Cycles;
+		CPU_Cycles = 0;
+	}
 }
 
 void PIC_RemoveSpecificEvents(PIC_EventHandler handler, uint32_t val)
 {
-	PICEntry *entry = pic_queue.next_entry;
-	PICEntry *prev_entry;
-	prev_entry = nullptr;
-	while (entry) {
-		if ((entry->pic_event == handler) && (entry->value == val)) {
-			if (prev_entry) {
-				prev_entry->next=entry->next;
-				entry->next=pic_queue.free_entry;
-				pic_queue.free_entry=entry;
-				entry=prev_entry->next;
-				continue;
-			} else {
-				pic_queue.next_entry=entry->next;
-				entry->next=pic_queue.free_entry;
-				pic_queue.free_entry=entry;
-				entry=pic_queue.next_entry;
-				continue;
-			}
-		}
-		prev_entry=entry;
-		entry=entry->next;
-	}
+	pic_queue.RemoveSpecificEvents(handler, val);
 }
 
-void PIC_RemoveEvents(PIC_EventHandler handler) {
-	PICEntry * entry=pic_queue.next_entry;
-	PICEntry * prev_entry;
-	prev_entry=nullptr;
-	while (entry) {
-		if (entry->pic_event == handler) {
-			if (prev_entry) {
-				prev_entry->next=entry->next;
-				entry->next=pic_queue.free_entry;
-				pic_queue.free_entry=entry;
-				entry=prev_entry->next;
-				continue;
-			} else {
-				pic_queue.next_entry=entry->next;
-				entry->next=pic_queue.free_entry;
-				pic_queue.free_entry=entry;
-				entry=pic_queue.next_entry;
-				continue;
-			}
-		}
-		prev_entry=entry;
-		entry=entry->next;
-	}
+void PIC_RemoveEvents(PIC_EventHandler handler)
+{
+	pic_queue.RemoveEvents(handler);
 }
 
-
 bool PIC_RunQueue(void) {
 	PIC_UpdateAtomicIndex();
 
@@ -541,24 +715,21 @@ bool PIC_RunQueue(void) {
 
 	/* Check the queue for an entry */
 	InEventService = true;
-	while (pic_queue.next_entry &&
-	       (pic_queue.next_entry->index * static_cast<double>(CPU_CycleMax) <= index_nd_f)) {
-		PICEntry *entry = pic_queue.next_entry;
-		pic_queue.next_entry = entry->next;
-
-		srv_lag = entry->index;
-		(entry->pic_event)(entry->value); // call the event handler
-
-		/* Put the entry in the free list */
-		entry->next=pic_queue.free_entry;
-		pic_queue.free_entry=entry;
+	while (!pic_queue.IsEmpty() &&
+	       (pic_queue.Top().index * static_cast<double>(CPU_CycleMax) <= index_nd_f)) {
+		// The entry is removed from the queue before calling the
+		// handler, so the handler is free to add or remove events
+		const auto entry = pic_queue.Pop();
+
+		srv_lag = entry.index;
+		(entry.event)(entry.value); // call the event handler
 	}
 	InEventService = false;
 
 	/* Check when to set the new cycle end */
-	if (pic_queue.next_entry) {
+	if (!pic_queue.IsEmpty()) {
 		auto cycles = static_cast<int32_t>(
-		        pic_queue.next_entry->index * static_cast<double>(CPU_CycleMax) -
+		        pic_queue.Top().index * static_cast<double>(CPU_CycleMax) -
 		        index_nd_f);
 		if (!cycles) {
 			cycles = 1;
@@ -610,11 +781,7 @@ void TIMER_AddTick(void) {
 	CPU_Cycles=0;
 	PIC_Ticks++;
 	/* Go through the list of scheduled events and lower their index with 1000 */
-	PICEntry * entry=pic_queue.next_entry;
-	while (entry) {
-		entry->index -= 1.0f;
-		entry=entry->next;
-	}
+	pic_queue.ShiftIndices(1.0);
 	/* Call our list of ticker handlers */
 	TickerBlock * ticker=firstticker;
 	while (ticker) {
@@ -678,12 +845,7 @@ public:
 		WriteHandler[2].Install(0xa0, write_command, io_width_t::byte);
 		WriteHandler[3].Install(0xa1, write_data, io_width_t::byte);
 		/* Initialize the pic queue */
-		for (i=0;i<PIC_QUEUESIZE-1;i++) {
-			pic_queue.entries[i].next=&pic_queue.entries[i+1];
-		}
-		pic_queue.entries[PIC_QUEUESIZE-1].next=nullptr;
-		pic_queue.free_entry=&pic_queue.entries[0];
-		pic_queue.next_entry=nullptr;
+		pic_queue.Clear();
 	}
 
 	~PIC_8259A() = default;
@@ -3,12 +3,12 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 
 #include "port.h"
+#include "private/port_containers.h"
 
 #include <cassert>
 #include <cstring>
 #include <limits>
 #include <memory>
-#include <unordered_map>
 
 #include "config/setup.h"
 #include "cpu/callback.h"
@@ -17,10 +17,6 @@
 
 //#define ENABLE_PORTLOG
 
-// type-sized IO handler containers
-extern std::unordered_map<io_port_t, io_read_f> io_read_handlers[io_widths];
-extern std::unordered_map<io_port_t, io_write_f> io_write_handlers[io_widths];
-
 // type-sized IO handler API
 uint8_t read_byte_from_port(const io_port_t port);
 uint16_t read_word_from_port(const io_port_t port);
@@ -368,24 +364,20 @@ public:
 
 	~IO()
 	{
-		[[maybe_unused]] size_t total_bytes = 0u;
 		for (uint8_t i = 0; i < io_widths; ++i) {
-			const auto readers = io_read_handlers[i].size();
-			const auto writers = io_write_handlers[i].size();
+			const auto readers = io_read_handlers.NumHandledPorts(i);
+			const auto writers = io_write_handlers.NumHandledPorts(i);
 			LOG_DEBUG("IOBUS: Releasing %d read and %d write %d-bit port handlers",
 			          static_cast<int>(readers),
 			          static_cast<int>(writers),
 			          8 << i);
-
-			total_bytes += readers * sizeof(io_read_f) +
-			               sizeof(io_read_handlers[i]); //-V1055
-			total_bytes += writers * sizeof(io_write_f) +
-			               sizeof(io_write_handlers[i]); //-V1055
-			io_read_handlers[i].clear();
-			io_write_handlers[i].clear();
 		}
-		LOG_DEBUG("IOBUS: Handlers consumed %d total bytes",
-		          static_cast<int>(total_bytes));
+		LOG_DEBUG("IOBUS: Releasing %d read and %d write handler functions",
+		          static_cast<int>(io_read_handlers.NumHandlers()),
+		          static_cast<int>(io_write_handlers.NumHandlers()));
+
+		io_read_handlers.Clear();
+		io_write_handlers.Clear();
 	}
 };
 
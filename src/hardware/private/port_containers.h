@@ -0,0 +1,193 @@
+// SPDX-FileCopyrightText:  2026-2026 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef DOSBOX_PORT_CONTAINERS_H
+#define DOSBOX_PORT_CONTAINERS_H
+
+#include "hardware/port.h"
+
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "dosbox.h"
+
+// Flat IO handler dispatch tables
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Every IO width (byte, word, and dword) has a dense 64K-entry table indexed
+// by port number. The entries are small handler IDs pointing into a shared
+// list of handler functions, so a single registration covering a range of
+// ports stores its handler only once and the tables stay compact (128 KB per
+// width) and cache-friendly.
+//
+// ID 0 marks a port without a handler at the given width (callers fall back
+// to narrower accesses or block the port), and ID 1 is the shared "blocked"
+// sentinel handler installed for unhandled byte accesses.
+//
+// The handler functions are kept in a deque, as handlers can register other
+// handlers while they run: adding to the end of a deque doesn't move the
+// existing elements, so the handler being called stays where it is.
+//
+template <typename handler_t>
+class IoHandlerTable {
+public:
+	using id_t = uint16_t;
+
+	static constexpr id_t Unhandled = 0;
+	static constexpr id_t Blocked   = 1;
+
+	static constexpr size_t NumPorts = std::numeric_limits<io_port_t>::max() + 1;
+
+	explicit IoHandlerTable(const handler_t blocked_handler)
+	        : ids(std::make_unique<PortIds[]>(io_widths))
+	{
+		Clear();
+		handlers[Blocked] = blocked_handler;
+	}
+
+	IoHandlerTable(const IoHandlerTable&)            = delete;
+	IoHandlerTable& operator=(const IoHandlerTable&) = delete;
+
+	id_t Lookup(const int width_index, const io_port_t port) const
+	{
+		assert(width_index < io_widths);
+		return ids[width_index][port];
+	}
+
+	const handler_t& Get(const id_t id) const
+	{
+		assert(id != Unhandled && id < handlers.size());
+		return handlers[id];
+	}
+
+	// Installs the shared blocked handler on the given port
+	id_t Block(const int width_index, const io_port_t port)
+	{
+		SetId(width_index, port, Blocked);
+		return Blocked;
+	}
+
+	// Installs the handler on the given range of ports, on every width up
+	// to and including the maximum width
+	void Assign(const handler_t& handler, io_port_t port,
+	            const int max_width_index, io_port_t range)
+	{
+		if (range == 0) {
+			return;
+		}
+		const auto id = AllocateId();
+		handlers[id]  = handler;
+
+		while (range--) {
+			for (auto w = 0; w <= max_width_index; ++w) {
+				SetId(w, port, id);
+			}
+			++port;
+		}
+	}
+
+	// Removes the handlers from the given range of ports, on every width
+	// up to and including the maximum width
+	void Release(io_port_t port, const int max_width_index, io_port_t range)
+	{
+		while (range--) {
+			for (auto w = 0; w <= max_width_index; ++w) {
+				SetId(w, port, Unhandled);
+			}
+			++port;
+		}
+	}
+
+	// Returns the number of ports having a handler at the given width
+	size_t NumHandledPorts(const int width_index) const
+	{
+		size_t count = 0;
+		for (const auto id : ids[width_index]) {
+			count += (id != Unhandled) ? 1 : 0;
+		}
+		return count;
+	}
+
+	// Returns the number of handler functions currently in use
+	size_t NumHandlers() const
+	{
+		return handlers.size() - free_ids.size() - FirstHandlerId;
+	}
+
+	void Clear()
+	{
+		for (auto w = 0; w < io_widths; ++w) {
+			ids[w].fill(Unhandled);
+		}
+		const auto blocked_handler = handlers.empty() ? handler_t{}
+		                                              : handlers[Blocked];
+		handlers.assign(FirstHandlerId, handler_t{});
+		handlers[Blocked] = blocked_handler;
+
+		ref_counts.assign(FirstHandlerId, 0);
+		free_ids.clear();
+	}
+
+private:
+	static constexpr id_t FirstHandlerId = Blocked + 1;
+
+	using PortIds = std::array<id_t, NumPorts>;
+
+	void SetId(const int width_index, const io_port_t port, const id_t id)
+	{
+		assert(width_index < io_widths);
+		auto& slot = ids[width_index][port];
+		if (slot == id) {
+			return;
+		}
+		Unreference(slot);
+		slot = id;
+		if (id >= FirstHandlerId) {
+			++ref_counts[id];
+		}
+	}
+
+	void Unreference(const id_t id)
+	{
+		if (id < FirstHandlerId) {
+			return;
+		}
+		assert(ref_counts[id] > 0);
+		if (--ref_counts[id] == 0) {
+			// Release the captured state of the handler
+			handlers[id] = handler_t{};
+			free_ids.push_back(id);
+		}
+	}
+
+	id_t AllocateId()
+	{
+		if (!free_ids.empty()) {
+			const auto id = free_ids.back();
+			free_ids.pop_back();
+			return id;
+		}
+		// The IDs are 16-bit, and every ID is in use
+		if (handlers.size() > std::numeric_limits<id_t>::max()) {
+			E_Exit("IO: Too many IO handlers registered");
+		}
+		handlers.emplace_back();
+		ref_counts.push_back(0);
+		return static_cast<id_t>(handlers.size() - 1);
+	}
+
+	std::unique_ptr<PortIds[]> ids = {};
+
+	std::deque<handler_t> handlers = {};
+	std::vector<uint32_t> ref_counts = {};
+	std::vector<id_t> free_ids = {};
+};
+
+extern IoHandlerTable<io_read_f> io_read_handlers;
+extern IoHandlerTable<io_write_f> io_write_handlers;
+
+#endif // DOSBOX_PORT_CONTAINERS_H
@@ -81,6 +81,8 @@
 #include "hardware/memory.h"
 #include "hardware/pci_bus.h"
 #include "hardware/pic.h"
+#include "hardware/timer.h"
+#include "hardware/video/voodoo_combine.h"
 #include "misc/cross.h"
 #include "misc/support.h"
 #include "simde/x86/sse2.h"
@@ -884,13 +886,50 @@ struct draw_state {
 	bool screen_update_pending   = false;
 };
 
+// Triangles are split into a number of work units per thread (including the
+// main thread). Finer units balance the load better across the threads but
+// cost more synchronisation, and the best trade-off depends on the host and
+// the game, so it's tuned at runtime from the measured rendering times.
+constexpr int WorkUnitsPerThread[] = {1, 2, 4, 8, 16};
+constexpr int NumWorkUnitSteps     = static_cast<int>(std::size(WorkUnitsPerThread));
+
+// I measured 4x the thread count to be the sweet spot, after which
+// performance degrades. This gives about 20% more FPS in Descent II over the
+// old 1x count.
+constexpr int DefaultWorkUnitStep = 2;
+
+// The work index while no triangle is being rendered; it's far enough from
+// the limits that late increments by the worker threads can't overflow it.
+constexpr int IdleWorkIndex = INT_MAX / 2;
+
+struct work_unit_tuner {
+	// Number of frames each setting is measured for
+	static constexpr int FramesPerMeasurement = 60;
+
+	// Ignore measurements with too little threaded rendering work
+	static constexpr int64_t MinPixelsPerMeasurement = 100'000;
+
+	// A setting has to be this much faster to replace the current best
+	static constexpr double MinImprovement = 0.95;
+
+	int current_step = DefaultWorkUnitStep;
+	int best_step    = DefaultWorkUnitStep;
+	double best_cost = 0.0; // microseconds per pixel
+	int direction    = 1;
+
+	int frames         = 0;
+	int64_t elapsed_us = 0;
+	int64_t pixels     = 0;
+};
+
 struct triangle_worker
 {
 	triangle_worker(const int num_threads_)
 	        : num_threads(num_threads_),
-	          // I measured 4x the thread count to be the sweet spot, after which performance degrades.
-	          // This gives about 20% more FPS in Descent II over the old 1x count.
-	          num_work_units((num_threads + 1) * 4),
+	          max_work_units((num_threads + 1) *
+	                         WorkUnitsPerThread[NumWorkUnitSteps - 1]),
+	          num_work_units((num_threads + 1) *
+	                         WorkUnitsPerThread[DefaultWorkUnitStep]),
 	          threads(num_threads)
 	{
 		assert(num_work_units > num_threads);
@@ -900,8 +939,13 @@ struct triangle_worker
 	triangle_worker(const triangle_worker&)            = delete;
 	triangle_worker& operator=(const triangle_worker&) = delete;
 
-	const int num_threads = 0;
-	const int num_work_units = 0;
+	const int num_threads    = 0;
+	const int max_work_units = 0;
+
+	// Only changed by the main thread between triangles
+	std::atomic<int> num_work_units = 0;
+
+	work_unit_tuner tuner = {};
 
 	bool disable_bilinear_filter = {};
 
@@ -920,7 +964,7 @@ struct triangle_worker
 	std::vector<std::thread> threads = {};
 
 	// Worker threads start working when this gets reset to 0
-	std::atomic<int> work_index = INT_MAX;
+	std::atomic<int> work_index = IdleWorkIndex;
 
 	std::atomic<int> done_count = 0;
 };
@@ -929,7 +973,7 @@ struct voodoo_state
 {
 	voodoo_state(const int num_threads)
 	        : tworker(num_threads),
-	          thread_stats(tworker.num_work_units)
+	          thread_stats(tworker.max_work_units)
 	{
 		assert(!thread_stats.empty());
 	}
@@ -3037,6 +3081,31 @@ static double Voodoo_GetHRetracePosition();
 static dither_lut_t dither2_lookup = {};
 static dither_lut_t dither4_lookup = {};
 
+// Number of pixels the color combine unit processes at once; a multiple of
+// four as voodoo_color_combine_batch() requires
+constexpr int CombineBatchSize = 8;
+
+static voodoo_combine_mode get_combine_mode(const uint32_t fbzcp)
+{
+	voodoo_combine_mode mode = {};
+
+	mode.zero_other       = FBZCP_CC_ZERO_OTHER(fbzcp);
+	mode.zero_other_alpha = FBZCP_CCA_ZERO_OTHER(fbzcp);
+
+	mode.sub_local       = FBZCP_CC_SUB_CLOCAL(fbzcp);
+	mode.sub_local_alpha = FBZCP_CCA_SUB_CLOCAL(fbzcp);
+
+	mode.reverse_blend       = FBZCP_CC_REVERSE_BLEND(fbzcp);
+	mode.reverse_blend_alpha = FBZCP_CCA_REVERSE_BLEND(fbzcp);
+
+	mode.add_local       = static_cast<uint8_t>(FBZCP_CC_ADD_ACLOCAL(fbzcp));
+	mode.add_local_alpha = FBZCP_CCA_ADD_ACLOCAL(fbzcp);
+
+	mode.invert       = FBZCP_CC_INVERT_OUTPUT(fbzcp);
+	mode.invert_alpha = FBZCP_CCA_INVERT_OUTPUT(fbzcp);
+	return mode;
+}
+
 static inline void raster_generic(const voodoo_state* vs, uint32_t TMUS, uint32_t TEXMODE0,
                                   uint32_t TEXMODE1, void* destbase, int32_t y,
                                   const poly_extent* extent, stats_block& stats)
@@ -3146,6 +3215,48 @@ static inline void raster_generic(const voodoo_state* vs, uint32_t TMUS, uint32_
 		itert1 = tmu1.startt + dy * tmu1.dtdy + dx * tmu1.dtdx;
 	}
 
+	/* without fogging and alpha blending, nothing after the color */
+	/* combine unit reads the framebuffer, so the pixels that pass the */
+	/* tests are collected and combined in batches with SIMD */
+	const auto combine_mode = get_combine_mode(r_fbzColorPath);
+	const bool batch_combine = !FOGMODE_ENABLE_FOG(r_fogMode) &&
+	                           !ALPHAMODE_ALPHABLEND(r_alphaMode);
+
+	const auto combine_masks = batch_combine
+	                                 ? voodoo_make_combine_masks(combine_mode)
+	                                 : voodoo_combine_masks{};
+	struct {
+		int32_t x[CombineBatchSize]        = {};
+		int32_t depthval[CombineBatchSize] = {};
+		uint32_t c_other[CombineBatchSize] = {};
+		uint32_t c_local[CombineBatchSize] = {};
+		uint32_t blend[CombineBatchSize]   = {};
+		uint32_t result[CombineBatchSize]  = {};
+		int count = 0;
+	} batch;
+
+	const auto flush_batch = [&]() {
+		voodoo_color_combine_batch(combine_masks, batch.c_other,
+		                           batch.c_local, batch.blend,
+		                           batch.count, batch.result);
+
+		for (int i = 0; i < batch.count; ++i) {
+			const int32_t x        = batch.x[i];
+			const int32_t depthval = batch.depthval[i];
+
+			rgb_union result;
+			result.u = batch.result[i];
+
+			int32_t r = result.rgb.r;
+			int32_t g = result.rgb.g;
+			int32_t b = result.rgb.b;
+			int32_t a = result.rgb.a;
+
+			PIXEL_PIPELINE_FINISH(vs, dither_lookup, x, dest, depth, r_fbzMode);
+		}
+		batch.count = 0;
+	};
+
 	/* loop in X */
 	for (int32_t x = startx; x < stopx; x++)
 	{
@@ -3185,12 +3296,9 @@ static inline void raster_generic(const voodoo_state* vs, uint32_t TMUS, uint32_
 		CLAMPED_ARGB(iterr, iterg, iterb, itera, r_fbzColorPath, iterargb);
 
 
-		int32_t blendr;
-		int32_t blendg;
-		int32_t blendb;
-		int32_t blenda;
 		rgb_union c_other;
 		rgb_union c_local;
+		rgb_union blend;
 
 		/* compute c_other */
 		switch (FBZCP_CC_RGBSELECT(r_fbzColorPath))
@@ -3282,147 +3390,78 @@ static inline void raster_generic(const voodoo_state* vs, uint32_t TMUS, uint32_
 			}
 		}
 
-		/* select zero or c_other */
-		if (FBZCP_CC_ZERO_OTHER(r_fbzColorPath) == 0)
-		{
-			r = c_other.rgb.r;
-			g = c_other.rgb.g;
-			b = c_other.rgb.b;
-		} else {
-			r = g = b = 0;
-		}
-
-		/* select zero or a_other */
-		if (FBZCP_CCA_ZERO_OTHER(r_fbzColorPath) == 0) {
-			a = c_other.rgb.a;
-		} else {
-			a = 0;
-		}
-
-		/* subtract c_local */
-		if (FBZCP_CC_SUB_CLOCAL(r_fbzColorPath))
-		{
-			r -= c_local.rgb.r;
-			g -= c_local.rgb.g;
-			b -= c_local.rgb.b;
-		}
-
-		/* subtract a_local */
-		if (FBZCP_CCA_SUB_CLOCAL(r_fbzColorPath)) {
-			a -= c_local.rgb.a;
-		}
-
-		/* blend RGB */
+		/* select the RGB blend factors */
+		blend.u = 0;
 		switch (FBZCP_CC_MSELECT(r_fbzColorPath))
 		{
 			default:	/* reserved */
 			case 0:		/* 0 */
-				blendr = blendg = blendb = 0;
 				break;
 			case 1:		/* c_local */
-				blendr = c_local.rgb.r;
-				blendg = c_local.rgb.g;
-				blendb = c_local.rgb.b;
+				blend.rgb.r = c_local.rgb.r;
+				blend.rgb.g = c_local.rgb.g;
+				blend.rgb.b = c_local.rgb.b;
 				break;
 			case 2:		/* a_other */
-				blendr = blendg = blendb = c_other.rgb.a;
+				blend.rgb.r = blend.rgb.g = blend.rgb.b = c_other.rgb.a;
 				break;
 			case 3:		/* a_local */
-				blendr = blendg = blendb = c_local.rgb.a;
+				blend.rgb.r = blend.rgb.g = blend.rgb.b = c_local.rgb.a;
 				break;
 			case 4:		/* texture alpha */
-				blendr = blendg = blendb = texel.rgb.a;
+				blend.rgb.r = blend.rgb.g = blend.rgb.b = texel.rgb.a;
 				break;
 			case 5:		/* texture RGB (Voodoo 2 only) */
-				blendr = texel.rgb.r;
-				blendg = texel.rgb.g;
-				blendb = texel.rgb.b;
+				blend.rgb.r = texel.rgb.r;
+				blend.rgb.g = texel.rgb.g;
+				blend.rgb.b = texel.rgb.b;
 				break;
 		}
 
-		/* blend alpha */
+		/* select the alpha blend factor */
 		switch (FBZCP_CCA_MSELECT(r_fbzColorPath))
 		{
 			default:	/* reserved */
 			case 0:		/* 0 */
-				blenda = 0;
 				break;
 			case 1:		/* a_local */
 			case 3:
-				blenda = c_local.rgb.a;
+				blend.rgb.a = c_local.rgb.a;
 				break;
 			case 2:		/* a_other */
-				blenda = c_other.rgb.a;
+				blend.rgb.a = c_other.rgb.a;
 				break;
 			case 4:		/* texture alpha */
-				blenda = texel.rgb.a;
-				break;
-		}
-
-		/* reverse the RGB blend */
-		if (!FBZCP_CC_REVERSE_BLEND(r_fbzColorPath))
-		{
-			blendr ^= 0xff;
-			blendg ^= 0xff;
-			blendb ^= 0xff;
-		}
-
-		/* reverse the alpha blend */
-		if (!FBZCP_CCA_REVERSE_BLEND(r_fbzColorPath)) {
-			blenda ^= 0xff;
-		}
-
-		/* do the blend */
-		r = (r * (blendr + 1)) >> 8;
-		g = (g * (blendg + 1)) >> 8;
-		b = (b * (blendb + 1)) >> 8;
-		a = (a * (blenda + 1)) >> 8;
-
-		/* add clocal or alocal to RGB */
-		switch (FBZCP_CC_ADD_ACLOCAL(r_fbzColorPath))
-		{
-			case 3:		/* reserved */
-			case 0:		/* nothing */
-				break;
-			case 1:		/* add c_local */
-				r += c_local.rgb.r;
-				g += c_local.rgb.g;
-				b += c_local.rgb.b;
+				blend.rgb.a = texel.rgb.a;
 				break;
-			case 2:		/* add_alocal */
-				r += c_local.rgb.a;
-				g += c_local.rgb.a;
-				b += c_local.rgb.a;
-				break;
-		}
-
-		/* add clocal or alocal to alpha */
-		if (FBZCP_CCA_ADD_ACLOCAL(r_fbzColorPath)) {
-			a += c_local.rgb.a;
 		}
 
-		/* clamp */
-		r = clamp_to_uint8(r);
-		g = clamp_to_uint8(g);
-		b = clamp_to_uint8(b);
-		a = clamp_to_uint8(a);
-
-		/* invert */
-		if (FBZCP_CC_INVERT_OUTPUT(r_fbzColorPath))
-		{
-			r ^= 0xff;
-			g ^= 0xff;
-			b ^= 0xff;
-		}
-		if (FBZCP_CCA_INVERT_OUTPUT(r_fbzColorPath)) {
-			a ^= 0xff;
+		if (batch_combine) {
+			/* the combine and the output happen when the batch is full */
+			const auto i = batch.count++;
+			batch.x[i]        = x;
+			batch.depthval[i] = depthval;
+			batch.c_other[i]  = c_other.u;
+			batch.c_local[i]  = c_local.u;
+			batch.blend[i]    = blend.u;
+			if (batch.count == CombineBatchSize) {
+				flush_batch();
+			}
+		} else {
+			rgb_union result;
+			result.u = voodoo_color_combine(combine_mode,
+			                                {c_other.u, c_local.u, blend.u});
+			r = result.rgb.r;
+			g = result.rgb.g;
+			b = result.rgb.b;
+			a = result.rgb.a;
+
+			/* pixel pipeline part 2 handles fog, alpha, and final output */
+			PIXEL_PIPELINE_MODIFY(vs, dither, dither4, x,
+								r_fbzMode, r_fbzColorPath, r_alphaMode, r_fogMode,
+								iterz, iterw, iterargb);
+			PIXEL_PIPELINE_FINISH(vs, dither_lookup, x, dest, depth, r_fbzMode);
 		}
-
-		/* pixel pipeline part 2 handles fog, alpha, and final output */
-		PIXEL_PIPELINE_MODIFY(vs, dither, dither4, x,
-							r_fbzMode, r_fbzColorPath, r_alphaMode, r_fogMode,
-							iterz, iterw, iterargb);
-		PIXEL_PIPELINE_FINISH(vs, dither_lookup, x, dest, depth, r_fbzMode);
 		PIXEL_PIPELINE_END(stats);
 
 		/* update the iterated parameters */
@@ -3445,6 +3484,10 @@ static inline void raster_generic(const voodoo_state* vs, uint32_t TMUS, uint32_
 			itert1 += tmu1.dtdx;
 		}
 	}
+
+	if (batch.count) {
+		flush_batch();
+	}
 }
 
 #ifdef C_ENABLE_VOODOO_OPENGL
@@ -4349,11 +4392,12 @@ static void triangle_worker_work(const triangle_worker& tworker,
 
 	// The number of workers represents the total work, while the start and
 	// end represent a fraction (up to 100%) of the total total.
-	assert(work_end > 0 && tworker.num_work_units >= work_end);
+	const auto work_units = tworker.num_work_units.load(std::memory_order_relaxed);
+	assert(work_end > 0 && work_units >= work_end);
 
 	// The following suppresses div-by-0 false positive reported in Clang
 	// analysis. This is confirmed fixed in Clang v18.
-	const auto num_work_units = tworker.num_work_units ? tworker.num_work_units : 1;
+	const auto num_work_units = work_units ? work_units : 1;
 
 	const int32_t from = tworker.totalpix * work_start / num_work_units;
 	const int32_t to   = tworker.totalpix * work_end / num_work_units;
@@ -4432,15 +4476,19 @@ static int do_triangle_work(triangle_worker& tworker)
 	// Extra load but this should ensure we don't overflow the index,
 	// with the fetch_add below in case of spurious wake-ups.
 	int i = tworker.work_index.load(std::memory_order_acquire);
-	if (i >= tworker.num_work_units) {
+	if (i >= tworker.num_work_units.load(std::memory_order_relaxed)) {
 		return i;
 	}
 
 	i = tworker.work_index.fetch_add(1, std::memory_order_acq_rel);
-	if (i < tworker.num_work_units) {
+
+	// Load the number of units after claiming the index, so both belong
+	// to the same triangle
+	const auto num_work_units = tworker.num_work_units.load(std::memory_order_relaxed);
+	if (i < num_work_units) {
 		triangle_worker_work(tworker, i, i + 1);
 		int done = tworker.done_count.fetch_add(1, std::memory_order_acq_rel) + 1;
-		if (done >= tworker.num_work_units) {
+		if (done >= num_work_units) {
 			tworker.done_count.notify_all();
 		}
 	}
@@ -4455,7 +4503,7 @@ static int triangle_worker_thread_func()
 	triangle_worker& tworker = v->tworker;
 	while (tworker.threads_active.load(std::memory_order_acquire)) {
 		int i = do_triangle_work(tworker);
-		if (i >= tworker.num_work_units) {
+		if (i >= tworker.num_work_units.load(std::memory_order_relaxed)) {
 			tworker.work_index.wait(i, std::memory_order_acquire);
 		}
 	}
@@ -4480,10 +4528,12 @@ static void triangle_worker_shutdown(triangle_worker& tworker)
 
 static void triangle_worker_run(triangle_worker& tworker)
 {
+	const auto num_work_units = tworker.num_work_units.load(std::memory_order_relaxed);
+
 	if (!tworker.num_threads) {
 		// do not use threaded calculation
 		tworker.totalpix = 0xFFFFFFF;
-		triangle_worker_work(tworker, 0, tworker.num_work_units);
+		triangle_worker_work(tworker, 0, num_work_units);
 		return;
 	}
 
@@ -4522,10 +4572,12 @@ static void triangle_worker_run(triangle_worker& tworker)
 	// Don't wake up threads for just a few pixels
 	if (tworker.totalpix <= 200)
 	{
-		triangle_worker_work(tworker, 0, tworker.num_work_units);
+		triangle_worker_work(tworker, 0, num_work_units);
 		return;
 	}
 
+	const auto start_us = GetTicksUs();
+
 	// The main thread is the only one who sets threads_active (here and in shutdown) so there is no race condition.
 	// In the future, if this changes, this will need to be an atomic compare_exchange.
 	// For now, this is better because 99% of the time threads_active == true.
@@ -4548,13 +4600,72 @@ static void triangle_worker_run(triangle_worker& tworker)
 	tworker.work_index.notify_all();
 
 	// Main thread also does the same work as the worker threads
-	while (do_triangle_work(tworker) < tworker.num_work_units);
+	while (do_triangle_work(tworker) < num_work_units);
 
 	// Wait until all work has been completed by the worker thread.
 	int i;
-	while ((i = tworker.done_count.load(std::memory_order_acquire)) < tworker.num_work_units) {
+	while ((i = tworker.done_count.load(std::memory_order_acquire)) < num_work_units) {
 		tworker.done_count.wait(i, std::memory_order_acquire);
 	}
+
+	// Keep idle workers from picking up work units if the number of units
+	// changes before the next triangle
+	tworker.work_index.store(IdleWorkIndex, std::memory_order_release);
+
+	tworker.tuner.elapsed_us += GetTicksUsSince(start_us);
+	tworker.tuner.pixels += tworker.totalpix;
+}
+
+// Called once per frame to tune the number of work units triangles are split
+// into. The best setting so far and one of its neighbours are measured in
+// turns, moving to the neighbour if it renders the pixels faster.
+static void triangle_worker_tune(triangle_worker& tworker)
+{
+	auto& tuner = tworker.tuner;
+	if (!tworker.num_threads || ++tuner.frames < tuner.FramesPerMeasurement) {
+		return;
+	}
+	const auto elapsed_us = tuner.elapsed_us;
+	const auto pixels     = tuner.pixels;
+
+	tuner.frames     = 0;
+	tuner.elapsed_us = 0;
+	tuner.pixels     = 0;
+
+	if (pixels < tuner.MinPixelsPerMeasurement) {
+		return;
+	}
+	const auto cost = static_cast<double>(elapsed_us) / static_cast<double>(pixels);
+
+	if (tuner.current_step == tuner.best_step) {
+		// Refresh the reference as the scenes change
+		tuner.best_cost = cost;
+	} else if (cost < tuner.best_cost * tuner.MinImprovement) {
+		tuner.best_step = tuner.current_step;
+		tuner.best_cost = cost;
+		LOG(LOG_VOODOO, LOG_NORMAL)("VOODOO: Splitting triangles into %d work units",
+		                            (tworker.num_threads + 1) *
+		                                    WorkUnitsPerThread[tuner.best_step]);
+	}
+
+	// Alternate between measuring the best setting and one of its
+	// neighbours, trying the lower and higher neighbour in turns
+	auto next_step = tuner.best_step;
+	if (tuner.current_step == tuner.best_step) {
+		for (auto tries = 0; tries < 2; ++tries) {
+			const auto step = tuner.best_step + tuner.direction;
+			tuner.direction = -tuner.direction;
+			if (step >= 0 && step < NumWorkUnitSteps) {
+				next_step = step;
+				break;
+			}
+		}
+	}
+	tuner.current_step = next_step;
+
+	tworker.num_work_units.store((tworker.num_threads + 1) *
+	                                     WorkUnitsPerThread[next_step],
+	                             std::memory_order_relaxed);
 }
 
 /*-------------------------------------------------
@@ -5144,6 +5255,8 @@ static void swapbuffer(voodoo_state *vs, uint32_t data)
 	vs->fbi.vblank_dont_swap = ((data >> 9) & 1)>0;
 
 	voodoo_swap_buffers(vs);
+
+	triangle_worker_tune(vs->tworker);
 }
 
 
@@ -5,9 +5,17 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <iterator>
 #include <utility>
 #include <vector>
 
+#if defined(HAVE_MMAP)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 #include "cpu/callback.h"
 #include "cpu/registers.h"
 #include "dos/dos.h" /* for Drives[] */
@@ -178,16 +186,6 @@ uint8_t imageDisk::Read_AbsoluteSector(uint32_t sectnum, void* data)
 {
 	const auto bytenum = check_cast<cross_off_t>(sectnum) * sector_size;
 
-	if (last_action == WRITE || bytenum != current_fpos) {
-		if (cross_fseeko(diskimg, bytenum, SEEK_SET) != 0) {
-			LOG_ERR("BIOSDISK: Could not seek to sector %u in file '%s': %s",
-			        sectnum,
-			        diskname,
-			        strerror(errno));
-			return 0xff;
-		}
-	}
-
 	// Only perform delay if we booted from a disk image
 	// Otherwise this would result in delay duplication in the int21 handler
 	if (DOS_IsGuestOsBooted()) {
@@ -195,10 +193,13 @@ uint8_t imageDisk::Read_AbsoluteSector(uint32_t sectnum, void* data)
 		DOS_PerformDiskIoDelay(sector_size, type);
 	}
 
-	size_t ret   = fread(data, 1, sector_size, diskimg);
-	current_fpos = bytenum + ret;
-	last_action  = READ;
-
+	if (!ReadFromImage(bytenum, static_cast<uint8_t*>(data), sector_size)) {
+		LOG_ERR("BIOSDISK: Could not read sector %u from file '%s': %s",
+		        sectnum,
+		        diskname,
+		        strerror(errno));
+		return 0xff;
+	}
 	return 0x00;
 }
 
@@ -218,16 +219,6 @@ uint8_t imageDisk::Write_AbsoluteSector(uint32_t sectnum, void* data)
 
 	// LOG_MSG("Writing sectors to %ld at bytenum %d", sectnum, bytenum);
 
-	if (last_action == READ || bytenum != current_fpos) {
-		if (cross_fseeko(diskimg, bytenum, SEEK_SET) != 0) {
-			LOG_ERR("BIOSDISK: Could not seek to byte %lld in file '%s': %s",
-			        static_cast<long long int>(bytenum),
-			        diskname,
-			        strerror(errno));
-			return 0xff;
-		}
-	}
-
 	// Only perform delay if we booted from a disk image
 	// Otherwise this would result in delay duplication in the int21 handler
 	if (DOS_IsGuestOsBooted()) {
@@ -235,15 +226,276 @@ uint8_t imageDisk::Write_AbsoluteSector(uint32_t sectnum, void* data)
 		DOS_PerformDiskIoDelay(sector_size, type);
 	}
 
-	size_t ret   = fwrite(data, 1, sector_size, diskimg);
-	current_fpos = bytenum + ret;
+	if (!WriteToImage(bytenum, static_cast<const uint8_t*>(data), sector_size)) {
+		return 0x05;
+	}
+	++write_count;
+	return 0x00;
+}
+
+// Block size of the sector cache; a multiple of all the sector sizes
+constexpr uint32_t CacheBlockSize = 4096;
+
+// Up to 16 MB of the image are kept in the cache
+constexpr size_t MaxCacheBlocks = 4096;
+
+static_assert(CacheBlockSize == DifferencingImage::BlockSize,
+              "Cache blocks have to map to the blocks of differencing images");
+
+bool imageDisk::ReadFromImage(const cross_off_t offset, uint8_t* data,
+                              const uint32_t size)
+{
+	if (mapped_image) {
+		// Reading past the end of the image leaves the rest of the
+		// buffer untouched, like a short read from the file
+		const auto start = static_cast<size_t>(offset);
+		if (start < mapped_size) {
+			const auto num_bytes = std::min<size_t>(size, mapped_size - start);
+			std::memcpy(data, mapped_image + start, num_bytes);
+		}
+		return true;
+	}
+
+	auto pos       = static_cast<uint64_t>(offset);
+	auto remaining = size;
+	while (remaining > 0) {
+		const auto block = GetCacheBlock(pos / CacheBlockSize);
+		if (!block) {
+			return false;
+		}
+		const auto block_offset = static_cast<uint32_t>(pos % CacheBlockSize);
+		const auto chunk = std::min(remaining, CacheBlockSize - block_offset);
+
+		if (block_offset < block->num_valid) {
+			const auto num_bytes = std::min(chunk,
+			                                block->num_valid - block_offset);
+			std::memcpy(data, block->data.data() + block_offset, num_bytes);
+		}
+		data += chunk;
+		pos += chunk;
+		remaining -= chunk;
+	}
+	return true;
+}
+
+bool imageDisk::WriteToImage(const cross_off_t offset, const uint8_t* data,
+                             const uint32_t size)
+{
+	// Reject the write up front; caching it would leave a dirty block
+	// that can never be written back
+	if (read_only && !differencing_image) {
+		return false;
+	}
+
+	auto pos       = static_cast<uint64_t>(offset);
+	auto remaining = size;
+	while (remaining > 0) {
+		const auto block = GetCacheBlock(pos / CacheBlockSize);
+		if (!block) {
+			return false;
+		}
+		const auto block_offset = static_cast<uint32_t>(pos % CacheBlockSize);
+		const auto chunk = std::min(remaining, CacheBlockSize - block_offset);
+
+		std::memcpy(block->data.data() + block_offset, data, chunk);
+
+		// Writing past the end of the image extends it; the gap, if
+		// any, reads back as zeros as the block was zero-filled
+		block->num_valid = std::max(block->num_valid, block_offset + chunk);
+		block->is_dirty  = true;
+
+		data += chunk;
+		pos += chunk;
+		remaining -= chunk;
+	}
+	return true;
+}
+
+imageDisk::CacheBlock* imageDisk::GetCacheBlock(const uint64_t index)
+{
+	if (const auto it = cache_index.find(index); it != cache_index.end()) {
+		// Move it to the front of the LRU list
+		cache_blocks.splice(cache_blocks.begin(), cache_blocks, it->second);
+		return &cache_blocks.front();
+	}
+
+	// Reuse the least recently used block if the cache is full
+	if (cache_blocks.size() >= MaxCacheBlocks) {
+		auto& lru_block = cache_blocks.back();
+		if (!WriteBackBlock(lru_block)) {
+			return nullptr;
+		}
+		cache_index.erase(lru_block.index);
+		cache_blocks.splice(cache_blocks.begin(),
+		                    cache_blocks,
+		                    std::prev(cache_blocks.end()));
+	} else {
+		cache_blocks.emplace_front();
+		cache_blocks.front().data.resize(CacheBlockSize);
+	}
+
+	auto& block = cache_blocks.front();
+	block.index     = index;
+	block.num_valid = 0;
+	block.is_dirty  = false;
+	std::fill(block.data.begin(), block.data.end(), 0);
+
+	if (differencing_image) {
+		const auto num_read = differencing_image->ReadBlock(index,
+		                                                    block.data.data());
+		if (!num_read) {
+			cache_blocks.pop_front();
+			return nullptr;
+		}
+		block.num_valid    = *num_read;
+		cache_index[index] = cache_blocks.begin();
+		return &block;
+	}
+
+	const auto block_pos = check_cast<cross_off_t>(index * CacheBlockSize);
+	if (last_action == WRITE || block_pos != current_fpos) {
+		if (cross_fseeko(diskimg, block_pos, SEEK_SET) != 0) {
+			cache_blocks.pop_front();
+			return nullptr;
+		}
+	}
+	const auto num_read = fread(block.data.data(), 1, CacheBlockSize, diskimg);
+	block.num_valid     = check_cast<uint32_t>(num_read);
+	current_fpos        = block_pos + check_cast<cross_off_t>(num_read);
+	last_action         = READ;
+
+	cache_index[index] = cache_blocks.begin();
+	return &block;
+}
+
+bool imageDisk::WriteBackBlock(CacheBlock& block)
+{
+	if (!block.is_dirty) {
+		return true;
+	}
+	if (differencing_image) {
+		if (!differencing_image->WriteBlock(block.index,
+		                                    block.data.data(),
+		                                    block.num_valid)) {
+			return false;
+		}
+		block.is_dirty = false;
+		return true;
+	}
+	const auto block_pos = check_cast<cross_off_t>(block.index * CacheBlockSize);
+	if (last_action == READ || block_pos != current_fpos) {
+		if (cross_fseeko(diskimg, block_pos, SEEK_SET) != 0) {
+			LOG_ERR("BIOSDISK: Could not seek to byte %lld in file '%s': %s",
+			        static_cast<long long int>(block_pos),
+			        diskname,
+			        strerror(errno));
+			return false;
+		}
+	}
+	const auto num_written = fwrite(block.data.data(), 1, block.num_valid, diskimg);
+	current_fpos = block_pos + check_cast<cross_off_t>(num_written);
 	last_action  = WRITE;
 
-	return ((ret > 0) ? 0x00 : 0x05);
+	if (num_written != block.num_valid) {
+		LOG_ERR("BIOSDISK: Could not write to file '%s': %s",
+		        diskname,
+		        strerror(errno));
+		return false;
+	}
+	block.is_dirty = false;
+	return true;
+}
+
+void imageDisk::Flush()
+{
+	bool wrote_blocks = false;
+	for (auto& block : cache_blocks) {
+		wrote_blocks |= block.is_dirty;
+		WriteBackBlock(block);
+	}
+	if (differencing_image) {
+		differencing_image->Flush();
+	} else if (wrote_blocks) {
+		fflush(diskimg);
+	}
+}
+
+void imageDisk::Flush(const uint32_t first_sector, const uint32_t num_sectors)
+{
+	const auto first_byte = static_cast<uint64_t>(first_sector) * sector_size;
+	const auto end_byte = first_byte + static_cast<uint64_t>(num_sectors) * sector_size;
+
+	bool wrote_blocks = false;
+	for (auto index = first_byte / CacheBlockSize;
+	     index * CacheBlockSize < end_byte;
+	     ++index) {
+		const auto it = cache_index.find(index);
+		if (it == cache_index.end()) {
+			continue;
+		}
+		auto& block = *it->second;
+		wrote_blocks |= block.is_dirty;
+		WriteBackBlock(block);
+	}
+	if (!wrote_blocks) {
+		return;
+	}
+	if (differencing_image) {
+		differencing_image->Flush();
+	} else {
+		fflush(diskimg);
+	}
+}
+
+bool imageDisk::AttachDifferencingImage(const std_fs::path& overlay_path)
+{
+	Flush();
+
+	auto image = DifferencingImage::Open(overlay_path, diskname);
+	if (!image) {
+		return false;
+	}
+	differencing_image = std::move(image);
+
+	// From now on the blocks come from the differencing image
+	cache_blocks.clear();
+	cache_index.clear();
+#if defined(HAVE_MMAP)
+	if (mapped_image) {
+		munmap(const_cast<uint8_t*>(mapped_image), mapped_size);
+		mapped_image = nullptr;
+		mapped_size  = 0;
+	}
+#endif
+	return true;
+}
+
+bool imageDisk::CommitDifferencingImage()
+{
+	if (!differencing_image) {
+		return false;
+	}
+	// The contents of the disk stay the same, so the cache stays valid
+	Flush();
+	return differencing_image->Commit();
+}
+
+bool imageDisk::DiscardDifferencingImage()
+{
+	if (!differencing_image) {
+		return false;
+	}
+	cache_blocks.clear();
+	cache_index.clear();
+
+	// Let the users of the disk know its contents have changed
+	++write_count;
+
+	return differencing_image->Discard();
 }
 
 imageDisk::imageDisk(FILE* img_file, const char* img_name, uint32_t img_size_k,
-                     bool is_hdd)
+                     bool is_hdd, bool is_read_only)
         : hardDrive(is_hdd),
           active(false),
           diskimg(img_file),
@@ -252,6 +504,7 @@ imageDisk::imageDisk(FILE* img_file, const char* img_name, uint32_t img_size_k,
           heads(0),
           cylinders(0),
           sectors(0),
+          read_only(is_read_only),
           current_fpos(0),
           last_action(NONE)
 {
@@ -281,6 +534,37 @@ imageDisk::imageDisk(FILE* img_file, const char* img_name, uint32_t img_size_k,
 			incrementFDD();
 		}
 	}
+
+#if defined(HAVE_MMAP)
+	// Map read-only images into memory; writable ones go through the
+	// sector cache
+	const auto fd = cross_fileno(diskimg);
+	if (read_only && fd >= 0) {
+		struct stat image_stat = {};
+		if (fstat(fd, &image_stat) == 0 && image_stat.st_size > 0) {
+			const auto size = static_cast<size_t>(image_stat.st_size);
+			const auto ptr = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+			if (ptr != MAP_FAILED) {
+				mapped_image = static_cast<const uint8_t*>(ptr);
+				mapped_size  = size;
+			}
+		}
+	}
+#endif
+}
+
+imageDisk::~imageDisk()
+{
+#if defined(HAVE_MMAP)
+	if (mapped_image) {
+		munmap(const_cast<uint8_t*>(mapped_image), mapped_size);
+	}
+#endif
+	if (diskimg != nullptr) {
+		Flush();
+		fclose(diskimg);
+	}
+	differencing_image.reset();
 }
 
 void imageDisk::Set_Geometry(uint32_t setHeads, uint32_t setCyl,
@@ -406,6 +690,11 @@ static Bitu INT13_DiskHandler(void)
 		if (!is_machine_pcjr() && reg_dl < 0x80) {
 			reg_ip++;
 		}
+		// Operating systems reset the disks when they are done
+		// writing, e.g., on shutdown
+		if (drivenum < MAX_DISK_IMAGES && imageDiskList[drivenum]) {
+			imageDiskList[drivenum]->Flush();
+		}
 		last_status = 0x00;
 		CALLBACK_SCF(false);
 	} break;
@@ -8,12 +8,17 @@
 
 #include <cstdio>
 #include <array>
+#include <list>
 #include <memory>
+#include <unordered_map>
 #include <vector>
 
 #include "dos/dos.h"
 #include "hardware/memory.h"
 #include "ints/bios.h"
+#include "ints/differencing_image.h"
+#include "misc/cross.h"
+#include "misc/std_filesystem.h"
 
 /* The Section handling Bios Disk Access */
 #define BIOS_MAX_DISK 10
@@ -41,14 +46,45 @@ public:
 	uint8_t GetBiosType(void);
 	uint32_t getSectSize(void);
 
-	imageDisk(FILE *img_file, const char *img_name, uint32_t img_size_k, bool is_hdd);
+	// 'is_read_only' tells whether 'img_file' was opened for reading only;
+	// the sector writes to such images fail unless a differencing image is
+	// attached
+	imageDisk(FILE* img_file, const char* img_name, uint32_t img_size_k,
+	          bool is_hdd, bool is_read_only);
 	imageDisk(const imageDisk&) = delete; // prevent copy
 	imageDisk& operator=(const imageDisk&) = delete; // prevent assignment
 
-	~imageDisk()
+	~imageDisk();
+
+	// Writes the modified sectors held in the cache back to the image file
+	void Flush();
+
+	// Writes the modified sectors of the given range held in the cache back
+	// to the image file, leaving the other ones in the cache
+	void Flush(uint32_t first_sector, uint32_t num_sectors);
+
+	// Redirects the writes to the differencing image at 'overlay_path'
+	// (see differencing_image.h) and reads the modified sectors from it,
+	// leaving the image file itself untouched. Call it before any sectors
+	// are accessed.
+	bool AttachDifferencingImage(const std_fs::path& overlay_path);
+
+	bool HasDifferencingImage() const
+	{
+		return differencing_image != nullptr;
+	}
+
+	// Writes the changes in the differencing image to the image file
+	bool CommitDifferencingImage();
+
+	// Throws away the changes in the differencing image
+	bool DiscardDifferencingImage();
+
+	// Incremented on every sector write, so the users of the disk can tell
+	// when the data they derived from its contents may have become stale
+	uint32_t GetWriteCount() const
 	{
-		if (diskimg != nullptr)
-			fclose(diskimg);
+		return write_count;
 	}
 
 	bool hardDrive;
@@ -60,6 +96,44 @@ public:
 	uint32_t sector_size;
 	uint32_t heads,cylinders,sectors;
 private:
+	bool ReadFromImage(cross_off_t offset, uint8_t* data, uint32_t size);
+	bool WriteToImage(cross_off_t offset, const uint8_t* data, uint32_t size);
+
+	// Sector cache
+	// ~~~~~~~~~~~~
+	// Writable images, and read-only ones that can't be memory-mapped, are
+	// accessed through an LRU cache of fixed-size blocks of the image, so
+	// the consecutive sector accesses of the BIOS and the DOS FAT driver
+	// don't each become a seek and a small read or write on the host.
+	// Modified blocks are written back when they get evicted and on
+	// Flush().
+	struct CacheBlock {
+		uint64_t index = 0; // image offset divided by the block size
+
+		std::vector<uint8_t> data = {};
+
+		// Number of bytes of the block present in the image file
+		uint32_t num_valid = 0;
+		bool is_dirty      = false;
+	};
+	using cache_list_t = std::list<CacheBlock>;
+
+	CacheBlock* GetCacheBlock(uint64_t index);
+	bool WriteBackBlock(CacheBlock& block);
+
+	cache_list_t cache_blocks = {}; // most recently used first
+	std::unordered_map<uint64_t, cache_list_t::iterator> cache_index = {};
+
+	bool read_only = false;
+
+	// Read-only images get mapped into memory if the host supports it
+	const uint8_t* mapped_image = nullptr;
+	size_t mapped_size          = 0;
+
+	uint32_t write_count = 0;
+
+	std::unique_ptr<DifferencingImage> differencing_image = {};
+
 	cross_off_t current_fpos;
 	enum { NONE,READ,WRITE } last_action;
 };
@@ -0,0 +1,329 @@
+// SPDX-FileCopyrightText:  2026-2026 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "differencing_image.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cerrno>
+#include <cstring>
+
+#include "misc/cross.h"
+#include "misc/logging.h"
+#include "utils/checks.h"
+#include "utils/mem_host.h"
+
+CHECK_NARROWING();
+
+constexpr std::array<uint8_t, 8> Magic = {'D', 'B', 'X', 'D', 'I', 'F', 'F', 0};
+constexpr uint32_t FormatVersion       = 1;
+
+constexpr uint64_t HeaderSize = 512;
+
+static bool read_at(FILE* file, const uint64_t offset, uint8_t* data,
+                    const size_t num_bytes)
+{
+	return cross_fseeko(file, static_cast<cross_off_t>(offset), SEEK_SET) == 0 &&
+	       fread(data, 1, num_bytes, file) == num_bytes;
+}
+
+static bool write_at(FILE* file, const uint64_t offset, const uint8_t* data,
+                     const size_t num_bytes)
+{
+	return cross_fseeko(file, static_cast<cross_off_t>(offset), SEEK_SET) == 0 &&
+	       fwrite(data, 1, num_bytes, file) == num_bytes;
+}
+
+std::unique_ptr<DifferencingImage> DifferencingImage::Open(const std_fs::path& overlay_path,
+                                                           const std_fs::path& base_path)
+{
+	std::error_code ec = {};
+
+	const auto base_size = std_fs::file_size(base_path, ec);
+	if (ec) {
+		LOG_WARNING("BIOSDISK: Could not get the size of base image '%s'",
+		            base_path.string().c_str());
+		return nullptr;
+	}
+
+	std::unique_ptr<DifferencingImage> image(new DifferencingImage());
+
+	image->overlay_path = overlay_path;
+	image->base_path    = base_path;
+
+	image->base = fopen(base_path.string().c_str(), "rb");
+	if (!image->base) {
+		LOG_WARNING("BIOSDISK: Could not open base image '%s'",
+		            base_path.string().c_str());
+		return nullptr;
+	}
+
+	if (!std_fs::exists(overlay_path, ec)) {
+		image->overlay = fopen(overlay_path.string().c_str(), "wb+");
+		if (!image->overlay) {
+			LOG_WARNING("BIOSDISK: Could not create differencing image '%s'",
+			            overlay_path.string().c_str());
+			return nullptr;
+		}
+
+		image->base_size  = base_size;
+		image->image_size = base_size;
+		image->num_blocks = std::max<uint64_t>((base_size + BlockSize - 1) / BlockSize,
+		                                       1);
+		image->bitmap.resize((image->num_blocks + 7) / 8);
+
+		image->bitmap_offset = HeaderSize;
+		image->data_offset = (HeaderSize + image->bitmap.size() + BlockSize - 1) /
+		                     BlockSize * BlockSize;
+
+		image->is_header_dirty = true;
+		if (!image->Flush()) {
+			LOG_WARNING("BIOSDISK: Could not write differencing image '%s'",
+			            overlay_path.string().c_str());
+			return nullptr;
+		}
+		LOG_MSG("BIOSDISK: Created differencing image '%s'",
+		        overlay_path.string().c_str());
+		return image;
+	}
+
+	image->overlay = fopen(overlay_path.string().c_str(), "rb+");
+	if (!image->overlay) {
+		LOG_WARNING("BIOSDISK: Could not open differencing image '%s'",
+		            overlay_path.string().c_str());
+		return nullptr;
+	}
+
+	std::array<uint8_t, HeaderSize> header = {};
+	if (!read_at(image->overlay, 0, header.data(), header.size()) ||
+	    !std::equal(Magic.begin(), Magic.end(), header.begin())) {
+		LOG_WARNING("BIOSDISK: '%s' is not a differencing image",
+		            overlay_path.string().c_str());
+		return nullptr;
+	}
+
+	const auto version    = host_readd(&header[8]);
+	const auto block_size = host_readd(&header[12]);
+
+	image->base_size     = host_readq(&header[16]);
+	image->image_size    = host_readq(&header[24]);
+	image->num_blocks    = host_readq(&header[32]);
+	image->bitmap_offset = host_readq(&header[40]);
+	image->data_offset   = host_readq(&header[48]);
+
+	if (version != FormatVersion || block_size != BlockSize) {
+		LOG_WARNING("BIOSDISK: Differencing image '%s' has an unsupported format",
+		            overlay_path.string().c_str());
+		return nullptr;
+	}
+
+	// Catch overlays of other images; we can't detect other changes to
+	// the base image, but a different size is a sure sign
+	if (image->base_size != base_size) {
+		LOG_WARNING("BIOSDISK: Differencing image '%s' doesn't belong to base image '%s'",
+		            overlay_path.string().c_str(),
+		            base_path.string().c_str());
+		return nullptr;
+	}
+
+	image->bitmap.resize((image->num_blocks + 7) / 8);
+	if (!read_at(image->overlay,
+	             image->bitmap_offset,
+	             image->bitmap.data(),
+	             image->bitmap.size())) {
+		LOG_WARNING("BIOSDISK: Could not read differencing image '%s'",
+		            overlay_path.string().c_str());
+		return nullptr;
+	}
+
+	LOG_MSG("BIOSDISK: Opened differencing image '%s' with %llu modified blocks",
+	        overlay_path.string().c_str(),
+	        static_cast<unsigned long long>(image->GetNumModifiedBlocks()));
+	return image;
+}
+
+DifferencingImage::~DifferencingImage()
+{
+	if (overlay) {
+		Flush();
+		fclose(overlay);
+	}
+	if (base) {
+		fclose(base);
+	}
+}
+
+bool DifferencingImage::IsModified(const uint64_t index) const
+{
+	return index < num_blocks && (bitmap[index / 8] & (1 << (index % 8)));
+}
+
+uint64_t DifferencingImage::GetNumModifiedBlocks() const
+{
+	uint64_t count = 0;
+	for (const auto byte : bitmap) {
+		count += static_cast<uint64_t>(std::popcount(byte));
+	}
+	return count;
+}
+
+std::optional<uint32_t> DifferencingImage::ReadBlock(const uint64_t index,
+                                                     uint8_t* data)
+{
+	const auto pos = index * BlockSize;
+	if (pos >= image_size) {
+		return 0;
+	}
+	const auto num_bytes = static_cast<uint32_t>(
+	        std::min<uint64_t>(BlockSize, image_size - pos));
+
+	if (IsModified(index)) {
+		if (!read_at(overlay, data_offset + pos, data, num_bytes)) {
+			return {};
+		}
+		return num_bytes;
+	}
+
+	// The disk might have been extended past the end of the base image
+	std::memset(data, 0, num_bytes);
+	if (pos < base_size) {
+		const auto num_base_bytes = static_cast<size_t>(
+		        std::min<uint64_t>(num_bytes, base_size - pos));
+		if (!read_at(base, pos, data, num_base_bytes)) {
+			return {};
+		}
+	}
+	return num_bytes;
+}
+
+bool DifferencingImage::WriteBlock(const uint64_t index, const uint8_t* data,
+                                   const uint32_t num_bytes)
+{
+	if (index >= num_blocks) {
+		LOG_WARNING("BIOSDISK: Can't write past the end of differencing image '%s'",
+		            overlay_path.string().c_str());
+		return false;
+	}
+
+	const auto pos = index * BlockSize;
+	if (!write_at(overlay, data_offset + pos, data, num_bytes)) {
+		LOG_ERR("BIOSDISK: Could not write to differencing image '%s': %s",
+		        overlay_path.string().c_str(),
+		        strerror(errno));
+		return false;
+	}
+
+	if (!IsModified(index)) {
+		bitmap[index / 8] |= static_cast<uint8_t>(1 << (index % 8));
+		is_header_dirty = true;
+	}
+	if (pos + num_bytes > image_size) {
+		image_size      = pos + num_bytes;
+		is_header_dirty = true;
+	}
+	return true;
+}
+
+bool DifferencingImage::WriteHeader()
+{
+	std::array<uint8_t, HeaderSize> header = {};
+	std::copy(Magic.begin(), Magic.end(), header.begin());
+
+	host_writed(&header[8], FormatVersion);
+	host_writed(&header[12], BlockSize);
+	host_writeq(&header[16], base_size);
+	host_writeq(&header[24], image_size);
+	host_writeq(&header[32], num_blocks);
+	host_writeq(&header[40], bitmap_offset);
+	host_writeq(&header[48], data_offset);
+
+	return write_at(overlay, 0, header.data(), header.size()) &&
+	       write_at(overlay, bitmap_offset, bitmap.data(), bitmap.size());
+}
+
+bool DifferencingImage::Flush()
+{
+	// The blocks are already written, so the bitmap never refers to
+	// missing data, even if the header doesn't make it to the disk
+	if (is_header_dirty) {
+		if (fflush(overlay) != 0 || !WriteHeader()) {
+			return false;
+		}
+		is_header_dirty = false;
+	}
+	return fflush(overlay) == 0;
+}
+
+bool DifferencingImage::Commit()
+{
+	if (!Flush()) {
+		return false;
+	}
+
+	FILE* target = fopen(base_path.string().c_str(), "rb+");
+	if (!target) {
+		LOG_WARNING("BIOSDISK: Could not open base image '%s' for writing",
+		            base_path.string().c_str());
+		return false;
+	}
+
+	std::vector<uint8_t> block(BlockSize);
+
+	auto success = true;
+	for (uint64_t index = 0; index < num_blocks && success; ++index) {
+		if (!IsModified(index)) {
+			continue;
+		}
+		const auto pos       = index * BlockSize;
+		const auto num_bytes = static_cast<size_t>(
+		        std::min<uint64_t>(BlockSize, image_size - pos));
+
+		success = read_at(overlay, data_offset + pos, block.data(), num_bytes) &&
+		          write_at(target, pos, block.data(), num_bytes);
+	}
+	success = (fclose(target) == 0) && success;
+
+	if (!success) {
+		// The overlay is left intact, so committing can be retried
+		LOG_ERR("BIOSDISK: Could not commit differencing image '%s' to '%s': %s",
+		        overlay_path.string().c_str(),
+		        base_path.string().c_str(),
+		        strerror(errno));
+		return false;
+	}
+
+	// Reopen the base image so we don't read stale buffered data
+	fclose(base);
+	base = fopen(base_path.string().c_str(), "rb");
+	if (!base) {
+		LOG_ERR("BIOSDISK: Could not reopen base image '%s'",
+		        base_path.string().c_str());
+		return false;
+	}
+	base_size = std::max(base_size, image_size);
+
+	return Discard();
+}
+
+bool DifferencingImage::Discard()
+{
+	std::fill(bitmap.begin(), bitmap.end(), 0);
+	image_size      = base_size;
+	is_header_dirty = true;
+
+	if (!Flush()) {
+		return false;
+	}
+
+	// Release the space taken by the blocks
+	std::error_code ec = {};
+	std_fs::resize_file(overlay_path, data_offset, ec);
+	if (ec) {
+		LOG_ERR("BIOSDISK: Could not truncate differencing image '%s': %s",
+		        overlay_path.string().c_str(),
+		        ec.message().c_str());
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,97 @@
+// SPDX-FileCopyrightText:  2026-2026 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef DOSBOX_DIFFERENCING_IMAGE_H
+#define DOSBOX_DIFFERENCING_IMAGE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "misc/std_filesystem.h"
+
+// Differencing disk images
+// ~~~~~~~~~~~~~~~~~~~~~~~~
+// A differencing image is a sparse overlay file on top of a read-only base
+// disk image. The disk is accessed in fixed-size blocks: blocks that were
+// written are stored in the overlay, the rest are read from the base image.
+// This lets many instances share one base image, each with a small overlay
+// holding its own changes, which can later be committed into the base image
+// or discarded.
+//
+// Overlay file layout (all values little-endian):
+//
+//   0   8 bytes   magic, "DBXDIFF" followed by a zero byte
+//   8   uint32    format version
+//  12   uint32    block size in bytes
+//  16   uint64    size of the base image in bytes
+//  24   uint64    size of the disk in bytes (the base can get extended)
+//  32   uint64    number of blocks covered by the bitmap
+//  40   uint64    offset of the bitmap
+//  48   uint64    offset of the block data
+//
+// The bitmap has one bit per block, set if the block is in the overlay. Block
+// N is stored at the data offset plus N times the block size, so the overlay
+// file only takes up space for the written blocks on hosts that support
+// sparse files.
+
+class DifferencingImage {
+public:
+	static constexpr uint32_t BlockSize = 4096;
+
+	// Opens the overlay at 'overlay_path' on top of the base image at
+	// 'base_path', creating a new, empty overlay if it doesn't exist yet.
+	// Returns nullptr if the overlay is invalid or was created for a base
+	// image of a different size.
+	static std::unique_ptr<DifferencingImage> Open(const std_fs::path& overlay_path,
+	                                               const std_fs::path& base_path);
+
+	DifferencingImage(const DifferencingImage&)            = delete;
+	DifferencingImage& operator=(const DifferencingImage&) = delete;
+
+	~DifferencingImage();
+
+	// Reads a block of the disk into 'data' and returns the number of bytes
+	// of the block that are within the disk, or nothing on I/O errors
+	std::optional<uint32_t> ReadBlock(uint64_t index, uint8_t* data);
+
+	// Writes the first 'num_bytes' of a block to the overlay
+	bool WriteBlock(uint64_t index, const uint8_t* data, uint32_t num_bytes);
+
+	// Writes the updated bitmap and header to the overlay file
+	bool Flush();
+
+	// Copies the blocks in the overlay into the base image, then empties
+	// the overlay. The base image needs to be writable.
+	bool Commit();
+
+	// Empties the overlay, reverting the disk to the base image
+	bool Discard();
+
+	uint64_t GetNumModifiedBlocks() const;
+
+private:
+	DifferencingImage() = default;
+
+	bool IsModified(uint64_t index) const;
+	bool WriteHeader();
+
+	std_fs::path overlay_path = {};
+	std_fs::path base_path    = {};
+
+	FILE* overlay = nullptr;
+	FILE* base    = nullptr;
+
+	uint64_t base_size     = 0;
+	uint64_t image_size    = 0;
+	uint64_t num_blocks    = 0;
+	uint64_t bitmap_offset = 0;
+	uint64_t data_offset   = 0;
+
+	std::vector<uint8_t> bitmap = {};
+	bool is_header_dirty        = false;
+};
+
+#endif // DOSBOX_DIFFERENCING_IMAGE_H
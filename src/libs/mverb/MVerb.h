@@ -22,6 +22,7 @@
 #endif
 
 #include <cmath>
+#include <cstring>
 
 //forward declaration
 template<typename T, int maxLength> class Allpass;
@@ -108,6 +109,21 @@ public:
         //nowt to do here
     }
 
+    // Like process(), but instead of ramping the parameters to their new
+    // values over the block, they're set at the start of the block. This
+    // gives the same results as processing the block one frame at a time.
+    void processWithoutSmoothing(T **inputs, T **outputs, int sampleFrames){
+        MixSmooth += Mix - MixSmooth;
+        EarlyLateSmooth += EarlyMix - EarlyLateSmooth;
+        BandwidthSmooth += static_cast<T>(((BandwidthFreq * MaxFreq) + 100.0f) - BandwidthSmooth);
+        DampingSmooth += static_cast<T>(((DampingFreq * MaxFreq) + 100.0f) - DampingSmooth);
+        PredelaySmooth += static_cast<T>((PreDelayTime * 200 * (SampleRate / 1000)) - PredelaySmooth);
+        SizeSmooth += static_cast<T>(Size - SizeSmooth);
+        DecaySmooth += static_cast<T>(((0.7995f * Decay) + 0.005) - DecaySmooth);
+        DensitySmooth += static_cast<T>(((0.7995f * Density1) + 0.005) - DensitySmooth);
+        process(inputs, outputs, sampleFrames);
+    }
+
     void process(T **inputs, T **outputs, int sampleFrames){
         T OneOverSampleFrames = static_cast<T>(1. / sampleFrames);
         T MixDelta	= (Mix - MixSmooth) * OneOverSampleFrames;
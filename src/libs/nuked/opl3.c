@@ -88,6 +88,10 @@
  *   - Compatibility switches OPL_COMPAT_OLD_EG (pre-2024 envelope stepping)
  *     and OPL_COMPAT_DEFERRED_4OP_ALG (pre-Nov-2022 4-op routing update),
  *     both default-off; see opl3.h.
+ *   - OPL_ENABLE_SIMD (default-off) adds OPL3_GenerateStreamSimd, which keeps
+ *     the envelope and phase generator state of the 36 slots in lanes and
+ *     steps 8 slots at a time with SSE2 (via simde). Operator output and the
+ *     mix stay scalar: each operator depends on the previous one's output.
  */
 
 #include <stddef.h>
@@ -96,6 +100,13 @@
 #include <string.h>
 #include "opl3.h"
 
+#if OPL_ENABLE_SIMD
+#include "simde/x86/sse2.h"
+#endif
+
+/* Structure-of-arrays slot state of the vectorised generator */
+typedef struct _opl3_simd_slots opl3_simd_slots;
+
 #if OPL_WF_TABLE_RUNTIME
 
 /* Base logsin quarter-wave table from upstream Nuked-OPL3. logsin_wf is
@@ -1309,6 +1320,34 @@ static void OPL3_ProcessSlotRhythm(opl3_slot *slot, uint8_t fb)
     OPL3_ProcessSlotImpl(slot, fb, 1);
 }
 
+/* Try to mark the slot dormant, which requires that *mod and *trem stay zero
+ * without reprocessing. trem must be frozen at zeromod. mod may be zeromod,
+ * the slot's own fbmod (unchanged while the slot is skipped), or another
+ * slot's out; that slot is always earlier in processing order, so if it is
+ * dormant now, its out stays 0 for exactly as long as this slot's own gate
+ * holds (any register write invalidates both). */
+static inline void OPL3_SlotTryMarkDormant(opl3_slot *slot, uint32_t write_gen)
+{
+    opl3_chip *chip = slot->chip;
+    if (slot->trem == (uint8_t*)&chip->zeromod)
+    {
+        int16_t *m = slot->mod;
+        if (m == &chip->zeromod || m == &slot->fbmod)
+        {
+            slot->dormant_gen = write_gen;
+        }
+        else
+        {
+            /* m is &src->out for some slot src */
+            opl3_slot *src = (opl3_slot *)((char *)m - offsetof(opl3_slot, out));
+            if (src->dormant_gen == write_gen)
+            {
+                slot->dormant_gen = write_gen;
+            }
+        }
+    }
+}
+
 /* Inlined pre-check skipping the ProcessSlot call for trivially-silent slots.
  * The prout == 0 and eg_gen == release conditions are critical because their
  * silence values are not implied by the other conditions (a key-on pulse with
@@ -1332,31 +1371,7 @@ static inline void OPL3_ProcessSlotMaybeInline(opl3_slot *slot, uint8_t fb, int
         && *slot->mod == 0 && slot->eg_tl_ksl == 0 && *slot->trem == 0
         && slot->pg_phase == 0 && slot->reg_vib == 0 && slot->reg_wf == 0)
     {
-        /* Try to mark the slot dormant, which requires that *mod and *trem
-         * stay zero without reprocessing. trem must be frozen at zeromod.
-         * mod may be zeromod, the slot's own fbmod (unchanged while the slot
-         * is skipped), or another slot's out; that slot is always earlier in
-         * processing order, so if it is dormant now, its out stays 0 for
-         * exactly as long as this slot's own gate holds (any register write
-         * invalidates both). */
-        opl3_chip *chip = slot->chip;
-        if (slot->trem == (uint8_t*)&chip->zeromod)
-        {
-            int16_t *m = slot->mod;
-            if (m == &chip->zeromod || m == &slot->fbmod)
-            {
-                slot->dormant_gen = write_gen;
-            }
-            else
-            {
-                /* m is &src->out for some slot src */
-                opl3_slot *src = (opl3_slot *)((char *)m - offsetof(opl3_slot, out));
-                if (src->dormant_gen == write_gen)
-                {
-                    slot->dormant_gen = write_gen;
-                }
-            }
-        }
+        OPL3_SlotTryMarkDormant(slot, write_gen);
         return;
     }
     if (maybe_rhythm)
@@ -1419,7 +1434,389 @@ static void OPL3_MixRight(opl3_chip *chip)
     chip->mixbuff[3] = mix1;
 }
 
-void OPL3_Generate4Ch(opl3_chip *chip, int16_t *buf4)
+#if OPL_ENABLE_SIMD
+
+/* Vectorised slot processing (OPL3_GenerateStreamSimd)
+ *
+ * The envelope and phase generators of the 36 slots only depend on the
+ * slot's own state and the chip-wide timers, so they run in parallel SIMD
+ * lanes: 16-bit lanes for the envelope generator, 32-bit lanes for the phase
+ * accumulators. The slots' state is kept in structure-of-arrays form for the
+ * length of a stream call. The register-controlled inputs are regathered
+ * after every register write (write_gen bump) and the per-sample outputs are
+ * written back to the slots, so the operator output, feedback, and mixing
+ * stages run unchanged in slot order. They can't be vectorised: every
+ * operator's phase is modulated by the output of the one before it.
+ *
+ * The lanes always take the full envelope path, which gives the same results
+ * as the scalar fast paths. Dormant slots are skipped like in the scalar
+ * generator, and so are whole vectors of them. The rhythm-mode phase
+ * overrides of slots 13, 16, and 17 are applied per slot after the vector
+ * pass, in processing order. */
+
+#define OPL_SIMD_LANES 40 /* 36 slots rounded up to a whole 8-lane vector */
+
+struct _opl3_simd_slots {
+    /* Envelope generator state and inputs (16-bit lanes; masks are 0xffff) */
+    uint16_t eg_rout[OPL_SIMD_LANES];
+    uint16_t eg_gen[OPL_SIMD_LANES];
+    uint16_t eg_out[OPL_SIMD_LANES];
+    uint16_t pg_reset[OPL_SIMD_LANES];
+    uint16_t key_mask[OPL_SIMD_LANES];
+    uint16_t trem_mask[OPL_SIMD_LANES];
+    uint16_t eg_tl_ksl[OPL_SIMD_LANES];
+    uint16_t reg_sl[OPL_SIMD_LANES];
+    uint16_t rate_nonzero[4][OPL_SIMD_LANES];
+    uint16_t rate_hi[4][OPL_SIMD_LANES];
+    uint16_t rate_lo[4][OPL_SIMD_LANES];
+
+    /* Phase generator state and inputs (32-bit lanes) */
+    uint32_t pg_phase[OPL_SIMD_LANES];
+    uint32_t pg_phase_out[OPL_SIMD_LANES];
+    uint32_t pg_inc[OPL_SIMD_LANES];
+
+    uint32_t write_gen;
+    uint8_t vibpos;
+};
+
+/* Resolves the phase increments for the current vibrato position */
+static void OPL3_SimdUpdatePhaseInc(opl3_chip *chip, opl3_simd_slots *simd)
+{
+    uint8_t ii;
+    for (ii = 0; ii < 36; ii++)
+    {
+        const opl3_slot *slot = &chip->slot[ii];
+        simd->pg_inc[ii] = slot->reg_vib ? slot->pg_inc_vib[chip->vibpos] : slot->pg_inc;
+    }
+    simd->vibpos = chip->vibpos;
+}
+
+/* Gathers the inputs set by register writes */
+static void OPL3_SimdGatherRegs(opl3_chip *chip, opl3_simd_slots *simd)
+{
+    uint8_t ii, gen;
+    for (ii = 0; ii < 36; ii++)
+    {
+        const opl3_slot *slot = &chip->slot[ii];
+        simd->key_mask[ii] = slot->key ? 0xffff : 0;
+        simd->trem_mask[ii] = (slot->trem != (uint8_t*)&chip->zeromod) ? 0xffff : 0;
+        simd->eg_tl_ksl[ii] = slot->eg_tl_ksl;
+        simd->reg_sl[ii] = slot->reg_sl;
+        for (gen = 0; gen < 4; gen++)
+        {
+            simd->rate_nonzero[gen][ii] = slot->eg_rates[gen] ? 0xffff : 0;
+            simd->rate_hi[gen][ii] = slot->eg_rate_hi[gen];
+            simd->rate_lo[gen][ii] = slot->eg_rate_lo[gen];
+        }
+    }
+    OPL3_SimdUpdatePhaseInc(chip, simd);
+    simd->write_gen = chip->write_gen;
+}
+
+static void OPL3_SimdGather(opl3_chip *chip, opl3_simd_slots *simd)
+{
+    uint8_t ii;
+    memset(simd, 0, sizeof(*simd));
+    for (ii = 0; ii < 36; ii++)
+    {
+        const opl3_slot *slot = &chip->slot[ii];
+        simd->eg_rout[ii] = slot->eg_rout;
+        simd->eg_gen[ii] = slot->eg_gen;
+        simd->pg_phase[ii] = slot->pg_phase;
+    }
+    OPL3_SimdGatherRegs(chip, simd);
+}
+
+static void OPL3_SimdScatter(opl3_chip *chip, const opl3_simd_slots *simd)
+{
+    uint8_t ii;
+    for (ii = 0; ii < 36; ii++)
+    {
+        opl3_slot *slot = &chip->slot[ii];
+        slot->eg_rout = simd->eg_rout[ii];
+        slot->eg_gen = (uint8_t)simd->eg_gen[ii];
+        slot->pg_reset = simd->pg_reset[ii] & 1;
+        slot->pg_phase = simd->pg_phase[ii];
+    }
+}
+
+#define OPL_SIMD_LOAD(p) simde_mm_loadu_si128((const simde__m128i*)(p))
+#define OPL_SIMD_STORE(p, v) simde_mm_storeu_si128((simde__m128i*)(p), (v))
+
+/* (mask & a) | (~mask & b) */
+static inline simde__m128i OPL3_SimdSelect(simde__m128i mask, simde__m128i a, simde__m128i b)
+{
+    return simde_mm_or_si128(simde_mm_and_si128(mask, a), simde_mm_andnot_si128(mask, b));
+}
+
+/* OPL3_EnvelopeCalc for 8 slots, followed by the phase accumulator update of
+ * OPL3_PhaseGenerate */
+static inline void OPL3_SimdEnvelopePhase8(opl3_simd_slots *simd, uint8_t base,
+                                           simde__m128i tremolo, simde__m128i eg_add,
+                                           simde__m128i eg_state, simde__m128i incstep[4])
+{
+    const simde__m128i zero = simde_mm_setzero_si128();
+    const simde__m128i ones = simde_mm_set1_epi16(-1);
+    const simde__m128i one = simde_mm_set1_epi16(1);
+    const simde__m128i two = simde_mm_set1_epi16(2);
+    const simde__m128i three = simde_mm_set1_epi16(3);
+    const simde__m128i mask_1ff = simde_mm_set1_epi16(0x1ff);
+    const simde__m128i mask_1f8 = simde_mm_set1_epi16(0x1f8);
+
+    simde__m128i rout = OPL_SIMD_LOAD(&simd->eg_rout[base]);
+    simde__m128i gen = OPL_SIMD_LOAD(&simd->eg_gen[base]);
+    simde__m128i key = OPL_SIMD_LOAD(&simd->key_mask[base]);
+    simde__m128i eg_out, reset, gen_eff, nonzero, rate_hi, rate_lo, shift;
+    simde__m128i low_shift, high_shift, is_low, step, sel;
+    simde__m128i is_attack, is_decay, eg_off, rout_zero, sl_hit, shift_pos, rate_hi_max;
+    simde__m128i eg_rout, attack_inc, pow_inc, inc, not_rout;
+    simde__m128i cond_attack, cond_dsr, new_gen;
+    simde__m128i phase, reset32, inc32;
+    uint8_t gen_num, lane;
+
+    eg_out = simde_mm_add_epi16(rout, OPL_SIMD_LOAD(&simd->eg_tl_ksl[base]));
+    eg_out = simde_mm_add_epi16(eg_out, simde_mm_and_si128(OPL_SIMD_LOAD(&simd->trem_mask[base]), tremolo));
+    OPL_SIMD_STORE(&simd->eg_out[base], eg_out);
+
+    reset = simde_mm_and_si128(key, simde_mm_cmpeq_epi16(gen, three));
+    OPL_SIMD_STORE(&simd->pg_reset[base], reset);
+
+    /* Rates of the current envelope stage (of the attack on a key-on) */
+    gen_eff = simde_mm_andnot_si128(reset, gen);
+    nonzero = zero;
+    rate_hi = zero;
+    rate_lo = zero;
+    for (gen_num = 0; gen_num < 4; gen_num++)
+    {
+        sel = simde_mm_cmpeq_epi16(gen_eff, simde_mm_set1_epi16(gen_num));
+        nonzero = simde_mm_or_si128(nonzero, simde_mm_and_si128(sel, OPL_SIMD_LOAD(&simd->rate_nonzero[gen_num][base])));
+        rate_hi = simde_mm_or_si128(rate_hi, simde_mm_and_si128(sel, OPL_SIMD_LOAD(&simd->rate_hi[gen_num][base])));
+        rate_lo = simde_mm_or_si128(rate_lo, simde_mm_and_si128(sel, OPL_SIMD_LOAD(&simd->rate_lo[gen_num][base])));
+    }
+
+    /* Rates below 12 step on eg_state cycles once eg_shift reaches 12 */
+    {
+        simde__m128i eg_shift = simde_mm_add_epi16(rate_hi, eg_add);
+        simde__m128i s12 = simde_mm_and_si128(simde_mm_cmpeq_epi16(eg_shift, simde_mm_set1_epi16(12)), one);
+        simde__m128i s13 = simde_mm_and_si128(simde_mm_cmpeq_epi16(eg_shift, simde_mm_set1_epi16(13)),
+                                              simde_mm_and_si128(simde_mm_srli_epi16(rate_lo, 1), one));
+        simde__m128i s14 = simde_mm_and_si128(simde_mm_cmpeq_epi16(eg_shift, simde_mm_set1_epi16(14)),
+                                              simde_mm_and_si128(rate_lo, one));
+        low_shift = simde_mm_and_si128(simde_mm_or_si128(s12, simde_mm_or_si128(s13, s14)),
+                                       simde_mm_cmpeq_epi16(eg_state, one));
+    }
+
+    /* Higher rates step every sample */
+    step = zero;
+    for (gen_num = 0; gen_num < 4; gen_num++)
+    {
+        /* eg_incstep[rate_lo][timer], the timer being fixed per sample */
+        sel = simde_mm_cmpeq_epi16(rate_lo, simde_mm_set1_epi16(gen_num));
+        step = simde_mm_or_si128(step, simde_mm_and_si128(sel, incstep[gen_num]));
+    }
+    high_shift = simde_mm_add_epi16(simde_mm_and_si128(rate_hi, three), step);
+    high_shift = OPL3_SimdSelect(simde_mm_cmpeq_epi16(simde_mm_and_si128(high_shift, simde_mm_set1_epi16(4)),
+                                                      simde_mm_set1_epi16(4)),
+                                 three, high_shift);
+    high_shift = OPL3_SimdSelect(simde_mm_cmpeq_epi16(high_shift, zero), eg_state, high_shift);
+
+    is_low = simde_mm_cmpgt_epi16(simde_mm_set1_epi16(12), rate_hi);
+    shift = simde_mm_and_si128(nonzero, OPL3_SimdSelect(is_low, low_shift, high_shift));
+
+    /* Next envelope level */
+    is_attack = simde_mm_cmpeq_epi16(gen, zero);
+    is_decay = simde_mm_cmpeq_epi16(gen, one);
+    rate_hi_max = simde_mm_cmpeq_epi16(rate_hi, simde_mm_set1_epi16(0x0f));
+    eg_off = simde_mm_cmpeq_epi16(simde_mm_and_si128(rout, mask_1f8), mask_1f8);
+    rout_zero = simde_mm_cmpeq_epi16(rout, zero);
+    sl_hit = simde_mm_and_si128(is_decay,
+                                simde_mm_cmpeq_epi16(simde_mm_srli_epi16(rout, 4),
+                                                     OPL_SIMD_LOAD(&simd->reg_sl[base])));
+    shift_pos = simde_mm_cmpgt_epi16(shift, zero);
+
+    /* Instant attack */
+    eg_rout = simde_mm_andnot_si128(simde_mm_and_si128(reset, rate_hi_max), rout);
+    /* Envelope off */
+    eg_rout = simde_mm_or_si128(eg_rout,
+                                simde_mm_and_si128(simde_mm_andnot_si128(simde_mm_or_si128(is_attack, reset), eg_off),
+                                                   mask_1ff));
+
+    /* Attack: ~eg_rout >> (4 - shift) */
+    not_rout = simde_mm_xor_si128(rout, ones);
+    attack_inc = simde_mm_and_si128(simde_mm_cmpeq_epi16(shift, one), simde_mm_srai_epi16(not_rout, 3));
+    attack_inc = simde_mm_or_si128(attack_inc, simde_mm_and_si128(simde_mm_cmpeq_epi16(shift, two),
+                                                                  simde_mm_srai_epi16(not_rout, 2)));
+    attack_inc = simde_mm_or_si128(attack_inc, simde_mm_and_si128(simde_mm_cmpeq_epi16(shift, three),
+                                                                  simde_mm_srai_epi16(not_rout, 1)));
+    cond_attack = simde_mm_and_si128(simde_mm_andnot_si128(rout_zero, is_attack),
+                                     simde_mm_andnot_si128(rate_hi_max, simde_mm_and_si128(key, shift_pos)));
+
+    /* Decay, sustain, and release: 1 << (shift - 1) */
+    pow_inc = simde_mm_and_si128(simde_mm_cmpeq_epi16(shift, one), one);
+    pow_inc = simde_mm_or_si128(pow_inc, simde_mm_and_si128(simde_mm_cmpeq_epi16(shift, two), two));
+    pow_inc = simde_mm_or_si128(pow_inc, simde_mm_and_si128(simde_mm_cmpeq_epi16(shift, three),
+                                                            simde_mm_set1_epi16(4)));
+    cond_dsr = simde_mm_andnot_si128(simde_mm_or_si128(simde_mm_or_si128(is_attack, sl_hit),
+                                                       simde_mm_or_si128(eg_off, reset)),
+                                     shift_pos);
+
+    inc = simde_mm_or_si128(simde_mm_and_si128(cond_attack, attack_inc),
+                            simde_mm_and_si128(cond_dsr, pow_inc));
+    eg_rout = simde_mm_and_si128(simde_mm_add_epi16(eg_rout, inc), mask_1ff);
+    OPL_SIMD_STORE(&simd->eg_rout[base], eg_rout);
+
+    /* Next envelope stage */
+    new_gen = OPL3_SimdSelect(simde_mm_and_si128(is_attack, rout_zero), one, gen);
+    new_gen = OPL3_SimdSelect(sl_hit, two, new_gen);
+    new_gen = simde_mm_andnot_si128(reset, new_gen);
+    new_gen = simde_mm_or_si128(new_gen, simde_mm_andnot_si128(key, three));
+    OPL_SIMD_STORE(&simd->eg_gen[base], new_gen);
+
+    /* Phase accumulators, 4 slots at a time */
+    for (lane = 0; lane < 8; lane += 4)
+    {
+        reset32 = lane ? simde_mm_unpackhi_epi16(reset, reset) : simde_mm_unpacklo_epi16(reset, reset);
+        phase = OPL_SIMD_LOAD(&simd->pg_phase[base + lane]);
+        inc32 = OPL_SIMD_LOAD(&simd->pg_inc[base + lane]);
+        OPL_SIMD_STORE(&simd->pg_phase_out[base + lane], simde_mm_srli_epi32(phase, 9));
+        phase = simde_mm_add_epi32(simde_mm_andnot_si128(reset32, phase), inc32);
+        OPL_SIMD_STORE(&simd->pg_phase[base + lane], phase);
+    }
+}
+
+/* The rhythm-mode part of OPL3_PhaseGenerateImpl for slots 13, 16, and 17 */
+static void OPL3_SimdRhythmPhase(opl3_chip *chip, opl3_simd_slots *simd)
+{
+    uint16_t phase;
+    uint8_t rm_xor;
+
+    /* hh */
+    phase = (uint16_t)simd->pg_phase_out[13];
+    chip->rm_hh_bit2 = (phase >> 2) & 1;
+    chip->rm_hh_bit3 = (phase >> 3) & 1;
+    chip->rm_hh_bit7 = (phase >> 7) & 1;
+    chip->rm_hh_bit8 = (phase >> 8) & 1;
+    if (!(chip->rhy & 0x20))
+    {
+        return;
+    }
+    rm_xor = (chip->rm_hh_bit2 ^ chip->rm_hh_bit7)
+           | (chip->rm_hh_bit3 ^ chip->rm_tc_bit5)
+           | (chip->rm_tc_bit3 ^ chip->rm_tc_bit5);
+    simd->pg_phase_out[13] = (rm_xor << 9) | ((rm_xor ^ (chip->noise_hh & 1)) ? 0xd0 : 0x34);
+
+    /* sd */
+    simd->pg_phase_out[16] = (chip->rm_hh_bit8 << 9)
+                           | ((chip->rm_hh_bit8 ^ (chip->noise_sd & 1)) << 8);
+
+    /* tc */
+    phase = (uint16_t)simd->pg_phase_out[17];
+    chip->rm_tc_bit3 = (phase >> 3) & 1;
+    chip->rm_tc_bit5 = (phase >> 5) & 1;
+    rm_xor = (chip->rm_hh_bit2 ^ chip->rm_hh_bit7)
+           | (chip->rm_hh_bit3 ^ chip->rm_tc_bit5)
+           | (chip->rm_tc_bit3 ^ chip->rm_tc_bit5);
+    simd->pg_phase_out[17] = (rm_xor << 9) | 0x80;
+}
+
+/* The vector pass can skip a group of 8 slots once they're all dormant */
+static inline int OPL3_SimdGroupDormant(const opl3_chip *chip, uint8_t base, uint32_t write_gen)
+{
+    uint8_t ii;
+    for (ii = base; ii < base + 8 && ii < 36; ii++)
+    {
+        if (chip->slot[ii].dormant_gen != write_gen)
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* The scalar generator's trivially-silent check (OPL3_ProcessSlotMaybeInline)
+ * evaluated on the state after processing the slot, which is the state the
+ * next sample would start from */
+static inline void OPL3_SimdMaybeMarkDormant(const opl3_simd_slots *simd, opl3_slot *slot,
+                                             uint8_t fb, uint32_t write_gen)
+{
+    const uint8_t n = slot->slot_num;
+    if (!slot->key && simd->eg_rout[n] == 0x1ff
+        && simd->eg_gen[n] == envelope_gen_num_release
+        && n != 13 && n != 16 && n != 17
+        && fb == 0 && slot->pg_inc == 0 && slot->out == 0
+        && slot->prout == 0
+        && *slot->mod == 0 && slot->eg_tl_ksl == 0 && *slot->trem == 0
+        && simd->pg_phase[n] == 0 && slot->reg_vib == 0 && slot->reg_wf == 0)
+    {
+        OPL3_SlotTryMarkDormant(slot, write_gen);
+    }
+}
+
+static void OPL3_ProcessSlotsSimd(opl3_chip *chip, opl3_simd_slots *simd)
+{
+    simde__m128i incstep[4];
+    simde__m128i tremolo, eg_add, eg_state;
+    uint32_t write_gen = chip->write_gen;
+    uint8_t ii, timer_lo;
+
+    if (simd->write_gen != chip->write_gen)
+    {
+        OPL3_SimdGatherRegs(chip, simd);
+    }
+    else if (simd->vibpos != chip->vibpos)
+    {
+        OPL3_SimdUpdatePhaseInc(chip, simd);
+    }
+
+#if OPL_COMPAT_OLD_EG
+    timer_lo = chip->timer & 0x03u;
+#else
+    timer_lo = chip->eg_timer_lo;
+#endif
+    for (ii = 0; ii < 4; ii++)
+    {
+        incstep[ii] = simde_mm_set1_epi16(eg_incstep[ii][timer_lo]);
+    }
+    tremolo = simde_mm_set1_epi16(chip->tremolo);
+    eg_add = simde_mm_set1_epi16(chip->eg_add);
+    eg_state = simde_mm_set1_epi16(chip->eg_state);
+
+    for (ii = 0; ii < OPL_SIMD_LANES; ii += 8)
+    {
+        if (!OPL3_SimdGroupDormant(chip, ii, write_gen))
+        {
+            OPL3_SimdEnvelopePhase8(simd, ii, tremolo, eg_add, eg_state, incstep);
+        }
+    }
+    OPL3_SimdRhythmPhase(chip, simd);
+
+    /* Operator output and feedback, in slot order */
+    for (ii = 0; ii < 18; ii++)
+    {
+        opl3_channel *channel = &chip->channel[ii];
+        uint8_t fb = channel->fb;
+        uint8_t jj;
+        for (jj = 0; jj < 2; jj++)
+        {
+            opl3_slot *slot = channel->slotz[jj];
+            if (slot->dormant_gen == write_gen)
+            {
+                continue;
+            }
+            slot->eg_out = simd->eg_out[slot->slot_num];
+            slot->pg_phase_out = (uint16_t)simd->pg_phase_out[slot->slot_num];
+            OPL3_SlotCalcFB(slot, fb);
+            OPL3_SlotGenerate(slot);
+            OPL3_SimdMaybeMarkDormant(simd, slot, fb, write_gen);
+        }
+    }
+}
+
+#endif /* OPL_ENABLE_SIMD */
+
+/* simd is NULL for the scalar generator; the compiler drops the branch from
+ * the scalar clone. */
+static inline void OPL3_Generate4ChImpl(opl3_chip *chip, int16_t *buf4, opl3_simd_slots *simd)
 {
     opl3_channel *channel;
     opl3_writebuf *writebuf;
@@ -1467,6 +1864,15 @@ void OPL3_Generate4Ch(opl3_chip *chip, int16_t *buf4)
     /* Process all 36 slots (channel-grouped pairs) before either mix pass.
      * The mixes read the delayed slots' previous-sample out through prout
      * via the out_left/out_right pointer lists. */
+#if OPL_ENABLE_SIMD
+    if (simd)
+    {
+        OPL3_ProcessSlotsSimd(chip, simd);
+    }
+    else
+#else
+    (void)simd;
+#endif
     {
         uint32_t write_gen = chip->write_gen;
         for (ii = 0; ii < 7; ii++)
@@ -1626,6 +2032,11 @@ void OPL3_Generate4Ch(opl3_chip *chip, int16_t *buf4)
     chip->writebuf_samplecnt++;
 }
 
+void OPL3_Generate4Ch(opl3_chip *chip, int16_t *buf4)
+{
+    OPL3_Generate4ChImpl(chip, buf4, NULL);
+}
+
 void OPL3_Generate(opl3_chip *chip, int16_t *buf)
 {
     int16_t samples[4];
@@ -1634,7 +2045,7 @@ void OPL3_Generate(opl3_chip *chip, int16_t *buf)
     buf[1] = samples[1];
 }
 
-void OPL3_Generate4ChResampled(opl3_chip *chip, int16_t *buf4)
+static inline void OPL3_Generate4ChResampledImpl(opl3_chip *chip, int16_t *buf4, opl3_simd_slots *simd)
 {
     while (chip->samplecnt >= chip->rateratio)
     {
@@ -1642,7 +2053,7 @@ void OPL3_Generate4ChResampled(opl3_chip *chip, int16_t *buf4)
         chip->oldsamples[1] = chip->samples[1];
         chip->oldsamples[2] = chip->samples[2];
         chip->oldsamples[3] = chip->samples[3];
-        OPL3_Generate4Ch(chip, chip->samples);
+        OPL3_Generate4ChImpl(chip, chip->samples, simd);
         chip->samplecnt -= chip->rateratio;
     }
     buf4[0] = (int16_t)((chip->oldsamples[0] * (chip->rateratio - chip->samplecnt)
@@ -1656,6 +2067,11 @@ void OPL3_Generate4ChResampled(opl3_chip *chip, int16_t *buf4)
     chip->samplecnt += 1 << RSM_FRAC;
 }
 
+void OPL3_Generate4ChResampled(opl3_chip *chip, int16_t *buf4)
+{
+    OPL3_Generate4ChResampledImpl(chip, buf4, NULL);
+}
+
 void OPL3_GenerateResampled(opl3_chip *chip, int16_t *buf)
 {
     int16_t samples[4];
@@ -1935,3 +2351,22 @@ void OPL3_GenerateStream(opl3_chip *chip, int16_t *sndptr, uint32_t numsamples)
         sndptr += 2;
     }
 }
+
+#if OPL_ENABLE_SIMD
+void OPL3_GenerateStreamSimd(opl3_chip *chip, int16_t *sndptr, uint32_t numsamples)
+{
+    opl3_simd_slots simd;
+    uint_fast32_t i;
+    int16_t samples[4];
+
+    OPL3_SimdGather(chip, &simd);
+    for(i = 0; i < numsamples; i++)
+    {
+        OPL3_Generate4ChResampledImpl(chip, samples, &simd);
+        sndptr[0] = samples[0];
+        sndptr[1] = samples[1];
+        sndptr += 2;
+    }
+    OPL3_SimdScatter(chip, &simd);
+}
+#endif
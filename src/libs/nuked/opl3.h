@@ -53,6 +53,8 @@
  *     table in place of wf_rom.h).
  *   - Added the OPL_COMPAT_OLD_EG and OPL_COMPAT_DEFERRED_4OP_ALG build
  *     options (parity with older upstream commits).
+ *   - Added the OPL_ENABLE_SIMD build option and OPL3_GenerateStreamSimd
+ *     (vectorised envelope and phase generators).
  */
 
 #ifndef OPL_OPL3_H
@@ -104,6 +106,15 @@ extern "C" {
 #define OPL_COMPAT_DEFERRED_4OP_ALG 0
 #endif
 
+/* OPL_ENABLE_SIMD=1 adds OPL3_GenerateStreamSimd, a variant of
+ * OPL3_GenerateStream that runs the envelope and phase generators of all 36
+ * slots in parallel SIMD lanes. Its output is identical to the scalar
+ * generator's. Requires the SIMD Everywhere (simde) headers. Build
+ * opl3_simd.c to add it next to a plain build of opl3.c. */
+#ifndef OPL_ENABLE_SIMD
+#define OPL_ENABLE_SIMD 0
+#endif
+
 #define OPL_WRITEBUF_SIZE   1024
 #define OPL_WRITEBUF_DELAY  2
 
@@ -266,6 +277,9 @@ void OPL3_Reset(opl3_chip *chip, uint32_t samplerate);
 void OPL3_WriteReg(opl3_chip *chip, uint16_t reg, uint8_t v);
 void OPL3_WriteRegBuffered(opl3_chip *chip, uint16_t reg, uint8_t v);
 void OPL3_GenerateStream(opl3_chip *chip, int16_t *sndptr, uint32_t numsamples);
+#if OPL_ENABLE_SIMD
+void OPL3_GenerateStreamSimd(opl3_chip *chip, int16_t *sndptr, uint32_t numsamples);
+#endif
 
 void OPL3_Generate4Ch(opl3_chip *chip, int16_t *buf4);
 void OPL3_Generate4ChResampled(opl3_chip *chip, int16_t *buf4);
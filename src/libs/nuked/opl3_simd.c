@@ -0,0 +1,53 @@
+/* Nuked OPL3
+ *
+ * Copyright (C) 2013-2020 Nuke.YKT
+ * Copyright (C) 2026 Tony Gies (Nuked-OPL3-fast modifications)
+ *
+ * This file is part of Nuked OPL3.
+ *
+ * Nuked OPL3 is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * Nuked OPL3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Nuked OPL3. If not, see <https://www.gnu.org/licenses/>.
+ *
+ *  Standalone build of OPL3_GenerateStreamSimd.
+ *
+ *  The vectorised generator shares the slot, envelope, and mix code of
+ *  opl3.c, which is all static, so it is built from the same source. The
+ *  scalar entry points of this copy are renamed to OPL3Simd_* so that
+ *  OPL3_GenerateStreamSimd is the only OPL3_* symbol this object defines,
+ *  and it can be linked next to a plain build of opl3.c in any order. The
+ *  chip state is the same struct, so a chip set up and written to with the
+ *  plain OPL3_Reset and OPL3_WriteRegBuffered can be rendered with either
+ *  generator.
+ *
+ *  Not supported together with OPL_WF_TABLE_RUNTIME: this copy's waveform
+ *  table would only be built by OPL3Simd_Reset, which nothing calls.
+ */
+
+#if OPL_WF_TABLE_RUNTIME
+#error "opl3_simd.c needs the compiled-in waveform table (wf_rom.h)"
+#endif
+
+#undef OPL_ENABLE_SIMD
+#define OPL_ENABLE_SIMD 1
+
+#define OPL3_Generate             OPL3Simd_Generate
+#define OPL3_GenerateResampled    OPL3Simd_GenerateResampled
+#define OPL3_Reset                OPL3Simd_Reset
+#define OPL3_WriteReg             OPL3Simd_WriteReg
+#define OPL3_WriteRegBuffered     OPL3Simd_WriteRegBuffered
+#define OPL3_GenerateStream       OPL3Simd_GenerateStream
+#define OPL3_Generate4Ch          OPL3Simd_Generate4Ch
+#define OPL3_Generate4ChResampled OPL3Simd_Generate4ChResampled
+#define OPL3_Generate4ChStream    OPL3Simd_Generate4ChStream
+
+#include "opl3.c"
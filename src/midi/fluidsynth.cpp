@@ -736,7 +736,8 @@ MidiDeviceFluidSynth::MidiDeviceFluidSynth()
 	mixer_channel = MIXER_AddChannel(mixer_callback,
 	                                 sample_rate_hz,
 	                                 ChannelName::FluidSynth,
-	                                 {ChannelFeature::Sleep,
+	                                 {ChannelFeature::ParallelRender,
+	                                  ChannelFeature::Sleep,
 	                                  ChannelFeature::Stereo,
 	                                  ChannelFeature::ReverbSend,
 	                                  ChannelFeature::ChorusSend,
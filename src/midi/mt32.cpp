@@ -707,7 +707,8 @@ MidiDeviceMt32::MidiDeviceMt32()
 	auto mixer_channel = MIXER_AddChannel(mixer_callback,
 	                                      sample_rate_hz,
 	                                      ChannelName::RolandMt32,
-	                                      {ChannelFeature::Sleep,
+	                                      {ChannelFeature::ParallelRender,
+	                                       ChannelFeature::Sleep,
 	                                       ChannelFeature::Stereo,
 	                                       ChannelFeature::Synthesizer});
 
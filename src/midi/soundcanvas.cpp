@@ -414,6 +414,7 @@ MidiDeviceSoundCanvas::MidiDeviceSoundCanvas()
 	                                 iroundf(sample_rate_hz),
 	                                 ChannelName::SoundCanvas,
 	                                 {ChannelFeature::NoiseGate,
+	                                  ChannelFeature::ParallelRender,
 	                                  ChannelFeature::Sleep,
 	                                  ChannelFeature::Stereo,
 	                                  ChannelFeature::Synthesizer});
@@ -324,6 +324,10 @@ template class RWQueue<MidiWork>;
 #include "gui/render/render.h"
 template class RWQueue<SaveImageTask>;
 
+// Video capture
+#include "capture/private/capture_video.h"
+template class RWQueue<VideoCaptureFrame>;
+
 //PC Speaker
 template class RWQueue<float>;
 
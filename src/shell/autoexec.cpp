@@ -388,7 +388,8 @@ AutoExecModule::AutoExecModule(Section* configuration)
 		}
 
 		// Check if argument is a CD image
-		if (extension_ucase == "ISO" || extension_ucase == "CUE") {
+		if (extension_ucase == "ISO" || extension_ucase == "CUE" ||
+		    extension_ucase == "CHD") {
 			if (!cdrom_images.empty()) {
 				cdrom_images += " ";
 			}
@@ -727,7 +728,7 @@ static std::string build_auto_mount_command(const char dir_letter,
                                             const std::optional<AutoMountSettings>& settings)
 {
 	std::set<std::string_view, std::less<>> image_type = {"cdrom", "iso"};
-	std::vector<std::string_view> image_ext = {".iso", ".cue", ".mds"};
+	std::vector<std::string_view> image_ext = {".iso", ".cue", ".mds", ".chd"};
 	auto build_auto_mount_images_command = build_auto_mount_cd_images_command;
 
 	// Look for floppy images when dir_letter matches a floppy drive
@@ -0,0 +1,117 @@
+// SPDX-FileCopyrightText:  2026-2026 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef DOSBOX_FIFO_BUFFER_H
+#define DOSBOX_FIFO_BUFFER_H
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+// Growable FIFO buffer
+// ~~~~~~~~~~~~~~~~~~~~
+// A ring buffer of items that are pushed to the back, then read from the
+// front and popped. Popping just advances the read position, so the remaining
+// items never have to be moved like when erasing from the front of a vector.
+//
+// Pushing more items than there's room for grows the buffer, so no items are
+// ever dropped. The capacity is always a power of two.
+//
+// It's not thread-safe; the users need to guard it with a lock. See
+// SpscRingBuffer for a lock-free FIFO of fixed capacity.
+//
+template <typename T>
+class FifoBuffer {
+public:
+	FifoBuffer() = default;
+
+	explicit FifoBuffer(const size_t min_capacity)
+	{
+		Reserve(min_capacity);
+	}
+
+	// Grows the buffer to hold at least the given number of items, keeping
+	// the items it holds
+	void Reserve(const size_t min_capacity)
+	{
+		if (min_capacity <= items.size()) {
+			return;
+		}
+		const auto num_items = Size();
+
+		std::vector<T> new_items(std::bit_ceil(min_capacity));
+		for (size_t i = 0; i < num_items; ++i) {
+			new_items[i] = (*this)[i];
+		}
+		items = std::move(new_items);
+		mask  = items.size() - 1;
+
+		read_pos  = 0;
+		write_pos = num_items;
+	}
+
+	size_t Capacity() const
+	{
+		return items.size();
+	}
+
+	size_t Size() const
+	{
+		return write_pos - read_pos;
+	}
+
+	bool IsEmpty() const
+	{
+		return Size() == 0;
+	}
+
+	void Push(const T* source, const size_t num_items)
+	{
+		Reserve(Size() + num_items);
+
+		// Copy in up to two runs, split where the buffer wraps around
+		const auto start     = write_pos & mask;
+		const auto first_run = std::min(num_items, items.size() - start);
+		std::copy_n(source, first_run, items.begin() + start);
+		if (num_items > first_run) {
+			std::copy_n(source + first_run, num_items - first_run, items.begin());
+		}
+		write_pos += num_items;
+	}
+
+	void Push(const T& item)
+	{
+		Push(&item, 1);
+	}
+
+	// Returns the item at the given position counted from the front
+	const T& operator[](const size_t index) const
+	{
+		assert(index < Size());
+		return items[(read_pos + index) & mask];
+	}
+
+	void Pop(const size_t num_items)
+	{
+		assert(num_items <= Size());
+		read_pos += num_items;
+	}
+
+	void Clear()
+	{
+		read_pos = write_pos;
+	}
+
+private:
+	std::vector<T> items = {};
+	size_t mask          = 0;
+
+	// Total number of items ever read and written; only their difference
+	// and the positions modulo the capacity matter, so they can wrap
+	size_t read_pos  = 0;
+	size_t write_pos = 0;
+};
+
+#endif // DOSBOX_FIFO_BUFFER_H
@@ -0,0 +1,147 @@
+// SPDX-FileCopyrightText:  2026-2026 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef DOSBOX_SPSC_RING_BUFFER_H
+#define DOSBOX_SPSC_RING_BUFFER_H
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+// Single-producer, single-consumer ring buffer
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// A lock-free FIFO of items: one thread pushes items to the back, another
+// reads them from the front and pops them, without a lock between the two.
+// Popping just advances the read position, so the remaining items never have
+// to be moved like when erasing from the front of a vector.
+//
+// Pushing more items than there's room for drops the excess; the push calls
+// return how many made it in.
+//
+// "Single" means one at a time, not one thread for the buffer's lifetime.
+// Consumers on different threads are fine as long as they're serialised,
+// e.g., by each holding the same mutex while they read and pop; the same
+// goes for producers. Two unsynchronised consumers would read the same
+// items and pop past each other.
+//
+// The capacity is rounded up to a power of two. Reserve() and Clear() must
+// not run at the same time as the other side accesses the buffer.
+//
+template <typename T>
+class SpscRingBuffer {
+public:
+	SpscRingBuffer() = default;
+
+	explicit SpscRingBuffer(const size_t min_capacity)
+	{
+		Reserve(min_capacity);
+	}
+
+	// prevent copying
+	SpscRingBuffer(const SpscRingBuffer&) = delete;
+	// prevent assignment
+	SpscRingBuffer& operator=(const SpscRingBuffer&) = delete;
+
+	// Grows the buffer to hold at least the given number of items, keeping
+	// the items it holds
+	void Reserve(const size_t min_capacity)
+	{
+		if (min_capacity <= items.size()) {
+			return;
+		}
+		const auto num_items = Size();
+
+		std::vector<T> new_items(std::bit_ceil(min_capacity));
+		for (size_t i = 0; i < num_items; ++i) {
+			new_items[i] = (*this)[i];
+		}
+		items = std::move(new_items);
+		mask  = items.size() - 1;
+
+		read_pos.store(0, std::memory_order_relaxed);
+		write_pos.store(num_items, std::memory_order_release);
+	}
+
+	size_t Capacity() const
+	{
+		return items.size();
+	}
+
+	size_t Size() const
+	{
+		const auto write = write_pos.load(std::memory_order_acquire);
+		const auto read  = read_pos.load(std::memory_order_acquire);
+		return write - read;
+	}
+
+	bool IsEmpty() const
+	{
+		return Size() == 0;
+	}
+
+	// Producer side
+	// -------------
+
+	size_t Push(const T* source, const size_t num_items)
+	{
+		const auto write = write_pos.load(std::memory_order_relaxed);
+		const auto read  = read_pos.load(std::memory_order_acquire);
+
+		const auto num_pushed = std::min(num_items,
+		                                 items.size() - (write - read));
+
+		// Copy in up to two runs, split where the buffer wraps around
+		const auto start     = write & mask;
+		const auto first_run = std::min(num_pushed, items.size() - start);
+		std::copy_n(source, first_run, items.begin() + start);
+		if (num_pushed > first_run) {
+			std::copy_n(source + first_run,
+			            num_pushed - first_run,
+			            items.begin());
+		}
+
+		write_pos.store(write + num_pushed, std::memory_order_release);
+		return num_pushed;
+	}
+
+	bool Push(const T& item)
+	{
+		return Push(&item, 1) == 1;
+	}
+
+	// Consumer side
+	// -------------
+
+	// Returns the item at the given position counted from the front
+	const T& operator[](const size_t index) const
+	{
+		assert(index < Size());
+		return items[(read_pos.load(std::memory_order_relaxed) + index) & mask];
+	}
+
+	void Pop(const size_t num_items)
+	{
+		assert(num_items <= Size());
+		read_pos.fetch_add(num_items, std::memory_order_release);
+	}
+
+	void Clear()
+	{
+		read_pos.store(write_pos.load(std::memory_order_acquire),
+		               std::memory_order_release);
+	}
+
+private:
+	std::vector<T> items = {};
+	size_t mask          = 0;
+
+	// Total number of items ever read and written; only their difference
+	// and the positions modulo the capacity matter, so they can wrap
+	std::atomic<size_t> read_pos  = 0;
+	std::atomic<size_t> write_pos = 0;
+};
+
+#endif // DOSBOX_SPSC_RING_BUFFER_H
@@ -10,6 +10,7 @@
 #include "json/json.h"
 
 #include "cpu/registers.h"
+#include "utils/string_utils.h"
 
 using json = nlohmann::json;
 
@@ -51,4 +52,66 @@ void CpuStateCommand::Get(const httplib::Request&, httplib::Response& res)
 	send_json(res, j);
 }
 
+void CpuProfileCommand::Execute()
+{
+	if (enable) {
+		DYNPROF_SetEnabled(*enable);
+	}
+	if (reset) {
+		DYNPROF_Reset();
+	}
+	enabled  = DYNPROF_IsEnabled();
+	counters = DYNPROF_GetCounters();
+	blocks   = DYNPROF_GetHotBlocks(num_blocks);
+	LOG_DEBUG("API: CpuProfileCommand()");
+}
+
+size_t CpuProfileCommand::ParseNumBlocks(const httplib::Request& req)
+{
+	constexpr int DefaultNumBlocks = 20;
+	constexpr int MaxNumBlocks     = 1000;
+
+	if (!req.has_param("top")) {
+		return DefaultNumBlocks;
+	}
+	const auto num_blocks = parse_int(req.get_param_value("top"));
+	if (!num_blocks || *num_blocks < 0 || *num_blocks > MaxNumBlocks) {
+		throw std::invalid_argument("'top' must be a number between 0 and " +
+		                            std::to_string(MaxNumBlocks));
+	}
+	return static_cast<size_t>(*num_blocks);
+}
+
+void CpuProfileCommand::SendResponse(httplib::Response& res) const
+{
+	json j;
+	j["profile"]["enabled"]    = enabled;
+	j["profile"]["counters"]   = counters;
+	j["profile"]["hot_blocks"] = blocks;
+	send_json(res, j);
+}
+
+void CpuProfileCommand::Get(const httplib::Request& req, httplib::Response& res)
+{
+	CpuProfileCommand cmd(ParseNumBlocks(req));
+	cmd.WaitForCompletion();
+	cmd.SendResponse(res);
+}
+
+void CpuProfileCommand::Put(const httplib::Request& req, httplib::Response& res)
+{
+	CpuProfileCommand cmd(ParseNumBlocks(req));
+
+	const auto j = json::parse(req.body);
+	if (j.contains("enabled")) {
+		cmd.enable = j.at("enabled").get<bool>();
+	}
+	if (j.contains("reset")) {
+		cmd.reset = j.at("reset").get<bool>();
+	}
+
+	cmd.WaitForCompletion();
+	cmd.SendResponse(res);
+}
+
 } // namespace Webserver
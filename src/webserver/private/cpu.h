@@ -6,9 +6,22 @@
 
 #include "webserver/bridge.h"
 
+#include <optional>
+#include <vector>
+
 #include "http/http.h"
 #include "json/json.h"
 
+#include "cpu/dyn_profiler.h"
+
+// The JSON conversions of the profiler types have to live in their
+// namespace to be found by argument-dependent lookup
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(DynProfileCounters, executions, translations,
+                                   invalidations, links, unlinks)
+
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(DynBlockProfile, address, size, code32,
+                                   executions, translations, invalidations)
+
 namespace Webserver {
 
 struct Registers {
@@ -45,6 +58,30 @@ private:
 	Registers regs = {};
 };
 
+// Dynamic core profiling; the command optionally enables, disables, or
+// resets the profiler before reading the counters and hot blocks
+class CpuProfileCommand : public Command {
+public:
+	CpuProfileCommand(const size_t num_blocks) : num_blocks(num_blocks) {}
+
+	void Execute() override;
+	static void Get(const httplib::Request& req, httplib::Response& res);
+	static void Put(const httplib::Request& req, httplib::Response& res);
+
+	std::optional<bool> enable = {};
+	bool reset                 = false;
+
+private:
+	size_t num_blocks = 0;
+
+	bool enabled                         = false;
+	DynProfileCounters counters          = {};
+	std::vector<DynBlockProfile> blocks = {};
+
+	static size_t ParseNumBlocks(const httplib::Request& req);
+	void SendResponse(httplib::Response& res) const;
+};
+
 } // namespace Webserver
 
 #endif // DOSBOX_WEBSERVER_CPU_H
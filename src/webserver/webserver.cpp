@@ -57,6 +57,8 @@ static httplib::Server server;
 static void setup_api_handlers()
 {
 	server.Get("/api/v1/cpu/state", CpuStateCommand::Get);
+	server.Get("/api/v1/cpu/profile", CpuProfileCommand::Get);
+	server.Put("/api/v1/cpu/profile", CpuProfileCommand::Put);
 
 	server.Get("/api/v1/dos/internals", DosInternalsCommand::Get);
 
@@ -0,0 +1,49 @@
+// SPDX-FileCopyrightText:  2026-2026 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef DOSBOX_BENCHMARK_H
+#define DOSBOX_BENCHMARK_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+// Minimal microbenchmark harness
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Each benchmark body receives the number of iterations to run. The runner
+// calibrates the iteration count until a run takes long enough to be
+// measured reliably, then reports the average time per iteration.
+//
+// Usage:
+//
+//   BENCHMARK(port_dispatch, flat_table_read)
+//   {
+//       for (uint64_t i = 0; i < iterations; ++i) {
+//           benchmark_keep(IO_ReadB(0x3da));
+//       }
+//   }
+//
+using benchmark_body_t = std::function<void(uint64_t iterations)>;
+
+int benchmark_register(const std::string& group, const std::string& name,
+                       benchmark_body_t body);
+
+// Prevents the compiler from optimising away the computation of a value
+template <typename T>
+inline void benchmark_keep(const T& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	asm volatile("" : : "r,m"(value) : "memory");
+#else
+	static volatile T sink = {};
+	sink = value;
+#endif
+}
+
+#define BENCHMARK(group, name) \
+	static void benchmark_##group##_##name(uint64_t iterations); \
+	[[maybe_unused]] static const int benchmark_##group##_##name##_id = \
+	        benchmark_register(#group, #name, benchmark_##group##_##name); \
+	static void benchmark_##group##_##name([[maybe_unused]] uint64_t iterations)
+
+#endif // DOSBOX_BENCHMARK_H
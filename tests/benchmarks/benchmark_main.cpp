@@ -0,0 +1,83 @@
+// SPDX-FileCopyrightText:  2026-2026 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "benchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+struct Benchmark {
+	std::string group = {};
+	std::string name  = {};
+	benchmark_body_t body = {};
+};
+
+static std::vector<Benchmark>& get_benchmarks()
+{
+	static std::vector<Benchmark> benchmarks = {};
+	return benchmarks;
+}
+
+int benchmark_register(const std::string& group, const std::string& name,
+                       benchmark_body_t body)
+{
+	auto& benchmarks = get_benchmarks();
+	benchmarks.push_back({group, name, std::move(body)});
+	return static_cast<int>(benchmarks.size());
+}
+
+static double run_timed(const benchmark_body_t& body, const uint64_t iterations)
+{
+	using namespace std::chrono;
+
+	const auto start = steady_clock::now();
+	body(iterations);
+	const auto end = steady_clock::now();
+
+	return duration<double, std::nano>(end - start).count();
+}
+
+static void run_benchmark(const Benchmark& benchmark)
+{
+	// Aim for at least this much time per measured run
+	constexpr double MinRunTimeNs = 250e6;
+
+	// Warm up caches and let the body perform its lazy initialisation
+	run_timed(benchmark.body, 1);
+
+	uint64_t iterations = 1;
+	auto elapsed_ns     = run_timed(benchmark.body, iterations);
+
+	while (elapsed_ns < MinRunTimeNs && iterations < (UINT64_C(1) << 40)) {
+		iterations *= (elapsed_ns < MinRunTimeNs / 100) ? 10 : 2;
+		elapsed_ns = run_timed(benchmark.body, iterations);
+	}
+
+	// Report the fastest of a few repetitions to filter out the noise
+	// caused by other processes and frequency scaling
+	constexpr auto NumRepetitions = 5;
+	for (auto i = 1; i < NumRepetitions; ++i) {
+		elapsed_ns = std::min(elapsed_ns, run_timed(benchmark.body, iterations));
+	}
+
+	printf("%-24s %-36s %12.2f ns/iter  (%llu iterations)\n",
+	       benchmark.group.c_str(),
+	       benchmark.name.c_str(),
+	       elapsed_ns / static_cast<double>(iterations),
+	       static_cast<unsigned long long>(iterations));
+}
+
+int main(int argc, char* argv[])
+{
+	const std::string filter = (argc > 1) ? argv[1] : "";
+
+	for (const auto& benchmark : get_benchmarks()) {
+		const auto full_name = benchmark.group + "." + benchmark.name;
+		if (full_name.find(filter) != std::string::npos) {
+			run_benchmark(benchmark);
+		}
+	}
+	return 0;
+}
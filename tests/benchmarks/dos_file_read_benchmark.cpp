@@ -0,0 +1,155 @@
+// SPDX-FileCopyrightText:  2026-2026 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "benchmark.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "dos/dos.h"
+#include "dos/drive_local.h"
+#include "misc/cross.h"
+#include "utils/fs_utils.h"
+
+#include "../temp_directory.h"
+
+// Replays a trace of INT 21h read and seek calls on a file of a mounted host
+// directory, shaped after a game loading its resource archive: the header
+// and the directory entries are read a few bytes at a time, then each
+// resource is seeked to and read in a mix of small parsing reads and larger
+// blocks. The buffered variant goes through localFile and its read-ahead
+// buffer; the baseline makes one host call per DOS call, like the unbuffered
+// handles did.
+
+constexpr auto ArchiveSize = 1024 * 1024;
+
+struct TraceCall {
+	enum class Type { Read, Seek } type = Type::Read;
+	uint32_t value = 0; // number of bytes to read, or the position to seek to
+};
+
+static const std::vector<TraceCall>& get_trace()
+{
+	static std::vector<TraceCall> trace = {};
+	if (!trace.empty()) {
+		return trace;
+	}
+
+	using Type = TraceCall::Type;
+
+	constexpr auto NumResources = 200;
+	constexpr auto EntrySize    = 16;
+
+	std::mt19937 rng(42);
+
+	// Header, then the directory one entry at a time
+	trace.push_back({Type::Read, 4});
+	for (auto i = 0; i < NumResources; ++i) {
+		trace.push_back({Type::Read, EntrySize});
+	}
+
+	// The resources in directory order, as they get loaded
+	uint32_t offset = 4 + NumResources * EntrySize;
+	while (offset < ArchiveSize) {
+		const auto size = 512 + rng() % 8192;
+		trace.push_back({Type::Seek, offset});
+
+		uint32_t num_read = 0;
+		while (num_read < size) {
+			// Mostly small reads of headers and records, with the
+			// occasional block of pixel or sound data
+			const auto chunk = static_cast<uint32_t>(
+			        (rng() % 8 == 0) ? 1024 + rng() % 4096 : 1 + rng() % 64);
+			trace.push_back({Type::Read, chunk});
+			num_read += chunk;
+		}
+		offset += size;
+	}
+	return trace;
+}
+
+static std::filesystem::path get_archive_dir()
+{
+	// Removed with the archive when the benchmarks exit
+	static const TempDirectory temp_dir("dosbox_read_trace");
+
+	static const auto dir = [] {
+		const auto& path = temp_dir.GetPath();
+
+		std::mt19937 rng(1234);
+		std::vector<char> contents(ArchiveSize);
+		for (auto& byte : contents) {
+			byte = static_cast<char>(rng());
+		}
+		std::ofstream(path / "ARCHIVE.DAT", std::ios::binary)
+		        .write(contents.data(), ArchiveSize);
+		return path;
+	}();
+	return dir;
+}
+
+BENCHMARK(dos_file_read, unbuffered)
+{
+	const auto path = (get_archive_dir() / "ARCHIVE.DAT").string();
+	const auto& trace = get_trace();
+
+	const auto handle = open_native_file(path.c_str(), false);
+	std::vector<uint8_t> data(UINT16_MAX);
+
+	for (uint64_t i = 0; i < iterations; ++i) {
+		seek_native_file(handle, 0, NativeSeek::Set);
+		for (const auto& call : trace) {
+			if (call.type == TraceCall::Type::Seek) {
+				seek_native_file(handle, call.value, NativeSeek::Set);
+			} else {
+				read_native_file(handle, data.data(), call.value);
+			}
+		}
+		benchmark_keep(data[0]);
+	}
+	close_native_file(handle);
+}
+
+BENCHMARK(dos_file_read, buffered)
+{
+	const auto dir    = get_archive_dir();
+	const auto path   = (dir / "ARCHIVE.DAT").string();
+	const auto& trace = get_trace();
+
+	auto basedir = dir.string();
+	basedir += CROSS_FILESPLIT;
+
+	const auto drive = std::make_shared<localDrive>(
+	        basedir.c_str(), 512, 32, 32765, 16000, 0xf8, true);
+
+	localFile file("ARCHIVE.DAT",
+	               path.c_str(),
+	               open_native_file(path.c_str(), false),
+	               basedir.c_str(),
+	               true,
+	               drive,
+	               {},
+	               OPEN_READ);
+	file.AddRef();
+
+	std::vector<uint8_t> data(UINT16_MAX);
+
+	for (uint64_t i = 0; i < iterations; ++i) {
+		uint32_t pos = 0;
+		file.Seek(&pos, DOS_SEEK_SET);
+		for (const auto& call : trace) {
+			if (call.type == TraceCall::Type::Seek) {
+				pos = call.value;
+				file.Seek(&pos, DOS_SEEK_SET);
+			} else {
+				auto num_bytes = static_cast<uint16_t>(call.value);
+				file.Read(data.data(), &num_bytes);
+			}
+		}
+		benchmark_keep(data[0]);
+	}
+}
@@ -0,0 +1,144 @@
+// SPDX-FileCopyrightText:  2026-2026 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "benchmark.h"
+
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <numbers>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "audio/mixer.h"
+#include "config/config.h"
+#include "shell/command_line.h"
+
+// Renders a fixed scene of the kind of channels a well-equipped DOS game
+// keeps busy at the same time: two synthesizers, the Sound Blaster and GUS
+// digital audio, and CD audio, each at its own sample rate so the mixer has
+// to resample them. The reverb and chorus are enabled. Each iteration renders
+// one second of audio in blocks of the default size.
+
+constexpr auto MixerBlocksize = 512;
+
+struct SceneChannel {
+	const char* name = nullptr;
+	int sample_rate_hz = 0;
+	bool is_stereo     = false;
+	bool is_synth      = false;
+
+	// The synthesizers play a chord of sine waves, the digital audio
+	// channels play noise
+	std::vector<float> frequencies_hz = {};
+};
+
+struct ChannelRenderer {
+	MixerChannelPtr channel = {};
+	SceneChannel scene      = {};
+
+	std::vector<float> phases  = {};
+	std::vector<float> samples = {};
+	std::mt19937 rng           = std::mt19937(42);
+
+	void Render(const int num_frames)
+	{
+		const auto num_channels = scene.is_stereo ? 2 : 1;
+		samples.resize(static_cast<size_t>(num_frames * num_channels));
+
+		std::uniform_real_distribution<float> noise(-8000.0f, 8000.0f);
+
+		for (auto i = 0; i < num_frames; ++i) {
+			auto sample = 0.0f;
+			if (scene.is_synth) {
+				for (size_t f = 0; f < phases.size(); ++f) {
+					sample += 4000.0f * std::sin(phases[f]);
+
+					phases[f] += 2.0f * std::numbers::pi_v<float> *
+					             scene.frequencies_hz[f] /
+					             static_cast<float>(scene.sample_rate_hz);
+					phases[f] = std::fmod(phases[f],
+					                      2.0f * std::numbers::pi_v<float>);
+				}
+			} else {
+				sample = noise(rng);
+			}
+			for (auto c = 0; c < num_channels; ++c) {
+				samples[static_cast<size_t>(i * num_channels + c)] = sample;
+			}
+		}
+
+		if (scene.is_stereo) {
+			channel->AddSamples_sfloat(num_frames, samples.data());
+		} else {
+			channel->AddSamples_mfloat(num_frames, samples.data());
+		}
+	}
+};
+
+static void set_up_scene()
+{
+	static std::vector<std::unique_ptr<ChannelRenderer>> renderers = {};
+	if (!renderers.empty()) {
+		return;
+	}
+
+	static CommandLine command_line("dosbox", "");
+	control = std::make_unique<Config>(&command_line);
+	MIXER_AddConfigSection(control);
+
+	MIXER_SetReverbPreset(ReverbPreset::Medium);
+	MIXER_SetChorusPreset(ChorusPreset::Normal);
+
+	const std::vector<SceneChannel> scene = {
+	        {"OPL", 49716, true, true, {261.6f, 329.6f, 392.0f, 523.3f}},
+	        {"MT32", 32000, true, true, {110.0f, 220.0f, 277.2f, 329.6f, 440.0f}},
+	        {"SB", 22050, false, false, {}},
+	        {"GUS", 44100, true, false, {}},
+	        {"CDAUDIO", 44100, true, false, {}},
+	};
+
+	for (const auto& scene_channel : scene) {
+		auto renderer   = std::make_unique<ChannelRenderer>();
+		renderer->scene = scene_channel;
+		renderer->phases.resize(scene_channel.frequencies_hz.size());
+
+		std::set<ChannelFeature> features = {ChannelFeature::ReverbSend,
+		                                     ChannelFeature::ChorusSend};
+		features.insert(scene_channel.is_synth ? ChannelFeature::Synthesizer
+		                                       : ChannelFeature::DigitalAudio);
+		if (scene_channel.is_stereo) {
+			features.insert(ChannelFeature::Stereo);
+		}
+
+		auto renderer_ptr = renderer.get();
+		renderer->channel = MIXER_AddChannel(
+		        [renderer_ptr](const int num_frames) {
+			        renderer_ptr->Render(num_frames);
+		        },
+		        scene_channel.sample_rate_hz,
+		        scene_channel.name,
+		        features);
+
+		renderer->channel->Enable(true);
+		renderers.push_back(std::move(renderer));
+	}
+}
+
+BENCHMARK(mixer, render_scene)
+{
+	set_up_scene();
+
+	const auto blocks_per_second = MIXER_GetSampleRate() / MixerBlocksize;
+
+	float checksum = 0.0f;
+	for (uint64_t i = 0; i < iterations; ++i) {
+		for (auto b = 0; b < blocks_per_second; ++b) {
+			const auto& output = MIXER_MixBlock(MixerBlocksize);
+			checksum += output.front().left;
+		}
+	}
+	benchmark_keep(checksum);
+}
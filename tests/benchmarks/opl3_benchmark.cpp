@@ -0,0 +1,95 @@
+// SPDX-FileCopyrightText:  2026-2026 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "benchmark.h"
+
+#include <array>
+#include <cstdint>
+
+#include "nuked/opl3.h"
+
+// Renders sustained notes through the Nuked OPL3 core with the scalar and the
+// SIMD generators. The sparse case keys two voices like a simple sound effect
+// and leaves the others dormant, the dense case keys all 18 voices like busy
+// OPL3 music.
+
+#if OPL_ENABLE_SIMD
+
+constexpr auto SampleRate      = 49716;
+constexpr auto FramesPerRender = 256;
+
+static void key_voices(opl3_chip& chip, const int num_voices)
+{
+	OPL3_Reset(&chip, SampleRate);
+
+	// Enable OPL3 mode, deep tremolo and vibrato
+	OPL3_WriteReg(&chip, 0x105, 0x01);
+	OPL3_WriteReg(&chip, 0x0bd, 0xc0);
+
+	constexpr std::array<uint16_t, 9> SlotOffsets = {
+	        0x00, 0x01, 0x02, 0x08, 0x09, 0x0a, 0x10, 0x11, 0x12};
+
+	for (auto voice = 0; voice < num_voices; ++voice) {
+		const uint16_t bank = (voice < 9) ? 0x000 : 0x100;
+		const uint16_t chan = voice % 9;
+		const uint16_t slot = bank | SlotOffsets[chan];
+
+		// Modulator and carrier with tremolo and vibrato on the former
+		OPL3_WriteReg(&chip, 0x20 + slot, 0xe1);
+		OPL3_WriteReg(&chip, 0x23 + slot, 0x61);
+		OPL3_WriteReg(&chip, 0x40 + slot, 0x10);
+		OPL3_WriteReg(&chip, 0x43 + slot, 0x00);
+		OPL3_WriteReg(&chip, 0x60 + slot, 0xf2);
+		OPL3_WriteReg(&chip, 0x63 + slot, 0xf2);
+		OPL3_WriteReg(&chip, 0x80 + slot, 0x24);
+		OPL3_WriteReg(&chip, 0x83 + slot, 0x34);
+
+		// Feedback, both outputs, and a different pitch per voice
+		OPL3_WriteReg(&chip, (bank | 0xc0) + chan, 0x3e);
+		OPL3_WriteReg(&chip, (bank | 0xa0) + chan, 0x50 + voice * 7);
+		OPL3_WriteReg(&chip, (bank | 0xb0) + chan, 0x31);
+	}
+}
+
+static opl3_chip& get_chip()
+{
+	// The chip is too large to keep on the stack
+	static opl3_chip chip = {};
+	return chip;
+}
+
+template <typename Generate>
+static void render(const int num_voices, const uint64_t iterations, Generate generate)
+{
+	auto& chip = get_chip();
+	key_voices(chip, num_voices);
+
+	std::array<int16_t, FramesPerRender * 2> samples = {};
+
+	for (uint64_t i = 0; i < iterations; ++i) {
+		generate(&chip, samples.data(), FramesPerRender);
+		benchmark_keep(samples[0]);
+	}
+}
+
+BENCHMARK(opl3, sparse_scalar)
+{
+	render(2, iterations, OPL3_GenerateStream);
+}
+
+BENCHMARK(opl3, sparse_simd)
+{
+	render(2, iterations, OPL3_GenerateStreamSimd);
+}
+
+BENCHMARK(opl3, dense_scalar)
+{
+	render(18, iterations, OPL3_GenerateStream);
+}
+
+BENCHMARK(opl3, dense_simd)
+{
+	render(18, iterations, OPL3_GenerateStreamSimd);
+}
+
+#endif // OPL_ENABLE_SIMD
@@ -0,0 +1,121 @@
+// SPDX-FileCopyrightText:  2026-2026 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "benchmark.h"
+
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+
+#include "hardware/port.h"
+
+// Defined in port_containers.cpp
+uint8_t read_byte_from_port(const io_port_t port);
+uint16_t read_word_from_port(const io_port_t port);
+void write_byte_to_port(const io_port_t port, const uint8_t val);
+
+// A mix of frequently polled ports: VGA input status and CRTC, Sound Blaster
+// DSP read status and data, AdLib status, and the PIT
+constexpr std::array<io_port_t, 8> polled_ports = {
+        0x3da, 0x3d4, 0x3d5, 0x22e, 0x22a, 0x388, 0x40, 0x43};
+
+static uint8_t last_written = 0;
+
+static io_val_t read_handler(const io_port_t port, const io_width_t)
+{
+	return port & 0xff;
+}
+
+static void write_handler(const io_port_t, const io_val_t val, const io_width_t)
+{
+	last_written = static_cast<uint8_t>(val);
+}
+
+// A fully configured machine has handlers on several hundred ports; we
+// populate the first 1K ports to get a similarly sized working set
+constexpr io_port_t num_populated_ports = 0x400;
+
+static void install_handlers()
+{
+	static bool installed = false;
+	if (installed) {
+		return;
+	}
+	IO_RegisterReadHandler(0, read_handler, io_width_t::word, num_populated_ports);
+	IO_RegisterWriteHandler(0, write_handler, io_width_t::word, num_populated_ports);
+	installed = true;
+}
+
+// The previous dispatch scheme, kept here as the baseline: one hash map per
+// width with a "blocked" handler inserted on the first unhandled access.
+static std::unordered_map<io_port_t, io_read_f> map_read_handlers = {};
+static std::unordered_map<io_port_t, io_write_f> map_write_handlers = {};
+
+static void install_map_handlers()
+{
+	if (!map_read_handlers.empty()) {
+		return;
+	}
+	for (io_port_t port = 0; port < num_populated_ports; ++port) {
+		map_read_handlers[port]  = read_handler;
+		map_write_handlers[port] = write_handler;
+	}
+}
+
+static uint8_t map_read_byte(const io_port_t port)
+{
+	const auto [it, was_blocked] = map_read_handlers.try_emplace(
+	        port, [](io_port_t, io_width_t) -> io_val_t { return 0xff; });
+	return it->second(port, io_width_t::byte) & 0xff;
+}
+
+static void map_write_byte(const io_port_t port, const uint8_t val)
+{
+	const auto [it, was_blocked] = map_write_handlers.try_emplace(
+	        port, [](io_port_t, io_val_t, io_width_t) {});
+	it->second(port, val, io_width_t::byte);
+}
+
+BENCHMARK(port_dispatch, unordered_map_read_byte)
+{
+	install_map_handlers();
+	for (uint64_t i = 0; i < iterations; ++i) {
+		benchmark_keep(map_read_byte(polled_ports[i % polled_ports.size()]));
+	}
+}
+
+BENCHMARK(port_dispatch, unordered_map_write_byte)
+{
+	install_map_handlers();
+	for (uint64_t i = 0; i < iterations; ++i) {
+		map_write_byte(polled_ports[i % polled_ports.size()],
+		               static_cast<uint8_t>(i));
+	}
+	benchmark_keep(last_written);
+}
+
+BENCHMARK(port_dispatch, flat_table_read_byte)
+{
+	install_handlers();
+	for (uint64_t i = 0; i < iterations; ++i) {
+		benchmark_keep(read_byte_from_port(polled_ports[i % polled_ports.size()]));
+	}
+}
+
+BENCHMARK(port_dispatch, flat_table_read_word)
+{
+	install_handlers();
+	for (uint64_t i = 0; i < iterations; ++i) {
+		benchmark_keep(read_word_from_port(polled_ports[i % polled_ports.size()]));
+	}
+}
+
+BENCHMARK(port_dispatch, flat_table_write_byte)
+{
+	install_handlers();
+	for (uint64_t i = 0; i < iterations; ++i) {
+		write_byte_to_port(polled_ports[i % polled_ports.size()],
+		                   static_cast<uint8_t>(i));
+	}
+	benchmark_keep(last_written);
+}
@@ -0,0 +1,149 @@
+// SPDX-FileCopyrightText:  2026-2026 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "benchmark.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "hardware/video/voodoo_combine.h"
+
+// Replays the color combine work of a stream of triangles, shaped after a
+// typical 3D game frame: mostly small to medium triangles with the texture
+// modulated by the iterated color, plus some decal-textured and Gouraud
+// shaded ones. Each triangle is a run of spans; the batched variant combines
+// each span in batches of eight pixels like the rasteriser does.
+
+constexpr int BatchSize = 8;
+
+struct Span {
+	int mode_index = 0;
+	int first      = 0; // index of the first pixel in the pixel arrays
+	int length     = 0;
+};
+
+struct TriangleStream {
+	std::vector<Span> spans = {};
+
+	std::vector<uint32_t> c_other = {};
+	std::vector<uint32_t> c_local = {};
+	std::vector<uint32_t> blend   = {};
+
+	int num_pixels = 0;
+};
+
+static std::array<voodoo_combine_mode, 3> get_modes()
+{
+	// Texture modulated by the iterated color
+	voodoo_combine_mode modulate = {};
+	modulate.reverse_blend       = true;
+	modulate.reverse_blend_alpha = true;
+
+	// Decal texture
+	voodoo_combine_mode decal = {};
+
+	// Iterated color only
+	voodoo_combine_mode gouraud = {};
+	gouraud.zero_other          = true;
+	gouraud.zero_other_alpha    = true;
+	gouraud.add_local           = 1;
+	gouraud.add_local_alpha     = true;
+
+	return {modulate, decal, gouraud};
+}
+
+static const TriangleStream& get_stream()
+{
+	static TriangleStream stream = {};
+	if (!stream.spans.empty()) {
+		return stream;
+	}
+
+	constexpr auto NumTriangles = 2000;
+
+	std::mt19937 rng(42);
+
+	for (auto t = 0; t < NumTriangles; ++t) {
+		// Three out of four triangles are modulated
+		const auto mode_index = (rng() % 4 == 0) ? static_cast<int>(1 + rng() % 2)
+		                                         : 0;
+		const auto height = static_cast<int>(2 + rng() % 30);
+		const auto width  = static_cast<int>(2 + rng() % 60);
+
+		for (auto y = 0; y < height; ++y) {
+			// Spans narrow towards the bottom vertex
+			const auto length = std::max(1, width * (height - y) / height);
+
+			stream.spans.push_back({mode_index, stream.num_pixels, length});
+			for (auto x = 0; x < length; ++x) {
+				const auto texel  = rng();
+				const auto shaded = 0xff000000 | ((0x80 + x + y) * 0x010101);
+
+				stream.c_other.push_back(mode_index == 2 ? shaded : texel);
+				stream.c_local.push_back(shaded);
+				stream.blend.push_back(shaded);
+			}
+			stream.num_pixels += length;
+		}
+	}
+
+	// The batches may read past the last span
+	stream.c_other.resize(stream.c_other.size() + BatchSize);
+	stream.c_local.resize(stream.c_local.size() + BatchSize);
+	stream.blend.resize(stream.blend.size() + BatchSize);
+	return stream;
+}
+
+BENCHMARK(voodoo_combine, scalar)
+{
+	const auto& stream = get_stream();
+	const auto modes   = get_modes();
+
+	uint32_t checksum = 0;
+	for (uint64_t i = 0; i < iterations; ++i) {
+		for (const auto& span : stream.spans) {
+			const auto& mode = modes[span.mode_index];
+			for (auto p = span.first; p < span.first + span.length; ++p) {
+				checksum += voodoo_color_combine(
+				        mode, {stream.c_other[p], stream.c_local[p], stream.blend[p]});
+			}
+		}
+	}
+	benchmark_keep(checksum);
+}
+
+BENCHMARK(voodoo_combine, batch)
+{
+	const auto& stream = get_stream();
+	const auto modes   = get_modes();
+
+	std::array<voodoo_combine_masks, 3> masks = {};
+	for (size_t m = 0; m < modes.size(); ++m) {
+		masks[m] = voodoo_make_combine_masks(modes[m]);
+	}
+
+	std::array<uint32_t, BatchSize> result = {};
+
+	uint32_t checksum = 0;
+	for (uint64_t i = 0; i < iterations; ++i) {
+		for (const auto& span : stream.spans) {
+			const auto& span_masks = masks[span.mode_index];
+			for (auto p = span.first; p < span.first + span.length; p += BatchSize) {
+				const auto count = std::min(BatchSize, span.first + span.length - p);
+				voodoo_color_combine_batch(span_masks,
+				                           &stream.c_other[p],
+				                           &stream.c_local[p],
+				                           &stream.blend[p],
+				                           count,
+				                           result.data());
+				for (auto r = 0; r < count; ++r) {
+					checksum += result[r];
+				}
+			}
+		}
+	}
+	benchmark_keep(checksum);
+}
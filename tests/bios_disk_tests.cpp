@@ -0,0 +1,253 @@
+// SPDX-FileCopyrightText:  2026-2026 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "ints/bios_disk.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <vector>
+
+#include "temp_directory.h"
+
+namespace {
+
+constexpr uint32_t SectorSize      = 512;
+constexpr uint32_t SectorsPerBlock = 4096 / SectorSize;
+
+// The sector cache holds 4096 blocks; the image is a bit larger, so going
+// through all of it evicts blocks
+constexpr uint32_t NumCacheBlocks = 4096;
+constexpr uint32_t NumSectors     = (NumCacheBlocks + 64) * SectorsPerBlock;
+
+std::vector<uint8_t> make_sector(const uint32_t sectnum, const uint8_t seed)
+{
+	std::vector<uint8_t> sector(SectorSize);
+	for (uint32_t i = 0; i < SectorSize; ++i) {
+		sector[i] = static_cast<uint8_t>(sectnum * 13 + (sectnum >> 8) + i + seed);
+	}
+	return sector;
+}
+
+class ImageDiskTest : public ::testing::Test {
+protected:
+	void SetUp() override
+	{
+		contents.resize(static_cast<size_t>(NumSectors) * SectorSize);
+		for (uint32_t s = 0; s < NumSectors; ++s) {
+			const auto sector = make_sector(s, 0);
+			std::copy(sector.begin(),
+			          sector.end(),
+			          contents.begin() + static_cast<size_t>(s) * SectorSize);
+		}
+		std::ofstream(image_path, std::ios::binary)
+		        .write(reinterpret_cast<const char*>(contents.data()),
+		               static_cast<std::streamsize>(contents.size()));
+	}
+
+	// Opens the image file; read-only images get memory-mapped on hosts
+	// that support it
+	std::unique_ptr<imageDisk> open_image(const bool is_read_only)
+	{
+		const auto file = fopen(image_path.string().c_str(),
+		                        is_read_only ? "rb" : "rb+");
+		EXPECT_NE(file, nullptr);
+		return make_disk(file, is_read_only);
+	}
+
+	// Opens an in-memory copy of the image through a stream without a file
+	// descriptor. It can't be memory-mapped, so all accesses go through the
+	// sector cache like on hosts without mmap.
+	std::unique_ptr<imageDisk> open_unmapped_image(const bool is_read_only)
+	{
+#if defined(WIN32)
+		return open_image(is_read_only);
+#else
+		const auto file = fmemopen(contents.data(),
+		                           contents.size(),
+		                           is_read_only ? "rb" : "rb+");
+		EXPECT_NE(file, nullptr);
+		return make_disk(file, is_read_only);
+#endif
+	}
+
+	std::vector<uint8_t> read_image_file() const
+	{
+		std::vector<uint8_t> data(std_fs::file_size(image_path));
+		std::ifstream(image_path, std::ios::binary)
+		        .read(reinterpret_cast<char*>(data.data()),
+		              static_cast<std::streamsize>(data.size()));
+		return data;
+	}
+
+	static std::vector<uint8_t> get_sector(const std::vector<uint8_t>& data,
+	                                       const uint32_t sectnum)
+	{
+		const auto start = data.begin() + static_cast<size_t>(sectnum) * SectorSize;
+		return {start, start + SectorSize};
+	}
+
+	static std::vector<uint8_t> read_sector(imageDisk& disk, const uint32_t sectnum)
+	{
+		std::vector<uint8_t> sector(SectorSize);
+		EXPECT_EQ(disk.Read_AbsoluteSector(sectnum, sector.data()), 0x00);
+		return sector;
+	}
+
+	TempDirectory temp_dir{"dosbox_image_disk"};
+	const std_fs::path image_path = temp_dir.GetPath() / "disk.img";
+
+	std::vector<uint8_t> contents = {};
+
+private:
+	std::unique_ptr<imageDisk> make_disk(FILE* file, const bool is_read_only)
+	{
+		// Unbuffered, so the blocks the cache writes back reach the
+		// file immediately and the tests can tell when that happens
+		setvbuf(file, nullptr, _IONBF, 0);
+
+		constexpr auto IsHardDisk = true;
+		return std::make_unique<imageDisk>(file,
+		                                   image_path.string().c_str(),
+		                                   NumSectors * SectorSize / 1024,
+		                                   IsHardDisk,
+		                                   is_read_only);
+	}
+};
+
+TEST_F(ImageDiskTest, ReadsBackWritesAcrossEvictions)
+{
+	{
+		auto disk = open_image(false);
+		for (uint32_t s = 0; s < NumSectors; ++s) {
+			auto sector = make_sector(s, 1);
+			ASSERT_EQ(disk->Write_AbsoluteSector(s, sector.data()), 0x00);
+		}
+		for (uint32_t s = 0; s < NumSectors; ++s) {
+			ASSERT_EQ(read_sector(*disk, s), make_sector(s, 1));
+		}
+	}
+	// Destroying the disk writes back the blocks still in the cache
+	const auto data = read_image_file();
+	ASSERT_EQ(data.size(), contents.size());
+	for (uint32_t s = 0; s < NumSectors; ++s) {
+		ASSERT_EQ(get_sector(data, s), make_sector(s, 1));
+	}
+}
+
+TEST_F(ImageDiskTest, WritesBackLeastRecentlyUsedBlock)
+{
+	auto disk = open_image(false);
+
+	auto sector = make_sector(0, 1);
+	ASSERT_EQ(disk->Write_AbsoluteSector(0, sector.data()), 0x00);
+
+	// Fill the rest of the cache; the written block is now the least
+	// recently used one, but still only in the cache
+	for (uint32_t block = 1; block < NumCacheBlocks; ++block) {
+		read_sector(*disk, block * SectorsPerBlock);
+	}
+	EXPECT_EQ(get_sector(read_image_file(), 0), make_sector(0, 0));
+
+	// Loading one more block evicts it
+	read_sector(*disk, NumCacheBlocks * SectorsPerBlock);
+	EXPECT_EQ(get_sector(read_image_file(), 0), make_sector(0, 1));
+}
+
+TEST_F(ImageDiskTest, KeepsRecentlyUsedBlock)
+{
+	auto disk = open_image(false);
+
+	auto sector = make_sector(0, 1);
+	ASSERT_EQ(disk->Write_AbsoluteSector(0, sector.data()), 0x00);
+
+	for (uint32_t block = 1; block < NumCacheBlocks; ++block) {
+		read_sector(*disk, block * SectorsPerBlock);
+	}
+
+	// Using the written block again makes block 1 the eviction candidate
+	EXPECT_EQ(read_sector(*disk, 0), make_sector(0, 1));
+	read_sector(*disk, NumCacheBlocks * SectorsPerBlock);
+
+	EXPECT_EQ(get_sector(read_image_file(), 0), make_sector(0, 0));
+
+	disk->Flush();
+	EXPECT_EQ(get_sector(read_image_file(), 0), make_sector(0, 1));
+}
+
+TEST_F(ImageDiskTest, FlushesOnlyTheGivenSectors)
+{
+	auto disk = open_image(false);
+
+	constexpr uint32_t OtherSector = 10 * SectorsPerBlock;
+	for (const auto s : {SectorsPerBlock + 1, OtherSector}) {
+		auto sector = make_sector(s, 1);
+		ASSERT_EQ(disk->Write_AbsoluteSector(s, sector.data()), 0x00);
+	}
+
+	// The range ends in the block of the first written sector
+	disk->Flush(0, SectorsPerBlock + 1);
+
+	auto data = read_image_file();
+	EXPECT_EQ(get_sector(data, SectorsPerBlock + 1), make_sector(SectorsPerBlock + 1, 1));
+	EXPECT_EQ(get_sector(data, OtherSector), make_sector(OtherSector, 0));
+
+	disk->Flush(OtherSector, 1);
+	data = read_image_file();
+	EXPECT_EQ(get_sector(data, OtherSector), make_sector(OtherSector, 1));
+}
+
+TEST_F(ImageDiskTest, UnmappedImageReadsBackWritesAcrossEvictions)
+{
+	auto disk = open_unmapped_image(false);
+
+	// Every other block, so the dirty and clean blocks interleave in the
+	// LRU order
+	for (uint32_t s = 0; s < NumSectors; s += 2 * SectorsPerBlock) {
+		auto sector = make_sector(s, 2);
+		ASSERT_EQ(disk->Write_AbsoluteSector(s, sector.data()), 0x00);
+	}
+	for (uint32_t s = 0; s < NumSectors; ++s) {
+		const auto is_written = (s % (2 * SectorsPerBlock)) == 0;
+		ASSERT_EQ(read_sector(*disk, s), make_sector(s, is_written ? 2 : 0));
+	}
+	disk->Flush();
+#if !defined(WIN32)
+	EXPECT_EQ(get_sector(contents, 0), make_sector(0, 2));
+	EXPECT_EQ(get_sector(contents, 1), make_sector(1, 0));
+#endif
+}
+
+TEST_F(ImageDiskTest, ReadOnlyImageRejectsWrites)
+{
+	auto disk = open_image(true);
+
+	auto sector = make_sector(5, 1);
+	EXPECT_EQ(disk->Write_AbsoluteSector(5, sector.data()), 0x05);
+	EXPECT_EQ(disk->GetWriteCount(), 0u);
+	EXPECT_EQ(read_sector(*disk, 5), make_sector(5, 0));
+}
+
+TEST_F(ImageDiskTest, UnmappedReadOnlyImageRejectsWrites)
+{
+	auto disk = open_unmapped_image(true);
+
+	auto sector = make_sector(5, 1);
+	EXPECT_EQ(disk->Write_AbsoluteSector(5, sector.data()), 0x05);
+	EXPECT_EQ(disk->GetWriteCount(), 0u);
+
+	// The rejected write mustn't leave a dirty block behind that blocks
+	// the cache when it's evicted
+	for (uint32_t s = 0; s < NumSectors; ++s) {
+		ASSERT_EQ(read_sector(*disk, s), make_sector(s, 0));
+	}
+	for (uint32_t s = 0; s < NumSectors; s += SectorsPerBlock) {
+		ASSERT_EQ(read_sector(*disk, s), make_sector(s, 0));
+	}
+	disk->Flush();
+}
+
+} // namespace
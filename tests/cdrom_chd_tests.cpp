@@ -0,0 +1,557 @@
+// SPDX-FileCopyrightText:  2026-2026 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "dos/cdrom_chd.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "temp_directory.h"
+
+constexpr auto FrameSize      = ChdImage::FrameSize;
+constexpr auto FramesPerHunk  = 4;
+constexpr uint32_t HunkBytes  = FrameSize * FramesPerHunk;
+constexpr uint32_t HeaderSize = 124;
+
+// Track 1 is 6 frames of data, padded to 8, track 2 is 4 frames of audio
+constexpr uint32_t NumFrames = 12;
+constexpr uint32_t NumHunks  = NumFrames / FramesPerHunk;
+
+// Where the P and Q parity of a sector start
+constexpr uint32_t EccStart = 2076;
+
+constexpr auto TrackMetadata =
+        "TRACK:%d TYPE:%s SUBTYPE:NONE FRAMES:%d PREGAP:0 PGTYPE:MODE1 "
+        "PGSUB:RW POSTGAP:0";
+
+// The image written from the BIN by tests/files/chd/make_image.py, laid out
+// the way chdman compresses CD images, with the data track in 'cdzl' hunks
+// and the audio track in 'cdfl' hunks
+constexpr auto FixtureChd = "tests/files/chd/image.chd";
+constexpr auto FixtureBin = "tests/files/chd/image.bin";
+
+static std::vector<uint8_t> read_file(const std_fs::path& path)
+{
+	std::ifstream stream(path, std::ios::binary);
+	return {std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>()};
+}
+
+static void put_be(std::vector<uint8_t>& data, const size_t pos,
+                   const uint64_t value, const int num_bytes)
+{
+	if (data.size() < pos + num_bytes) {
+		data.resize(pos + num_bytes);
+	}
+	for (auto i = 0; i < num_bytes; ++i) {
+		data[pos + i] = static_cast<uint8_t>(value >> ((num_bytes - 1 - i) * 8));
+	}
+}
+
+static uint16_t crc16(const uint8_t* data, const size_t num_bytes)
+{
+	uint16_t crc = 0xffff;
+	for (size_t i = 0; i < num_bytes; ++i) {
+		crc ^= static_cast<uint16_t>(data[i] << 8);
+		for (auto bit = 0; bit < 8; ++bit) {
+			crc = static_cast<uint16_t>((crc & 0x8000) ? (crc << 1) ^ 0x1021
+			                                           : (crc << 1));
+		}
+	}
+	return crc;
+}
+
+// Deflate stream of stored blocks, so we don't need a compressor
+static std::vector<uint8_t> deflate_stored(const uint8_t* data, const uint16_t num_bytes)
+{
+	std::vector<uint8_t> stream = {0x01};
+	stream.push_back(static_cast<uint8_t>(num_bytes & 0xff));
+	stream.push_back(static_cast<uint8_t>(num_bytes >> 8));
+	stream.push_back(static_cast<uint8_t>(~num_bytes & 0xff));
+	stream.push_back(static_cast<uint8_t>((~num_bytes >> 8) & 0xff));
+	stream.insert(stream.end(), data, data + num_bytes);
+	return stream;
+}
+
+class BitWriter {
+public:
+	void Write(const uint32_t value, const int num_bits)
+	{
+		for (auto i = num_bits - 1; i >= 0; --i) {
+			if (num_written % 8 == 0) {
+				data.push_back(0);
+			}
+			if ((value >> i) & 1) {
+				data.back() |= static_cast<uint8_t>(0x80 >> (num_written % 8));
+			}
+			++num_written;
+		}
+	}
+
+	std::vector<uint8_t> data = {};
+
+private:
+	size_t num_written = 0;
+};
+
+static uint8_t crc8_flac(const uint8_t* data, const size_t num_bytes)
+{
+	uint8_t crc = 0;
+	for (size_t i = 0; i < num_bytes; ++i) {
+		crc ^= data[i];
+		for (auto bit = 0; bit < 8; ++bit) {
+			crc = static_cast<uint8_t>((crc & 0x80) ? (crc << 1) ^ 0x07
+			                                        : (crc << 1));
+		}
+	}
+	return crc;
+}
+
+static uint16_t crc16_flac(const uint8_t* data, const size_t num_bytes)
+{
+	uint16_t crc = 0;
+	for (size_t i = 0; i < num_bytes; ++i) {
+		crc ^= static_cast<uint16_t>(data[i] << 8);
+		for (auto bit = 0; bit < 8; ++bit) {
+			crc = static_cast<uint16_t>((crc & 0x8000) ? (crc << 1) ^ 0x8005
+			                                           : (crc << 1));
+		}
+	}
+	return crc;
+}
+
+// A single headerless FLAC frame holding the sectors as big-endian stereo
+// samples, stored verbatim so we don't need an encoder
+static std::vector<uint8_t> encode_flac_verbatim(const std::vector<uint8_t>& sectors)
+{
+	const auto num_samples = static_cast<uint32_t>(sectors.size() / 4);
+
+	BitWriter bits = {};
+	bits.Write(0xfff8, 16);
+	bits.Write(0b0111, 4); // 16-bit block size at the end of the header
+	bits.Write(0b1001, 4); // 44.1 kHz
+	bits.Write(0b0001, 4); // independent left and right channels
+	bits.Write(0b100, 3);  // 16 bits
+	bits.Write(0, 1);
+	bits.Write(0, 8); // frame number
+	bits.Write(num_samples - 1, 16);
+	bits.Write(crc8_flac(bits.data.data(), bits.data.size()), 8);
+
+	for (auto channel = 0; channel < 2; ++channel) {
+		bits.Write(0b00000010, 8); // verbatim subframe
+		for (uint32_t i = 0; i < num_samples; ++i) {
+			const auto pos = (i * 2 + channel) * 2;
+			bits.Write(static_cast<uint32_t>(sectors[pos] << 8 | sectors[pos + 1]),
+			           16);
+		}
+	}
+	const auto crc = crc16_flac(bits.data.data(), bits.data.size());
+	bits.Write(crc, 16);
+	return bits.data;
+}
+
+class ChdImageTest : public ::testing::Test {
+protected:
+	void SetUp() override
+	{
+		frames.resize(NumFrames * FrameSize);
+		for (uint32_t frame = 0; frame < NumFrames; ++frame) {
+			auto data = &frames[frame * FrameSize];
+			for (uint32_t i = 0; i < FrameSize; ++i) {
+				data[i] = static_cast<uint8_t>(frame * 31 + i * 7);
+			}
+			if (frame < 6) {
+				// Mode 1 sector header
+				data[15] = 1;
+			}
+		}
+	}
+
+	std::vector<uint8_t> make_header(const std::array<const char*, 4>& codecs,
+	                                 const uint64_t map_offset,
+	                                 const uint64_t meta_offset) const
+	{
+		std::vector<uint8_t> header(HeaderSize);
+		std::copy_n("MComprHD", 8, header.begin());
+		put_be(header, 8, HeaderSize, 4);
+		put_be(header, 12, 5, 4);
+		for (size_t i = 0; i < codecs.size(); ++i) {
+			if (codecs[i]) {
+				std::copy_n(codecs[i], 4, header.begin() + 16 + i * 4);
+			}
+		}
+		put_be(header, 32, NumHunks * HunkBytes, 8);
+		put_be(header, 40, map_offset, 8);
+		put_be(header, 48, meta_offset, 8);
+		put_be(header, 56, HunkBytes, 4);
+		put_be(header, 60, FrameSize, 4);
+		return header;
+	}
+
+	// Appends the track metadata entries
+	void add_metadata(std::vector<uint8_t>& file) const
+	{
+		const std::array<std::pair<const char*, int>, 2> tracks = {
+		        {{"MODE1_RAW", 6}, {"AUDIO", 4}}};
+
+		for (size_t i = 0; i < tracks.size(); ++i) {
+			char text[128] = {};
+			snprintf(text,
+			         sizeof(text),
+			         TrackMetadata,
+			         static_cast<int>(i + 1),
+			         tracks[i].first,
+			         tracks[i].second);
+			const auto length = strlen(text) + 1;
+
+			const auto pos  = file.size();
+			const auto next = (i + 1 < tracks.size()) ? pos + 16 + length : 0;
+			put_be(file, pos, 0x43485432, 4); // CHT2
+			put_be(file, pos + 4, 0x01, 1);
+			put_be(file, pos + 5, length, 3);
+			put_be(file, pos + 8, next, 8);
+			file.insert(file.end(), text, text + length);
+		}
+	}
+
+	void write_file(const std_fs::path& path, const std::vector<uint8_t>& contents) const
+	{
+		std::ofstream(path, std::ios::binary)
+		        .write(reinterpret_cast<const char*>(contents.data()),
+		               static_cast<std::streamsize>(contents.size()));
+	}
+
+	// Uncompressed image; the second hunk isn't stored and reads as zeros
+	std_fs::path make_uncompressed_image() const
+	{
+		const auto meta_offset = HeaderSize + NumHunks * 4;
+
+		auto file = make_header({}, HeaderSize, meta_offset);
+		file.resize(meta_offset);
+		add_metadata(file);
+
+		for (uint32_t hunk = 0; hunk < NumHunks; ++hunk) {
+			if (hunk == 1) {
+				continue;
+			}
+			// Hunks are stored at multiples of the hunk size
+			const auto hunk_pos = (file.size() + HunkBytes - 1) / HunkBytes;
+			put_be(file, HeaderSize + hunk * 4, hunk_pos, 4);
+
+			file.resize(hunk_pos * HunkBytes);
+			const auto data = &frames[hunk * HunkBytes];
+			file.insert(file.end(), data, data + HunkBytes);
+		}
+
+		const auto path = dir / "uncompressed.chd";
+		write_file(path, file);
+		return path;
+	}
+
+	// 'cdzl' compressed image. The first hunk is compressed, with the sync
+	// pattern and ECC of its first sector stripped, the second is a copy of
+	// the first, and the third is stored uncompressed. The first sector is
+	// a blank Mode 2 sector unless another one is given. With the 'cdfl'
+	// codec, the first hunk is compressed as audio, keeping its sectors
+	// whole.
+	std_fs::path make_compressed_image(const char* codec = "cdzl",
+	                                   const std::vector<uint8_t>& first_sector = {})
+	{
+		if (first_sector.empty()) {
+			// A blank Mode 2 sector, whose ECC is all zeros as the
+			// header doesn't count
+			constexpr std::array<uint8_t, 16> SyncAndHeader = {
+			        0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+			        0xff, 0xff, 0xff, 0x00, 0x00, 0x02, 0x00, 0x02};
+			std::fill_n(frames.begin(), ChdImage::SectorSize, 0);
+			std::copy(SyncAndHeader.begin(), SyncAndHeader.end(), frames.begin());
+		} else {
+			std::copy(first_sector.begin(), first_sector.end(), frames.begin());
+		}
+
+		std::copy_n(frames.begin(), HunkBytes, frames.begin() + HunkBytes);
+
+		auto file = make_header({codec, nullptr, nullptr, nullptr}, 0, HeaderSize);
+		add_metadata(file);
+
+		struct Entry {
+			uint8_t type    = 0;
+			uint32_t length = 0;
+			uint64_t offset = 0;
+			uint16_t crc    = 0;
+		};
+		std::array<Entry, NumHunks> entries = {};
+
+		const auto first_offset = file.size();
+
+		std::vector<uint8_t> sectors = {};
+		std::vector<uint8_t> subcode = {};
+		for (auto frame = 0; frame < FramesPerHunk; ++frame) {
+			const auto data = &frames[frame * FrameSize];
+			sectors.insert(sectors.end(), data, data + ChdImage::SectorSize);
+			subcode.insert(subcode.end(), data + ChdImage::SectorSize, data + FrameSize);
+		}
+
+		std::vector<uint8_t> hunk = {};
+		if (std::string(codec) == "cdfl") {
+			hunk = encode_flac_verbatim(sectors);
+		} else {
+			std::fill_n(sectors.begin(), 12, 0);
+			std::fill(sectors.begin() + EccStart,
+			          sectors.begin() + ChdImage::SectorSize,
+			          0);
+
+			const auto compressed_sectors = deflate_stored(
+			        sectors.data(), static_cast<uint16_t>(sectors.size()));
+
+			hunk = {0x01}; // ECC stripped from frame 0
+			put_be(hunk, 1, compressed_sectors.size(), 2);
+			hunk.insert(hunk.end(),
+			            compressed_sectors.begin(),
+			            compressed_sectors.end());
+		}
+
+		const auto compressed_subcode = deflate_stored(
+		        subcode.data(), static_cast<uint16_t>(subcode.size()));
+		hunk.insert(hunk.end(), compressed_subcode.begin(), compressed_subcode.end());
+
+		entries[0] = {0,
+		              static_cast<uint32_t>(hunk.size()),
+		              file.size(),
+		              crc16(frames.data(), HunkBytes)};
+		file.insert(file.end(), hunk.begin(), hunk.end());
+
+		entries[1] = {5, 0, 0, 0};
+
+		const auto data = &frames[2 * HunkBytes];
+		entries[2] = {4, HunkBytes, file.size(), crc16(data, HunkBytes)};
+		file.insert(file.end(), data, data + HunkBytes);
+
+		// The map: all 16 Huffman codes are 4 bits long, which is
+		// encoded as a length of 4 repeated 16 times, then the types,
+		// then the lengths, CRCs and offsets
+		constexpr auto LengthBits = 24;
+		constexpr auto SelfBits   = 8;
+
+		BitWriter bits = {};
+		bits.Write(1, 4);
+		bits.Write(4, 4);
+		bits.Write(16 - 3, 4);
+		for (const auto& entry : entries) {
+			bits.Write(entry.type, 4);
+		}
+		for (const auto& entry : entries) {
+			if (entry.type == 0) {
+				bits.Write(entry.length, LengthBits);
+				bits.Write(entry.crc, 16);
+			} else if (entry.type == 4) {
+				bits.Write(entry.crc, 16);
+			} else {
+				bits.Write(static_cast<uint32_t>(entry.offset), SelfBits);
+			}
+		}
+
+		// The map's CRC covers the decoded entries
+		std::vector<uint8_t> raw_map = {};
+		for (const auto& entry : entries) {
+			const auto pos = raw_map.size();
+			put_be(raw_map, pos, entry.type, 1);
+			put_be(raw_map, pos + 1, entry.length, 3);
+			put_be(raw_map, pos + 4, entry.offset, 6);
+			put_be(raw_map, pos + 10, entry.crc, 2);
+		}
+
+		const auto map_offset = file.size();
+		put_be(file, 40, map_offset, 8);
+		put_be(file, map_offset, bits.data.size(), 4);
+		put_be(file, map_offset + 4, first_offset, 6);
+		put_be(file, map_offset + 10, crc16(raw_map.data(), raw_map.size()), 2);
+		put_be(file, map_offset + 12, LengthBits, 1);
+		put_be(file, map_offset + 13, SelfBits, 1);
+		put_be(file, map_offset + 14, 0, 2);
+		file.insert(file.end(), bits.data.begin(), bits.data.end());
+
+		const auto path = dir / "compressed.chd";
+		write_file(path, file);
+		return path;
+	}
+
+	TempDirectory temp_dir{"dosbox_cdrom_chd"};
+	const std_fs::path dir = temp_dir.GetPath();
+	std::vector<uint8_t> frames = {};
+};
+
+TEST_F(ChdImageTest, ReadsTracks)
+{
+	const auto image = ChdImage::Open(make_uncompressed_image());
+	ASSERT_TRUE(image);
+
+	const auto& tracks = image->GetTracks();
+	ASSERT_EQ(tracks.size(), 2u);
+
+	EXPECT_EQ(tracks[0].number, 1);
+	EXPECT_EQ(tracks[0].type, "MODE1_RAW");
+	EXPECT_EQ(tracks[0].num_frames, 6u);
+	EXPECT_EQ(tracks[0].first_frame, 0u);
+	EXPECT_FALSE(tracks[0].is_pregap_stored);
+
+	// Tracks are padded to a multiple of four frames
+	EXPECT_EQ(tracks[1].number, 2);
+	EXPECT_EQ(tracks[1].type, "AUDIO");
+	EXPECT_EQ(tracks[1].num_frames, 4u);
+	EXPECT_EQ(tracks[1].first_frame, 8u);
+}
+
+TEST_F(ChdImageTest, ReadsUncompressedFrames)
+{
+	const auto image = ChdImage::Open(make_uncompressed_image());
+	ASSERT_TRUE(image);
+
+	std::vector<uint8_t> frame(FrameSize);
+	ASSERT_TRUE(image->Read(0, frame.data(), FrameSize));
+	EXPECT_TRUE(std::equal(frame.begin(), frame.end(), frames.begin()));
+
+	// The hunk that isn't stored reads as zeros
+	ASSERT_TRUE(image->Read(5 * FrameSize, frame.data(), FrameSize));
+	EXPECT_EQ(frame, std::vector<uint8_t>(FrameSize, 0));
+
+	// A read spanning hunks
+	std::vector<uint8_t> data(FrameSize * 2);
+	ASSERT_TRUE(image->Read(7 * FrameSize + 100, data.data(), FrameSize * 2));
+	EXPECT_TRUE(std::equal(data.begin() + FrameSize - 100,
+	                       data.end(),
+	                       frames.begin() + 8 * FrameSize));
+
+	// Past the end
+	EXPECT_FALSE(image->Read(NumFrames * FrameSize, frame.data(), FrameSize));
+}
+
+TEST_F(ChdImageTest, ReadsCompressedFrames)
+{
+	const auto image = ChdImage::Open(make_compressed_image());
+	ASSERT_TRUE(image);
+	EXPECT_EQ(image->GetTracks().size(), 2u);
+
+	// The sync pattern and ECC of the first sector are restored, and the
+	// sectors and their subcode are put back together
+	std::vector<uint8_t> hunk(HunkBytes);
+	for (uint32_t i = 0; i < NumHunks; ++i) {
+		ASSERT_TRUE(image->Read(i * HunkBytes, hunk.data(), HunkBytes));
+		EXPECT_TRUE(std::equal(hunk.begin(), hunk.end(), frames.begin() + i * HunkBytes));
+	}
+}
+
+TEST_F(ChdImageTest, ReadsFlacCompressedFrames)
+{
+	const auto image = ChdImage::Open(make_compressed_image("cdfl"));
+	ASSERT_TRUE(image);
+
+	// The subcode after the FLAC frames is restored as well, which the
+	// CRC of the hunk covers
+	std::vector<uint8_t> hunk(HunkBytes);
+	for (uint32_t i = 0; i < NumHunks; ++i) {
+		ASSERT_TRUE(image->Read(i * HunkBytes, hunk.data(), HunkBytes));
+		EXPECT_TRUE(std::equal(hunk.begin(), hunk.end(), frames.begin() + i * HunkBytes));
+	}
+}
+
+TEST_F(ChdImageTest, CachesHunks)
+{
+	const auto image = ChdImage::Open(make_uncompressed_image());
+	ASSERT_TRUE(image);
+
+	// Jump around the image, as a program seeking through files would
+	const std::array<uint32_t, 8> order = {9, 2, 11, 0, 8, 3, 10, 1};
+
+	std::vector<uint8_t> frame(FrameSize);
+	for (const auto index : order) {
+		ASSERT_TRUE(image->Read(index * FrameSize, frame.data(), FrameSize));
+		EXPECT_EQ(frame[100], frames[index * FrameSize + 100]);
+	}
+
+	// Every hunk was only decompressed once
+	EXPECT_EQ(image->GetNumCacheMisses(), 2u);
+	EXPECT_EQ(image->GetNumCacheHits(), order.size() - 2);
+}
+
+TEST_F(ChdImageTest, RejectsInvalidImages)
+{
+	const auto path = dir / "not_a_chd.iso";
+	write_file(path, std::vector<uint8_t>(HunkBytes, 0));
+	EXPECT_FALSE(ChdImage::Open(path));
+
+	EXPECT_FALSE(ChdImage::Open(dir / "missing.chd"));
+
+	// LZMA compressed images aren't supported
+	EXPECT_FALSE(ChdImage::Open(make_compressed_image("cdlz")));
+}
+
+TEST_F(ChdImageTest, ReadsImageLikeTheBin)
+{
+	const auto image = ChdImage::Open(FixtureChd);
+	ASSERT_TRUE(image);
+
+	const auto bin = read_file(FixtureBin);
+	ASSERT_FALSE(bin.empty());
+
+	const auto& tracks = image->GetTracks();
+	ASSERT_EQ(tracks.size(), 2u);
+	EXPECT_EQ(tracks[0].type, "MODE1_RAW");
+	EXPECT_EQ(tracks[1].type, "AUDIO");
+	ASSERT_EQ((tracks[0].num_frames + tracks[1].num_frames) * ChdImage::SectorSize,
+	          bin.size());
+
+	std::vector<uint8_t> frame(FrameSize);
+	auto bin_sector = bin.begin();
+	for (const auto& track : tracks) {
+		const auto is_audio = (track.type == "AUDIO");
+
+		for (uint32_t i = 0; i < track.num_frames; ++i) {
+			const auto index = track.first_frame + i;
+			ASSERT_TRUE(image->Read(static_cast<uint64_t>(index) * FrameSize,
+			                        frame.data(),
+			                        FrameSize));
+
+			// The audio is stored big-endian
+			if (is_audio) {
+				for (uint32_t b = 0; b < ChdImage::SectorSize; b += 2) {
+					std::swap(frame[b], frame[b + 1]);
+				}
+			}
+			EXPECT_TRUE(std::equal(bin_sector,
+			                       bin_sector + ChdImage::SectorSize,
+			                       frame.begin()))
+			        << "in frame " << index;
+
+			// The BIN has no subcode
+			EXPECT_TRUE(std::all_of(frame.begin() + ChdImage::SectorSize,
+			                        frame.end(),
+			                        [](const auto b) { return b == 0; }));
+
+			bin_sector += ChdImage::SectorSize;
+		}
+	}
+}
+
+TEST_F(ChdImageTest, RegeneratesEccOfSectorWithData)
+{
+	// A Mode 1 sector holding data, with its ECC stripped in the image
+	const auto bin = read_file(FixtureBin);
+	ASSERT_GE(bin.size(), ChdImage::SectorSize);
+	const std::vector<uint8_t> sector(bin.begin(), bin.begin() + ChdImage::SectorSize);
+	ASSERT_EQ(sector[15], 1);
+
+	const auto image = ChdImage::Open(make_compressed_image("cdzl", sector));
+	ASSERT_TRUE(image);
+
+	std::vector<uint8_t> frame(FrameSize);
+	ASSERT_TRUE(image->Read(0, frame.data(), FrameSize));
+	EXPECT_TRUE(std::equal(sector.begin(), sector.end(), frame.begin()));
+}
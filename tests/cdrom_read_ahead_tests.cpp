@@ -0,0 +1,147 @@
+// SPDX-FileCopyrightText:  2026-2026 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "dos/cdrom_read_ahead.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "temp_directory.h"
+#include "utils/math_utils.h"
+
+namespace {
+
+constexpr uint32_t ChunkSize  = ImageReadAhead::ChunkSize;
+constexpr uint32_t RawSector  = 2352;
+constexpr uint32_t DataSector = 2048;
+
+// Not a whole number of chunks, so the last one is partial
+constexpr uint32_t ImageSize = 20 * ChunkSize + 1000;
+
+uint8_t get_image_byte(const uint32_t pos)
+{
+	return static_cast<uint8_t>(pos * 13 + (pos >> 11));
+}
+
+class ImageReadAheadTest : public ::testing::Test {
+protected:
+	void SetUp() override
+	{
+		std::vector<char> data(ImageSize);
+		for (uint32_t pos = 0; pos < ImageSize; ++pos) {
+			data[pos] = static_cast<char>(get_image_byte(pos));
+		}
+		std::ofstream(image_path, std::ios::binary)
+		        .write(data.data(), static_cast<std::streamsize>(data.size()));
+
+		read_ahead = std::make_unique<ImageReadAhead>(image_path);
+	}
+
+	// Returns whether the read was served from the read-ahead data, and
+	// checks the data if it was
+	bool read(const uint32_t offset, const uint32_t num_bytes)
+	{
+		std::vector<uint8_t> buffer(num_bytes);
+		const auto is_hit = read_ahead->Read(buffer.data(), offset, num_bytes);
+		if (is_hit) {
+			for (uint32_t i = 0; i < num_bytes; ++i) {
+				EXPECT_EQ(buffer[i], get_image_byte(offset + i))
+				        << "at byte " << offset + i;
+			}
+		}
+		return is_hit;
+	}
+
+	TempDirectory temp_dir{"dosbox_cdrom_read_ahead"};
+	const std_fs::path image_path = temp_dir.GetPath() / "image.bin";
+
+	std::unique_ptr<ImageReadAhead> read_ahead = {};
+};
+
+TEST_F(ImageReadAheadTest, ServesSequentialReads)
+{
+	// The first reads go to the image, and the one detected as sequential
+	// only starts reading ahead
+	EXPECT_FALSE(read(0, RawSector));
+	EXPECT_FALSE(read(RawSector, RawSector));
+	EXPECT_FALSE(read(2 * RawSector, RawSector));
+
+	// From then on the window moves along with the reads, which span the
+	// chunk boundaries and end with the partial last chunk
+	uint32_t offset = 3 * RawSector;
+	while (offset < ImageSize) {
+		const auto num_bytes = std::min(RawSector, ImageSize - offset);
+		read_ahead->WaitUntilFilled();
+		EXPECT_TRUE(read(offset, num_bytes)) << "at offset " << offset;
+		offset += num_bytes;
+	}
+
+	EXPECT_EQ(read_ahead->GetNumMisses(), 3u);
+	EXPECT_EQ(read_ahead->GetNumHits(), ceil_udivide(ImageSize, RawSector) - 3);
+}
+
+TEST_F(ImageReadAheadTest, CookedReadsCountAsSequential)
+{
+	// The user data of raw sectors, skipping their 16-byte headers
+	constexpr uint32_t NumSectors = 200;
+	for (uint32_t sector = 0; sector < NumSectors; ++sector) {
+		read_ahead->WaitUntilFilled();
+		read(sector * RawSector + 16, DataSector);
+	}
+	EXPECT_EQ(read_ahead->GetNumMisses(), 3u);
+	EXPECT_EQ(read_ahead->GetNumHits(), NumSectors - 3);
+}
+
+TEST_F(ImageReadAheadTest, MissesRandomReads)
+{
+	std::mt19937 rng(42);
+	for (auto i = 0; i < 200; ++i) {
+		// Every third sector, so they're never back to back
+		const auto sector = static_cast<uint32_t>(rng() % (ImageSize / DataSector / 3));
+		EXPECT_FALSE(read(sector * 3 * DataSector, DataSector));
+	}
+	EXPECT_EQ(read_ahead->GetNumHits(), 0u);
+}
+
+TEST_F(ImageReadAheadTest, StartsOverAfterSeek)
+{
+	for (uint32_t sector = 0; sector < 3; ++sector) {
+		EXPECT_FALSE(read(sector * DataSector, DataSector));
+	}
+	read_ahead->WaitUntilFilled();
+	EXPECT_TRUE(read(3 * DataSector, DataSector));
+
+	// Past the window, so it takes sequential reads to move it there
+	const auto offset = 15 * ChunkSize;
+	for (uint32_t sector = 0; sector < 3; ++sector) {
+		EXPECT_FALSE(read(offset + sector * DataSector, DataSector));
+	}
+	read_ahead->WaitUntilFilled();
+	EXPECT_TRUE(read(offset + 3 * DataSector, DataSector));
+
+	// The chunks not reused by the new window still serve reads going
+	// back, the reused ones don't
+	EXPECT_TRUE(read(5 * ChunkSize, DataSector));
+	EXPECT_FALSE(read(0, DataSector));
+}
+
+TEST_F(ImageReadAheadTest, DoesNotReadPastEndOfImage)
+{
+	const auto last_sector = ImageSize / DataSector - 1;
+	for (auto sector = last_sector - 2; sector <= last_sector; ++sector) {
+		EXPECT_FALSE(read(sector * DataSector, DataSector));
+	}
+	read_ahead->WaitUntilFilled();
+
+	// The last chunk only holds the rest of the image
+	const auto offset = (last_sector + 1) * DataSector;
+	EXPECT_TRUE(read(offset, ImageSize - offset));
+	EXPECT_FALSE(read(ImageSize - 10, 20));
+}
+
+} // namespace
@@ -0,0 +1,163 @@
+// SPDX-FileCopyrightText:  2026-2026 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "ints/differencing_image.h"
+
+#include <fstream>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "temp_directory.h"
+
+constexpr auto BlockSize = DifferencingImage::BlockSize;
+
+class DifferencingImageTest : public ::testing::Test {
+protected:
+	void SetUp() override
+	{
+		base_path    = dir / "base.img";
+		overlay_path = dir / "base.dif";
+
+		// Three and a half blocks, so the last one is partial
+		base_contents.resize(BlockSize * 3 + BlockSize / 2);
+		for (size_t i = 0; i < base_contents.size(); ++i) {
+			base_contents[i] = static_cast<uint8_t>(i * 7);
+		}
+		write_base(base_contents);
+	}
+
+	void write_base(const std::vector<uint8_t>& contents) const
+	{
+		std::ofstream(base_path, std::ios::binary)
+		        .write(reinterpret_cast<const char*>(contents.data()),
+		               static_cast<std::streamsize>(contents.size()));
+	}
+
+	std::vector<uint8_t> read_base() const
+	{
+		std::vector<uint8_t> contents(std_fs::file_size(base_path));
+		std::ifstream(base_path, std::ios::binary)
+		        .read(reinterpret_cast<char*>(contents.data()),
+		              static_cast<std::streamsize>(contents.size()));
+		return contents;
+	}
+
+	TempDirectory temp_dir{"dosbox_differencing_image"};
+	const std_fs::path dir = temp_dir.GetPath();
+	std_fs::path base_path    = {};
+	std_fs::path overlay_path = {};
+
+	std::vector<uint8_t> base_contents = {};
+};
+
+TEST_F(DifferencingImageTest, ReadsThroughToBase)
+{
+	auto image = DifferencingImage::Open(overlay_path, base_path);
+	ASSERT_TRUE(image);
+	EXPECT_TRUE(std_fs::exists(overlay_path));
+
+	std::vector<uint8_t> block(BlockSize);
+
+	EXPECT_EQ(image->ReadBlock(1, block.data()), BlockSize);
+	EXPECT_EQ(block[0], base_contents[BlockSize]);
+
+	// The last block is only half present
+	EXPECT_EQ(image->ReadBlock(3, block.data()), BlockSize / 2);
+	EXPECT_EQ(image->ReadBlock(4, block.data()), 0u);
+}
+
+TEST_F(DifferencingImageTest, WritesGoToOverlay)
+{
+	std::vector<uint8_t> block(BlockSize, 0xab);
+	{
+		auto image = DifferencingImage::Open(overlay_path, base_path);
+		ASSERT_TRUE(image);
+		EXPECT_TRUE(image->WriteBlock(2, block.data(), BlockSize));
+		EXPECT_EQ(image->GetNumModifiedBlocks(), 1u);
+	}
+	EXPECT_EQ(read_base(), base_contents);
+
+	// The changes persist when the overlay is opened again
+	auto image = DifferencingImage::Open(overlay_path, base_path);
+	ASSERT_TRUE(image);
+	EXPECT_EQ(image->GetNumModifiedBlocks(), 1u);
+
+	std::vector<uint8_t> read(BlockSize);
+	EXPECT_EQ(image->ReadBlock(2, read.data()), BlockSize);
+	EXPECT_EQ(read, block);
+
+	EXPECT_EQ(image->ReadBlock(1, read.data()), BlockSize);
+	EXPECT_EQ(read[0], base_contents[BlockSize]);
+}
+
+TEST_F(DifferencingImageTest, CommitWritesToBase)
+{
+	auto image = DifferencingImage::Open(overlay_path, base_path);
+	ASSERT_TRUE(image);
+
+	std::vector<uint8_t> block(BlockSize, 0xcd);
+	EXPECT_TRUE(image->WriteBlock(0, block.data(), BlockSize));
+	EXPECT_TRUE(image->WriteBlock(3, block.data(), BlockSize / 2));
+
+	EXPECT_TRUE(image->Commit());
+	EXPECT_EQ(image->GetNumModifiedBlocks(), 0u);
+
+	auto expected = base_contents;
+	std::fill(expected.begin(), expected.begin() + BlockSize, 0xcd);
+	std::fill(expected.begin() + BlockSize * 3, expected.end(), 0xcd);
+	EXPECT_EQ(read_base(), expected);
+
+	// The disk reads the same after the commit
+	std::vector<uint8_t> read(BlockSize);
+	EXPECT_EQ(image->ReadBlock(0, read.data()), BlockSize);
+	EXPECT_EQ(read, block);
+}
+
+TEST_F(DifferencingImageTest, DiscardRevertsToBase)
+{
+	auto image = DifferencingImage::Open(overlay_path, base_path);
+	ASSERT_TRUE(image);
+
+	std::vector<uint8_t> block(BlockSize, 0xef);
+	EXPECT_TRUE(image->WriteBlock(1, block.data(), BlockSize));
+	EXPECT_TRUE(image->Discard());
+	EXPECT_EQ(image->GetNumModifiedBlocks(), 0u);
+
+	std::vector<uint8_t> read(BlockSize);
+	EXPECT_EQ(image->ReadBlock(1, read.data()), BlockSize);
+	EXPECT_EQ(read[0], base_contents[BlockSize]);
+	EXPECT_EQ(read_base(), base_contents);
+}
+
+// Windows doesn't allow renaming open files
+#if !defined(WIN32)
+TEST_F(DifferencingImageTest, DiscardFailsIfOverlayCannotBeTruncated)
+{
+	auto image = DifferencingImage::Open(overlay_path, base_path);
+	ASSERT_TRUE(image);
+
+	// The open overlay file can still be written, but it can't be found
+	// by its path to truncate it anymore
+	const auto moved_path = dir / "moved.dif";
+	std_fs::rename(overlay_path, moved_path);
+
+	std::vector<uint8_t> block(BlockSize, 0xef);
+	EXPECT_TRUE(image->WriteBlock(1, block.data(), BlockSize));
+	EXPECT_FALSE(image->Discard());
+
+	std_fs::rename(moved_path, overlay_path);
+}
+#endif
+
+TEST_F(DifferencingImageTest, RejectsOtherBase)
+{
+	ASSERT_TRUE(DifferencingImage::Open(overlay_path, base_path));
+
+	base_contents.resize(base_contents.size() + BlockSize);
+	write_base(base_contents);
+	EXPECT_FALSE(DifferencingImage::Open(overlay_path, base_path));
+
+	// Neither is something that isn't a differencing image
+	EXPECT_FALSE(DifferencingImage::Open(base_path, base_path));
+}
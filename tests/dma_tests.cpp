@@ -0,0 +1,321 @@
+// SPDX-FileCopyrightText:  2026-2026 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "hardware/dma.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <vector>
+
+#include "config/setup.h"
+#include "cpu/paging.h"
+#include "dosbox_test_fixture.h"
+#include "hardware/memory.h"
+
+extern uint32_t ems_board_mapping[LINK_START];
+
+namespace {
+
+struct SpanRecord {
+	const uint8_t* data = nullptr;
+	size_t num_bytes    = 0;
+};
+
+class DmaSpanTest : public DOSBoxTestFixture {
+protected:
+	void SetUp() override
+	{
+		DOSBoxTestFixture::SetUp();
+		DMA_Init();
+	}
+
+	void TearDown() override
+	{
+		DMA_Destroy();
+		DOSBoxTestFixture::TearDown();
+	}
+
+	// Sets up the channel to transfer from the address within the page,
+	// with the address and count in words
+	static DmaChannel* setup_channel(const uint8_t chan_num, const uint8_t page,
+	                                 const uint16_t addr, const uint16_t num_words)
+	{
+		auto chan = DMA_GetChannel(chan_num);
+		EXPECT_TRUE(chan);
+		if (chan) {
+			chan->SetPage(page);
+			chan->base_addr  = addr;
+			chan->curr_addr  = addr;
+			chan->base_count = static_cast<uint16_t>(num_words - 1);
+			chan->curr_count = static_cast<uint16_t>(num_words - 1);
+		}
+		return chan;
+	}
+
+	static std::vector<SpanRecord> read_spans(DmaChannel& chan, const size_t words)
+	{
+		std::vector<SpanRecord> spans = {};
+		chan.ReadSpans(words, [&](const DmaSpan& span) {
+			spans.push_back({span.data, span.num_bytes});
+		});
+		return spans;
+	}
+
+	// Fills guest memory with a pattern that differs from page to page
+	static void fill(const PhysPt start, const uint32_t num_bytes)
+	{
+		for (auto addr = start; addr < start + num_bytes; ++addr) {
+			phys_writeb(addr, static_cast<uint8_t>(addr * 7 + (addr >> 12)));
+		}
+	}
+
+	static std::vector<uint8_t> read_memory(const PhysPt start,
+	                                        const uint32_t num_bytes)
+	{
+		std::vector<uint8_t> bytes = {};
+		for (auto addr = start; addr < start + num_bytes; ++addr) {
+			bytes.push_back(phys_readb(addr));
+		}
+		return bytes;
+	}
+};
+
+TEST_F(DmaSpanTest, CoalescesConsecutivePages)
+{
+	auto chan = setup_channel(1, 0x01, 0x0800, 0x3000);
+	ASSERT_TRUE(chan);
+
+	const auto spans = read_spans(*chan, 0x3000);
+	ASSERT_EQ(spans.size(), 1u);
+	EXPECT_EQ(spans[0].data, MemBase + 0x10800);
+	EXPECT_EQ(spans[0].num_bytes, 0x3000u);
+}
+
+TEST_F(DmaSpanTest, SplitsAtRemappedFirstMegabytePage)
+{
+	auto chan = setup_channel(1, 0x01, 0x0800, 0x3000);
+	ASSERT_TRUE(chan);
+
+	paging.firstmb[0x12] = 0x180;
+	const auto spans = read_spans(*chan, 0x3000);
+	paging.firstmb[0x12] = 0x12;
+
+	ASSERT_EQ(spans.size(), 3u);
+	EXPECT_EQ(spans[0].data, MemBase + 0x10800);
+	EXPECT_EQ(spans[0].num_bytes, 0x1800u);
+	EXPECT_EQ(spans[1].data, MemBase + 0x180000);
+	EXPECT_EQ(spans[1].num_bytes, 0x1000u);
+	EXPECT_EQ(spans[2].data, MemBase + 0x13000);
+	EXPECT_EQ(spans[2].num_bytes, 0x800u);
+}
+
+TEST_F(DmaSpanTest, SplitsAtMappedEmsPage)
+{
+	auto chan = setup_channel(1, 0x0e, 0x0800, 0x1000);
+	ASSERT_TRUE(chan);
+
+	// The EMS board mapping of the page frame is used, not the paging
+	ems_board_mapping[0xe1] = 0x200;
+	paging.firstmb[0xe1]    = 0x300;
+	const auto spans = read_spans(*chan, 0x1000);
+	ems_board_mapping[0xe1] = 0xe1;
+	paging.firstmb[0xe1]    = 0xe1;
+
+	ASSERT_EQ(spans.size(), 2u);
+	EXPECT_EQ(spans[0].data, MemBase + 0xe0800);
+	EXPECT_EQ(spans[0].num_bytes, 0x800u);
+	EXPECT_EQ(spans[1].data, MemBase + 0x200000);
+	EXPECT_EQ(spans[1].num_bytes, 0x800u);
+}
+
+TEST_F(DmaSpanTest, ReadsOpenBusPastEndOfMemory)
+{
+	MEM_Destroy();
+	set_section_property_value("dosbox", "memsize", "2");
+	MEM_Init(get_section("dosbox"));
+	PAGING_ClearTLB();
+	ASSERT_EQ(MEM_TotalPages(), 0x200u);
+
+	// The end of the memory reads as usual
+	auto chan = setup_channel(1, 0x1f, 0xf800, 0x800);
+	ASSERT_TRUE(chan);
+	fill(0x1ff800, 0x800);
+
+	std::vector<uint8_t> bytes(0x1800);
+	EXPECT_EQ(chan->Read(0x800, bytes.data()), 0x800u);
+	const auto expected = read_memory(0x1ff800, 0x800);
+	EXPECT_TRUE(std::equal(expected.begin(), expected.end(), bytes.begin()));
+
+	// The open bus beyond it reads as all ones
+	chan = setup_channel(1, 0x20, 0x0000, 0x1800);
+	ASSERT_TRUE(chan);
+	EXPECT_EQ(chan->Read(0x1800, bytes.data()), 0x1800u);
+	EXPECT_TRUE(std::all_of(bytes.begin(), bytes.end(), [](const auto b) {
+		return b == 0xff;
+	}));
+
+	// Writes to it are lost, and don't change what's read back
+	chan = setup_channel(1, 0x20, 0x0000, 0x1000);
+	EXPECT_EQ(chan->WriteSpans(0x1000, [](const DmaSpan& span) {
+		std::memset(span.data, 0, span.num_bytes);
+	}), 0x1000u);
+
+	chan = setup_channel(1, 0x20, 0x0000, 0x1000);
+	EXPECT_EQ(chan->Read(0x1000, bytes.data()), 0x1000u);
+	EXPECT_EQ(bytes[0], 0xff);
+	EXPECT_EQ(bytes[0xfff], 0xff);
+}
+
+TEST_F(DmaSpanTest, AutoInitWrapsToStartOfBuffer)
+{
+	constexpr PhysPt BufferStart      = 0x20100;
+	constexpr uint16_t BufferSize     = 0x100;
+	constexpr uint32_t NumBytesToRead = 0x12c;
+
+	auto chan = setup_channel(1, 0x02, 0x0100, BufferSize);
+	ASSERT_TRUE(chan);
+	chan->is_autoiniting = true;
+	fill(BufferStart, BufferSize);
+
+	std::vector<DmaEvent> events = {};
+	chan->RegisterCallback([&](const DmaChannel*, const DmaEvent event) {
+		events.push_back(event);
+	});
+	chan->SetMask(false);
+	events.clear();
+
+	const auto spans = read_spans(*chan, NumBytesToRead);
+
+	// The buffer, then its start again after the terminal count
+	ASSERT_EQ(spans.size(), 2u);
+	EXPECT_EQ(spans[0].data, MemBase + BufferStart);
+	EXPECT_EQ(spans[0].num_bytes, BufferSize);
+	EXPECT_EQ(spans[1].data, MemBase + BufferStart);
+	EXPECT_EQ(spans[1].num_bytes, NumBytesToRead - BufferSize);
+
+	ASSERT_EQ(events.size(), 1u);
+	EXPECT_EQ(events[0], DmaEvent::ReachedTerminalCount);
+	EXPECT_TRUE(chan->has_reached_terminal_count);
+	EXPECT_EQ(chan->curr_addr, 0x0100u + NumBytesToRead - BufferSize);
+	EXPECT_EQ(chan->curr_count, 2 * BufferSize - NumBytesToRead - 1);
+	EXPECT_FALSE(chan->is_masked);
+}
+
+TEST_F(DmaSpanTest, MasksAtTerminalCountWithoutAutoInit)
+{
+	constexpr uint16_t BufferSize = 0x100;
+
+	auto chan = setup_channel(1, 0x02, 0x0100, BufferSize);
+	ASSERT_TRUE(chan);
+	chan->is_autoiniting = false;
+
+	std::vector<DmaEvent> events = {};
+	chan->RegisterCallback([&](const DmaChannel*, const DmaEvent event) {
+		events.push_back(event);
+	});
+	chan->SetMask(false);
+	events.clear();
+
+	const auto spans = read_spans(*chan, 2 * BufferSize);
+
+	// The transfer stops at the terminal count
+	ASSERT_EQ(spans.size(), 1u);
+	EXPECT_EQ(spans[0].num_bytes, BufferSize);
+
+	ASSERT_EQ(events.size(), 2u);
+	EXPECT_EQ(events[0], DmaEvent::ReachedTerminalCount);
+	EXPECT_EQ(events[1], DmaEvent::IsMasked);
+	EXPECT_TRUE(chan->is_masked);
+	EXPECT_EQ(chan->curr_count, 0xffff);
+}
+
+// Reads the transfers through for_each_dma_frame_run() like the Sound
+// Blaster does, and returns the frames in the order they were handed over
+template <size_t FrameBytes>
+std::vector<uint8_t> read_frames(DmaChannel& chan,
+                                 const std::vector<size_t>& transfer_words,
+                                 size_t& num_runs_carried)
+{
+	std::array<uint8_t, FrameBytes> carried = {};
+	uint32_t num_carried = 0;
+
+	std::vector<uint8_t> frames = {};
+	for (const auto words : transfer_words) {
+		chan.ReadSpans(words, [&](const DmaSpan& span) {
+			for_each_dma_frame_run<FrameBytes>(
+			        span,
+			        carried.data(),
+			        num_carried,
+			        [&](const uint8_t* data, const size_t num_bytes) {
+				        EXPECT_EQ(num_bytes % FrameBytes, 0u);
+				        if (data == carried.data()) {
+					        ++num_runs_carried;
+				        }
+				        frames.insert(frames.end(), data, data + num_bytes);
+			        });
+		});
+	}
+	EXPECT_EQ(num_carried, 0u);
+	return frames;
+}
+
+TEST_F(DmaSpanTest, Carries16BitStereoFramesAcrossSpans)
+{
+	// A 16-bit channel starting a word before a page boundary, so the
+	// first and the last frames of the remapped page straddle its ends
+	auto chan = setup_channel(5, 0x02, 0x07ff, 0x0802);
+	ASSERT_TRUE(chan);
+
+	fill(0x20ffe, 2);
+	fill(0x180000, 0x1000);
+	fill(0x22000, 2);
+
+	paging.firstmb[0x21] = 0x180;
+	size_t num_runs_carried = 0;
+	const auto frames = read_frames<4>(*chan, {0x0802}, num_runs_carried);
+	paging.firstmb[0x21] = 0x21;
+
+	auto expected = read_memory(0x20ffe, 2);
+	const auto remapped = read_memory(0x180000, 0x1000);
+	expected.insert(expected.end(), remapped.begin(), remapped.end());
+	const auto next = read_memory(0x22000, 2);
+	expected.insert(expected.end(), next.begin(), next.end());
+
+	EXPECT_EQ(frames, expected);
+	EXPECT_EQ(num_runs_carried, 2u);
+}
+
+TEST_F(DmaSpanTest, Carries8BitStereoFramesAcrossTransfers)
+{
+	// 16-bit stereo over an 8-bit channel, in transfers that end mid-frame
+	constexpr uint16_t NumBytes = 0x1400;
+
+	auto chan = setup_channel(1, 0x03, 0x0f01, NumBytes);
+	ASSERT_TRUE(chan);
+
+	fill(0x30f01, NumBytes);
+	fill(0x190000, 0x1000);
+
+	paging.firstmb[0x31] = 0x190;
+	size_t num_runs_carried = 0;
+	const auto frames = read_frames<4>(*chan, {0x101, 0x7ff, 0xb00}, num_runs_carried);
+	paging.firstmb[0x31] = 0x31;
+
+	auto expected = read_memory(0x30f01, 0xff);
+	const auto remapped = read_memory(0x190000, 0x1000);
+	expected.insert(expected.end(), remapped.begin(), remapped.end());
+	const auto rest = read_memory(0x32000, NumBytes - 0x10ff);
+	expected.insert(expected.end(), rest.begin(), rest.end());
+
+	ASSERT_EQ(expected.size(), NumBytes);
+	EXPECT_EQ(frames, expected);
+
+	// The end of the first transfer and both ends of the remapped page
+	// split a frame
+	EXPECT_EQ(num_runs_carried, 3u);
+}
+
+} // namespace
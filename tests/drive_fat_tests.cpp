@@ -0,0 +1,327 @@
+// SPDX-FileCopyrightText:  2026-2026 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "dos/drives.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "dosbox_test_fixture.h"
+#include "ints/bios_disk.h"
+#include "temp_directory.h"
+
+namespace {
+
+// 1.44 MB floppy: one sector per cluster, two 9-sector FATs after the boot
+// sector, then 14 sectors of root directory
+constexpr uint32_t SectorSize      = 512;
+constexpr uint32_t NumSectors      = 2880;
+constexpr uint32_t SectorsPerFat   = 9;
+constexpr uint32_t FirstFatSector  = 1;
+constexpr uint32_t RootDirSector   = FirstFatSector + 2 * SectorsPerFat;
+constexpr uint32_t FirstDataSector = RootDirSector + 14;
+
+constexpr uint32_t FileClusters = 40;
+constexpr uint32_t FileSize     = FileClusters * SectorSize - 100;
+
+constexpr uint16_t EndOfChain = 0xfff;
+
+uint32_t get_cluster_sector(const uint16_t cluster)
+{
+	return FirstDataSector + cluster - 2;
+}
+
+void put_le(std::vector<uint8_t>& data, const size_t offset,
+            const uint32_t value, const int num_bytes)
+{
+	for (auto i = 0; i < num_bytes; ++i) {
+		data[offset + i] = static_cast<uint8_t>(value >> (i * 8));
+	}
+}
+
+void set_fat12_entry(std::vector<uint8_t>& fat, const uint16_t cluster,
+                     const uint16_t value)
+{
+	const auto offset = cluster * 3 / 2;
+	if (cluster % 2 == 0) {
+		fat[offset]     = static_cast<uint8_t>(value);
+		fat[offset + 1] = static_cast<uint8_t>((fat[offset + 1] & 0xf0) |
+		                                       ((value >> 8) & 0x0f));
+	} else {
+		fat[offset] = static_cast<uint8_t>((fat[offset] & 0x0f) | (value << 4));
+		fat[offset + 1] = static_cast<uint8_t>(value >> 4);
+	}
+}
+
+// The file's data; each byte depends on its position in the file
+uint8_t get_file_byte(const uint32_t pos)
+{
+	return static_cast<uint8_t>(pos * 7 + (pos >> 9));
+}
+
+class FatDriveTest : public DOSBoxTestFixture {
+protected:
+	void SetUp() override
+	{
+		DOSBoxTestFixture::SetUp();
+
+		// A fragmented file: its clusters are scattered over the disk
+		// in no particular order
+		std::vector<uint16_t> free_clusters(300);
+		std::iota(free_clusters.begin(), free_clusters.end(), uint16_t{2});
+		std::shuffle(free_clusters.begin(), free_clusters.end(), std::mt19937(42));
+		chain.assign(free_clusters.begin(), free_clusters.begin() + FileClusters);
+
+		write_image();
+
+		drive = std::make_shared<fatDrive>(image_path.string().c_str(),
+		                                   SectorSize,
+		                                   18,
+		                                   2,
+		                                   80,
+		                                   0xf0,
+		                                   false);
+		ASSERT_TRUE(drive->created_successfully);
+	}
+
+	void TearDown() override
+	{
+		drive.reset();
+		DOSBoxTestFixture::TearDown();
+	}
+
+	std::vector<uint8_t> make_fat(const std::vector<uint16_t>& file_chain) const
+	{
+		std::vector<uint8_t> fat(SectorsPerFat * SectorSize);
+		set_fat12_entry(fat, 0, 0xff0);
+		set_fat12_entry(fat, 1, EndOfChain);
+		for (size_t i = 0; i < file_chain.size(); ++i) {
+			const auto next = (i + 1 < file_chain.size()) ? file_chain[i + 1]
+			                                              : EndOfChain;
+			set_fat12_entry(fat, file_chain[i], next);
+		}
+		return fat;
+	}
+
+	void write_image() const
+	{
+		std::vector<uint8_t> image(NumSectors * SectorSize);
+
+		// Boot sector with a DOS 3.3+ BPB
+		const uint8_t jump[] = {0xeb, 0x3c, 0x90};
+		std::copy(std::begin(jump), std::end(jump), image.begin());
+		std::copy_n("MSDOS5.0", 8, image.begin() + 3);
+		put_le(image, 11, SectorSize, 2);
+		put_le(image, 13, 1, 1);   // sectors per cluster
+		put_le(image, 14, 1, 2);   // reserved sectors
+		put_le(image, 16, 2, 1);   // FATs
+		put_le(image, 17, 224, 2); // root directory entries
+		put_le(image, 19, NumSectors, 2);
+		put_le(image, 21, 0xf0, 1); // media descriptor
+		put_le(image, 22, SectorsPerFat, 2);
+		put_le(image, 24, 18, 2); // sectors per track
+		put_le(image, 26, 2, 2);  // heads
+		put_le(image, 510, 0xaa55, 2);
+
+		const auto fat = make_fat(chain);
+		for (auto copy = 0; copy < 2; ++copy) {
+			const auto sector = FirstFatSector + copy * SectorsPerFat;
+			std::copy(fat.begin(), fat.end(), image.begin() + sector * SectorSize);
+		}
+
+		// Root directory entry of the file
+		const auto entry = RootDirSector * SectorSize;
+		std::copy_n("DATA    BIN", 11, image.begin() + entry);
+		put_le(image, entry + 11, 0x20, 1); // archive attribute
+		put_le(image, entry + 26, chain[0], 2);
+		put_le(image, entry + 28, FileSize, 4);
+
+		for (uint32_t pos = 0; pos < FileSize; ++pos) {
+			const auto cluster = chain[pos / SectorSize];
+			image[get_cluster_sector(cluster) * SectorSize + pos % SectorSize] =
+			        get_file_byte(pos);
+		}
+
+		std::ofstream(image_path, std::ios::binary)
+		        .write(reinterpret_cast<const char*>(image.data()),
+		               static_cast<std::streamsize>(image.size()));
+	}
+
+	void expect_chain(const std::vector<uint16_t>& expected_chain,
+	                  const std::vector<uint32_t>& order) const
+	{
+		for (const auto index : order) {
+			EXPECT_EQ(drive->getAbsoluteSectFromChain(chain[0], index),
+			          get_cluster_sector(expected_chain[index]))
+			        << "at cluster index " << index;
+		}
+	}
+
+	std::vector<uint32_t> forward_order(const size_t num_clusters) const
+	{
+		std::vector<uint32_t> order(num_clusters);
+		std::iota(order.begin(), order.end(), 0);
+		return order;
+	}
+
+	TempDirectory temp_dir{"dosbox_drive_fat"};
+	const std_fs::path image_path = temp_dir.GetPath() / "floppy.img";
+
+	std::vector<uint16_t> chain = {};
+
+	std::shared_ptr<fatDrive> drive = {};
+};
+
+TEST_F(FatDriveTest, FollowsFragmentedChain)
+{
+	auto order = forward_order(chain.size());
+
+	// Sequentially, which resumes from the cursors
+	expect_chain(chain, order);
+
+	// Backwards, which has to restart from earlier positions
+	std::reverse(order.begin(), order.end());
+	expect_chain(chain, order);
+
+	// And all over the place
+	std::shuffle(order.begin(), order.end(), std::mt19937(1));
+	expect_chain(chain, order);
+}
+
+TEST_F(FatDriveTest, FollowsInterleavedWalks)
+{
+	// Like two handles of the file reading from both of its ends
+	for (uint32_t i = 0; i < FileClusters / 2; ++i) {
+		EXPECT_EQ(drive->getAbsoluteSectFromChain(chain[0], i),
+		          get_cluster_sector(chain[i]));
+		EXPECT_EQ(drive->getAbsoluteSectFromChain(chain[0], FileClusters - 1 - i),
+		          get_cluster_sector(chain[FileClusters - 1 - i]));
+	}
+}
+
+TEST_F(FatDriveTest, ReadsFileWithSeeks)
+{
+	auto file = drive->FileOpen("DATA.BIN", OPEN_READ);
+	ASSERT_TRUE(file);
+	file->AddRef();
+
+	std::vector<uint8_t> data(FileSize);
+	uint16_t size = FileSize;
+	ASSERT_TRUE(file->Read(data.data(), &size));
+	ASSERT_EQ(size, FileSize);
+	for (uint32_t pos = 0; pos < FileSize; ++pos) {
+		ASSERT_EQ(data[pos], get_file_byte(pos)) << "at byte " << pos;
+	}
+
+	std::mt19937 rng(7);
+	for (auto i = 0; i < 200; ++i) {
+		uint32_t pos = rng() % FileSize;
+		ASSERT_TRUE(file->Seek(&pos, DOS_SEEK_SET));
+
+		uint8_t chunk[700] = {};
+		uint16_t chunk_size = sizeof(chunk);
+		ASSERT_TRUE(file->Read(chunk, &chunk_size));
+		ASSERT_EQ(chunk_size, std::min<uint32_t>(sizeof(chunk), FileSize - pos));
+		for (uint16_t j = 0; j < chunk_size; ++j) {
+			ASSERT_EQ(chunk[j], get_file_byte(pos + j)) << "at byte " << pos + j;
+		}
+	}
+	file->Close();
+}
+
+TEST_F(FatDriveTest, ClosingFileWritesBackOnlyItsSectors)
+{
+	std::vector<uint8_t> image(NumSectors * SectorSize);
+	const auto read_image = [&] {
+		std::ifstream(image_path, std::ios::binary)
+		        .read(reinterpret_cast<char*>(image.data()),
+		              static_cast<std::streamsize>(image.size()));
+	};
+
+	// A write of some other part of the disk that's still in the cache
+	constexpr uint32_t OtherSector = NumSectors - 1;
+	std::vector<uint8_t> other_data(SectorSize, 0xaa);
+	ASSERT_EQ(drive->loadedDisk->Write_AbsoluteSector(OtherSector, other_data.data()),
+	          0x00);
+
+	auto file = drive->FileOpen("DATA.BIN", OPEN_READWRITE);
+	ASSERT_TRUE(file);
+	file->AddRef();
+
+	std::vector<uint8_t> data(SectorSize + 10, 0x55);
+	uint16_t size = static_cast<uint16_t>(data.size());
+	ASSERT_TRUE(file->Write(data.data(), &size));
+	ASSERT_EQ(size, data.size());
+
+	file->Close();
+	read_image();
+
+	for (uint32_t pos = 0; pos < data.size(); ++pos) {
+		const auto cluster = chain[pos / SectorSize];
+		ASSERT_EQ(image[get_cluster_sector(cluster) * SectorSize + pos % SectorSize],
+		          0x55)
+		        << "at byte " << pos;
+	}
+	EXPECT_EQ(image[OtherSector * SectorSize], 0x00);
+
+	drive->loadedDisk->Flush();
+	read_image();
+	EXPECT_EQ(image[OtherSector * SectorSize], 0xaa);
+}
+
+TEST_F(FatDriveTest, FollowsChainChangedByDrive)
+{
+	expect_chain(chain, forward_order(chain.size()));
+
+	// Growing the file changes the FAT through the drive
+	const auto new_cluster = drive->appendCluster(chain[0]);
+	ASSERT_NE(new_cluster, 0u);
+
+	auto grown_chain = chain;
+	grown_chain.push_back(static_cast<uint16_t>(new_cluster));
+	expect_chain(grown_chain, forward_order(grown_chain.size()));
+
+	// Cutting it down to half its clusters frees the cluster a cursor is
+	// left on, and appending a cluster again gives that position another
+	// cluster
+	EXPECT_EQ(drive->getAbsoluteSectFromChain(chain[0], FileClusters / 2),
+	          get_cluster_sector(chain[FileClusters / 2]));
+	drive->deleteClustChain(chain[0], FileClusters / 2 * SectorSize);
+	const auto new_tail = drive->appendCluster(chain[0]);
+	ASSERT_NE(new_tail, 0u);
+	ASSERT_NE(new_tail, chain[FileClusters / 2]);
+
+	auto cut_chain = std::vector<uint16_t>(chain.begin(),
+	                                       chain.begin() + FileClusters / 2);
+	cut_chain.push_back(static_cast<uint16_t>(new_tail));
+	expect_chain(cut_chain, forward_order(cut_chain.size()));
+}
+
+TEST_F(FatDriveTest, FollowsChainChangedBehindDrivesBack)
+{
+	expect_chain(chain, forward_order(chain.size()));
+
+	// Relink the second half of the chain in reverse through the disk
+	// itself, like a program writing the FAT through INT 13h
+	auto relinked_chain = chain;
+	std::reverse(relinked_chain.begin() + FileClusters / 2, relinked_chain.end());
+
+	auto fat = make_fat(relinked_chain);
+	for (auto copy = 0u; copy < 2; ++copy) {
+		for (uint32_t s = 0; s < SectorsPerFat; ++s) {
+			const auto sectnum = FirstFatSector + copy * SectorsPerFat + s;
+			ASSERT_EQ(drive->loadedDisk->Write_AbsoluteSector(
+			                  sectnum, fat.data() + s * SectorSize),
+			          0x00);
+		}
+	}
+	expect_chain(relinked_chain, forward_order(relinked_chain.size()));
+}
+
+} // namespace
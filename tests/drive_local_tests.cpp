@@ -0,0 +1,209 @@
+// SPDX-FileCopyrightText:  2026-2026 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "dos/drive_local.h"
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "dos/dos.h"
+#include "dosbox_test_fixture.h"
+#include "misc/cross.h"
+#include "temp_directory.h"
+
+namespace {
+
+// Small enough to stay in the read-ahead and write-behind buffers
+const std::string Contents = "The quick brown fox jumps over the lazy dog";
+
+class LocalDriveTest : public DOSBoxTestFixture {
+protected:
+	void SetUp() override
+	{
+		DOSBoxTestFixture::SetUp();
+
+		std::ofstream(file_path, std::ios::binary) << Contents;
+
+		auto basedir = temp_dir.GetPath().string();
+		basedir += CROSS_FILESPLIT;
+		drive = std::make_shared<localDrive>(
+		        basedir.c_str(), 512, 32, 32765, 16000, 0xf8, false);
+	}
+
+	void TearDown() override
+	{
+		drive.reset();
+		DOSBoxTestFixture::TearDown();
+	}
+
+	std::unique_ptr<DOS_File> open_file()
+	{
+		auto file = drive->FileOpen("TEST.DAT", OPEN_READWRITE);
+		EXPECT_TRUE(file);
+		if (file) {
+			file->AddRef();
+		}
+		return file;
+	}
+
+	std::unique_ptr<DOS_File> create_file()
+	{
+		auto file = drive->FileCreate("TEST.DAT", {});
+		EXPECT_TRUE(file);
+		if (file) {
+			file->AddRef();
+		}
+		return file;
+	}
+
+	static void write(DOS_File& file, std::string data)
+	{
+		auto num_bytes = static_cast<uint16_t>(data.size());
+		ASSERT_TRUE(file.Write(reinterpret_cast<uint8_t*>(data.data()),
+		                       &num_bytes));
+		ASSERT_EQ(num_bytes, data.size());
+	}
+
+	static std::string read(DOS_File& file, const uint16_t size)
+	{
+		std::vector<uint8_t> data(size);
+		auto num_bytes = size;
+		EXPECT_TRUE(file.Read(data.data(), &num_bytes));
+		return {data.begin(), data.begin() + num_bytes};
+	}
+
+	static void seek(DOS_File& file, uint32_t pos)
+	{
+		ASSERT_TRUE(file.Seek(&pos, DOS_SEEK_SET));
+	}
+
+	std::string read_host_file() const
+	{
+		std::ifstream stream(file_path, std::ios::binary);
+		return {std::istreambuf_iterator<char>(stream),
+		        std::istreambuf_iterator<char>()};
+	}
+
+	TempDirectory temp_dir{"dosbox_drive_local"};
+	const std_fs::path file_path = temp_dir.GetPath() / "TEST.DAT";
+
+	std::shared_ptr<localDrive> drive = {};
+};
+
+TEST_F(LocalDriveTest, ReadsBackWrites)
+{
+	auto file = open_file();
+	ASSERT_TRUE(file);
+
+	seek(*file, 4);
+	write(*file, "qu");
+	write(*file, "iet");
+	EXPECT_EQ(read(*file, 6), " brown");
+
+	seek(*file, 0);
+	EXPECT_EQ(read(*file, 15), "The quiet brown");
+
+	file->Close();
+	EXPECT_EQ(read_host_file(),
+	          "The quiet brown fox jumps over the lazy dog");
+}
+
+TEST_F(LocalDriveTest, TwoHandlesSeeEachOthersWrites)
+{
+	auto reader = open_file();
+	auto writer = open_file();
+	ASSERT_TRUE(reader && writer);
+
+	// Fill the read-ahead buffer of one handle, then change the data it
+	// holds through the other one
+	EXPECT_EQ(read(*reader, 4), "The ");
+
+	seek(*writer, 10);
+	write(*writer, "white");
+	EXPECT_EQ(read(*reader, 11), "quick white");
+
+	// And the other way around, with the writes still buffered
+	seek(*writer, 0);
+	EXPECT_EQ(read(*writer, 3), "The");
+	seek(*reader, 16);
+	write(*reader, "cat");
+	EXPECT_EQ(read(*writer, 19), " quick white cat ju");
+
+	reader->Close();
+	writer->Close();
+	EXPECT_EQ(read_host_file(),
+	          "The quick white cat jumps over the lazy dog");
+}
+
+TEST_F(LocalDriveTest, SeeksPastEndOfFile)
+{
+	auto file = open_file();
+	ASSERT_TRUE(file);
+
+	// Reading past the end gets nothing
+	seek(*file, Contents.size() + 10);
+	EXPECT_EQ(read(*file, 4), "");
+
+	// Writing past the end grows the file and fills the gap with zeros
+	write(*file, "!");
+	seek(*file, Contents.size());
+	EXPECT_EQ(read(*file, 11), std::string(10, '\0') + "!");
+
+	file->Close();
+	EXPECT_EQ(read_host_file(), Contents + std::string(10, '\0') + "!");
+}
+
+TEST_F(LocalDriveTest, ZeroByteWriteTruncates)
+{
+	auto file  = open_file();
+	auto other = open_file();
+	ASSERT_TRUE(file && other);
+
+	EXPECT_EQ(read(*other, 4), "The ");
+
+	seek(*file, Contents.size());
+	write(*file, " again");
+	seek(*file, 9);
+	write(*file, "");
+	EXPECT_EQ(read_host_file(), "The quick");
+
+	// The read-ahead data of the other handle is gone with the truncation
+	EXPECT_EQ(read(*other, 20), "quick");
+
+	file->Close();
+	other->Close();
+	EXPECT_EQ(read_host_file(), "The quick");
+}
+
+TEST_F(LocalDriveTest, CreateWhileAnotherHandleIsOpen)
+{
+	auto reader = open_file();
+	auto writer = open_file();
+	ASSERT_TRUE(reader && writer);
+
+	EXPECT_EQ(read(*reader, 4), "The ");
+	seek(*writer, 4);
+	write(*writer, "slow");
+
+	// Creating the file again truncates it; the buffered writes of the
+	// open handle must not come back on top of the new contents
+	auto created = create_file();
+	ASSERT_TRUE(created);
+	EXPECT_EQ(read_host_file(), "");
+
+	// Nor must the stale read-ahead data be served
+	EXPECT_EQ(read(*reader, 10), "");
+
+	write(*created, "new");
+	created->Close();
+	writer->Close();
+	reader->Close();
+	EXPECT_EQ(read_host_file(), "new");
+}
+
+} // namespace
@@ -22,8 +22,13 @@
 
 #include <gtest/gtest.h>
 
+#include <fstream>
 #include <string>
 
+#include "misc/cross.h"
+#include "misc/std_filesystem.h"
+#include "temp_directory.h"
+
 std::string run_Set_Label(char const * const input, bool cdrom) {
     char output[32] = { 0 };
     Set_Label(input, output, cdrom);
@@ -219,4 +224,70 @@ TEST(Set_Label, InvalidCharsEndingDotCD)
     EXPECT_EQ("?*':&@(..", output);
 }
 
+class DriveCacheTest : public ::testing::Test {
+protected:
+	void SetUp() override
+	{
+		create_file("LongFileName.txt");
+		create_file("LongFileName2.txt");
+		create_file("SHORT.TXT");
+
+		basedir = dir.string() + CROSS_FILESPLIT;
+	}
+
+	void create_file(const std::string& name) const
+	{
+		std::ofstream(dir / name) << name;
+	}
+
+	std::string get_short_name(DOS_Drive_Cache& cache, const std::string& name) const
+	{
+		char shortname[CROSS_LEN] = {};
+		if (!cache.GetShortName((basedir + name).c_str(), shortname)) {
+			return {};
+		}
+		return shortname;
+	}
+
+	TempDirectory temp_dir{"dosbox_drive_cache"};
+	const std_fs::path dir = temp_dir.GetPath();
+	std::string basedir = {};
+};
+
+TEST_F(DriveCacheTest, LooksUpShortNames)
+{
+	DOS_Drive_Cache cache(basedir.c_str());
+
+	EXPECT_EQ(get_short_name(cache, "LongFileName.txt"), "LONGFI~1.TXT");
+	EXPECT_EQ(get_short_name(cache, "LongFileName2.txt"), "LONGFI~2.TXT");
+	EXPECT_EQ(get_short_name(cache, "SHORT.TXT"), "SHORT.TXT");
+	EXPECT_EQ(get_short_name(cache, "Missing.txt"), "");
+
+	EXPECT_EQ(std::string(cache.GetExpandNameAndNormaliseCase(
+	                  (basedir + "LONGFI~2.TXT").c_str())),
+	          basedir + "LongFileName2.txt");
+}
+
+#if defined(LINUX)
+TEST_F(DriveCacheTest, PicksUpHostChanges)
+{
+	DOS_Drive_Cache cache;
+	cache.SetWatchHost(true);
+	cache.SetBaseDir(basedir.c_str());
+
+	create_file("CreatedOnHost.txt");
+	std_fs::remove(dir / "SHORT.TXT");
+
+	EXPECT_EQ(get_short_name(cache, "CreatedOnHost.txt"), "CREATE~1.TXT");
+	EXPECT_EQ(get_short_name(cache, "SHORT.TXT"), "");
+
+	// Short names aren't reused: the new file gets the next number, not
+	// the LONGFI~1 of the deleted file
+	create_file("LongFileName3.txt");
+	std_fs::remove(dir / "LongFileName.txt");
+	EXPECT_EQ(get_short_name(cache, "LongFileName3.txt"), "LONGFI~3.TXT");
+	EXPECT_EQ(get_short_name(cache, "LongFileName.txt"), "");
+}
+#endif
+
 } // namespace
@@ -0,0 +1,135 @@
+// SPDX-FileCopyrightText:  2026-2026 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "utils/fifo_buffer.h"
+
+#include <gtest/gtest.h>
+
+#include <numeric>
+#include <vector>
+
+namespace {
+
+TEST(FifoBuffer, CapacityIsRoundedUpToPowerOfTwo)
+{
+	FifoBuffer<int> buf(100);
+	EXPECT_EQ(buf.Capacity(), 128);
+	EXPECT_EQ(buf.Size(), 0);
+	EXPECT_TRUE(buf.IsEmpty());
+}
+
+TEST(FifoBuffer, PushAndPop)
+{
+	FifoBuffer<int> buf(8);
+
+	const std::vector<int> items = {1, 2, 3, 4, 5};
+	buf.Push(items.data(), items.size());
+	EXPECT_EQ(buf.Size(), 5);
+
+	for (size_t i = 0; i < items.size(); ++i) {
+		EXPECT_EQ(buf[i], items[i]);
+	}
+
+	buf.Pop(2);
+	EXPECT_EQ(buf.Size(), 3);
+	EXPECT_EQ(buf[0], 3);
+	EXPECT_EQ(buf[2], 5);
+
+	buf.Pop(3);
+	EXPECT_TRUE(buf.IsEmpty());
+}
+
+TEST(FifoBuffer, WrapsAround)
+{
+	FifoBuffer<int> buf(8);
+
+	int next_push = 0;
+	int next_pop  = 0;
+
+	for (auto round = 0; round < 20; ++round) {
+		std::vector<int> items(5);
+		std::iota(items.begin(), items.end(), next_push);
+		next_push += 5;
+
+		buf.Push(items.data(), items.size());
+
+		for (size_t i = 0; i < buf.Size(); ++i) {
+			EXPECT_EQ(buf[i], next_pop + static_cast<int>(i));
+		}
+		buf.Pop(5);
+		next_pop += 5;
+	}
+	EXPECT_TRUE(buf.IsEmpty());
+	EXPECT_EQ(buf.Capacity(), 8);
+}
+
+TEST(FifoBuffer, GrowsWhenFull)
+{
+	FifoBuffer<int> buf(4);
+
+	const std::vector<int> items = {1, 2, 3, 4};
+	buf.Push(items.data(), items.size());
+	buf.Pop(3);
+
+	// The items wrap around the end of the buffer when it has to grow
+	const std::vector<int> more_items = {5, 6, 7, 8, 9, 10};
+	buf.Push(more_items.data(), more_items.size());
+
+	EXPECT_EQ(buf.Capacity(), 8);
+	ASSERT_EQ(buf.Size(), 7);
+	for (size_t i = 0; i < buf.Size(); ++i) {
+		EXPECT_EQ(buf[i], static_cast<int>(i) + 4);
+	}
+}
+
+TEST(FifoBuffer, GrowsFromEmpty)
+{
+	FifoBuffer<int> buf = {};
+	EXPECT_EQ(buf.Capacity(), 0);
+
+	buf.Push(1);
+	buf.Push(2);
+	buf.Push(3);
+
+	EXPECT_EQ(buf.Capacity(), 4);
+	ASSERT_EQ(buf.Size(), 3);
+	EXPECT_EQ(buf[0], 1);
+	EXPECT_EQ(buf[2], 3);
+}
+
+TEST(FifoBuffer, ReserveKeepsItems)
+{
+	FifoBuffer<int> buf(4);
+
+	const std::vector<int> items = {1, 2, 3, 4};
+	buf.Push(items.data(), items.size());
+	buf.Pop(2);
+	buf.Push(5);
+	buf.Push(6);
+
+	// The items now wrap around the end of the buffer
+	buf.Reserve(16);
+	EXPECT_EQ(buf.Capacity(), 16);
+	ASSERT_EQ(buf.Size(), 4);
+	for (size_t i = 0; i < buf.Size(); ++i) {
+		EXPECT_EQ(buf[i], static_cast<int>(i) + 3);
+	}
+
+	// Reserving less than the capacity does nothing
+	buf.Reserve(8);
+	EXPECT_EQ(buf.Capacity(), 16);
+	EXPECT_EQ(buf.Size(), 4);
+}
+
+TEST(FifoBuffer, Clear)
+{
+	FifoBuffer<int> buf(4);
+	buf.Push(1);
+	buf.Push(2);
+
+	buf.Clear();
+	EXPECT_TRUE(buf.IsEmpty());
+	EXPECT_EQ(buf.Capacity(), 4);
+}
+
+} // namespace
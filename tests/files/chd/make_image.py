@@ -0,0 +1,570 @@
+#!/usr/bin/env python3
+
+# SPDX-FileCopyrightText:  2026-2026 The DOSBox Staging Team
+# SPDX-License-Identifier: GPL-2.0-or-later
+
+"""
+Writes the CD image the CHD tests read: 'image.bin' with a Mode 1 data track
+and an audio track, 'image.cue' describing it, and 'image.chd' compressed
+from it.
+
+The CHD is laid out the way 'chdman createcd -c cdzl,cdfl' lays it out:
+a version 5 header, hunks of 8 frames, each compressed with whichever of
+the 'cdzl' and 'cdfl' codecs gives the smaller result, the sync pattern and
+ECC stripped from the sectors whose ECC checks out, and the Huffman coded
+hunk map written at the end.
+
+The image is written by this script, not by chdman, so it only checks the
+reader against our understanding of the format. An image made with
+'chdman createcd -i image.cue -o image.chd' can take its place, as the tests
+only compare the sectors they read back with 'image.bin'.
+
+The ECC and EDC of the data sectors are computed from their definition in
+ECMA-130 rather than with lookup tables, so they're an independent check of
+the ones the emulator regenerates.
+"""
+
+import hashlib
+import math
+import random
+import struct
+import zlib
+from pathlib import Path
+
+SECTOR_SIZE  = 2352
+SUBCODE_SIZE = 96
+FRAME_SIZE   = SECTOR_SIZE + SUBCODE_SIZE
+
+FRAMES_PER_HUNK = 8
+HUNK_BYTES      = FRAMES_PER_HUNK * FRAME_SIZE
+TRACK_PADDING   = 4
+
+NUM_DATA_FRAMES  = 14
+NUM_AUDIO_FRAMES = 14
+
+# The data sector whose ECC gets corrupted, so it's stored as is
+CORRUPT_SECTOR = 5
+
+SYNC = bytes([0x00] + [0xff] * 10 + [0x00])
+
+COMPRESSION_TYPE_0    = 0
+COMPRESSION_TYPE_1    = 1
+COMPRESSION_NONE      = 4
+COMPRESSION_SELF      = 5
+COMPRESSION_RLE_SMALL = 7
+COMPRESSION_RLE_LARGE = 8
+
+CODECS = [b"cdzl", b"cdfl"]
+
+
+# ECMA-130 error correction
+# ~~~~~~~~~~~~~~~~~~~~~~~~~
+
+def gf_mul(a, b):
+    result = 0
+    while b:
+        if b & 1:
+            result ^= a
+        a = ((a << 1) ^ (0x11d if a & 0x80 else 0)) & 0xff
+        b >>= 1
+    return result
+
+
+def gf_pow2(n):
+    result = 1
+    for _ in range(n):
+        result = gf_mul(result, 2)
+    return result
+
+
+def gf_inv(a):
+    return next(b for b in range(1, 256) if gf_mul(a, b) == 1)
+
+
+def parity_pair(symbols):
+    """
+    Returns the two parity symbols that make the syndromes of the codeword
+    zero: the sum of its symbols, and the sum weighted by descending powers
+    of alpha.
+    """
+    n  = len(symbols) + 2
+    s0 = 0
+    s1 = 0
+    for k, c in enumerate(symbols):
+        s0 ^= c
+        s1 ^= gf_mul(gf_pow2(n - 1 - k), c)
+
+    # p0 + p1 = s0 and alpha * p0 + p1 = s1
+    p0 = gf_mul(s0 ^ s1, gf_inv(2 ^ 1))
+    p1 = s0 ^ p0
+    return p0, p1
+
+
+def generate_ecc(sector):
+    # The header doesn't count for Mode 2 sectors
+    def byte(offset):
+        if sector[15] != 1 and offset < 4:
+            return 0
+        return sector[12 + offset]
+
+    # P parity over the 43 columns of 16-bit words, split into bytes
+    for i in range(86):
+        p0, p1 = parity_pair([byte(i + 86 * k) for k in range(24)])
+        sector[2076 + i] = p0
+        sector[2162 + i] = p1
+
+    # Q parity over the diagonals, which cover the P parity as well
+    for i in range(52):
+        start = (i >> 1) * 86 + (i & 1)
+        q0, q1 = parity_pair([byte((start + 88 * k) % 2236) for k in range(43)])
+        sector[2248 + i] = q0
+        sector[2300 + i] = q1
+
+
+def check_ecc(sector):
+    copy = bytearray(sector)
+    generate_ecc(copy)
+    return copy[2076:] == sector[2076:]
+
+
+def edc(data):
+    crc = 0
+    for b in data:
+        crc ^= b
+        for _ in range(8):
+            crc = (crc >> 1) ^ (0xd8018001 if crc & 1 else 0)
+    return crc
+
+
+def to_bcd(value):
+    return (value // 10) << 4 | value % 10
+
+
+# The tracks
+# ~~~~~~~~~~
+
+def make_data_sector(lba, rng):
+    sector = bytearray(SECTOR_SIZE)
+    sector[0:12] = SYNC
+
+    # The address is offset by the two second lead-in
+    minutes, rest = divmod(lba + 150, 75 * 60)
+    seconds, frames = divmod(rest, 75)
+    sector[12:16] = bytes([to_bcd(minutes), to_bcd(seconds), to_bcd(frames), 1])
+
+    # Text and a run of noise, so the user data is compressible but no
+    # part of it is left blank
+    text = f"DOSBox Staging CHD test image, sector {lba:02}. ".encode()
+    user_data = (text * (2048 // len(text) + 1))[:1536]
+    user_data += bytes(rng.randrange(1, 256) for _ in range(512))
+    sector[16:2064] = user_data
+
+    sector[2064:2068] = struct.pack("<I", edc(sector[0:2064]))
+    generate_ecc(sector)
+
+    if lba == CORRUPT_SECTOR:
+        sector[100] ^= 0xff
+    return bytes(sector)
+
+
+def make_audio_sector(index, rng):
+    # Stereo tones with some noise, as little-endian 16-bit samples
+    samples = []
+    for i in range(SECTOR_SIZE // 4):
+        t = (index * (SECTOR_SIZE // 4) + i) / 44100
+        left  = 8000 * math.sin(2 * math.pi * 440 * t) + rng.randint(-40, 40)
+        right = 6000 * math.sin(2 * math.pi * 660 * t) + rng.randint(-40, 40)
+        samples += [round(left), round(right)]
+    return struct.pack(f"<{len(samples)}h", *samples)
+
+
+# FLAC frames of 'cdfl' hunks
+# ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+class BitWriter:
+    def __init__(self):
+        self.bits = []
+
+    def write(self, value, num_bits):
+        for i in range(num_bits - 1, -1, -1):
+            self.bits.append((value >> i) & 1)
+
+    def write_unary(self, value):
+        self.bits += [0] * value + [1]
+
+    def to_bytes(self):
+        bits = self.bits + [0] * (-len(self.bits) % 8)
+        return bytes(int("".join(map(str, bits[i:i + 8])), 2)
+                     for i in range(0, len(bits), 8))
+
+
+def crc8(data):
+    crc = 0
+    for b in data:
+        crc ^= b
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x07) & 0xff if crc & 0x80 else (crc << 1) & 0xff
+    return crc
+
+
+def crc16_flac(data):
+    crc = 0
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x8005) & 0xffff if crc & 0x8000 else (crc << 1) & 0xffff
+    return crc
+
+
+def write_fixed_subframe(bits, samples, bps):
+    # Second order fixed prediction, with the Rice parameter that gives the
+    # fewest bits
+    residuals = [samples[i] - 2 * samples[i - 1] + samples[i - 2]
+                 for i in range(2, len(samples))]
+    folded = [(r << 1) if r >= 0 else ((-r << 1) - 1) for r in residuals]
+    param = min(range(15), key=lambda k: sum((u >> k) + 1 + k for u in folded))
+
+    bits.write(0, 1)
+    bits.write(0b001010, 6)
+    bits.write(0, 1)
+    for s in samples[:2]:
+        bits.write(s & ((1 << bps) - 1), bps)
+
+    bits.write(0, 2)     # Rice coding with 4-bit parameters
+    bits.write(0, 4)     # a single partition
+    bits.write(param, 4)
+    for u in folded:
+        bits.write_unary(u >> param)
+        bits.write(u & ((1 << param) - 1), param)
+
+
+def flac_block_size(num_bytes):
+    # As chdman picks it
+    result = num_bytes // FRAME_SIZE * SECTOR_SIZE // 4
+    while result > 2048:
+        result //= 2
+    return result
+
+
+def encode_flac(sectors):
+    """
+    Encodes big-endian stereo samples as headerless FLAC frames, like the
+    FLAC encoder of chdman. The frames alternate between independent and
+    mid/side stereo.
+    """
+    block_size = flac_block_size(len(sectors) // SECTOR_SIZE * FRAME_SIZE)
+    samples = struct.unpack(f">{len(sectors) // 2}h", sectors)
+
+    stream = b""
+    for number, start in enumerate(range(0, len(samples) // 2, block_size)):
+        left  = samples[start * 2:(start + block_size) * 2:2]
+        right = samples[start * 2 + 1:(start + block_size) * 2:2]
+
+        is_mid_side = number % 2 == 1
+
+        header = BitWriter()
+        header.write(0xfff8, 16)
+        header.write(0b0111, 4)                         # 16-bit block size
+        header.write(0b1001, 4)                         # 44.1 kHz
+        header.write(0b1010 if is_mid_side else 0b0001, 4)
+        header.write(0b100, 3)                          # 16 bits
+        header.write(0, 1)
+        header.write(number, 8)
+        header.write(len(left) - 1, 16)
+        header_bytes = header.to_bytes()
+
+        frame = BitWriter()
+        frame.bits = [int(b) for byte in header_bytes + bytes([crc8(header_bytes)])
+                      for b in f"{byte:08b}"]
+        if is_mid_side:
+            mid  = [(l + r) >> 1 for l, r in zip(left, right)]
+            side = [l - r for l, r in zip(left, right)]
+            write_fixed_subframe(frame, mid, 16)
+            write_fixed_subframe(frame, side, 17)
+        else:
+            write_fixed_subframe(frame, list(left), 16)
+            write_fixed_subframe(frame, list(right), 16)
+
+        frame_bytes = frame.to_bytes()
+        stream += frame_bytes + struct.pack(">H", crc16_flac(frame_bytes))
+    return stream
+
+
+# The CHD image
+# ~~~~~~~~~~~~~
+
+def deflate(data):
+    compressor = zlib.compressobj(9, zlib.DEFLATED, -15, 8)
+    return compressor.compress(data) + compressor.flush()
+
+
+def split_hunk(hunk):
+    frames = [hunk[i:i + FRAME_SIZE] for i in range(0, len(hunk), FRAME_SIZE)]
+    return [f[:SECTOR_SIZE] for f in frames], [f[SECTOR_SIZE:] for f in frames]
+
+
+def compress_cdzl(hunk):
+    sectors, subcode = split_hunk(hunk)
+
+    ecc_flags = bytearray((len(sectors) + 7) // 8)
+    stripped = b""
+    for i, sector in enumerate(sectors):
+        sector = bytearray(sector)
+        if sector[:12] == SYNC and check_ecc(sector):
+            ecc_flags[i // 8] |= 1 << (i % 8)
+            sector[:12] = bytes(12)
+            sector[2076:] = bytes(SECTOR_SIZE - 2076)
+        stripped += sector
+
+    compressed_sectors = deflate(stripped)
+    return (bytes(ecc_flags) + struct.pack(">H", len(compressed_sectors)) +
+            compressed_sectors + deflate(b"".join(subcode)))
+
+
+def compress_cdfl(hunk):
+    sectors, subcode = split_hunk(hunk)
+    return encode_flac(b"".join(sectors)) + deflate(b"".join(subcode))
+
+
+def huffman_lengths(histogram, max_bits=8):
+    weights = {code: count for code, count in enumerate(histogram) if count}
+    lengths = [0] * len(histogram)
+    if len(weights) == 1:
+        lengths[next(iter(weights))] = 1
+        return lengths
+
+    nodes = [(count, [code]) for code, count in weights.items()]
+    while len(nodes) > 1:
+        nodes.sort(key=lambda node: node[0])
+        (w1, c1), (w2, c2) = nodes[0], nodes[1]
+        for code in c1 + c2:
+            lengths[code] += 1
+        nodes = nodes[2:] + [(w1 + w2, c1 + c2)]
+    assert max(lengths) <= max_bits
+    return lengths
+
+
+def canonical_codes(lengths):
+    histogram = [0] * 33
+    for length in lengths:
+        histogram[length] += 1
+    start = 0
+    for length in range(32, 0, -1):
+        next_start = (start + histogram[length]) >> 1
+        histogram[length] = start
+        start = next_start
+    codes = [0] * len(lengths)
+    for code, length in enumerate(lengths):
+        if length:
+            codes[code] = histogram[length]
+            histogram[length] += 1
+    return codes
+
+
+def write_tree(bits, lengths):
+    def write_run(value, count):
+        while count > 0:
+            if value == 1:
+                bits.write(1, 4)
+                bits.write(1, 4)
+                count -= 1
+            elif count <= 2:
+                bits.write(value, 4)
+                count -= 1
+            else:
+                reps = min(count - 3, 15)
+                bits.write(1, 4)
+                bits.write(value, 4)
+                bits.write(reps, 4)
+                count -= reps + 3
+
+    last, count = None, 0
+    for length in lengths:
+        if length == last:
+            count += 1
+        else:
+            if count:
+                write_run(last, count)
+            last, count = length, 1
+    write_run(last, count)
+
+
+def bits_for_value(value):
+    return value.bit_length()
+
+
+def compress_map(entries, first_offset):
+    # The types, run-length encoded
+    symbols = []
+    last_type, count = 0, 0
+
+    def flush():
+        nonlocal count
+        while count:
+            if count < 3:
+                symbols.append(last_type)
+                count -= 1
+            elif count <= 3 + 15:
+                symbols.extend([COMPRESSION_RLE_SMALL, count - 3])
+                count = 0
+            else:
+                this_count = min(count, 3 + 16 + 255)
+                symbols.extend([COMPRESSION_RLE_LARGE,
+                                (this_count - 3 - 16) >> 4,
+                                (this_count - 3 - 16) & 15])
+                count -= this_count
+
+    for entry in entries:
+        if entry["type"] == last_type:
+            count += 1
+        else:
+            flush()
+            symbols.append(entry["type"])
+            last_type = entry["type"]
+    flush()
+
+    histogram = [0] * 16
+    for symbol in symbols:
+        histogram[symbol] += 1
+    lengths = huffman_lengths(histogram)
+    codes   = canonical_codes(lengths)
+
+    max_length = max([e["length"] for e in entries if e["type"] < 4] + [0])
+    max_self   = max([e["offset"] for e in entries if e["type"] == COMPRESSION_SELF] + [0])
+    length_bits = bits_for_value(max_length)
+    self_bits   = bits_for_value(max_self)
+
+    bits = BitWriter()
+    write_tree(bits, lengths)
+    for symbol in symbols:
+        bits.write(codes[symbol], lengths[symbol])
+    for entry in entries:
+        if entry["type"] < 4:
+            bits.write(entry["length"], length_bits)
+            bits.write(entry["crc"], 16)
+        elif entry["type"] == COMPRESSION_NONE:
+            bits.write(entry["crc"], 16)
+        elif entry["type"] == COMPRESSION_SELF:
+            bits.write(entry["offset"], self_bits)
+    data = bits.to_bytes()
+
+    raw_map = b"".join(bytes([e["type"]]) + e["length"].to_bytes(3, "big") +
+                       e["offset"].to_bytes(6, "big") + e["crc"].to_bytes(2, "big")
+                       for e in entries)
+    header = (len(data).to_bytes(4, "big") + first_offset.to_bytes(6, "big") +
+              crc16(raw_map).to_bytes(2, "big") +
+              bytes([length_bits, self_bits, 0, 0]))
+    return header + data
+
+
+def crc16(data):
+    crc = 0xffff
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) & 0xffff if crc & 0x8000 else (crc << 1) & 0xffff
+    return crc
+
+
+def padded(num_frames):
+    return -(-num_frames // TRACK_PADDING) * TRACK_PADDING
+
+
+def make_chd(data_sectors, audio_sectors):
+    # Audio is stored big-endian, and the tracks are padded with blank
+    # frames; the BIN has no subcode
+    frames = b""
+    for sector in data_sectors:
+        frames += sector + bytes(SUBCODE_SIZE)
+    frames += bytes(FRAME_SIZE * (padded(len(data_sectors)) - len(data_sectors)))
+    for sector in audio_sectors:
+        swapped = bytearray(sector)
+        swapped[0::2], swapped[1::2] = sector[1::2], sector[0::2]
+        frames += bytes(swapped) + bytes(SUBCODE_SIZE)
+    frames += bytes(FRAME_SIZE * (padded(len(audio_sectors)) - len(audio_sectors)))
+    frames += bytes(-len(frames) % HUNK_BYTES)
+
+    metadata = []
+    for number, (track_type, num_frames) in enumerate(
+            [("MODE1_RAW", len(data_sectors)), ("AUDIO", len(audio_sectors))], 1):
+        text = (f"TRACK:{number} TYPE:{track_type} SUBTYPE:NONE FRAMES:{num_frames} "
+                f"PREGAP:0 PGTYPE:MODE1 PGSUB:RW POSTGAP:0").encode() + b"\0"
+        metadata.append((b"CHT2", text))
+
+    header_size = 124
+    file = bytearray(header_size)
+
+    meta_offset = len(file)
+    for i, (tag, text) in enumerate(metadata):
+        next_offset = len(file) + 16 + len(text) if i + 1 < len(metadata) else 0
+        file += tag + bytes([0x01]) + len(text).to_bytes(3, "big")
+        file += next_offset.to_bytes(8, "big") + text
+
+    entries = []
+    first_offset = len(file)
+    hunks_seen = {}
+    for index in range(len(frames) // HUNK_BYTES):
+        hunk = frames[index * HUNK_BYTES:(index + 1) * HUNK_BYTES]
+        crc = crc16(hunk)
+
+        if hunk in hunks_seen:
+            entries.append({"type": COMPRESSION_SELF, "length": 0,
+                            "offset": hunks_seen[hunk], "crc": 0})
+            continue
+        hunks_seen[hunk] = index
+
+        candidates = [(len(c), codec, c) for codec, c in
+                      enumerate([compress_cdzl(hunk), compress_cdfl(hunk)])]
+        length, codec, compressed = min(candidates)
+        if length >= HUNK_BYTES:
+            entries.append({"type": COMPRESSION_NONE, "length": HUNK_BYTES,
+                            "offset": len(file), "crc": crc})
+            file += hunk
+        else:
+            entries.append({"type": codec, "length": length,
+                            "offset": len(file), "crc": crc})
+            file += compressed
+
+    map_offset = len(file)
+    file += compress_map(entries, first_offset)
+
+    # The SHA-1 of the data, and the one covering the metadata as well
+    raw_sha1 = hashlib.sha1(frames).digest()
+    meta_hashes = sorted(tag + hashlib.sha1(text).digest() for tag, text in metadata)
+    sha1 = hashlib.sha1(raw_sha1 + b"".join(meta_hashes)).digest()
+
+    file[0:8] = b"MComprHD"
+    file[8:12] = header_size.to_bytes(4, "big")
+    file[12:16] = (5).to_bytes(4, "big")
+    file[16:24] = b"".join(CODECS)
+    file[32:40] = len(frames).to_bytes(8, "big")
+    file[40:48] = map_offset.to_bytes(8, "big")
+    file[48:56] = meta_offset.to_bytes(8, "big")
+    file[56:60] = HUNK_BYTES.to_bytes(4, "big")
+    file[60:64] = FRAME_SIZE.to_bytes(4, "big")
+    file[64:84] = raw_sha1
+    file[84:104] = sha1
+
+    types = {entry["type"] for entry in entries}
+    assert {COMPRESSION_TYPE_0, COMPRESSION_TYPE_1} <= types, types
+    return bytes(file)
+
+
+def main():
+    rng = random.Random(2026)
+    data_sectors  = [make_data_sector(lba, rng) for lba in range(NUM_DATA_FRAMES)]
+    audio_sectors = [make_audio_sector(i, rng) for i in range(NUM_AUDIO_FRAMES)]
+
+    directory = Path(__file__).parent
+    (directory / "image.bin").write_bytes(b"".join(data_sectors + audio_sectors))
+    (directory / "image.cue").write_text(
+        'FILE "image.bin" BINARY\n'
+        "  TRACK 01 MODE1/2352\n"
+        "    INDEX 01 00:00:00\n"
+        "  TRACK 02 AUDIO\n"
+        f"    INDEX 01 00:00:{NUM_DATA_FRAMES:02}\n")
+    (directory / "image.chd").write_bytes(make_chd(data_sectors, audio_sectors))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,277 @@
+// SPDX-FileCopyrightText:  2026-2026 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <Iir.h>
+
+#include "mverb/MVerb.h"
+#include "tal-chorus/ChorusEngine.h"
+
+#include "audio/mixer.h"
+#include "audio/private/stereo_highpass.h"
+#include "config/config.h"
+#include "shell/command_line.h"
+
+#include <gtest/gtest.h>
+
+// The mixer processes the reverb and chorus in whole blocks; these check
+// that gives the same results as processing them one frame at a time.
+//
+// The high-pass filters run both channels at once in their own implementation
+// rather than iir1's, so their output only matches iir1 to within rounding.
+
+namespace {
+
+constexpr auto SampleRateHz = 48000;
+constexpr auto BlockSize    = 512;
+constexpr auto NumBlocks    = 40;
+
+// Of samples of up to 16-bit amplitude; float has about 7 significant digits
+constexpr auto HighpassTolerance = 0.01f;
+
+using EmVerb = MVerb<float>;
+
+struct Block {
+	std::vector<float> left  = std::vector<float>(BlockSize);
+	std::vector<float> right = std::vector<float>(BlockSize);
+};
+
+Block make_noise_block(std::mt19937& rng)
+{
+	std::uniform_real_distribution<float> noise(-20000.0f, 20000.0f);
+
+	Block block = {};
+	for (auto i = 0; i < BlockSize; ++i) {
+		block.left[i]  = noise(rng);
+		block.right[i] = noise(rng);
+	}
+	return block;
+}
+
+void set_up_reverb(EmVerb& mverb, const float size, const float decay)
+{
+	mverb.setParameter(EmVerb::PREDELAY, 0.0f);
+	mverb.setParameter(EmVerb::EARLYMIX, 0.75f);
+	mverb.setParameter(EmVerb::SIZE, size);
+	mverb.setParameter(EmVerb::DENSITY, 0.5f);
+	mverb.setParameter(EmVerb::BANDWIDTHFREQ, 0.95f);
+	mverb.setParameter(EmVerb::DECAY, decay);
+	mverb.setParameter(EmVerb::DAMPINGFREQ, 0.21f);
+	mverb.setParameter(EmVerb::GAIN, 1.0f);
+	mverb.setParameter(EmVerb::MIX, 1.0f);
+	mverb.setSampleRate(SampleRateHz);
+}
+
+TEST(MixerEffects, ReverbBlockMatchesPerFrame)
+{
+	// MVerb is too large for the stack
+	auto per_frame = std::make_unique<EmVerb>();
+	auto per_block = std::make_unique<EmVerb>();
+
+	set_up_reverb(*per_frame, 0.5f, 0.42f);
+	set_up_reverb(*per_block, 0.5f, 0.42f);
+
+	std::mt19937 rng(42);
+
+	for (auto b = 0; b < NumBlocks; ++b) {
+		// Change the decay half-way, like switching presets does
+		if (b == NumBlocks / 2) {
+			per_frame->setParameter(EmVerb::DECAY, 0.52f);
+			per_block->setParameter(EmVerb::DECAY, 0.52f);
+		}
+
+		auto in = make_noise_block(rng);
+
+		Block expected = {};
+		for (auto i = 0; i < BlockSize; ++i) {
+			float* in_buf[2]  = {&in.left[i], &in.right[i]};
+			float* out_buf[2] = {&expected.left[i], &expected.right[i]};
+			per_frame->process(in_buf, out_buf, 1);
+		}
+
+		Block actual      = {};
+		float* in_buf[2]  = {in.left.data(), in.right.data()};
+		float* out_buf[2] = {actual.left.data(), actual.right.data()};
+		per_block->processWithoutSmoothing(in_buf, out_buf, BlockSize);
+
+		for (auto i = 0; i < BlockSize; ++i) {
+			ASSERT_FLOAT_EQ(actual.left[i], expected.left[i]);
+			ASSERT_FLOAT_EQ(actual.right[i], expected.right[i]);
+		}
+	}
+}
+
+TEST(MixerEffects, StereoHighpassMatchesIir)
+{
+	for (const auto cutoff_freq_hz : {20.0, 170.0, 5000.0}) {
+		StereoHighpassFilter stereo = {};
+		stereo.Setup(SampleRateHz, cutoff_freq_hz);
+
+		Iir::Butterworth::HighPass<2> iir[2] = {};
+		for (auto& f : iir) {
+			f.setup(SampleRateHz, cutoff_freq_hz);
+		}
+
+		std::mt19937 rng(42);
+
+		for (auto b = 0; b < NumBlocks; ++b) {
+			const auto in = make_noise_block(rng);
+
+			std::vector<AudioFrame> frames(BlockSize);
+			for (auto i = 0; i < BlockSize; ++i) {
+				frames[i] = {in.left[i], in.right[i]};
+			}
+			stereo.Process(frames);
+
+			for (auto i = 0; i < BlockSize; ++i) {
+				const auto left  = iir[0].filter(in.left[i]);
+				const auto right = iir[1].filter(in.right[i]);
+
+				ASSERT_NEAR(frames[i].left, left, HighpassTolerance);
+				ASSERT_NEAR(frames[i].right, right, HighpassTolerance);
+			}
+		}
+	}
+}
+
+TEST(MixerEffects, ChorusBlockMatchesPerFrame)
+{
+	ChorusEngine per_frame(SampleRateHz);
+	ChorusEngine per_block(SampleRateHz);
+
+	per_frame.setEnablesChorus(true, false);
+	per_block.setEnablesChorus(true, false);
+
+	std::mt19937 rng(42);
+
+	for (auto b = 0; b < NumBlocks; ++b) {
+		auto expected = make_noise_block(rng);
+		auto actual   = expected;
+
+		for (auto i = 0; i < BlockSize; ++i) {
+			per_frame.process(&expected.left[i], &expected.right[i]);
+		}
+		per_block.process(actual.left.data(), actual.right.data(), BlockSize);
+
+		for (auto i = 0; i < BlockSize; ++i) {
+			ASSERT_FLOAT_EQ(actual.left[i], expected.left[i]);
+			ASSERT_FLOAT_EQ(actual.right[i], expected.right[i]);
+		}
+	}
+}
+
+// Mixes blocks with a synthesizer channel playing noise through the reverb
+// and chorus, and checks the master output against running the master bus
+// one frame at a time on the inputs of each block
+class MixerMasterBus : public ::testing::Test {
+protected:
+	void SetUp() override
+	{
+		control = std::make_unique<Config>(&command_line);
+		MIXER_AddConfigSection(control);
+
+		MIXER_SetReverbPreset(ReverbPreset::Medium);
+		MIXER_SetChorusPreset(ChorusPreset::Normal);
+
+		channel = MIXER_AddChannel(
+		        [this](const int num_frames) { Render(num_frames); },
+		        MIXER_GetSampleRate(),
+		        "TEST",
+		        {ChannelFeature::Stereo,
+		         ChannelFeature::Synthesizer,
+		         ChannelFeature::ReverbSend,
+		         ChannelFeature::ChorusSend});
+
+		channel->Enable(true);
+	}
+
+	void TearDown() override
+	{
+		MIXER_DeregisterChannel(channel);
+
+		MIXER_SetReverbPreset(ReverbPreset::None);
+		MIXER_SetChorusPreset(ChorusPreset::None);
+
+		control = {};
+	}
+
+	void Render(const int num_frames)
+	{
+		std::uniform_real_distribution<float> noise(-8000.0f, 8000.0f);
+
+		samples.resize(static_cast<size_t>(num_frames * 2));
+		for (auto& sample : samples) {
+			sample = noise(rng);
+		}
+		channel->AddSamples_sfloat(num_frames, samples.data());
+	}
+
+	CommandLine command_line = CommandLine("dosbox", "");
+
+	MixerChannelPtr channel    = {};
+	std::vector<float> samples = {};
+	std::mt19937 rng           = std::mt19937(42);
+};
+
+TEST_F(MixerMasterBus, BlockMatchesPerFrame)
+{
+	const auto sample_rate_hz = MIXER_GetSampleRate();
+
+	// Set up like the Medium reverb and Normal chorus presets and the
+	// master high-pass filter
+	auto mverb = std::make_unique<EmVerb>();
+	set_up_reverb(*mverb, 0.5f, 0.42f);
+	mverb->setSampleRate(static_cast<float>(sample_rate_hz));
+
+	ChorusEngine chorus(static_cast<float>(sample_rate_hz));
+	chorus.setEnablesChorus(true, false);
+
+	Iir::Butterworth::HighPass<2> reverb_highpass[2] = {};
+	Iir::Butterworth::HighPass<2> master_highpass[2] = {};
+	for (auto i = 0; i < 2; ++i) {
+		reverb_highpass[i].setup(sample_rate_hz, 170.0f);
+		master_highpass[i].setup(sample_rate_hz, 20.0);
+	}
+
+	const auto gain = MIXER_GetMasterVolume();
+
+	MixerBusInputs inputs = {};
+	for (auto b = 0; b < NumBlocks; ++b) {
+		const auto& output = MIXER_MixBlock(BlockSize, &inputs);
+		ASSERT_EQ(output.size(), static_cast<size_t>(BlockSize));
+
+		for (auto i = 0; i < BlockSize; ++i) {
+			auto frame = inputs.dry[i];
+
+			float reverb_in[2] = {
+			        reverb_highpass[0].filter(inputs.reverb_send[i].left),
+			        reverb_highpass[1].filter(inputs.reverb_send[i].right)};
+			float reverb_out[2] = {};
+
+			float* in_buf[2]  = {&reverb_in[0], &reverb_in[1]};
+			float* out_buf[2] = {&reverb_out[0], &reverb_out[1]};
+			mverb->process(in_buf, out_buf, 1);
+			frame += AudioFrame(reverb_out[0], reverb_out[1]);
+
+			auto chorus_frame = inputs.chorus_send[i];
+			chorus.process(&chorus_frame.left, &chorus_frame.right);
+			frame += chorus_frame;
+
+			frame.left  = master_highpass[0].filter(frame.left);
+			frame.right = master_highpass[1].filter(frame.right);
+			frame *= gain;
+
+			ASSERT_NEAR(output[i].left,
+			            frame.left / 32768.0f,
+			            HighpassTolerance / 32768.0f);
+			ASSERT_NEAR(output[i].right,
+			            frame.right / 32768.0f,
+			            HighpassTolerance / 32768.0f);
+		}
+	}
+}
+
+} // namespace
@@ -0,0 +1,174 @@
+// SPDX-FileCopyrightText:  2026-2026 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "audio/mixer.h"
+
+#include <array>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "config/config.h"
+#include "shell/command_line.h"
+
+#include <gtest/gtest.h>
+
+// The channels with the ParallelRender feature are rendered on several
+// threads; these check the mix is the same as rendering all channels on the
+// mixer thread, and that the other channels stay on the mixer thread.
+
+namespace {
+
+constexpr auto BlockSize = 512;
+constexpr auto NumBlocks = 20;
+
+constexpr auto NumChannels = 6;
+
+class MixerRender : public ::testing::Test {
+protected:
+	void SetUp() override
+	{
+		control = std::make_unique<Config>(&command_line);
+		MIXER_AddConfigSection(control);
+	}
+
+	void TearDown() override
+	{
+		RemoveChannels();
+		MIXER_SetNumRenderThreads(1);
+		control = {};
+	}
+
+	// Every other channel can be rendered in parallel. Each plays its own
+	// noise, and some take longer than others so the threads finish them
+	// in a different order every block.
+	void AddChannels()
+	{
+		for (auto i = 0; i < NumChannels; ++i) {
+			auto& source = sources[i];
+			source.rng   = std::mt19937(static_cast<uint32_t>(i + 1));
+
+			std::set<ChannelFeature> features = {ChannelFeature::Stereo};
+			if (i % 2 == 0) {
+				features.insert(ChannelFeature::ParallelRender);
+			}
+			source.channel = MIXER_AddChannel(
+			        [this, i](const int num_frames) { Render(i, num_frames); },
+			        MIXER_GetSampleRate(),
+			        "TEST" + std::to_string(i),
+			        features);
+
+			source.channel->Enable(true);
+		}
+	}
+
+	void RemoveChannels()
+	{
+		for (auto& source : sources) {
+			if (source.channel) {
+				MIXER_DeregisterChannel(source.channel);
+				source.channel = {};
+			}
+		}
+	}
+
+	void Render(const int index, const int num_frames)
+	{
+		auto& source = sources[index];
+		{
+			std::lock_guard lock(threads_mutex);
+			source.threads.insert(std::this_thread::get_id());
+		}
+
+		std::uniform_real_distribution<float> noise(-8000.0f, 8000.0f);
+
+		// Busy work of varying length
+		std::uniform_int_distribution<int> work(0, 20000);
+		volatile auto sum = 0;
+		for (auto n = work(source.rng); n > 0; --n) {
+			sum = sum + n;
+		}
+
+		source.samples.resize(static_cast<size_t>(num_frames * 2));
+		for (auto& sample : source.samples) {
+			sample = noise(source.rng);
+		}
+		source.channel->AddSamples_sfloat(num_frames, source.samples.data());
+	}
+
+	// Returns the sum of the channels of each block, before the master bus,
+	// whose filters carry their state over from the blocks mixed before
+	std::vector<std::vector<AudioFrame>> MixBlocks(const int num_threads)
+	{
+		MIXER_SetNumRenderThreads(num_threads);
+		AddChannels();
+
+		std::vector<std::vector<AudioFrame>> blocks = {};
+		MixerBusInputs inputs = {};
+		for (auto b = 0; b < NumBlocks; ++b) {
+			MIXER_MixBlock(BlockSize, &inputs);
+			blocks.push_back(inputs.dry);
+		}
+
+		RemoveChannels();
+		return blocks;
+	}
+
+	struct Source {
+		MixerChannelPtr channel         = {};
+		std::mt19937 rng                = {};
+		std::vector<float> samples      = {};
+		std::set<std::thread::id> threads = {};
+	};
+
+	CommandLine command_line = CommandLine("dosbox", "");
+
+	std::array<Source, NumChannels> sources = {};
+	std::mutex threads_mutex                = {};
+};
+
+TEST_F(MixerRender, ParallelMatchesSerial)
+{
+	const auto serial = MixBlocks(1);
+	for (const auto& source : sources) {
+		EXPECT_EQ(source.threads,
+		          std::set<std::thread::id>{std::this_thread::get_id()});
+	}
+
+	for (auto& source : sources) {
+		source.threads.clear();
+	}
+	const auto parallel = MixBlocks(4);
+
+	ASSERT_EQ(parallel.size(), serial.size());
+	for (size_t b = 0; b < serial.size(); ++b) {
+		ASSERT_EQ(parallel[b].size(), static_cast<size_t>(BlockSize));
+		for (auto i = 0; i < BlockSize; ++i) {
+			ASSERT_EQ(parallel[b][i].left, serial[b][i].left)
+			        << "block " << b << ", frame " << i;
+			ASSERT_EQ(parallel[b][i].right, serial[b][i].right)
+			        << "block " << b << ", frame " << i;
+		}
+	}
+
+	// Only the channels that can be rendered in parallel leave the mixer
+	// thread, which is the test's thread here
+	std::set<std::thread::id> parallel_threads = {};
+	for (auto i = 0; i < NumChannels; ++i) {
+		const auto& threads = sources[i].threads;
+		if (i % 2 == 0) {
+			parallel_threads.insert(threads.begin(), threads.end());
+		} else {
+			EXPECT_EQ(threads,
+			          std::set<std::thread::id>{std::this_thread::get_id()})
+			        << "channel " << i;
+		}
+	}
+	EXPECT_GT(parallel_threads.size(), 1u);
+}
+
+} // namespace
@@ -0,0 +1,362 @@
+// SPDX-FileCopyrightText:  2026-2026 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+// Regression harness for the vectorised Nuked OPL3 generator: plays DRO
+// captures (the format of the raw OPL capture) and scripted register writes
+// through both the scalar and the SIMD generator, and expects bit-identical
+// output.
+
+#include "nuked/opl3.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#if OPL_ENABLE_SIMD
+
+namespace {
+
+constexpr auto OplSampleRateHz = 49716;
+
+// A register write, or a delay when delay_ms is non-zero
+struct OplEvent {
+	uint32_t delay_ms = 0;
+	uint16_t reg      = 0;
+	uint8_t val       = 0;
+};
+
+// A timed sequence of register writes, like the ones the raw OPL capture
+// records
+class OplScript {
+public:
+	void AddWrite(const uint16_t reg, const uint8_t val)
+	{
+		events.push_back({0, reg, val});
+	}
+
+	void AddDelay(const uint32_t ms)
+	{
+		events.push_back({ms, 0, 0});
+	}
+
+	const std::vector<OplEvent>& GetEvents() const
+	{
+		return events;
+	}
+
+private:
+	std::vector<OplEvent> events = {};
+};
+
+// Recorded with the raw OPL capture (OplCapture) from a short tune: Ode to
+// Joy on a 4-op lead, two chord voices, and an OPL3 bass on the second
+// register bank, over rhythm-mode drums
+constexpr auto FixtureDro = "tests/files/opl/ode_to_joy.dro";
+
+std::vector<uint8_t> read_file(const char* path)
+{
+	std::ifstream stream(path, std::ios::binary);
+	return {std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>()};
+}
+
+// Reads a DRO v2.0 capture
+OplScript parse_dro(const std::vector<uint8_t>& data)
+{
+	constexpr auto HeaderSize = 26;
+
+	OplScript script = {};
+
+	if (data.size() < HeaderSize || std::memcmp(data.data(), "DBRAWOPL", 8) != 0) {
+		ADD_FAILURE() << "Not a DRO capture";
+		return script;
+	}
+	if (data[8] != 2 || data[9] != 0) {
+		ADD_FAILURE() << "Only DRO v2.0 captures are supported";
+		return script;
+	}
+
+	const auto delay256     = data[23];
+	const auto delay_shift8 = data[24];
+	const auto table_size   = data[25];
+
+	const auto to_reg = data.begin() + HeaderSize;
+	auto pos          = static_cast<size_t>(HeaderSize + table_size);
+
+	for (; pos + 1 < data.size(); pos += 2) {
+		const auto code = data[pos];
+		const auto val  = data[pos + 1];
+
+		if (code == delay256) {
+			script.AddDelay(val + 1u);
+		} else if (code == delay_shift8) {
+			script.AddDelay((val + 1u) << 8);
+		} else {
+			const auto index = code & 0x7f;
+			if (index >= table_size) {
+				ADD_FAILURE() << "Invalid register code " << int(code);
+				return {};
+			}
+			auto reg = static_cast<uint16_t>(to_reg[index]);
+			if (code & 0x80) {
+				reg |= 0x100;
+			}
+			script.AddWrite(reg, val);
+		}
+	}
+	return script;
+}
+
+// Plays the script through the scalar and the SIMD generator. The frames are
+// rendered in chunks of varying size to also exercise the SIMD generator's
+// state hand-over between calls.
+void expect_identical_output(const OplScript& script)
+{
+	const auto& events = script.GetEvents();
+	ASSERT_FALSE(events.empty());
+
+	auto is_audible = false;
+
+	auto scalar_chip = std::make_unique<opl3_chip>();
+	auto simd_chip   = std::make_unique<opl3_chip>();
+	OPL3_Reset(scalar_chip.get(), OplSampleRateHz);
+	OPL3_Reset(simd_chip.get(), OplSampleRateHz);
+
+	std::mt19937 chunk_rng(1234);
+	std::uniform_int_distribution<uint32_t> chunk_size(1, 300);
+
+	std::vector<int16_t> scalar_out = {};
+	std::vector<int16_t> simd_out   = {};
+
+	uint64_t elapsed_ms      = 0;
+	uint64_t frames_rendered = 0;
+
+	for (const auto& event : events) {
+		if (event.delay_ms == 0) {
+			OPL3_WriteRegBuffered(scalar_chip.get(), event.reg, event.val);
+			OPL3_WriteRegBuffered(simd_chip.get(), event.reg, event.val);
+			continue;
+		}
+		elapsed_ms += event.delay_ms;
+		const auto frames_due = elapsed_ms * OplSampleRateHz / 1000;
+
+		while (frames_rendered < frames_due) {
+			const auto num_frames = static_cast<uint32_t>(
+			        std::min<uint64_t>(chunk_size(chunk_rng),
+			                           frames_due - frames_rendered));
+
+			scalar_out.resize(num_frames * 2);
+			simd_out.resize(num_frames * 2);
+
+			OPL3_GenerateStream(scalar_chip.get(), scalar_out.data(), num_frames);
+			OPL3_GenerateStreamSimd(simd_chip.get(), simd_out.data(), num_frames);
+
+			for (size_t i = 0; i < scalar_out.size(); ++i) {
+				ASSERT_EQ(scalar_out[i], simd_out[i])
+				        << "Output differs at frame "
+				        << frames_rendered + i / 2;
+
+				is_audible = is_audible || (scalar_out[i] != 0);
+			}
+			frames_rendered += num_frames;
+		}
+	}
+
+	// Matching silence would prove nothing
+	EXPECT_TRUE(is_audible);
+}
+
+void write_instrument(OplScript& script, std::mt19937& rng, const uint16_t bank,
+                      const uint8_t slot_offset)
+{
+	std::uniform_int_distribution<int> byte(0, 255);
+
+	for (const auto reg : {0x20, 0x40, 0x60, 0x80, 0xe0}) {
+		auto val = static_cast<uint8_t>(byte(rng));
+		if (reg == 0x40) {
+			// Keep the operators mostly audible
+			val &= 0xdf;
+		}
+		script.AddWrite(static_cast<uint16_t>(bank | (reg + slot_offset)), val);
+	}
+}
+
+// Melodic notes on random instruments, with vibrato, tremolo, and all
+// envelope rates
+OplScript make_melodic_script(const bool opl3, const uint32_t seed)
+{
+	constexpr uint8_t SlotOffsets[9] = {0x00, 0x01, 0x02, 0x08, 0x09,
+	                                    0x0a, 0x10, 0x11, 0x12};
+
+	std::mt19937 rng(seed);
+	std::uniform_int_distribution<int> byte(0, 255);
+	std::uniform_int_distribution<int> channel_dist(0, 8);
+	std::uniform_int_distribution<int> delay_dist(1, 40);
+
+	OplScript script = {};
+	script.AddWrite(0x01, 0x20);
+	if (opl3) {
+		script.AddWrite(0x105, 0x01);
+		script.AddWrite(0x104, static_cast<uint8_t>(byte(rng) & 0x3f));
+	}
+	script.AddWrite(0xbd, 0xc0); // deep tremolo and vibrato
+
+	const auto num_banks = opl3 ? 2 : 1;
+	for (auto note = 0; note < 400; ++note) {
+		const auto bank = static_cast<uint16_t>(
+		        (opl3 && (note & 1)) ? 0x100 : 0);
+		const auto channel = channel_dist(rng);
+		const auto offset  = SlotOffsets[channel];
+
+		if (note < 18 * num_banks || byte(rng) < 64) {
+			write_instrument(script, rng, bank, offset);
+			write_instrument(script, rng, bank, static_cast<uint8_t>(offset + 3));
+			script.AddWrite(static_cast<uint16_t>(bank | (0xc0 + channel)),
+			             static_cast<uint8_t>(byte(rng) | (opl3 ? 0x30 : 0)));
+		}
+
+		// Key off, then on with a new frequency
+		const auto block_fnum_hi = static_cast<uint8_t>(byte(rng) & 0x1f);
+		script.AddWrite(static_cast<uint16_t>(bank | (0xb0 + channel)), block_fnum_hi);
+		script.AddWrite(static_cast<uint16_t>(bank | (0xa0 + channel)),
+		             static_cast<uint8_t>(byte(rng)));
+		script.AddWrite(static_cast<uint16_t>(bank | (0xb0 + channel)),
+		             static_cast<uint8_t>(block_fnum_hi | 0x20));
+
+		script.AddDelay(static_cast<uint32_t>(delay_dist(rng)));
+	}
+	script.AddDelay(1000);
+	return script;
+}
+
+// Percussion mode with all five drums
+OplScript make_rhythm_script(const uint32_t seed)
+{
+	std::mt19937 rng(seed);
+	std::uniform_int_distribution<int> byte(0, 255);
+
+	OplScript script = {};
+	script.AddWrite(0x01, 0x20);
+	for (const auto offset : {0x10, 0x11, 0x12, 0x13, 0x14, 0x15}) {
+		write_instrument(script, rng, 0, static_cast<uint8_t>(offset));
+	}
+	for (auto channel = 6; channel < 9; ++channel) {
+		script.AddWrite(static_cast<uint16_t>(0xa0 + channel),
+		             static_cast<uint8_t>(byte(rng)));
+		script.AddWrite(static_cast<uint16_t>(0xb0 + channel),
+		             static_cast<uint8_t>(byte(rng) & 0x1f));
+		script.AddWrite(static_cast<uint16_t>(0xc0 + channel),
+		             static_cast<uint8_t>(byte(rng)));
+	}
+	for (auto hit = 0; hit < 300; ++hit) {
+		script.AddWrite(0xbd, 0x20);
+		script.AddWrite(0xbd, static_cast<uint8_t>(0x20 | (byte(rng) & 0xdf)));
+		script.AddDelay(static_cast<uint32_t>(1 + (byte(rng) & 0x1f)));
+	}
+	script.AddDelay(500);
+	return script;
+}
+
+// Random writes to all the registers the raw OPL capture records, including
+// the mode switches
+OplScript make_random_script(const uint32_t seed)
+{
+	std::vector<uint16_t> regs = {0x01, 0x04, 0x05, 0x08, 0xbd};
+	for (const auto base : {0x20, 0x40, 0x60, 0x80, 0xe0}) {
+		for (auto offset = 0; offset < 0x16; ++offset) {
+			if ((offset & 7) < 6) {
+				regs.push_back(static_cast<uint16_t>(base + offset));
+			}
+		}
+	}
+	for (const auto base : {0xa0, 0xb0, 0xc0}) {
+		for (auto channel = 0; channel < 9; ++channel) {
+			regs.push_back(static_cast<uint16_t>(base + channel));
+		}
+	}
+
+	std::mt19937 rng(seed);
+	std::uniform_int_distribution<int> byte(0, 255);
+	std::uniform_int_distribution<size_t> reg_dist(0, regs.size() - 1);
+	std::uniform_int_distribution<int> delay_dist(0, 7);
+
+	OplScript script = {};
+	script.AddWrite(0x105, 0x01);
+	for (auto i = 0; i < 6000; ++i) {
+		const auto bank = static_cast<uint16_t>((byte(rng) & 1) << 8);
+		script.AddWrite(bank | regs[reg_dist(rng)], static_cast<uint8_t>(byte(rng)));
+
+		if (const auto delay_ms = delay_dist(rng); delay_ms > 0) {
+			script.AddDelay(static_cast<uint32_t>(delay_ms));
+		}
+	}
+	script.AddDelay(500);
+	return script;
+}
+
+TEST(Opl3Simd, ParsesDroCapture)
+{
+	const auto capture = read_file(FixtureDro);
+	ASSERT_FALSE(capture.empty()) << "Can't read " << FixtureDro;
+
+	// OPL3 hardware type
+	EXPECT_EQ(capture[20], 2);
+
+	const auto read_le32 = [&](const size_t pos) {
+		return static_cast<uint32_t>(capture[pos] | (capture[pos + 1] << 8) |
+		                             (capture[pos + 2] << 16) |
+		                             (capture[pos + 3] << 24));
+	};
+
+	// Every register write and delay is one command
+	const auto script  = parse_dro(capture);
+	const auto& events = script.GetEvents();
+	EXPECT_EQ(events.size(), read_le32(12));
+
+	uint32_t total_ms = 0;
+	for (const auto& event : events) {
+		total_ms += event.delay_ms;
+	}
+	EXPECT_EQ(total_ms, read_le32(16));
+}
+
+TEST(Opl3Simd, MatchesScalarDroCapture)
+{
+	const auto capture = read_file(FixtureDro);
+	ASSERT_FALSE(capture.empty()) << "Can't read " << FixtureDro;
+
+	expect_identical_output(parse_dro(capture));
+}
+
+TEST(Opl3Simd, MatchesScalarOpl2Melodic)
+{
+	expect_identical_output(make_melodic_script(false, 1));
+}
+
+TEST(Opl3Simd, MatchesScalarOpl3Melodic)
+{
+	expect_identical_output(make_melodic_script(true, 2));
+	expect_identical_output(make_melodic_script(true, 3));
+}
+
+TEST(Opl3Simd, MatchesScalarRhythm)
+{
+	expect_identical_output(make_rhythm_script(4));
+}
+
+TEST(Opl3Simd, MatchesScalarRandomWrites)
+{
+	expect_identical_output(make_random_script(5));
+	expect_identical_output(make_random_script(6));
+}
+
+} // namespace
+
+#endif // OPL_ENABLE_SIMD
@@ -0,0 +1,153 @@
+// SPDX-FileCopyrightText:  2026-2026 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "hardware/audio/private/opl_write_timing.h"
+
+#include <gtest/gtest.h>
+
+#include <utility>
+#include <vector>
+
+namespace {
+
+// 8 kHz keeps the frame times exact in floating point
+constexpr double MsPerFrame = 0.125;
+constexpr int BlockFrames   = 64;
+constexpr double BlockMs    = BlockFrames * MsPerFrame;
+
+struct TestWrite {
+	double timestamp_ms = 0.0;
+	int id              = 0;
+};
+
+class OplWriteTimingTest : public ::testing::Test {
+protected:
+	void Queue(const double timestamp_ms, const int id)
+	{
+		ASSERT_TRUE(write_queue.Push({timestamp_ms, id}));
+	}
+
+	// Renders a block at the given emulated time, and records the frame
+	// each write got applied at and the parts the block was rendered in
+	void RenderBlock(const double now_ms)
+	{
+		render_block_with_queued_writes(
+		        write_queue,
+		        last_rendered_ms,
+		        MsPerFrame,
+		        now_ms,
+		        BlockFrames,
+		        [&](const TestWrite& write) {
+			        applied.emplace_back(write.id, frames_rendered);
+		        },
+		        [&](const int first_frame, const int num_frames) {
+			        EXPECT_EQ(block_start + first_frame, frames_rendered);
+			        renders.emplace_back(first_frame, num_frames);
+			        frames_rendered += num_frames;
+		        });
+
+		EXPECT_EQ(frames_rendered, block_start + BlockFrames);
+		block_start = frames_rendered;
+	}
+
+	SpscRingBuffer<TestWrite> write_queue{64};
+	double last_rendered_ms = 0.0;
+
+	int frames_rendered = 0;
+	int block_start     = 0;
+
+	// Write IDs with the frames they were applied at
+	std::vector<std::pair<int, int>> applied = {};
+
+	// The first frame and number of frames of the renders
+	std::vector<std::pair<int, int>> renders = {};
+};
+
+using Applied = std::vector<std::pair<int, int>>;
+using Renders = std::vector<std::pair<int, int>>;
+
+TEST_F(OplWriteTimingTest, AppliesWritesAtTheirFrameOffsets)
+{
+	Queue(0.0, 1);
+	Queue(1.0, 2);
+	Queue(1.05, 3);
+	Queue(1.05, 4);
+	RenderBlock(BlockMs);
+
+	// A write lands on the first frame at or after its timestamp, and
+	// writes of the same frame are applied together in order
+	EXPECT_EQ(applied, (Applied{{1, 0}, {2, 8}, {3, 9}, {4, 9}}));
+
+	// The block is only split where the writes land
+	EXPECT_EQ(renders, (Renders{{0, 8}, {8, 1}, {9, 55}}));
+	EXPECT_TRUE(write_queue.IsEmpty());
+	EXPECT_EQ(last_rendered_ms, BlockMs);
+}
+
+TEST_F(OplWriteTimingTest, CarriesWritesOverToTheNextBlock)
+{
+	// The last write happens during the first block's time, but after its
+	// last frame
+	Queue(2.0, 1);
+	Queue(7.9, 2);
+	Queue(BlockMs + 0.5, 3);
+
+	RenderBlock(BlockMs);
+	EXPECT_EQ(applied, (Applied{{1, 16}}));
+	EXPECT_EQ(renders, (Renders{{0, 16}, {16, 48}}));
+	EXPECT_EQ(write_queue.Size(), 2);
+
+	RenderBlock(2 * BlockMs);
+	EXPECT_EQ(applied, (Applied{{1, 16}, {2, 64}, {3, 68}}));
+	EXPECT_EQ(renders, (Renders{{0, 16}, {16, 48}, {0, 4}, {4, 60}}));
+	EXPECT_TRUE(write_queue.IsEmpty());
+}
+
+TEST_F(OplWriteTimingTest, KeepsRenderClockWithinABlockOfDrift)
+{
+	RenderBlock(BlockMs);
+
+	// The emulated time ran ahead by less than a block, so the render
+	// clock runs on from the previous block
+	constexpr auto Drift = BlockMs / 2;
+	RenderBlock(2 * BlockMs + Drift);
+	EXPECT_EQ(last_rendered_ms, 2 * BlockMs);
+
+	Queue(2 * BlockMs + 1.0, 1);
+	RenderBlock(3 * BlockMs + Drift);
+	EXPECT_EQ(applied, (Applied{{1, 2 * BlockFrames + 8}}));
+}
+
+TEST_F(OplWriteTimingTest, ResyncsRenderClockToEmulatedTime)
+{
+	RenderBlock(BlockMs);
+
+	// The emulated time jumped ahead by more than a block (e.g., the
+	// channel slept or fast-forward mode is on), so the block is rendered
+	// as the one ending at the current time
+	constexpr auto Now = 100.0;
+
+	Queue(50.0, 1);
+	Queue(Now - BlockMs + 3.0, 2);
+	RenderBlock(Now);
+
+	// Writes from before the block land on its first frame
+	EXPECT_EQ(applied, (Applied{{1, BlockFrames}, {2, BlockFrames + 24}}));
+	EXPECT_EQ(last_rendered_ms, Now);
+}
+
+TEST_F(OplWriteTimingTest, ResyncsRenderClockWhenBehindEmulatedTime)
+{
+	last_rendered_ms = 100.0;
+
+	// The emulated time went back (e.g., after a reset)
+	constexpr auto Now = 20.0;
+
+	Queue(Now - 1.0, 1);
+	RenderBlock(Now);
+
+	EXPECT_EQ(applied, (Applied{{1, 56}}));
+	EXPECT_EQ(last_rendered_ms, Now);
+}
+
+} // namespace
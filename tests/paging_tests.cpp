@@ -0,0 +1,106 @@
+// SPDX-FileCopyrightText:  2026-2026 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "cpu/paging.h"
+
+#include <gtest/gtest.h>
+
+#include "dosbox_test_fixture.h"
+
+namespace {
+
+class PagingTlbTest : public DOSBoxTestFixture {};
+
+// Above the first megabyte, so the page is linked 1:1 with paging disabled
+constexpr PhysPt TestAddress = 0x200000;
+
+TEST_F(PagingTlbTest, LinksPageOnMiss)
+{
+	PAGING_ClearTLB();
+	PAGING_ResetTlbStats();
+	ASSERT_EQ(get_tlb_read(TestAddress), nullptr);
+
+	mem_writed(TestAddress, 0x12345678);
+
+	EXPECT_NE(get_tlb_read(TestAddress), nullptr);
+	EXPECT_NE(get_tlb_write(TestAddress), nullptr);
+	EXPECT_EQ(paging.stats.misses, 1);
+
+	// The page is cached now
+	EXPECT_EQ(mem_readd(TestAddress), 0x12345678u);
+	EXPECT_EQ(paging.stats.misses, 1);
+}
+
+TEST_F(PagingTlbTest, InvalidatePageOnlyDropsThatPage)
+{
+	constexpr PhysPt OtherAddress = TestAddress + MEM_PAGE_SIZE;
+
+	PAGING_ClearTLB();
+	mem_writed(OtherAddress, 0xcafe);
+	mem_writed(TestAddress, 0xbeef);
+	PAGING_ResetTlbStats();
+
+	const auto links_used = paging.links.used;
+	PAGING_InvalidatePage(TestAddress + 0x123);
+
+	EXPECT_EQ(get_tlb_read(TestAddress), nullptr);
+	EXPECT_EQ(get_tlb_write(TestAddress), nullptr);
+	EXPECT_NE(get_tlb_read(OtherAddress), nullptr);
+	EXPECT_EQ(paging.stats.invalidations, 1);
+	EXPECT_EQ(paging.stats.flushes, 0);
+
+	// The most recent link gets dropped as well
+	EXPECT_EQ(paging.links.used, links_used - 1);
+
+	// The page gets linked again on the next access
+	EXPECT_EQ(mem_readd(TestAddress), 0xbeefu);
+	EXPECT_EQ(paging.stats.misses, 1);
+	EXPECT_EQ(paging.links.used, links_used);
+}
+
+TEST_F(PagingTlbTest, ClearCountsFlushedPages)
+{
+	PAGING_ClearTLB();
+	mem_readb(TestAddress);
+	mem_readb(TestAddress + MEM_PAGE_SIZE);
+	PAGING_ResetTlbStats();
+
+	PAGING_ClearTLB();
+
+	EXPECT_EQ(paging.stats.flushes, 1);
+	EXPECT_EQ(paging.stats.flushed_pages, 2);
+	EXPECT_EQ(paging.links.used, 0);
+	EXPECT_EQ(get_tlb_read(TestAddress), nullptr);
+}
+
+TEST_F(PagingTlbTest, HostSpanOfRamLinksPages)
+{
+	// Spans three pages, none of them linked yet
+	constexpr PhysPt SpanAddress = TestAddress + 0x800;
+	constexpr size_t SpanSize    = 2 * MEM_PAGE_SIZE;
+
+	PAGING_ClearTLB();
+
+	const auto span = MEM_GetHostWriteSpan(SpanAddress, SpanSize);
+	ASSERT_NE(span, nullptr);
+	EXPECT_EQ(MEM_GetHostReadSpan(SpanAddress, SpanSize), span);
+
+	span[0]            = 0x12;
+	span[SpanSize - 1] = 0x34;
+	EXPECT_EQ(mem_readb(SpanAddress), 0x12);
+	EXPECT_EQ(mem_readb(SpanAddress + SpanSize - 1), 0x34);
+}
+
+TEST_F(PagingTlbTest, HostSpanExcludesNonRamPages)
+{
+	PAGING_ClearTLB();
+
+	// The BIOS ROM, and a span crossing into it
+	EXPECT_EQ(MEM_GetHostWriteSpan(0xf0000, 16), nullptr);
+	EXPECT_EQ(MEM_GetHostReadSpan(0xf0000, 16), nullptr);
+	EXPECT_EQ(MEM_GetHostWriteSpan(0xeff00, 0x200), nullptr);
+
+	EXPECT_EQ(MEM_GetHostWriteSpan(TestAddress, 0), nullptr);
+}
+
+} // namespace
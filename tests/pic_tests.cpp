@@ -0,0 +1,141 @@
+// SPDX-FileCopyrightText:  2026-2026 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "hardware/pic.h"
+
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "cpu/cpu.h"
+#include "hardware/timer.h"
+
+namespace {
+
+constexpr auto CyclesPerTick = 1000;
+
+std::vector<uint32_t> fired = {};
+
+void handler_a(uint32_t val)
+{
+	fired.push_back(val);
+}
+
+void handler_b(uint32_t val)
+{
+	fired.push_back(val + 1000);
+}
+
+class PicEventQueueTest : public ::testing::Test {
+protected:
+	void SetUp() override
+	{
+		CPU_CycleMax  = CyclesPerTick;
+		CPU_CycleLeft = CyclesPerTick;
+		CPU_Cycles    = 0;
+
+		PIC_Init();
+		fired.clear();
+	}
+
+	void TearDown() override
+	{
+		PIC_Destroy();
+	}
+
+	// Runs the queue as if the CPU had executed the given fraction of the
+	// current tick
+	static void run_until(const double fraction)
+	{
+		CPU_CycleLeft = CyclesPerTick -
+		                static_cast<int>(fraction * CyclesPerTick);
+		CPU_Cycles = 0;
+		PIC_RunQueue();
+	}
+};
+
+TEST_F(PicEventQueueTest, FiresInIndexOrder)
+{
+	PIC_AddEvent(handler_a, 0.3, 3);
+	PIC_AddEvent(handler_a, 0.1, 1);
+	PIC_AddEvent(handler_a, 0.2, 2);
+
+	run_until(0.15);
+	EXPECT_EQ(fired, (std::vector<uint32_t>{1}));
+
+	run_until(0.5);
+	EXPECT_EQ(fired, (std::vector<uint32_t>{1, 2, 3}));
+}
+
+TEST_F(PicEventQueueTest, EqualIndicesFireInInsertionOrder)
+{
+	for (uint32_t i = 0; i < 10; ++i) {
+		PIC_AddEvent((i % 2) ? handler_a : handler_b, 0.25, i);
+	}
+	run_until(0.5);
+
+	const std::vector<uint32_t> expected = {
+	        1000, 1, 1002, 3, 1004, 5, 1006, 7, 1008, 9};
+	EXPECT_EQ(fired, expected);
+}
+
+TEST_F(PicEventQueueTest, RemoveEvents)
+{
+	PIC_AddEvent(handler_a, 0.1, 1);
+	PIC_AddEvent(handler_b, 0.2, 2);
+	PIC_AddEvent(handler_a, 0.3, 3);
+	PIC_AddEvent(handler_b, 0.4, 4);
+
+	PIC_RemoveEvents(handler_a);
+	run_until(0.5);
+
+	EXPECT_EQ(fired, (std::vector<uint32_t>{1002, 1004}));
+}
+
+TEST_F(PicEventQueueTest, RemoveSpecificEvents)
+{
+	PIC_AddEvent(handler_a, 0.1, 1);
+	PIC_AddEvent(handler_a, 0.2, 2);
+	PIC_AddEvent(handler_b, 0.3, 2);
+	PIC_AddEvent(handler_a, 0.4, 2);
+	PIC_AddEvent(handler_a, 0.5, 3);
+
+	PIC_RemoveSpecificEvents(handler_a, 2);
+	run_until(0.9);
+
+	EXPECT_EQ(fired, (std::vector<uint32_t>{1, 1002, 3}));
+}
+
+TEST_F(PicEventQueueTest, CarriesOverToNextTick)
+{
+	PIC_AddEvent(handler_a, 1.5, 1);
+	PIC_AddEvent(handler_a, 0.5, 0);
+
+	run_until(0.9);
+	EXPECT_EQ(fired, (std::vector<uint32_t>{0}));
+
+	TIMER_AddTick();
+	run_until(0.4);
+	EXPECT_EQ(fired, (std::vector<uint32_t>{0}));
+
+	run_until(0.6);
+	EXPECT_EQ(fired, (std::vector<uint32_t>{0, 1}));
+}
+
+TEST_F(PicEventQueueTest, NoFixedCapacity)
+{
+	constexpr uint32_t NumEvents = 5000;
+
+	for (uint32_t i = 0; i < NumEvents; ++i) {
+		PIC_AddEvent(handler_a, 0.5 - i * 0.00001, i);
+	}
+	run_until(0.9);
+
+	ASSERT_EQ(fired.size(), NumEvents);
+	for (uint32_t i = 0; i < NumEvents; ++i) {
+		EXPECT_EQ(fired[i], NumEvents - 1 - i);
+	}
+}
+
+} // namespace
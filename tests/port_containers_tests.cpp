@@ -122,6 +122,55 @@ TEST(port_containers, empty_writes)
 	write_byte_to_port(unregistered, 0);
 }
 
+TEST(port_containers, released_handlers_are_reused)
+{
+	constexpr uint16_t first_port = 0x1080;
+	constexpr uint16_t num_ports  = 16;
+
+	const auto num_handlers = io_read_handlers.NumHandlers();
+
+	IO_RegisterReadHandler(first_port, read_word_new, io_width_t::word, num_ports);
+	EXPECT_EQ(io_read_handlers.NumHandlers(), num_handlers + 1);
+
+	IO_FreeReadHandler(first_port, io_width_t::word, num_ports);
+	EXPECT_EQ(io_read_handlers.NumHandlers(), num_handlers);
+
+	constexpr uint16_t unregistered = 0xffff;
+	EXPECT_EQ(static_cast<uint16_t>(-1), read_word_from_port(first_port));
+	EXPECT_EQ(static_cast<uint16_t>(-1), read_word_from_port(unregistered - 1));
+}
+
+TEST(port_containers, handler_can_register_handlers)
+{
+	constexpr uint16_t first_port = 0x2000;
+	constexpr uint16_t num_ports  = 512;
+
+	// The handler's captured state has to stay valid while the handler adds
+	// enough others to grow the handler list many times over. It's small
+	// enough to be stored inside the std::function itself.
+	uint8_t first  = 0x12;
+	uint8_t second = 0x34;
+
+	IO_RegisterReadHandler(
+	        first_port,
+	        [first, second](io_port_t, io_width_t) -> uint8_t {
+		        for (uint16_t i = 1; i <= num_ports; ++i) {
+			        IO_RegisterReadHandler(first_port + i,
+			                               [i](io_port_t, io_width_t) -> uint8_t {
+				                               return static_cast<uint8_t>(i);
+			                               },
+			                               io_width_t::byte);
+		        }
+		        return static_cast<uint8_t>(first + second);
+	        },
+	        io_width_t::byte);
+
+	EXPECT_EQ(read_byte_from_port(first_port), 0x46);
+	EXPECT_EQ(read_byte_from_port(first_port + num_ports), num_ports & 0xff);
+
+	IO_FreeReadHandler(first_port, io_width_t::byte, num_ports + 1);
+}
+
 // The following tests are temporarily disabled as they
 // are currently failing on all platforms.
 // Investigations have revealed the test cases rely on 
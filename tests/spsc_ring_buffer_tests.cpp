@@ -0,0 +1,143 @@
+// SPDX-FileCopyrightText:  2026-2026 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "utils/spsc_ring_buffer.h"
+
+#include <gtest/gtest.h>
+
+#include <numeric>
+#include <thread>
+#include <vector>
+
+namespace {
+
+TEST(SpscRingBuffer, CapacityIsRoundedUpToPowerOfTwo)
+{
+	SpscRingBuffer<int> buf(100);
+	EXPECT_EQ(buf.Capacity(), 128);
+	EXPECT_EQ(buf.Size(), 0);
+	EXPECT_TRUE(buf.IsEmpty());
+}
+
+TEST(SpscRingBuffer, PushAndPop)
+{
+	SpscRingBuffer<int> buf(8);
+
+	const std::vector<int> items = {1, 2, 3, 4, 5};
+	EXPECT_EQ(buf.Push(items.data(), items.size()), 5);
+	EXPECT_EQ(buf.Size(), 5);
+
+	for (size_t i = 0; i < items.size(); ++i) {
+		EXPECT_EQ(buf[i], items[i]);
+	}
+
+	buf.Pop(2);
+	EXPECT_EQ(buf.Size(), 3);
+	EXPECT_EQ(buf[0], 3);
+	EXPECT_EQ(buf[2], 5);
+
+	buf.Pop(3);
+	EXPECT_TRUE(buf.IsEmpty());
+}
+
+TEST(SpscRingBuffer, WrapsAround)
+{
+	SpscRingBuffer<int> buf(8);
+
+	int next_push = 0;
+	int next_pop  = 0;
+
+	for (auto round = 0; round < 20; ++round) {
+		std::vector<int> items(5);
+		std::iota(items.begin(), items.end(), next_push);
+		next_push += 5;
+
+		ASSERT_EQ(buf.Push(items.data(), items.size()), 5);
+
+		for (size_t i = 0; i < buf.Size(); ++i) {
+			EXPECT_EQ(buf[i], next_pop + static_cast<int>(i));
+		}
+		buf.Pop(5);
+		next_pop += 5;
+	}
+	EXPECT_TRUE(buf.IsEmpty());
+}
+
+TEST(SpscRingBuffer, DropsItemsWhenFull)
+{
+	SpscRingBuffer<int> buf(4);
+
+	const std::vector<int> items = {1, 2, 3, 4, 5, 6};
+	EXPECT_EQ(buf.Push(items.data(), items.size()), 4);
+	EXPECT_EQ(buf.Size(), 4);
+	EXPECT_FALSE(buf.Push(7));
+	EXPECT_EQ(buf[3], 4);
+
+	buf.Pop(1);
+	EXPECT_TRUE(buf.Push(7));
+	EXPECT_EQ(buf[3], 7);
+}
+
+TEST(SpscRingBuffer, ReserveKeepsItems)
+{
+	SpscRingBuffer<int> buf(4);
+
+	const std::vector<int> items = {1, 2, 3, 4};
+	buf.Push(items.data(), items.size());
+	buf.Pop(2);
+	buf.Push(5);
+	buf.Push(6);
+
+	// The items now wrap around the end of the buffer
+	buf.Reserve(16);
+	EXPECT_EQ(buf.Capacity(), 16);
+	ASSERT_EQ(buf.Size(), 4);
+	for (size_t i = 0; i < buf.Size(); ++i) {
+		EXPECT_EQ(buf[i], static_cast<int>(i) + 3);
+	}
+
+	// Reserving less than the capacity does nothing
+	buf.Reserve(8);
+	EXPECT_EQ(buf.Capacity(), 16);
+	EXPECT_EQ(buf.Size(), 4);
+}
+
+TEST(SpscRingBuffer, Clear)
+{
+	SpscRingBuffer<int> buf(4);
+	buf.Push(1);
+	buf.Push(2);
+
+	buf.Clear();
+	EXPECT_TRUE(buf.IsEmpty());
+	EXPECT_EQ(buf.Capacity(), 4);
+}
+
+TEST(SpscRingBuffer, ProducerAndConsumerThreads)
+{
+	constexpr auto NumItems = 100'000;
+
+	SpscRingBuffer<int> buf(64);
+
+	std::thread producer([&] {
+		for (auto i = 0; i < NumItems;) {
+			if (buf.Push(i)) {
+				++i;
+			}
+		}
+	});
+
+	auto expected = 0;
+	while (expected < NumItems) {
+		const auto num_items = buf.Size();
+		for (size_t i = 0; i < num_items; ++i) {
+			ASSERT_EQ(buf[i], expected++);
+		}
+		buf.Pop(num_items);
+	}
+	producer.join();
+
+	EXPECT_TRUE(buf.IsEmpty());
+}
+
+} // namespace
@@ -0,0 +1,45 @@
+// SPDX-FileCopyrightText:  2026-2026 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef DOSBOX_TEMP_DIRECTORY_H
+#define DOSBOX_TEMP_DIRECTORY_H
+
+#include <string>
+#include <system_error>
+
+#include "misc/std_filesystem.h"
+
+// A directory under the host's temporary directory for the files of a test.
+// It's created empty, wiping anything a crashed earlier run left behind, and
+// gets removed with all its contents when the object is destroyed. Keep one
+// as a member of a test fixture to get a fresh directory for every test.
+class TempDirectory {
+public:
+	explicit TempDirectory(const std::string& name)
+	        : path(std_fs::temp_directory_path() / name)
+	{
+		std_fs::remove_all(path);
+		std_fs::create_directories(path);
+	}
+
+	~TempDirectory()
+	{
+		std::error_code ec = {};
+		std_fs::remove_all(path, ec);
+	}
+
+	// prevent copying
+	TempDirectory(const TempDirectory&) = delete;
+	// prevent assignment
+	TempDirectory& operator=(const TempDirectory&) = delete;
+
+	const std_fs::path& GetPath() const
+	{
+		return path;
+	}
+
+private:
+	std_fs::path path = {};
+};
+
+#endif // DOSBOX_TEMP_DIRECTORY_H
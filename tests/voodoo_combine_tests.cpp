@@ -0,0 +1,112 @@
+// SPDX-FileCopyrightText:  2026-2026 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "hardware/video/voodoo_combine.h"
+
+#include <array>
+#include <random>
+
+#include <gtest/gtest.h>
+
+// Texture modulated by the iterated color, the most common combine mode
+static voodoo_combine_mode modulate_mode()
+{
+	voodoo_combine_mode mode = {};
+	mode.reverse_blend       = true;
+	mode.reverse_blend_alpha = true;
+	return mode;
+}
+
+TEST(voodoo_combine, Modulate)
+{
+	const auto mode = modulate_mode();
+
+	EXPECT_EQ(voodoo_color_combine(mode, {0xff804020, 0xffffffff, 0xffffffff}),
+	          0xff804020u);
+	EXPECT_EQ(voodoo_color_combine(mode, {0xff804020, 0xff7f7f7f, 0xff7f7f7f}),
+	          0xff402010u);
+	EXPECT_EQ(voodoo_color_combine(mode, {0xff804020, 0x00000000, 0x00000000}),
+	          0x00000000u);
+}
+
+TEST(voodoo_combine, SubtractAndClamp)
+{
+	voodoo_combine_mode mode = {};
+	mode.sub_local           = true;
+	mode.sub_local_alpha     = true;
+	mode.add_local           = 1;
+
+	// (other - local) * 256 / 256 + local == other, clamped per channel
+	EXPECT_EQ(voodoo_color_combine(mode, {0x10203040, 0x40302010, 0}),
+	          0x00203040u);
+
+	mode.add_local = 0;
+	EXPECT_EQ(voodoo_color_combine(mode, {0x10203040, 0x40302010, 0}),
+	          0x00001030u);
+}
+
+TEST(voodoo_combine, Invert)
+{
+	voodoo_combine_mode mode = {};
+	mode.zero_other          = true;
+	mode.zero_other_alpha    = true;
+	mode.invert              = true;
+
+	EXPECT_EQ(voodoo_color_combine(mode, {0x12345678, 0x9abcdef0, 0}),
+	          0x00ffffffu);
+
+	mode.invert_alpha = true;
+	EXPECT_EQ(voodoo_color_combine(mode, {0x12345678, 0x9abcdef0, 0}),
+	          0xffffffffu);
+}
+
+TEST(voodoo_combine, BatchMatchesScalar)
+{
+	constexpr auto NumPixels = 16;
+
+	std::mt19937 rng(1234);
+
+	// Every mode, with random colors and blend factors biased towards the
+	// extremes where the rounding and the clamping matter
+	for (uint32_t bits = 0; bits < (1 << 11); ++bits) {
+		voodoo_combine_mode mode = {};
+		mode.zero_other          = bits & (1 << 0);
+		mode.zero_other_alpha    = bits & (1 << 1);
+		mode.sub_local           = bits & (1 << 2);
+		mode.sub_local_alpha     = bits & (1 << 3);
+		mode.reverse_blend       = bits & (1 << 4);
+		mode.reverse_blend_alpha = bits & (1 << 5);
+		mode.add_local           = static_cast<uint8_t>((bits >> 6) & 3);
+		mode.add_local_alpha     = bits & (1 << 8);
+		mode.invert              = bits & (1 << 9);
+		mode.invert_alpha        = bits & (1 << 10);
+
+		std::array<uint32_t, NumPixels> c_other = {};
+		std::array<uint32_t, NumPixels> c_local = {};
+		std::array<uint32_t, NumPixels> blend   = {};
+		std::array<uint32_t, NumPixels> result  = {};
+
+		for (auto i = 0; i < NumPixels; ++i) {
+			c_other[i] = rng();
+			c_local[i] = rng();
+			switch (i % 4) {
+			case 0: blend[i] = 0; break;
+			case 1: blend[i] = 0xffffffff; break;
+			default: blend[i] = rng(); break;
+			}
+		}
+
+		voodoo_color_combine_batch(voodoo_make_combine_masks(mode),
+		                           c_other.data(),
+		                           c_local.data(),
+		                           blend.data(),
+		                           NumPixels,
+		                           result.data());
+
+		for (auto i = 0; i < NumPixels; ++i) {
+			const auto expected = voodoo_color_combine(
+			        mode, {c_other[i], c_local[i], blend[i]});
+			ASSERT_EQ(result[i], expected) << "mode bits " << bits;
+		}
+	}
+}
@@ -0,0 +1,180 @@
+// SPDX-FileCopyrightText:  2026-2026 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "capture/video/zmbv.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+
+// The motion search of the delta frames compares and XORs the blocks with
+// SIMD, and is split across threads on frames of 512 blocks or more. These
+// check the encoded frames are the same as with the plain, single-threaded
+// search.
+
+namespace {
+
+constexpr auto NumFrames = 6;
+
+// The frames scroll over a larger picture so most blocks find a motion
+// vector, and some blocks get new content in every frame
+constexpr auto ScrollMargin = 16;
+
+struct FrameSize {
+	int width  = 0;
+	int height = 0;
+};
+
+class Picture {
+public:
+	Picture(const int width, const int height, const int bytes_per_pixel)
+	        : width(width + 2 * ScrollMargin),
+	          height(height + 2 * ScrollMargin),
+	          bytes_per_pixel(bytes_per_pixel),
+	          pixels(static_cast<size_t>(this->width * this->height * bytes_per_pixel))
+	{
+		// Coarse noise, so the blocks aren't all alike
+		std::uniform_int_distribution<int> byte(0, 255);
+		for (auto& p : pixels) {
+			p = static_cast<uint8_t>(byte(rng) & 0xf0);
+		}
+	}
+
+	// Scatters new pixels over the picture
+	void Change(const int num_pixels)
+	{
+		std::uniform_int_distribution<int> x_dist(0, width - 1);
+		std::uniform_int_distribution<int> y_dist(0, height - 1);
+		std::uniform_int_distribution<int> byte(0, 255);
+
+		for (auto i = 0; i < num_pixels; ++i) {
+			auto p = Pixel(x_dist(rng), y_dist(rng));
+			for (auto b = 0; b < bytes_per_pixel; ++b) {
+				p[b] = static_cast<uint8_t>(byte(rng));
+			}
+		}
+	}
+
+	uint8_t* Pixel(const int x, const int y)
+	{
+		return &pixels[static_cast<size_t>((y * width + x) * bytes_per_pixel)];
+	}
+
+private:
+	int width           = 0;
+	int height          = 0;
+	int bytes_per_pixel = 0;
+
+	std::vector<uint8_t> pixels = {};
+	std::mt19937 rng            = std::mt19937(42);
+};
+
+// Encodes the same scrolling picture with the plain, single-threaded search
+// and with the SIMD search on four threads, and compares each frame
+void check_frames_match(const FrameSize size, const ZMBV_FORMAT format)
+{
+	VideoCodec plain_codec    = {};
+	VideoCodec threaded_codec = {};
+
+	plain_codec.SetSearchOptions(false, 1);
+	threaded_codec.SetSearchOptions(true, 4);
+
+	ASSERT_TRUE(plain_codec.SetupCompress(size.width, size.height));
+	ASSERT_TRUE(threaded_codec.SetupCompress(size.width, size.height));
+
+	const auto buf_size = static_cast<uint32_t>(
+	        plain_codec.NeededSize(size.width, size.height, format));
+
+	std::vector<uint8_t> plain_frame(buf_size);
+	std::vector<uint8_t> threaded_frame(buf_size);
+
+	uint8_t palette[256 * 4] = {};
+	for (auto i = 0; i < 256 * 4; ++i) {
+		palette[i] = static_cast<uint8_t>(i * 7);
+	}
+	const auto pal = (format == ZMBV_FORMAT::BPP_8) ? palette : nullptr;
+
+	const auto bytes_per_pixel = ZMBV_ToBytesPerPixel(format);
+	Picture picture(size.width, size.height, bytes_per_pixel);
+
+	// Odd and negative motion as well
+	constexpr int Scroll[NumFrames][2] = {
+	        {0, 0}, {3, 1}, {-2, 5}, {0, -7}, {9, 0}, {-1, -1}};
+
+	auto x = ScrollMargin;
+	auto y = ScrollMargin;
+
+	for (auto f = 0; f < NumFrames; ++f) {
+		x += Scroll[f][0];
+		y += Scroll[f][1];
+		picture.Change(size.width * size.height / 64);
+
+		const auto flags = (f == 0) ? 1 : 0;
+		ASSERT_TRUE(plain_codec.PrepareCompressFrame(
+		        flags, format, pal, plain_frame.data(), buf_size));
+		ASSERT_TRUE(threaded_codec.PrepareCompressFrame(
+		        flags, format, pal, threaded_frame.data(), buf_size));
+
+		for (auto line = 0; line < size.height; ++line) {
+			const uint8_t* row = picture.Pixel(x, y + line);
+			plain_codec.CompressLines(1, &row);
+			threaded_codec.CompressLines(1, &row);
+		}
+
+		const auto plain_size    = plain_codec.FinishCompressFrame();
+		const auto threaded_size = threaded_codec.FinishCompressFrame();
+
+		ASSERT_GT(plain_size, 0);
+		ASSERT_EQ(threaded_size, plain_size) << "frame " << f;
+		ASSERT_EQ(std::memcmp(threaded_frame.data(),
+		                      plain_frame.data(),
+		                      static_cast<size_t>(plain_size)),
+		          0)
+		        << "frame " << f;
+	}
+
+	plain_codec.FinishVideo();
+	threaded_codec.FinishVideo();
+}
+
+// 32 by 16 blocks, the fewest the search is split across threads for
+constexpr FrameSize AtThreshold = {512, 256};
+
+// Narrower blocks at the right and bottom edges, which leave tails to the
+// scalar loops
+constexpr FrameSize AboveThreshold = {648, 488};
+
+TEST(ZmbvEncoder, SearchMatchesPlainAtThreshold8Bpp)
+{
+	check_frames_match(AtThreshold, ZMBV_FORMAT::BPP_8);
+}
+
+TEST(ZmbvEncoder, SearchMatchesPlainAtThreshold16Bpp)
+{
+	check_frames_match(AtThreshold, ZMBV_FORMAT::BPP_16);
+}
+
+TEST(ZmbvEncoder, SearchMatchesPlainAtThreshold32Bpp)
+{
+	check_frames_match(AtThreshold, ZMBV_FORMAT::BPP_32);
+}
+
+TEST(ZmbvEncoder, SearchMatchesPlainAboveThreshold8Bpp)
+{
+	check_frames_match(AboveThreshold, ZMBV_FORMAT::BPP_8);
+}
+
+TEST(ZmbvEncoder, SearchMatchesPlainAboveThreshold16Bpp)
+{
+	check_frames_match(AboveThreshold, ZMBV_FORMAT::BPP_16);
+}
+
+TEST(ZmbvEncoder, SearchMatchesPlainAboveThreshold32Bpp)
+{
+	check_frames_match(AboveThreshold, ZMBV_FORMAT::BPP_32);
+}
+
+} // namespace